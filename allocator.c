@@ -0,0 +1,1139 @@
+/** !
+ * Implementation of pluggable allocators
+ *
+ * @file allocator.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/allocator.h>
+
+// Standard library
+#include <stdlib.h>
+#include <string.h>
+
+// POSIX
+#include <pthread.h>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+// Structure definitions
+struct hash_cache_slab_thread_cache_s
+{
+    hash_cache_slab                       *p_slab;         // The slab that owns the free list, or 0
+    void                                  *p_free;
+    size_t                                 count;
+    unsigned long long                     used;           // When the thread last used the free list
+    struct hash_cache_slab_thread_cache_s *p_prev, *p_next; // The neighboring thread caches of the same slab
+};
+
+// Function declarations
+/** !
+ * Round a size up to a whole quantity of huge pages
+ *
+ * @param size the size in bytes
+ *
+ * @return the rounded size in bytes
+ */
+static inline size_t hash_cache_pages_round ( size_t size )
+{
+
+    // Success
+    return ( size + HASH_CACHE_HUGE_PAGE_SIZE - 1 ) & ~((size_t) HASH_CACHE_HUGE_PAGE_SIZE - 1);
+}
+
+/** !
+ * Heap allocator
+ *
+ * @param p_allocator the allocator
+ * @param p           pointer to resize, or null pointer
+ * @param size        the new size in bytes, or zero to free
+ *
+ * @return pointer to memory on success, null pointer on error or free
+ */
+static void *hash_cache_heap_realloc ( hash_cache_allocator *const p_allocator, void *p, size_t size );
+
+/** !
+ * Arena allocator
+ *
+ * @param p_allocator the arena
+ * @param p           pointer to resize, or null pointer
+ * @param size        the new size in bytes, or zero to free
+ *
+ * @return pointer to memory on success, null pointer on error or free
+ */
+static void *hash_cache_arena_realloc ( hash_cache_allocator *const p_allocator, void *p, size_t size );
+
+/** !
+ * Get the current position of an arena
+ *
+ * @param p_allocator the arena
+ *
+ * @return the offset of the next allocation
+ */
+static size_t hash_cache_arena_mark ( hash_cache_allocator *const p_allocator );
+
+/** !
+ * Free everything allocated from an arena after a mark
+ *
+ * @param p_allocator the arena
+ * @param mark        the mark
+ *
+ * @return void
+ */
+static void hash_cache_arena_rewind ( hash_cache_allocator *const p_allocator, size_t mark );
+
+/** !
+ * Slab allocator
+ *
+ * @param p_allocator the slab
+ * @param p           pointer to resize, or null pointer
+ * @param size        the new size in bytes, or zero to free
+ *
+ * @return pointer to an object on success, null pointer on error or free
+ */
+static void *hash_cache_slab_realloc ( hash_cache_allocator *const p_allocator, void *p, size_t size );
+
+/** !
+ * Get the calling thread's free list for a slab. If the thread has no free
+ * list for the slab, the least recently used free list is returned to its
+ * slab, and given to this slab.
+ *
+ * @param p_slab the slab
+ *
+ * @return the free list
+ */
+static struct hash_cache_slab_thread_cache_s *hash_cache_slab_thread_cache ( hash_cache_slab *const p_slab );
+
+/** !
+ * Return a thread's free list to the slab that owns it, and forget the slab.
+ * The caller holds the lock of the thread caches.
+ *
+ * @param p_thread_cache the free list
+ *
+ * @return void
+ */
+static void hash_cache_slab_thread_cache_flush ( struct hash_cache_slab_thread_cache_s *const p_thread_cache );
+
+/** !
+ * Return each of an exiting thread's free lists to its slab
+ *
+ * @param p_thread_caches the thread's free lists
+ *
+ * @return void
+ */
+static void hash_cache_slab_thread_exit ( void *p_thread_caches );
+
+/** !
+ * Create the key whose destructor runs when a thread exits
+ *
+ * @param void
+ *
+ * @return void
+ */
+static void hash_cache_slab_thread_key_create ( void );
+
+// Data
+hash_cache_allocator hash_cache_heap_allocator =
+{
+    .pfn_realloc = hash_cache_heap_realloc,
+    .pfn_mark    = (void *) 0,
+    .pfn_rewind  = (void *) 0,
+    .owned       = false
+};
+static pthread_mutex_t   slab_thread_caches_lock = PTHREAD_MUTEX_INITIALIZER; // Guards which slab owns each thread cache
+static pthread_once_t    slab_thread_key_once    = PTHREAD_ONCE_INIT;
+static pthread_key_t     slab_thread_key;
+static bool              slab_thread_key_created = false;
+static __thread struct hash_cache_slab_thread_cache_s slab_thread_caches[HASH_CACHE_SLAB_THREAD_CACHES] = { 0 };
+static __thread unsigned long long                    slab_thread_clock = 0;
+
+// Function definitions
+int hash_cache_arena_construct ( hash_cache_arena **const pp_arena, size_t size )
+{
+
+    // Argument check
+    if ( pp_arena == (void *) 0 ) goto no_arena;
+    if ( size     ==          0 ) goto invalid_size;
+
+    // Initialized data
+    hash_cache_arena *p_arena = HASH_CACHE_REALLOC(0, sizeof(hash_cache_arena));
+
+    // Error check
+    if ( p_arena == (void *) 0 ) goto no_mem;
+
+    // Initialize the arena
+    *p_arena = (hash_cache_arena)
+    {
+        ._allocator =
+        {
+            .pfn_realloc = hash_cache_arena_realloc,
+            .pfn_mark    = hash_cache_arena_mark,
+            .pfn_rewind  = hash_cache_arena_rewind,
+            .owned       = false
+        },
+        .p_base = HASH_CACHE_REALLOC(0, size),
+        .size   = size,
+        .offset = 0,
+        .last   = 0
+    };
+
+    // Error check
+    if ( p_arena->p_base == (void *) 0 ) goto no_mem;
+
+    // Return a pointer to the caller
+    *pp_arena = p_arena;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_arena:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"pp_arena\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Parameter \"size\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_arena ) p_arena = HASH_CACHE_REALLOC(p_arena, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void *hash_cache_arena_alloc ( hash_cache_arena *const p_arena, size_t size )
+{
+
+    // Argument check
+    if ( p_arena == (void *) 0 ) goto no_arena;
+
+    // Success
+    return hash_cache_arena_realloc(&p_arena->_allocator, 0, size);
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_arena:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"p_arena\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_arena_reset ( hash_cache_arena *const p_arena )
+{
+
+    // Argument check
+    if ( p_arena == (void *) 0 ) goto no_arena;
+
+    // Rewind to the start of the arena
+    hash_cache_arena_rewind(&p_arena->_allocator, 0);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_arena:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"p_arena\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_arena_destroy ( hash_cache_arena **const pp_arena )
+{
+
+    // Argument check
+    if ( pp_arena  == (void *) 0 ) goto no_arena;
+    if ( *pp_arena == (void *) 0 ) goto no_arena;
+
+    // Initialized data
+    hash_cache_arena *p_arena = *pp_arena;
+
+    // No more pointer for caller
+    *pp_arena = (void *) 0;
+
+    // Free the memory
+    if ( HASH_CACHE_REALLOC(p_arena->p_base, 0) ) goto failed_to_free;
+
+    // Free the arena
+    if ( HASH_CACHE_REALLOC(p_arena, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_arena:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"pp_arena\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_allocator_acquire ( hash_cache_allocator *const p_allocator )
+{
+
+    // Initialized data
+    bool owned = false;
+
+    // An allocator that can't rewind is shared freely
+    if ( p_allocator->pfn_rewind == (void *) 0 ) return 1;
+
+    // Claim the allocator
+    if ( __atomic_compare_exchange_n(&p_allocator->owned, &owned, true, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == false ) goto allocator_owned;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Hash cache errors
+        {
+            allocator_owned:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Another structure rewinds this allocator in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void hash_cache_allocator_release ( hash_cache_allocator *const p_allocator )
+{
+
+    // Release the allocator
+    if ( p_allocator->pfn_rewind ) __atomic_store_n(&p_allocator->owned, false, __ATOMIC_RELEASE);
+
+    // Done
+    return;
+}
+
+int hash_cache_slab_construct ( hash_cache_slab **const pp_slab, size_t object_size, size_t objects_per_block )
+{
+
+    // Argument check
+    if ( pp_slab           == (void *) 0 ) goto no_slab;
+    if ( object_size       ==          0 ) goto invalid_size;
+    if ( objects_per_block ==          0 ) goto invalid_size;
+
+    // Initialized data
+    hash_cache_slab *p_slab = HASH_CACHE_REALLOC(0, sizeof(hash_cache_slab));
+
+    // Error check
+    if ( p_slab == (void *) 0 ) goto no_mem;
+
+    // Initialize the slab
+    *p_slab = (hash_cache_slab)
+    {
+        ._allocator =
+        {
+            .pfn_realloc = hash_cache_slab_realloc,
+            .pfn_mark    = (void *) 0,
+            .pfn_rewind  = (void *) 0,
+            .owned       = false
+        },
+        .p_free            = (void *) 0,
+        .pp_blocks         = (void *) 0,
+        .object_size       = ( object_size + HASH_CACHE_ALLOCATOR_ALIGNMENT - 1 ) & ~((size_t) HASH_CACHE_ALLOCATOR_ALIGNMENT - 1),
+        .objects_per_block = objects_per_block,
+        .blocks            = 0,
+        .blocks_max        = 0,
+        .p_caches          = (void *) 0
+    };
+
+    // Construct the lock
+    if ( spinlock_create(&p_slab->_lock) == 0 ) goto failed_to_create_lock;
+
+    // Return a pointer to the caller
+    *pp_slab = p_slab;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_slab:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"pp_slab\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Parameters \"object_size\" and \"objects_per_block\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Sync errors
+        {
+            failed_to_create_lock:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Failed to create spinlock in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                p_slab = HASH_CACHE_REALLOC(p_slab, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void *hash_cache_slab_alloc ( hash_cache_slab *const p_slab )
+{
+
+    // Argument check
+    if ( p_slab == (void *) 0 ) goto no_slab;
+
+    // Initialized data
+    struct hash_cache_slab_thread_cache_s *p_thread_cache = hash_cache_slab_thread_cache(p_slab);
+    void *p_object = (void *) 0;
+
+    // If this thread's free list is empty ...
+    if ( p_thread_cache->p_free == (void *) 0 )
+    {
+
+        // ... lock the slab ...
+        spinlock_lock(&p_slab->_lock);
+
+        // ... allocate another block if the shared free list is empty ...
+        if ( p_slab->p_free == (void *) 0 )
+        {
+
+            // Initialized data
+            unsigned char *p_block = (void *) 0;
+
+            // Grow the list of blocks
+            if ( p_slab->blocks == p_slab->blocks_max )
+            {
+
+                // Initialized data
+                size_t  blocks_max = ( p_slab->blocks_max ) ? p_slab->blocks_max * 2 : 8;
+                void  **pp_blocks  = HASH_CACHE_REALLOC(p_slab->pp_blocks, sizeof(void *) * blocks_max);
+
+                // Error check
+                if ( pp_blocks == (void *) 0 ) goto no_mem;
+
+                // Store the list of blocks
+                p_slab->pp_blocks  = pp_blocks;
+                p_slab->blocks_max = blocks_max;
+            }
+
+            // Allocate a block
+            p_block = HASH_CACHE_REALLOC(0, p_slab->object_size * p_slab->objects_per_block);
+
+            // Error check
+            if ( p_block == (void *) 0 ) goto no_mem;
+
+            // Store the block
+            p_slab->pp_blocks[p_slab->blocks++] = p_block;
+
+            // Thread each object in the block onto the shared free list
+            for (size_t i = p_slab->objects_per_block; i-- > 0; )
+            {
+                *(void **)(p_block + i * p_slab->object_size) = p_slab->p_free;
+                p_slab->p_free = p_block + i * p_slab->object_size;
+            }
+        }
+
+        // ... move a batch of objects to this thread ...
+        for (size_t i = 0; i < HASH_CACHE_SLAB_THREAD_MAX / 2 && p_slab->p_free; i++)
+        {
+
+            // Initialized data
+            void *p_next = *(void **)p_slab->p_free;
+
+            // Move the object
+            *(void **)p_slab->p_free = p_thread_cache->p_free;
+            p_thread_cache->p_free   = p_slab->p_free;
+            p_thread_cache->count++;
+
+            // Next object
+            p_slab->p_free = p_next;
+        }
+
+        // ... and unlock the slab
+        spinlock_unlock(&p_slab->_lock);
+    }
+
+    // Pop an object from this thread's free list
+    p_object               = p_thread_cache->p_free;
+    p_thread_cache->p_free = *(void **)p_object;
+    p_thread_cache->count--;
+
+    // Success
+    return p_object;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_slab:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"p_slab\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Unlock the slab
+                spinlock_unlock(&p_slab->_lock);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_slab_free ( hash_cache_slab *const p_slab, void *p_object )
+{
+
+    // Argument check
+    if ( p_slab   == (void *) 0 ) goto no_slab;
+    if ( p_object == (void *) 0 ) goto no_object;
+
+    // Initialized data
+    struct hash_cache_slab_thread_cache_s *p_thread_cache = hash_cache_slab_thread_cache(p_slab);
+
+    // Push the object onto this thread's free list
+    *(void **)p_object     = p_thread_cache->p_free;
+    p_thread_cache->p_free = p_object;
+    p_thread_cache->count++;
+
+    // If this thread is holding too many objects ...
+    if ( p_thread_cache->count > HASH_CACHE_SLAB_THREAD_MAX )
+    {
+
+        // ... lock the slab ...
+        spinlock_lock(&p_slab->_lock);
+
+        // ... return half of them to the shared free list ...
+        while ( p_thread_cache->count > HASH_CACHE_SLAB_THREAD_MAX / 2 )
+        {
+
+            // Initialized data
+            void *p_next = *(void **)p_thread_cache->p_free;
+
+            // Move the object
+            *(void **)p_thread_cache->p_free = p_slab->p_free;
+            p_slab->p_free                   = p_thread_cache->p_free;
+            p_thread_cache->count--;
+
+            // Next object
+            p_thread_cache->p_free = p_next;
+        }
+
+        // ... and unlock the slab
+        spinlock_unlock(&p_slab->_lock);
+    }
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_slab:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"p_slab\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_object:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"p_object\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_slab_destroy ( hash_cache_slab **const pp_slab )
+{
+
+    // Argument check
+    if ( pp_slab  == (void *) 0 ) goto no_slab;
+    if ( *pp_slab == (void *) 0 ) goto no_slab;
+
+    // Initialized data
+    hash_cache_slab *p_slab = *pp_slab;
+
+    // No more pointer for caller
+    *pp_slab = (void *) 0;
+
+    // Lock the thread caches
+    pthread_mutex_lock(&slab_thread_caches_lock);
+
+    // Every thread forgets its free list of the slab. The objects are freed with the blocks
+    for (struct hash_cache_slab_thread_cache_s *p_thread_cache = p_slab->p_caches; p_thread_cache; p_thread_cache = p_thread_cache->p_next)
+        __atomic_store_n(&p_thread_cache->p_slab, (hash_cache_slab *) 0, __ATOMIC_RELAXED),
+        p_thread_cache->p_free = (void *) 0,
+        p_thread_cache->count  = 0;
+
+    // Unlock the thread caches
+    pthread_mutex_unlock(&slab_thread_caches_lock);
+
+    // Free each block
+    for (size_t i = 0; i < p_slab->blocks; i++)
+        p_slab->pp_blocks[i] = HASH_CACHE_REALLOC(p_slab->pp_blocks[i], 0);
+
+    // Free the list of blocks
+    p_slab->pp_blocks = HASH_CACHE_REALLOC(p_slab->pp_blocks, 0);
+
+    // Destroy the lock
+    spinlock_destroy(&p_slab->_lock);
+
+    // Free the slab
+    if ( HASH_CACHE_REALLOC(p_slab, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_slab:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"pp_slab\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void *hash_cache_pages_map ( size_t size, bool prefault )
+{
+
+    // Argument check
+    if ( size == 0 ) goto invalid_size;
+
+    // Round the size up to a whole quantity of huge pages
+    size = hash_cache_pages_round(size);
+
+    #ifdef __linux__
+
+        // Initialized data
+        unsigned char *p_mapping = (void *) 0,
+                      *p_aligned = (void *) 0;
+        size_t         head      = 0,
+                       tail      = 0;
+
+        // Map an extra huge page, so the mapping can be aligned
+        p_mapping = mmap(NULL, size + HASH_CACHE_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+        // Error check
+        if ( p_mapping == MAP_FAILED ) goto failed_to_map;
+
+        // Align the mapping
+        p_aligned = (unsigned char *) hash_cache_pages_round((size_t) p_mapping);
+        head      = (size_t) ( p_aligned - p_mapping );
+        tail      = HASH_CACHE_HUGE_PAGE_SIZE - head;
+
+        // Unmap the unaligned head and tail
+        if ( head ) munmap(p_mapping, head);
+        if ( tail ) munmap(p_aligned + size, tail);
+
+        // Ask for transparent huge pages. This must happen before the first touch
+        #ifdef MADV_HUGEPAGE
+            (void) madvise(p_aligned, size, MADV_HUGEPAGE);
+        #endif
+
+        // Pre-fault
+        if ( prefault )
+        {
+
+            // Initialized data
+            bool populated = false;
+
+            // Let the kernel fault in the whole range at once ...
+            #ifdef MADV_POPULATE_WRITE
+                populated = ( madvise(p_aligned, size, MADV_POPULATE_WRITE) == 0 );
+            #endif
+
+            // ... or touch each page
+            if ( populated == false )
+                for (size_t i = 0, page = (size_t) sysconf(_SC_PAGESIZE); i < size; i += page)
+                    ((volatile unsigned char *)p_aligned)[i] = 0;
+        }
+
+        // Success
+        return p_aligned;
+    #else
+
+        // Initialized data
+        void *p_mapping = HASH_CACHE_REALLOC(0, size);
+
+        // Error check
+        if ( p_mapping == (void *) 0 ) goto failed_to_map;
+
+        // Zero the memory, which also faults it in
+        memset(p_mapping, 0, size);
+
+        // Unused
+        (void) prefault;
+
+        // Success
+        return p_mapping;
+    #endif
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Parameter \"size\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_map:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Failed to map memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+size_t hash_cache_pages_huge ( const void *const p, size_t size )
+{
+
+    // Argument check
+    if ( p == (void *) 0 ) return 0;
+
+    #ifdef __linux__
+
+        // Initialized data
+        FILE          *p_file    = fopen("/proc/self/smaps", "r");
+        char           _line[256] = { 0 };
+        unsigned long  begin     = 0,
+                       end       = 0;
+        bool           inside    = false;
+        size_t         huge      = 0;
+
+        // Error check
+        if ( p_file == (void *) 0 ) return 0;
+
+        // Read each line
+        while ( fgets(_line, sizeof(_line), p_file) )
+        {
+
+            // Initialized data
+            unsigned long kilobytes = 0;
+
+            // A line that starts a new mapping
+            if ( sscanf(_line, "%lx-%lx ", &begin, &end) == 2 )
+                inside = ( begin < (size_t) p + hash_cache_pages_round(size) ) && ( end > (size_t) p );
+
+            // The huge page usage of a mapping in the range
+            else if ( inside && sscanf(_line, "AnonHugePages: %lu kB", &kilobytes) == 1 )
+                huge += kilobytes * 1024;
+        }
+
+        // Clean up
+        fclose(p_file);
+
+        // Success
+        return huge;
+    #else
+
+        // Unused
+        (void) size;
+
+        // Success
+        return 0;
+    #endif
+}
+
+int hash_cache_pages_unmap ( void *p, size_t size )
+{
+
+    // Argument check
+    if ( p == (void *) 0 ) goto no_mapping;
+
+    #ifdef __linux__
+
+        // Unmap
+        if ( munmap(p, hash_cache_pages_round(size)) ) goto failed_to_unmap;
+    #else
+
+        // Unused
+        (void) size;
+
+        // Free
+        if ( HASH_CACHE_REALLOC(p, 0) ) goto failed_to_unmap;
+    #endif
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_mapping:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Null pointer provided for parameter \"p\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_unmap:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [allocator] Failed to unmap memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void *hash_cache_heap_realloc ( hash_cache_allocator *const p_allocator, void *p, size_t size )
+{
+
+    // Unused
+    (void) p_allocator;
+
+    // Success
+    return HASH_CACHE_REALLOC(p, size);
+}
+
+static void *hash_cache_arena_realloc ( hash_cache_allocator *const p_allocator, void *p, size_t size )
+{
+
+    // Initialized data
+    hash_cache_arena *p_arena = (hash_cache_arena *) p_allocator;
+    size_t            offset  = 0;
+
+    // Frees are no-ops
+    if ( size == 0 ) return (void *) 0;
+
+    // Round the size up to the alignment
+    size = ( size + HASH_CACHE_ALLOCATOR_ALIGNMENT - 1 ) & ~((size_t) HASH_CACHE_ALLOCATOR_ALIGNMENT - 1);
+
+    // If the caller is growing the most recent allocation ...
+    if ( p && (unsigned char *) p == p_arena->p_base + p_arena->last )
+    {
+
+        // ... and it fits ...
+        if ( size > p_arena->size - p_arena->last ) return (void *) 0;
+
+        // ... grow it in place
+        p_arena->offset = p_arena->last + size;
+
+        // Success
+        return p;
+    }
+
+    // Error check
+    if ( size > p_arena->size - p_arena->offset ) return (void *) 0;
+
+    // Bump the offset
+    offset           = p_arena->offset;
+    p_arena->last    = offset;
+    p_arena->offset += size;
+
+    // Copy the old allocation. The bytes after the old allocation are still inside the arena
+    if ( p )
+    {
+
+        // Initialized data
+        size_t available = (size_t) ( p_arena->p_base + offset - (unsigned char *) p );
+
+        // Copy
+        memcpy(p_arena->p_base + offset, p, ( available < size ) ? available : size);
+    }
+
+    // Success
+    return p_arena->p_base + offset;
+}
+
+static size_t hash_cache_arena_mark ( hash_cache_allocator *const p_allocator )
+{
+
+    // Success
+    return ((hash_cache_arena *) p_allocator)->offset;
+}
+
+static void hash_cache_arena_rewind ( hash_cache_allocator *const p_allocator, size_t mark )
+{
+
+    // Initialized data
+    hash_cache_arena *p_arena = (hash_cache_arena *) p_allocator;
+
+    // Rewind
+    p_arena->offset = mark;
+    p_arena->last   = mark;
+
+    // Done
+    return;
+}
+
+static void *hash_cache_slab_realloc ( hash_cache_allocator *const p_allocator, void *p, size_t size )
+{
+
+    // Initialized data
+    hash_cache_slab *p_slab = (hash_cache_slab *) p_allocator;
+
+    // Free
+    if ( size == 0 )
+    {
+
+        // Return the object to the slab
+        if ( p ) hash_cache_slab_free(p_slab, p);
+
+        // Done
+        return (void *) 0;
+    }
+
+    // Objects can't be bigger than the object size
+    if ( size > p_slab->object_size ) return (void *) 0;
+
+    // Success
+    return ( p ) ? p : hash_cache_slab_alloc(p_slab);
+}
+
+static struct hash_cache_slab_thread_cache_s *hash_cache_slab_thread_cache ( hash_cache_slab *const p_slab )
+{
+
+    // Initialized data
+    struct hash_cache_slab_thread_cache_s *p_thread_cache = &slab_thread_caches[0];
+
+    // Find this thread's free list of the slab ...
+    for (size_t i = 0; i < HASH_CACHE_SLAB_THREAD_CACHES; i++)
+    {
+
+        // Hit
+        if ( __atomic_load_n(&slab_thread_caches[i].p_slab, __ATOMIC_RELAXED) == p_slab )
+        {
+
+            // Mark the free list used
+            slab_thread_caches[i].used = ++slab_thread_clock;
+
+            // Success
+            return &slab_thread_caches[i];
+        }
+
+        // Keep the least recently used free list
+        if ( slab_thread_caches[i].used < p_thread_cache->used ) p_thread_cache = &slab_thread_caches[i];
+    }
+
+    // ... else make sure the thread returns its free lists when it exits ...
+    pthread_once(&slab_thread_key_once, hash_cache_slab_thread_key_create);
+    if ( slab_thread_key_created && pthread_getspecific(slab_thread_key) == (void *) 0 ) pthread_setspecific(slab_thread_key, slab_thread_caches);
+
+    // ... and give the least recently used free list to the slab
+    pthread_mutex_lock(&slab_thread_caches_lock);
+
+    // Return the free list's objects to their slab
+    hash_cache_slab_thread_cache_flush(p_thread_cache);
+
+    // Add the free list to the slab's thread caches
+    p_thread_cache->p_prev = (void *) 0;
+    p_thread_cache->p_next = p_slab->p_caches;
+    if ( p_slab->p_caches ) p_slab->p_caches->p_prev = p_thread_cache;
+    p_slab->p_caches = p_thread_cache;
+    __atomic_store_n(&p_thread_cache->p_slab, p_slab, __ATOMIC_RELAXED);
+
+    // Unlock the thread caches
+    pthread_mutex_unlock(&slab_thread_caches_lock);
+
+    // Mark the free list used
+    p_thread_cache->used = ++slab_thread_clock;
+
+    // Success
+    return p_thread_cache;
+}
+
+static void hash_cache_slab_thread_cache_flush ( struct hash_cache_slab_thread_cache_s *const p_thread_cache )
+{
+
+    // Initialized data
+    hash_cache_slab *p_slab = p_thread_cache->p_slab;
+
+    // Unowned free lists are empty
+    if ( p_slab == (void *) 0 ) return;
+
+    // Return each object to the slab
+    spinlock_lock(&p_slab->_lock);
+    while ( p_thread_cache->p_free )
+    {
+
+        // Initialized data
+        void *p_next = *(void **)p_thread_cache->p_free;
+
+        // Move the object
+        *(void **)p_thread_cache->p_free = p_slab->p_free;
+        p_slab->p_free                   = p_thread_cache->p_free;
+
+        // Next object
+        p_thread_cache->p_free = p_next;
+    }
+    spinlock_unlock(&p_slab->_lock);
+
+    // Remove the free list from the slab's thread caches
+    if ( p_thread_cache->p_prev ) p_thread_cache->p_prev->p_next = p_thread_cache->p_next;
+    else                          p_slab->p_caches               = p_thread_cache->p_next;
+    if ( p_thread_cache->p_next ) p_thread_cache->p_next->p_prev = p_thread_cache->p_prev;
+
+    // Forget the slab
+    __atomic_store_n(&p_thread_cache->p_slab, (hash_cache_slab *) 0, __ATOMIC_RELAXED);
+    p_thread_cache->count  = 0;
+    p_thread_cache->p_prev = (void *) 0;
+    p_thread_cache->p_next = (void *) 0;
+
+    // Done
+    return;
+}
+
+static void hash_cache_slab_thread_exit ( void *p_thread_caches )
+{
+
+    // Initialized data
+    struct hash_cache_slab_thread_cache_s *p_thread_cache = p_thread_caches;
+
+    // Return each free list to its slab
+    pthread_mutex_lock(&slab_thread_caches_lock);
+    for (size_t i = 0; i < HASH_CACHE_SLAB_THREAD_CACHES; i++) hash_cache_slab_thread_cache_flush(&p_thread_cache[i]);
+    pthread_mutex_unlock(&slab_thread_caches_lock);
+
+    // Done
+    return;
+}
+
+static void hash_cache_slab_thread_key_create ( void )
+{
+
+    // Create the key
+    slab_thread_key_created = ( pthread_key_create(&slab_thread_key, hash_cache_slab_thread_exit) == 0 );
+
+    // Done
+    return;
+}
@@ -0,0 +1,250 @@
+/** !
+ * Implementation of blocked bloom filter
+ *
+ * @file bloom.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/bloom.h>
+
+// Standard library
+#include <stdlib.h>
+#include <string.h>
+
+// Data
+static const unsigned long long bloom_salts[HASH_CACHE_BLOOM_BLOCK_WORDS] =
+{
+    0x47B6137B, 0x44974D91, 0x8824AD5B, 0xA2B7289D,
+    0x705495C7, 0x2DF1424B, 0x9EFC4947, 0x5C6BFB31
+};
+
+// Function declarations
+/** !
+ * Compute the block of a hash from its high bits
+ *
+ * @param p_bloom the bloom filter
+ * @param h       the hash
+ *
+ * @return the index of the block
+ */
+static inline size_t hash_cache_bloom_block ( const hash_cache_bloom *const p_bloom, hash64 h )
+{
+
+    // Success
+    return (size_t) (((h >> 32) * p_bloom->blocks) >> 32);
+}
+
+/** !
+ * Compute the bit that a hash sets in one word of its block from its low bits
+ *
+ * @param h the hash
+ * @param i the word
+ *
+ * @return the bit mask
+ */
+static inline unsigned long long hash_cache_bloom_mask ( hash64 h, size_t i )
+{
+
+    // Success
+    return 1ULL << ((( h & 0xFFFFFFFF ) * bloom_salts[i] & 0xFFFFFFFF) >> 26);
+}
+
+// Function definitions
+int hash_cache_bloom_construct ( hash_cache_bloom **const pp_bloom, size_t expected )
+{
+
+    // Argument check
+    if ( pp_bloom == (void *) 0 ) goto no_bloom;
+    if ( expected ==          0 ) goto invalid_expected;
+
+    // Initialized data
+    hash_cache_bloom *p_bloom = HASH_CACHE_REALLOC(0, sizeof(hash_cache_bloom));
+    size_t            blocks  = ( expected * HASH_CACHE_BLOOM_BITS_PER_KEY + 511 ) / 512,
+                      bytes   = blocks * sizeof(*p_bloom->p_blocks);
+
+    // Error check
+    if ( p_bloom == (void *) 0 ) goto no_mem;
+
+    // Initialize the bloom filter
+    *p_bloom = (hash_cache_bloom)
+    {
+        .p_blocks     = (void *) 0,
+        .p_allocation = HASH_CACHE_REALLOC(0, bytes + 64),
+        .blocks       = blocks,
+        .expected     = expected
+    };
+
+    // Error check
+    if ( p_bloom->p_allocation == (void *) 0 ) goto no_mem;
+
+    // Align the blocks to a cache line
+    p_bloom->p_blocks = (void *) ((((size_t) p_bloom->p_allocation) + 63) & ~(size_t) 63);
+
+    // Every bit starts clear
+    memset(p_bloom->p_blocks, 0, bytes);
+
+    // Return a pointer to the caller
+    *pp_bloom = p_bloom;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_bloom:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [bloom] Null pointer provided for parameter \"pp_bloom\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_expected:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [bloom] Parameter \"expected\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_bloom ) p_bloom = HASH_CACHE_REALLOC(p_bloom, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+bool hash_cache_bloom_query ( const hash_cache_bloom *const p_bloom, hash64 h )
+{
+
+    // Initialized data
+    const unsigned long long *p_block = p_bloom->p_blocks[hash_cache_bloom_block(p_bloom, h)];
+    unsigned long long        missing = 0;
+
+    // Check one bit in each word of the block
+    for (size_t i = 0; i < HASH_CACHE_BLOOM_BLOCK_WORDS; i++)
+        missing |= ~p_block[i] & hash_cache_bloom_mask(h, i);
+
+    // Done
+    return ( missing == 0 );
+}
+
+void hash_cache_bloom_insert ( hash_cache_bloom *const p_bloom, hash64 h )
+{
+
+    // Initialized data
+    unsigned long long *p_block = p_bloom->p_blocks[hash_cache_bloom_block(p_bloom, h)];
+
+    // Set one bit in each word of the block
+    for (size_t i = 0; i < HASH_CACHE_BLOOM_BLOCK_WORDS; i++)
+        p_block[i] |= hash_cache_bloom_mask(h, i);
+
+    // Done
+    return;
+}
+
+void hash_cache_bloom_insert_atomic ( hash_cache_bloom *const p_bloom, hash64 h )
+{
+
+    // Initialized data
+    unsigned long long *p_block = p_bloom->p_blocks[hash_cache_bloom_block(p_bloom, h)];
+
+    // Set one bit in each word of the block
+    for (size_t i = 0; i < HASH_CACHE_BLOOM_BLOCK_WORDS; i++)
+        __atomic_fetch_or(&p_block[i], hash_cache_bloom_mask(h, i), __ATOMIC_RELAXED);
+
+    // Done
+    return;
+}
+
+int hash_cache_bloom_clear ( hash_cache_bloom *const p_bloom )
+{
+
+    // Argument check
+    if ( p_bloom == (void *) 0 ) goto no_bloom;
+
+    // Clear every bit
+    memset(p_bloom->p_blocks, 0, p_bloom->blocks * sizeof(*p_bloom->p_blocks));
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_bloom:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [bloom] Null pointer provided for parameter \"p_bloom\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_bloom_destroy ( hash_cache_bloom **const pp_bloom )
+{
+
+    // Argument check
+    if ( pp_bloom  == (void *) 0 ) goto no_bloom;
+    if ( *pp_bloom == (void *) 0 ) goto no_bloom;
+
+    // Initialized data
+    hash_cache_bloom *p_bloom = *pp_bloom;
+
+    // No more pointer for caller
+    *pp_bloom = (void *) 0;
+
+    // Free the blocks
+    if ( HASH_CACHE_REALLOC(p_bloom->p_allocation, 0) ) goto failed_to_free;
+
+    // Free the bloom filter
+    if ( HASH_CACHE_REALLOC(p_bloom, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_bloom:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [bloom] Null pointer provided for parameter \"pp_bloom\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
@@ -9,6 +9,302 @@
 // Headers
 #include <hash_cache/cache.h>
 
+// SIMD
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Function declarations
+/** !
+ * Hash a key. A cache without a key hashing function hashes every key to 0,
+ * so every key is in one bucket, and a search compares the key to every
+ * property of the cache, in O(n)
+ * 
+ * @param p_cache the cache
+ * @param p_key   the key
+ * 
+ * @return the hash of the key
+ */
+static inline hash64 cache_hash ( const cache *const p_cache, const void *const p_key )
+{
+
+    // Success
+    return ( p_cache->pfn_key_hash ) ? p_cache->pfn_key_hash(p_key) : 0;
+}
+
+/** !
+ * Compute the tag of a hash, which is never 0
+ * 
+ * @param h the hash
+ * 
+ * @return the tag
+ */
+static inline unsigned char cache_tag ( hash64 h )
+{
+
+    // Initialized data
+    unsigned char tag = (unsigned char) ( h >> 56 );
+
+    // Success
+    return ( tag ) ? tag : 1;
+}
+
+/** !
+ * Compare CACHE_TAGS tags to a tag
+ * 
+ * @param p_tags the first of the tags
+ * @param tag    the tag
+ * 
+ * @return a mask with bit i set if tag i matches
+ */
+static inline unsigned int cache_tags_match ( const unsigned char *const p_tags, unsigned char tag )
+{
+
+    #if defined(__AVX2__)
+
+        // Compare 32 tags at once
+        return (unsigned int) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) p_tags), _mm256_set1_epi8((char) tag)));
+
+    #elif defined(__SSE2__)
+
+        // Initialized data
+        __m128i needle = _mm_set1_epi8((char) tag);
+
+        // Compare 16 tags at a time
+        return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) p_tags), needle))
+             | (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) ( p_tags + 16 )), needle)) << 16;
+
+    #else
+
+        // Initialized data
+        unsigned int mask = 0;
+
+        // Compare one tag at a time
+        for (unsigned int i = 0; i < CACHE_TAGS; i++)
+            mask |= (unsigned int) ( p_tags[i] == tag ) << i;
+
+        // Success
+        return mask;
+
+    #endif
+}
+
+/** !
+ * Find the slot of a key
+ * 
+ * @param p_cache  the cache
+ * @param p_key    the key
+ * @param h        the hash of the key
+ * @param p_probes return, the quantity of slots compared
+ * 
+ * @return the slot of the key on hit, CACHE_NIL on miss
+ */
+static size_t cache_find ( const cache *const p_cache, const void *const p_key, hash64 h, size_t *const p_probes );
+
+/** !
+ * Find the slot of a key in a small cache by scanning the tags. Every read
+ * of a slot is a single load, like cache_lookup.
+ * 
+ * @param p_cache  the cache
+ * @param p_key    the key
+ * @param h        the hash of the key
+ * @param p_probes return, the quantity of slots compared
+ * 
+ * @return the slot of the key on hit, CACHE_NIL on miss
+ */
+static size_t cache_scan ( const cache *const p_cache, const void *const p_key, hash64 h, size_t *const p_probes );
+
+/** !
+ * Search a cache for a key whose hash is known, as cache_get. The 
+ * arguments are already checked.
+ * 
+ * @param p_cache   the cache
+ * @param p_key     the key
+ * @param h         the hash of the key
+ * @param pp_result return
+ * 
+ * @return 1 on hit, 0 on miss
+ */
+static int cache_fetch ( cache *const p_cache, const void *const p_key, hash64 h, void **const pp_result );
+
+/** !
+ * Hash a batch of keys, and prefetch the bucket of each
+ * 
+ * @param p_cache  the cache
+ * @param pp_keys  the keys
+ * @param n        the quantity of keys, at most CACHE_BATCH
+ * @param p_hashes return the hash of each key
+ * 
+ * @return void
+ */
+static void cache_prefetch ( const cache *const p_cache, const void *const *const pp_keys, size_t n, hash64 *const p_hashes );
+
+/** !
+ * Store a value under a key that is not in the cache. While the cache is 
+ * full, or over its budget, the policy's victim is evicted and passed to 
+ * the evict function.
+ * 
+ * @param p_cache  the cache
+ * @param p_value  the value
+ * @param h        the hash of the key
+ * @param cost     the cost of the value
+ * @param deadline the time the value expires, or 0 to never expire
+ * 
+ * @return void
+ */
+static void cache_store ( cache *const p_cache, void *p_value, hash64 h, size_t cost, timestamp deadline );
+
+/** !
+ * Add or replace a property. The arguments are already checked.
+ * 
+ * @param p_cache  the cache
+ * @param p_key    the key of the property
+ * @param p_value  the value of the property
+ * @param h        the hash of the key
+ * @param cost     the cost of the value
+ * @param deadline the time the value expires, or 0 to never expire
+ * 
+ * @return void
+ */
+static void cache_put ( cache *const p_cache, const void *const p_key, const void *const p_value, hash64 h, size_t cost, timestamp deadline );
+
+/** !
+ * Test if the property in a slot expired
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot
+ * 
+ * @return true if the property expired, else false
+ */
+static inline bool cache_expired ( const cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    const hash_cache_wheel_timer *p_timer = ( p_cache->ttl.p_wheel ) ? &p_cache->ttl.p_wheel->p_timers[slot] : (void *) 0;
+
+    // Only a scheduled timer reads the clock
+    return p_timer && p_timer->next != HASH_CACHE_WHEEL_NIL && p_timer->deadline <= timer_high_precision();
+}
+
+/** !
+ * Compute the deadline of a property inserted now with the default time to live
+ * 
+ * @param p_cache the cache
+ * 
+ * @return the deadline, or 0 to never expire
+ */
+static inline timestamp cache_deadline ( const cache *const p_cache )
+{
+
+    // Success
+    return ( p_cache->ttl.p_wheel && p_cache->ttl.ttl ) ? timer_high_precision() + p_cache->ttl.ttl : 0;
+}
+
+/** !
+ * Reclaim the expired property in a slot, and pass it to the evict function
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot
+ * 
+ * @return void
+ */
+static void cache_expire ( cache *const p_cache, size_t slot );
+
+/** !
+ * Remove the property in a slot from its bucket, its policy, and the timer 
+ * wheel, and return the slot to the free list
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot
+ * 
+ * @return void
+ */
+static void cache_unlink ( cache *const p_cache, size_t slot );
+
+/** !
+ * Empty the index and the slots of a cache, and reset its policy
+ * 
+ * @param p_cache the cache
+ * 
+ * @return void
+ */
+static void cache_reset ( cache *const p_cache );
+
+/** !
+ * Add a key to a cache's bloom filter. A bloom filter can't forget evicted 
+ * keys, so it is rebuilt from the resident keys after enough inserts.
+ * 
+ * @param p_cache the cache
+ * @param h       the hash of the key
+ * 
+ * @return void
+ */
+static void cache_bloom_insert ( cache *const p_cache, hash64 h );
+
+// LRU
+/** !
+ * Move a slot to the front of the recency list
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot
+ * 
+ * @return void
+ */
+static void cache_lru_hit ( cache *const p_cache, size_t slot );
+
+/** !
+ * Add a slot to the front of the recency list
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot
+ * 
+ * @return void
+ */
+static void cache_lru_insert ( cache *const p_cache, size_t slot );
+
+/** !
+ * Pick the least recently used slot
+ * 
+ * @param p_cache the cache
+ * @param h       unused
+ * 
+ * @return the slot at the back of the recency list
+ */
+static size_t cache_lru_victim ( cache *const p_cache, hash64 h );
+
+/** !
+ * Remove a slot from the recency list
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot
+ * 
+ * @return void
+ */
+static void cache_lru_remove ( cache *const p_cache, size_t slot );
+
+/** !
+ * Walk the recency list from most to least recently used
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot, or CACHE_NIL for the first slot
+ * 
+ * @return the next slot, or CACHE_NIL after the last slot
+ */
+static size_t cache_lru_next ( const cache *const p_cache, size_t slot );
+
+// Data
+const cache_policy cache_policy_lru =
+{
+    .pfn_construct = (void *) 0,
+    .pfn_destroy   = (void *) 0,
+    .pfn_reset     = (void *) 0,
+    .pfn_hit       = cache_lru_hit,
+    .pfn_insert    = cache_lru_insert,
+    .pfn_victim    = cache_lru_victim,
+    .pfn_remove    = cache_lru_remove,
+    .pfn_next      = cache_lru_next
+};
+
 int cache_create ( cache **const pp_cache )
 {
 
@@ -24,6 +320,11 @@ int cache_create ( cache **const pp_cache )
     // Initialize data
     memset(p_cache, 0, sizeof(cache));
 
+    // Allocate the counters
+    #ifdef HASH_CACHE_STATS
+        if ( hash_cache_counters_construct(&p_cache->p_counters) == 0 ) goto failed_to_allocate_counters;
+    #endif
+
     // Return a pointer to the caller
     *pp_cache = p_cache;
 
@@ -44,6 +345,22 @@ int cache_create ( cache **const pp_cache )
                 return 0;
         }
 
+        // Hash cache errors
+        {
+            #ifdef HASH_CACHE_STATS
+            failed_to_allocate_counters:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate counters in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the cache
+                p_cache = HASH_CACHE_REALLOC(p_cache, 0);
+
+                // Error
+                return 0;
+            #endif
+        }
+
         // Standard library errors
         {
             no_mem:
@@ -63,6 +380,20 @@ int cache_construct (
     fn_hash_cache_equality      *pfn_equality,
     fn_hash_cache_key_accessor    *pfn_key_get
 )
+{
+
+    // Initialized data
+    cache_options _options =
+    {
+        .pfn_equality = pfn_equality,
+        .pfn_key_get  = pfn_key_get
+    };
+
+    // Success
+    return cache_construct_options(pp_cache, size, &_options);
+}
+
+int cache_construct_options ( cache **const pp_cache, size_t size, const cache_options *const p_options )
 {
 
     // Argument check
@@ -70,7 +401,18 @@ int cache_construct (
     if ( size     ==          0 ) goto invalid_size;
 
     // Initialized data
-    cache *p_cache = (void *) 0;
+    cache               *p_cache     = (void *) 0;
+    cache_options        _options    = ( p_options ) ? *p_options : (cache_options) { 0 };
+    hash_cache_allocator *p_allocator = ( _options.p_allocator ) ? _options.p_allocator : &hash_cache_heap_allocator;
+    size_t               buckets     = 0,
+                         tags        = 0,
+                         bytes       = 0;
+
+    // Error check. A bloom filter and a miss ratio curve estimator need a key hash that agrees with the equality function
+    if ( ( _options.bloom || _options.mrc ) && _options.pfn_equality && _options.pfn_key_hash == (void *) 0 ) goto no_key_hash;
+
+    // Claim the allocator. The cache rewinds an arena when it's cleared or destroyed
+    if ( hash_cache_allocator_acquire(p_allocator) == 0 ) goto allocator_owned;
 
     // Allocate memory for the cache
     if ( cache_create(&p_cache) == 0 ) goto failed_to_allocate_cache;
@@ -82,17 +424,96 @@ int cache_construct (
     p_cache->properties.max = size;
 
     // Set the equality function
-    p_cache->pfn_equality = pfn_equality ? pfn_equality : (fn_hash_cache_equality *) hash_cache_equals;
+    p_cache->pfn_equality = _options.pfn_equality ? _options.pfn_equality : (fn_hash_cache_equality *) hash_cache_equals;
 
     // Set the key getter function
-    p_cache->pfn_key_get = pfn_key_get ? pfn_key_get : (fn_hash_cache_key_accessor *) hash_cache_key_accessor;
+    p_cache->pfn_key_get = _options.pfn_key_get ? _options.pfn_key_get : (fn_hash_cache_key_accessor *) hash_cache_key_accessor;
 
-    // Allocate memory for the cache
-    p_cache->properties.pp_data = HASH_CACHE_REALLOC(0, sizeof(void *) * size);
+    // Set the key hashing function. The default only agrees with the default equality function
+    p_cache->pfn_key_hash = _options.pfn_key_hash ? _options.pfn_key_hash : ( _options.pfn_equality ) ? (void *) 0 : (fn_hash_cache_key_hash *) hash_cache_key_hash;
+
+    // Set the eviction policy
+    p_cache->policy.p_policy = ( _options.p_policy ) ? _options.p_policy : &cache_policy_lru;
+
+    // Set the evict function
+    p_cache->evict.pfn_evict = _options.pfn_evict;
+    p_cache->evict.p_context = _options.p_context;
+
+    // Set the cost function and the budget
+    p_cache->cost.pfn_cost = _options.pfn_cost;
+    p_cache->cost.budget   = _options.budget;
+
+    // Construct a bloom filter
+    if ( _options.bloom )
+        if ( hash_cache_bloom_construct(&p_cache->bloom.p_bloom, _options.bloom) == 0 ) goto failed_to_construct_bloom;
+
+    // Construct a miss ratio curve estimator
+    if ( _options.mrc )
+        if ( hash_cache_mrc_construct(&p_cache->mrc.p_mrc, size, _options.mrc) == 0 ) goto failed_to_construct_mrc;
+
+    // Construct a timer wheel with a tick of one millisecond
+    if ( _options.ttl || _options.expire )
+    {
+
+        // Initialized data
+        timestamp resolution = timer_seconds_divisor() / 1000;
+
+        // Store the default time to live
+        p_cache->ttl.ttl = _options.ttl;
+
+        // Construct the timer wheel
+        if ( hash_cache_wheel_construct(&p_cache->ttl.p_wheel, size, ( resolution > 0 ) ? resolution : 1, timer_high_precision()) == 0 ) goto failed_to_construct_wheel;
+    }
+
+    // Store the allocator
+    p_cache->allocator.p_allocator = p_allocator;
+
+    // Mark the start of the cache's allocations
+    if ( p_allocator->pfn_mark ) p_cache->allocator.begin = p_allocator->pfn_mark(p_allocator);
+
+    // Compute the size of the index
+    for (buckets = 1; buckets < size; buckets <<= 1);
+
+    // Compute the size of the tags of a small cache, padded to whole compares
+    if ( size <= CACHE_SMALL ) tags = ( size + CACHE_TAGS - 1 ) & ~(size_t) ( CACHE_TAGS - 1 );
+
+    // Compute the size of the slots, the nodes, the costs, the buckets, and the tags
+    bytes = ( sizeof(void *) + sizeof(cache_node) + sizeof(size_t) ) * size + sizeof(size_t) * buckets + tags;
+
+    // Map memory for the cache ...
+    if ( _options.huge_pages )
+    {
+
+        // Store the size of the mapping
+        p_cache->allocator.mapped = bytes;
+
+        // Map the slots
+        p_cache->properties.pp_data = hash_cache_pages_map(p_cache->allocator.mapped, _options.prefault);
+    }
+
+    // ... or allocate memory for the cache
+    else p_cache->properties.pp_data = HASH_CACHE_ALLOCATOR_REALLOC(p_allocator, 0, bytes);
 
     // Error check
     if ( p_cache->properties.pp_data == (void *) 0 ) goto no_mem;
 
+    // The nodes follow the slots, the costs follow the nodes, the buckets follow the costs, and the tags follow the buckets
+    p_cache->index.p_nodes   = (cache_node *) ( p_cache->properties.pp_data + size );
+    p_cache->cost.p_costs    = (size_t *) ( p_cache->index.p_nodes + size );
+    p_cache->index.p_buckets = p_cache->cost.p_costs + size;
+    p_cache->index.p_tags    = ( tags ) ? (unsigned char *) ( p_cache->index.p_buckets + buckets ) : (void *) 0;
+    p_cache->index.mask      = buckets - 1;
+
+    // Construct the policy's state
+    if ( p_cache->policy.p_policy->pfn_construct )
+        if ( p_cache->policy.p_policy->pfn_construct(p_cache) == 0 ) goto failed_to_construct_policy;
+
+    // Empty the cache
+    cache_reset(p_cache);
+
+    // Mark the end of the cache's allocations
+    if ( p_allocator->pfn_mark ) p_cache->allocator.end = p_allocator->pfn_mark(p_allocator);
+
     // Return a pointer to the caller
     *pp_cache = p_cache;
 
@@ -128,6 +549,116 @@ int cache_construct (
                     log_error("[hash cache] Failed to allocate caches in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
+                // Release the allocator
+                hash_cache_allocator_release(p_allocator);
+
+                // Error
+                return 0;
+
+            no_key_hash:
+                #ifndef NDEBUG
+                    log_error("[hash cache] A bloom filter or a miss ratio curve requires a key hashing function when the equality function is not the default in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            allocator_owned:
+                #ifndef NDEBUG
+                    log_error("[hash cache] The allocator is in use by another cache or hash table in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            failed_to_construct_bloom:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to construct bloom filter in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the counters
+                hash_cache_counters_destroy(&p_cache->p_counters);
+
+                // Free the cache
+                p_cache = HASH_CACHE_REALLOC(p_cache, 0);
+
+                // Release the allocator
+                hash_cache_allocator_release(p_allocator);
+
+                // Error
+                return 0;
+
+            failed_to_construct_mrc:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to construct miss ratio curve estimator in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Destroy the bloom filter
+                if ( p_cache->bloom.p_bloom ) hash_cache_bloom_destroy(&p_cache->bloom.p_bloom);
+
+                // Free the counters
+                hash_cache_counters_destroy(&p_cache->p_counters);
+
+                // Free the cache
+                p_cache = HASH_CACHE_REALLOC(p_cache, 0);
+
+                // Release the allocator
+                hash_cache_allocator_release(p_allocator);
+
+                // Error
+                return 0;
+
+            failed_to_construct_wheel:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to construct timer wheel in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Destroy the bloom filter
+                if ( p_cache->bloom.p_bloom ) hash_cache_bloom_destroy(&p_cache->bloom.p_bloom);
+
+                // Destroy the miss ratio curve estimator
+                if ( p_cache->mrc.p_mrc ) hash_cache_mrc_destroy(&p_cache->mrc.p_mrc);
+
+                // Free the counters
+                hash_cache_counters_destroy(&p_cache->p_counters);
+
+                // Free the cache
+                p_cache = HASH_CACHE_REALLOC(p_cache, 0);
+
+                // Release the allocator
+                hash_cache_allocator_release(p_allocator);
+
+                // Error
+                return 0;
+
+            failed_to_construct_policy:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to construct eviction policy in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the cache contents
+                if      ( p_cache->allocator.mapped ) hash_cache_pages_unmap(p_cache->properties.pp_data, p_cache->allocator.mapped);
+                else if ( p_allocator->pfn_rewind )   p_allocator->pfn_rewind(p_allocator, p_cache->allocator.begin);
+                else                                  (void) HASH_CACHE_ALLOCATOR_REALLOC(p_allocator, p_cache->properties.pp_data, 0);
+
+                // Destroy the bloom filter
+                if ( p_cache->bloom.p_bloom ) hash_cache_bloom_destroy(&p_cache->bloom.p_bloom);
+
+                // Destroy the miss ratio curve estimator
+                if ( p_cache->mrc.p_mrc ) hash_cache_mrc_destroy(&p_cache->mrc.p_mrc);
+
+                // Destroy the timer wheel
+                if ( p_cache->ttl.p_wheel ) hash_cache_wheel_destroy(&p_cache->ttl.p_wheel);
+
+                // Free the counters
+                hash_cache_counters_destroy(&p_cache->p_counters);
+
+                // Free the cache
+                p_cache = HASH_CACHE_REALLOC(p_cache, 0);
+
+                // Release the allocator
+                hash_cache_allocator_release(p_allocator);
+
                 // Error
                 return 0;
         }
@@ -139,13 +670,31 @@ int cache_construct (
                     log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
+                // Destroy the bloom filter
+                if ( p_cache->bloom.p_bloom ) hash_cache_bloom_destroy(&p_cache->bloom.p_bloom);
+
+                // Destroy the miss ratio curve estimator
+                if ( p_cache->mrc.p_mrc ) hash_cache_mrc_destroy(&p_cache->mrc.p_mrc);
+
+                // Destroy the timer wheel
+                if ( p_cache->ttl.p_wheel ) hash_cache_wheel_destroy(&p_cache->ttl.p_wheel);
+
+                // Free the counters
+                hash_cache_counters_destroy(&p_cache->p_counters);
+
+                // Free the cache
+                p_cache = HASH_CACHE_REALLOC(p_cache, 0);
+
+                // Release the allocator
+                hash_cache_allocator_release(p_allocator);
+
                 // Error
                 return 0;
         }
     }
 }
 
-int cache_get ( const cache *const p_cache, const void *const p_key, void **const pp_result )
+int cache_get ( cache *const p_cache, const void *const p_key, void **const pp_result )
 {
 
     // Argument check
@@ -153,28 +702,7 @@ int cache_get ( const cache *const p_cache, const void *const p_key, void **cons
     if ( p_key   == (void *) 0 ) goto no_key;
 
     // Search the cache
-    for (size_t i = 0; i < p_cache->properties.count; i++)
-    {
-        
-        // Compare
-        if ( p_cache->pfn_equality(p_cache->pfn_key_get(p_cache->properties.pp_data[i]), p_key ) == 0 )
-        {
-
-            // Move the property to the front of the cache 
-            void *tmp = p_cache->properties.pp_data[i];
-            p_cache->properties.pp_data[i] = p_cache->properties.pp_data[0];
-            p_cache->properties.pp_data[0] = tmp;
-
-            // Return the value to the caller 
-            *pp_result = tmp;
-
-            // Success
-            return 1;
-        }
-    }
-
-    // Miss
-    return 0;
+    return cache_fetch(p_cache, p_key, cache_hash(p_cache, p_key), pp_result);
 
     // Error handling
     {
@@ -200,33 +728,54 @@ int cache_get ( const cache *const p_cache, const void *const p_key, void **cons
     }
 }
 
-int cache_insert ( cache *const p_cache, const void *const p_key, const void *const p_value )
+size_t cache_get_many ( cache *const p_cache, const void *const *const pp_keys, size_t n, void **const pp_results, unsigned long long *const p_hits )
 {
 
     // Argument check
-    if ( p_cache == (void *) 0 ) goto no_cache;
-    if ( p_key   == (void *) 0 ) goto no_key;
-    if ( p_value == (void *) 0 ) goto no_value;
+    if ( p_cache    == (void *) 0 ) goto no_cache;
+    if ( pp_keys    == (void *) 0 ) goto no_keys;
+    if ( pp_results == (void *) 0 ) goto no_results;
 
-    // If the cache is full ...
-    if ( p_cache->properties.count == p_cache->properties.max )
+    // Initialized data
+    hash64 hashes[CACHE_BATCH];
+    size_t hits = 0;
+
+    // Clear the hit mask
+    if ( p_hits ) memset(p_hits, 0, sizeof(unsigned long long) * ( ( n + 63 ) / 64 ));
+
+    // Search each batch
+    for (size_t i = 0; i < n; i += CACHE_BATCH)
     {
-        
-        // ... remove the last object in the cache ...
-        //
 
-        // ... and decrement the quantity of entries
-        p_cache->properties.count--;
-    }
+        // Initialized data
+        size_t batch = ( n - i < CACHE_BATCH ) ? n - i : CACHE_BATCH;
 
-    // Add the object to the cache
-    p_cache->properties.pp_data[p_cache->properties.count] = (void *) p_value;
+        // Hash every key of the batch, and prefetch its bucket
+        cache_prefetch(p_cache, &pp_keys[i], batch, hashes);
 
-    // Increment the quantity of entries
-    p_cache->properties.count++;
+        // Search for each key
+        for (size_t j = 0; j < batch; j++)
+        {
+
+            // Miss
+            pp_results[i + j] = (void *) 0;
+
+            // Skip null keys
+            if ( pp_keys[i + j] == (void *) 0 ) continue;
+
+            // Hit
+            if ( cache_fetch(p_cache, pp_keys[i + j], hashes[j], &pp_results[i + j]) == 0 ) continue;
+
+            // Count the hit
+            hits++;
+
+            // Set the hit's bit
+            if ( p_hits ) p_hits[( i + j ) / 64] |= 1ULL << ( ( i + j ) % 64 );
+        }
+    }
 
     // Success
-    return 1;
+    return hits;
 
     // Error handling
     {
@@ -241,17 +790,17 @@ int cache_insert ( cache *const p_cache, const void *const p_key, const void *co
                 // Error
                 return 0;
 
-            no_key:
+            no_keys:
                 #ifndef NDEBUG
-                    log_error("[hash cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[hash cache] Null pointer provided for parameter \"pp_keys\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
                 // Error
                 return 0;
 
-            no_value:
+            no_results:
                 #ifndef NDEBUG
-                    log_error("[hash cache] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[hash cache] Null pointer provided for parameter \"pp_results\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
                 // Error
@@ -260,51 +809,158 @@ int cache_insert ( cache *const p_cache, const void *const p_key, const void *co
     }
 }
 
-int cache_remove ( cache *const p_cache, const void *const p_key, void **const pp_result )
+int cache_get_or_load ( cache *const p_cache, const void *const p_key, fn_hash_cache_loader *pfn_loader, void *p_context, void **const pp_result )
 {
 
     // Argument check
-    if ( p_cache == (void *) 0 ) goto no_cache;
-    if ( p_key   == (void *) 0 ) goto no_key;
-    
-    // Unused
-    (void) pp_result;
+    if ( p_cache    == (void *) 0 ) goto no_cache;
+    if ( p_key      == (void *) 0 ) goto no_key;
+    if ( pfn_loader == (void *) 0 ) goto no_loader;
+    if ( pp_result  == (void *) 0 ) goto no_result;
 
-    /*
     // Initialized data
-    size_t i = 0;
     void *p_value = (void *) 0;
 
-    // Search the cache
-    for (; i < p_cache->entries; i++)
-        
-        // Compare
-        if ( p_cache->pfn_equals(p_cache->pfn_key(p_cache->data[i]), p_key ) )
-        {
-
-            // Move the property to the front of the cache 
+    // Hit
+    if ( cache_get(p_cache, p_key, pp_result) ) return 1;
 
-            // Return the value to the caller 
-            p_value = p_cache->data[i];
-        }
+    // Load the value
+    if ( pfn_loader(p_key, p_context, &p_value) == 0 ) goto failed_to_load;
 
-    // If the cache hit
-    if ( p_value )
-    {
+    // Insert the value
+    if ( cache_insert(p_cache, p_key, p_value) == 0 ) goto failed_to_insert;
 
-        // Remove the element from the cache
+    // Return the value to the caller
+    *pp_result = p_value;
 
-        // Decrement the property count
+    // Success
+    return 1;
 
-        // Return a pointer to the caller
-        if ( *pp_result ) *pp_result = p_value;
+    // Error handling
+    {
 
-        // Success
-        return 1;
-    }*/
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
 
-    // Miss
-    return 0;
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_loader:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"pfn_loader\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_result:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"pp_result\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash cache errors
+        {
+            failed_to_load:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to load value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            failed_to_insert:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to insert value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // The cache owns the value
+                if ( p_cache->evict.pfn_evict ) p_cache->evict.pfn_evict(p_value, p_cache->evict.p_context);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+size_t cache_lookup ( const cache *const p_cache, const void *const p_key )
+{
+
+    // Argument check
+    if ( p_cache == (void *) 0 ) goto no_cache;
+    if ( p_key   == (void *) 0 ) goto no_key;
+
+    // Initialized data
+    hash64 h      = cache_hash(p_cache, p_key);
+    size_t slot   = CACHE_NIL,
+           probes = 0;
+
+    // The bloom filter resolves most misses with one cache line
+    if ( p_cache->bloom.p_bloom && hash_cache_bloom_query(p_cache->bloom.p_bloom, h) == false )
+    {
+
+        // Count the miss
+        HASH_CACHE_COUNT(p_cache->p_counters, misses, 1);
+
+        // Miss
+        return CACHE_NIL;
+    }
+
+    // Scan the tags of a small cache ...
+    if ( p_cache->index.p_tags ) slot = cache_scan(p_cache, p_key, h, &probes);
+
+    // ... or walk the bucket, at most once around the cache
+    else for (size_t i = 0, next = __atomic_load_n(&p_cache->index.p_buckets[h & p_cache->index.mask], __ATOMIC_RELAXED); slot == CACHE_NIL && i < p_cache->properties.max && next < p_cache->properties.max; i++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Count the probe
+        probes++;
+
+        // Compare the hash first, so a mismatch never loads the value ...
+        if ( __atomic_load_n(&p_cache->index.p_nodes[next].hash, __ATOMIC_RELAXED) == h )
+        {
+
+            // ... and the key only if the hash matches
+            p_value = __atomic_load_n(&p_cache->properties.pp_data[next], __ATOMIC_RELAXED);
+
+            // Hit
+            if ( p_value && p_cache->pfn_equality(p_cache->pfn_key_get(p_value), p_key) == 0 ) slot = next;
+        }
+
+        // Next
+        next = __atomic_load_n(&p_cache->index.p_nodes[next].chain, __ATOMIC_RELAXED);
+    }
+
+    // Count the probes of the search
+    HASH_CACHE_COUNT(p_cache->p_counters, probes, probes);
+
+    // An expired property is a miss
+    if ( slot != CACHE_NIL && cache_expired(p_cache, slot) ) slot = CACHE_NIL;
+
+    // Count the hit or the miss
+    if ( slot != CACHE_NIL ) HASH_CACHE_COUNT(p_cache->p_counters, hits, 1);
+    else                     HASH_CACHE_COUNT(p_cache->p_counters, misses, 1);
+
+    // Hit, or CACHE_NIL on miss
+    return slot;
 
     // Error handling
     {
@@ -317,7 +973,7 @@ int cache_remove ( cache *const p_cache, const void *const p_key, void **const p
                 #endif
 
                 // Error
-                return 0;
+                return CACHE_NIL;
 
             no_key:
                 #ifndef NDEBUG
@@ -325,31 +981,32 @@ int cache_remove ( cache *const p_cache, const void *const p_key, void **const p
                 #endif
 
                 // Error
-                return 0;
+                return CACHE_NIL;
         }
     }
 }
 
-int cache_clear ( cache *p_cache, fn_hash_cache_free *pfn_free )
+timestamp cache_expiry ( const cache *const p_cache, size_t slot )
 {
 
-    // Argument check
-    if ( p_cache == (void *) 0 ) goto no_cache;
+    // Initialized data
+    const hash_cache_wheel_timer *p_timer = ( p_cache->ttl.p_wheel ) ? &p_cache->ttl.p_wheel->p_timers[slot] : (void *) 0;
 
-    // Free each property
-    if ( pfn_free )
-        
-        // Iterate through the contents of the cache
-        for (size_t i = 0; i < p_cache->properties.count; i++)
-        
-            // Free the property
-            pfn_free(p_cache->properties.pp_data[i]);
+    // A property without a scheduled timer never expires
+    if ( p_timer == (void *) 0 || __atomic_load_n(&p_timer->next, __ATOMIC_RELAXED) == HASH_CACHE_WHEEL_NIL ) return 0;
 
-    // Clear the property counter
-    p_cache->properties.count = 0;
+    // Success
+    return __atomic_load_n(&p_timer->deadline, __ATOMIC_RELAXED);
+}
+
+size_t cache_huge_pages ( const cache *const p_cache )
+{
+
+    // Argument check
+    if ( p_cache == (void *) 0 ) goto no_cache;
 
     // Success
-    return 1;
+    return ( p_cache->allocator.mapped ) ? hash_cache_pages_huge(p_cache->properties.pp_data, p_cache->allocator.mapped) : 0;
 
     // Error handling
     {
@@ -367,21 +1024,40 @@ int cache_clear ( cache *p_cache, fn_hash_cache_free *pfn_free )
     }
 }
 
-int cache_for_i ( const cache *const p_cache, fn_hash_cache_property_i pfn_function )
+size_t cache_cost ( const cache *const p_cache )
 {
-    
+
     // Argument check
-    if ( p_cache      == (void *) 0 ) goto no_cache;
-    if ( pfn_function == (void *) 0 ) goto no_function;
+    if ( p_cache == (void *) 0 ) goto no_cache;
 
-    // Iterate through the cache
-    for (size_t i = 0; i < p_cache->properties.count; i++)
+    // Success
+    return p_cache->cost.used;
 
-        // Call the function
-        pfn_function(p_cache->properties.pp_data[i], i);        
+    // Error handling
+    {
 
-    // Success
-    return 1;
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_insert ( cache *const p_cache, const void *const p_key, const void *const p_value )
+{
+
+    // Argument check
+    if ( p_cache == (void *) 0 ) goto no_cache;
+    if ( p_value == (void *) 0 ) goto no_value;
+
+    // Insert the value with the cost from the cost function, or a cost of 1
+    return cache_insert_cost(p_cache, p_key, p_value, ( p_cache->cost.pfn_cost ) ? p_cache->cost.pfn_cost(p_value) : 1);
 
     // Error handling
     {
@@ -396,9 +1072,9 @@ int cache_for_i ( const cache *const p_cache, fn_hash_cache_property_i pfn_funct
                 // Error
                 return 0;
 
-            no_function:
+            no_value:
                 #ifndef NDEBUG
-                    log_error("[hash cache] Null pointer provided for parameter \"pfn_function\" in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[hash cache] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
                 // Error
@@ -407,21 +1083,65 @@ int cache_for_i ( const cache *const p_cache, fn_hash_cache_property_i pfn_funct
     }
 }
 
-int cache_for_each ( const cache *const p_cache, fn_hash_cache_property pfn_function )
+size_t cache_insert_many ( cache *const p_cache, const void *const *const pp_keys, const void *const *const pp_values, size_t n )
 {
-    
+
     // Argument check
-    if ( p_cache      == (void *) 0 ) goto no_cache;
-    if ( pfn_function == (void *) 0 ) goto no_function;
+    if ( p_cache   == (void *) 0 ) goto no_cache;
+    if ( pp_keys   == (void *) 0 ) goto no_keys;
+    if ( pp_values == (void *) 0 ) goto no_values;
 
-    // Iterate through the cache
-    for (size_t i = 0; i < p_cache->properties.count; i++)
+    // Initialized data
+    hash64    hashes[CACHE_BATCH];
+    size_t    inserted = 0;
+    timestamp deadline = cache_deadline(p_cache);
 
-        // Call the function
-        pfn_function(p_cache->properties.pp_data[i]);
+    // Insert each batch
+    for (size_t i = 0; i < n; i += CACHE_BATCH)
+    {
+
+        // Initialized data
+        size_t batch = ( n - i < CACHE_BATCH ) ? n - i : CACHE_BATCH;
+
+        // Hash every key of the batch, and prefetch its bucket
+        cache_prefetch(p_cache, &pp_keys[i], batch, hashes);
+
+        // Insert each property
+        for (size_t j = 0; j < batch; j++)
+        {
+
+            // Initialized data
+            const void *p_key   = pp_keys[i + j],
+                       *p_value = pp_values[i + j];
+            size_t      cost    = 0;
+
+            // Skip null keys and values
+            if ( p_key == (void *) 0 || p_value == (void *) 0 ) continue;
+
+            // Compute the cost of the value
+            cost = ( p_cache->cost.pfn_cost ) ? p_cache->cost.pfn_cost(p_value) : 1;
+
+            // The cache owns the value, so a value that can't fit the budget is evicted
+            if ( p_cache->cost.budget && cost > p_cache->cost.budget )
+            {
+
+                // Hand the value back to the caller
+                if ( p_cache->evict.pfn_evict ) p_cache->evict.pfn_evict((void *) p_value, p_cache->evict.p_context);
+
+                // Skip the value
+                continue;
+            }
+
+            // Add or replace the property
+            cache_put(p_cache, p_key, p_value, hashes[j], cost, deadline);
+
+            // Count the property
+            inserted++;
+        }
+    }
 
     // Success
-    return 1;
+    return inserted;
 
     // Error handling
     {
@@ -436,9 +1156,17 @@ int cache_for_each ( const cache *const p_cache, fn_hash_cache_property pfn_func
                 // Error
                 return 0;
 
-            no_function:
+            no_keys:
                 #ifndef NDEBUG
-                    log_error("[hash cache] Null pointer provided for parameter \"pfn_function\" in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[hash cache] Null pointer provided for parameter \"pp_keys\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_values:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"pp_values\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
                 // Error
@@ -447,28 +1175,24 @@ int cache_for_each ( const cache *const p_cache, fn_hash_cache_property pfn_func
     }
 }
 
-int cache_info ( const cache *const p_cache );
-
-int cache_destroy ( cache **const pp_cache, fn_hash_cache_free *pfn_cache_free )
+int cache_insert_ttl ( cache *const p_cache, const void *const p_key, const void *const p_value, timestamp ttl )
 {
 
     // Argument check
-    if ( pp_cache == (void *) 0 ) goto no_cache; 
+    if ( p_cache == (void *) 0 ) goto no_cache;
+    if ( p_key   == (void *) 0 ) goto no_key;
+    if ( p_value == (void *) 0 ) goto no_value;
+    if ( ttl     <           0 ) goto invalid_ttl;
 
     // Initialized data
-    cache *p_cache = *pp_cache;
-
-    // No more pointer for caller
-    *pp_cache = (void *) 0;
+    size_t cost = ( p_cache->cost.pfn_cost ) ? p_cache->cost.pfn_cost(p_value) : 1;
 
-    // Clear the cache
-    cache_clear(p_cache, pfn_cache_free);
-
-    // Free the cache contents
-    if ( HASH_CACHE_REALLOC(p_cache->properties.pp_data, 0) ) goto failed_to_free;
+    // Error check
+    if ( p_cache->ttl.p_wheel == (void *) 0                  ) goto no_expiration;
+    if ( p_cache->cost.budget && cost > p_cache->cost.budget ) goto cost_exceeds_budget;
 
-    // Free the cache
-    if ( HASH_CACHE_REALLOC(p_cache, 0) ) goto failed_to_free;
+    // Add or replace the property
+    cache_put(p_cache, p_key, p_value, cache_hash(p_cache, p_key), cost, ( ttl ) ? timer_high_precision() + ttl : 0);
 
     // Success
     return 1;
@@ -483,15 +1207,47 @@ int cache_destroy ( cache **const pp_cache, fn_hash_cache_free *pfn_cache_free )
                     log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_ttl:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Parameter \"ttl\" must not be negative in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
                 // Error
                 return 0;
         }
 
-        // Standard library errors
+        // Hash cache errors
         {
-            failed_to_free:
+            no_expiration:
                 #ifndef NDEBUG
-                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[hash cache] The cache does not track expiration in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            cost_exceeds_budget:
+                #ifndef NDEBUG
+                    log_error("[hash cache] The cost of the value exceeds the cache's budget in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
                 // Error
@@ -499,3 +1255,1065 @@ int cache_destroy ( cache **const pp_cache, fn_hash_cache_free *pfn_cache_free )
         }
     }
 }
+
+int cache_insert_cost ( cache *const p_cache, const void *const p_key, const void *const p_value, size_t cost )
+{
+
+    // Argument check
+    if ( p_cache == (void *) 0 ) goto no_cache;
+    if ( p_key   == (void *) 0 ) goto no_key;
+    if ( p_value == (void *) 0 ) goto no_value;
+
+    // Error check
+    if ( p_cache->cost.budget && cost > p_cache->cost.budget ) goto cost_exceeds_budget;
+
+    // Add or replace the property
+    cache_put(p_cache, p_key, p_value, cache_hash(p_cache, p_key), cost, cache_deadline(p_cache));
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            cost_exceeds_budget:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Parameter \"cost\" exceeds the cache's budget in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_upsert ( cache *const p_cache, const void *const p_key, fn_hash_cache_upsert_found *pfn_on_found, fn_hash_cache_upsert_create *pfn_on_create, void *p_context )
+{
+
+    // Argument check
+    if ( p_cache       == (void *) 0 ) goto no_cache;
+    if ( p_key         == (void *) 0 ) goto no_key;
+    if ( pfn_on_create == (void *) 0 ) goto no_create;
+
+    // Initialized data
+    void   *p_value = (void *) 0;
+    hash64  h       = cache_hash(p_cache, p_key);
+    size_t  slot    = CACHE_NIL,
+            probes  = 0,
+            cost    = 0;
+
+    // Sample the reference
+    if ( p_cache->mrc.p_mrc ) hash_cache_mrc_reference(p_cache->mrc.p_mrc, h);
+
+    // Search the index, unless the bloom filter rules the key out
+    if ( p_cache->bloom.p_bloom == (void *) 0 || hash_cache_bloom_query(p_cache->bloom.p_bloom, h) )
+        slot = cache_find(p_cache, p_key, h, &probes);
+
+    // Count the probes of the search
+    HASH_CACHE_COUNT(p_cache->p_counters, probes, probes);
+
+    // An expired property is a miss
+    if ( slot != CACHE_NIL && cache_expired(p_cache, slot) ) cache_expire(p_cache, slot), slot = CACHE_NIL;
+
+    // Hit
+    if ( slot != CACHE_NIL )
+    {
+
+        // Count the hit
+        HASH_CACHE_COUNT(p_cache->p_counters, hits, 1);
+
+        // Tell the policy
+        p_cache->policy.p_policy->pfn_hit(p_cache, slot);
+
+        // Mutate the value in place
+        if ( pfn_on_found ) pfn_on_found(p_cache->properties.pp_data[slot], p_context);
+
+        // Success
+        return 1;
+    }
+
+    // Count the miss
+    HASH_CACHE_COUNT(p_cache->p_counters, misses, 1);
+
+    // Make the value
+    p_value = pfn_on_create(p_key, p_context);
+
+    // Error check
+    if ( p_value == (void *) 0 ) goto failed_to_create;
+
+    // Compute the cost of the value
+    cost = ( p_cache->cost.pfn_cost ) ? p_cache->cost.pfn_cost(p_value) : 1;
+
+    // Error check
+    if ( p_cache->cost.budget && cost > p_cache->cost.budget ) goto cost_exceeds_budget;
+
+    // Store the value without searching again
+    cache_store(p_cache, p_value, h, cost, cache_deadline(p_cache));
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_create:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"pfn_on_create\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash cache errors
+        {
+            failed_to_create:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to create value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            cost_exceeds_budget:
+                #ifndef NDEBUG
+                    log_error("[hash cache] The cost of the created value exceeds the cache's budget in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Hand the value back to the caller
+                if ( p_cache->evict.pfn_evict ) p_cache->evict.pfn_evict(p_value, p_cache->evict.p_context);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_remove ( cache *const p_cache, const void *const p_key, void **const pp_result )
+{
+
+    // Argument check
+    if ( p_cache == (void *) 0 ) goto no_cache;
+    if ( p_key   == (void *) 0 ) goto no_key;
+    
+    // Initialized data
+    hash64 h      = cache_hash(p_cache, p_key);
+    size_t slot   = CACHE_NIL,
+           probes = 0;
+
+    // Search the index, unless the bloom filter rules the key out
+    if ( p_cache->bloom.p_bloom == (void *) 0 || hash_cache_bloom_query(p_cache->bloom.p_bloom, h) )
+        slot = cache_find(p_cache, p_key, h, &probes);
+
+    // Hit
+    if ( slot != CACHE_NIL )
+    {
+
+        // Return the value to the caller
+        if ( pp_result ) *pp_result = p_cache->properties.pp_data[slot];
+
+        // Remove the property from the cache
+        cache_unlink(p_cache, slot);
+
+        // Success
+        return 1;
+    }
+
+    // Miss
+    return 0;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_maintain ( cache *const p_cache, timestamp now )
+{
+
+    // Argument check
+    if ( p_cache == (void *) 0 ) goto no_cache;
+
+    // Initialized data
+    size_t slot = CACHE_NIL;
+
+    // Nothing expires?
+    if ( p_cache->ttl.p_wheel == (void *) 0 ) return 1;
+
+    // Move every expired timer to the expired list
+    hash_cache_wheel_advance(p_cache->ttl.p_wheel, now);
+
+    // Reclaim each expired property
+    while ( ( slot = hash_cache_wheel_pop(p_cache->ttl.p_wheel) ) != HASH_CACHE_WHEEL_NIL )
+        cache_expire(p_cache, slot);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void cache_touch ( cache *const p_cache, size_t slot )
+{
+
+    // Skip a slot that was emptied since the hit
+    if ( slot >= p_cache->properties.max || p_cache->properties.pp_data[slot] == (void *) 0 ) return;
+
+    // Tell the policy
+    p_cache->policy.p_policy->pfn_hit(p_cache, slot);
+
+    // Done
+    return;
+}
+
+int cache_clear ( cache *p_cache, fn_hash_cache_free *pfn_free )
+{
+
+    // Argument check
+    if ( p_cache == (void *) 0 ) goto no_cache;
+
+    // Free each property
+    if ( pfn_free )
+        
+        // Iterate through the slots
+        for (size_t i = 0; i < p_cache->properties.max; i++)
+        
+            // Free the property
+            if ( p_cache->properties.pp_data[i] ) pfn_free(p_cache->properties.pp_data[i]);
+
+    // Empty the cache
+    cache_reset(p_cache);
+
+    // Clear the bloom filter
+    if ( p_cache->bloom.p_bloom ) hash_cache_bloom_clear(p_cache->bloom.p_bloom), p_cache->bloom.inserts = 0;
+
+    // Free everything allocated after the cache was constructed
+    if ( p_cache->allocator.p_allocator->pfn_rewind )
+        p_cache->allocator.p_allocator->pfn_rewind(p_cache->allocator.p_allocator, p_cache->allocator.end);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_for_i ( const cache *const p_cache, fn_hash_cache_property_i pfn_function )
+{
+    
+    // Argument check
+    if ( p_cache      == (void *) 0 ) goto no_cache;
+    if ( pfn_function == (void *) 0 ) goto no_function;
+
+    // Iterate through the cache in the policy's order
+    for (size_t i = 0, slot = p_cache->policy.p_policy->pfn_next(p_cache, CACHE_NIL); slot != CACHE_NIL; i++, slot = p_cache->policy.p_policy->pfn_next(p_cache, slot))
+
+        // Call the function
+        pfn_function(p_cache->properties.pp_data[slot], i);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_function:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"pfn_function\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_for_each ( const cache *const p_cache, fn_hash_cache_property pfn_function )
+{
+    
+    // Argument check
+    if ( p_cache      == (void *) 0 ) goto no_cache;
+    if ( pfn_function == (void *) 0 ) goto no_function;
+
+    // Iterate through the cache in the policy's order
+    for (size_t slot = p_cache->policy.p_policy->pfn_next(p_cache, CACHE_NIL); slot != CACHE_NIL; slot = p_cache->policy.p_policy->pfn_next(p_cache, slot))
+
+        // Call the function
+        pfn_function(p_cache->properties.pp_data[slot]);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_function:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"pfn_function\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_stats ( const cache *const p_cache, hash_cache_stats *const p_stats )
+{
+
+    // Argument check
+    if ( p_cache == (void *) 0 ) goto no_cache;
+    if ( p_stats == (void *) 0 ) goto no_stats;
+
+    // State check
+    if ( p_cache->p_counters == (void *) 0 ) goto no_statistics;
+
+    // Sum the counters
+    hash_cache_counters_sum(p_cache->p_counters, p_stats);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_stats:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_stats\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash cache errors
+        {
+            no_statistics:
+                #ifndef NDEBUG
+                    log_error("[hash cache] The library was built without HASH_CACHE_STATS in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_miss_ratio_curve ( const cache *const p_cache, hash_cache_mrc_point *const p_points )
+{
+
+    // Argument check
+    if ( p_cache            == (void *) 0 ) goto no_cache;
+    if ( p_points           == (void *) 0 ) goto no_points;
+    if ( p_cache->mrc.p_mrc == (void *) 0 ) goto no_mrc;
+
+    // Success
+    return hash_cache_mrc_curve(p_cache->mrc.p_mrc, p_points);
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_points:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_points\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash cache errors
+        {
+            no_mrc:
+                #ifndef NDEBUG
+                    log_error("[hash cache] The cache does not estimate a miss ratio curve in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_destroy ( cache **const pp_cache, fn_hash_cache_free *pfn_cache_free )
+{
+
+    // Argument check
+    if ( pp_cache == (void *) 0 ) goto no_cache; 
+
+    // Initialized data
+    cache *p_cache = *pp_cache;
+
+    // No more pointer for caller
+    *pp_cache = (void *) 0;
+
+    // Clear the cache
+    cache_clear(p_cache, pfn_cache_free);
+
+    // Destroy the policy's state
+    if ( p_cache->policy.p_policy->pfn_destroy ) p_cache->policy.p_policy->pfn_destroy(p_cache);
+
+    // Destroy the bloom filter
+    if ( p_cache->bloom.p_bloom ) hash_cache_bloom_destroy(&p_cache->bloom.p_bloom);
+
+    // Destroy the miss ratio curve estimator
+    if ( p_cache->mrc.p_mrc ) hash_cache_mrc_destroy(&p_cache->mrc.p_mrc);
+
+    // Destroy the timer wheel
+    if ( p_cache->ttl.p_wheel ) hash_cache_wheel_destroy(&p_cache->ttl.p_wheel);
+
+    // Unmap the cache contents
+    if ( p_cache->allocator.mapped )
+        if ( hash_cache_pages_unmap(p_cache->properties.pp_data, p_cache->allocator.mapped) == 0 ) goto failed_to_free;
+
+    // Free everything allocated after the cache was created ...
+    if ( p_cache->allocator.p_allocator->pfn_rewind )
+        p_cache->allocator.p_allocator->pfn_rewind(p_cache->allocator.p_allocator, p_cache->allocator.begin);
+
+    // ... or free the cache contents
+    else if ( p_cache->allocator.mapped == 0 && HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_cache->properties.pp_data, 0) ) goto failed_to_free;
+
+    // Release the allocator
+    hash_cache_allocator_release(p_cache->allocator.p_allocator);
+
+    // Free the counters
+    hash_cache_counters_destroy(&p_cache->p_counters);
+
+    // Free the cache
+    if ( HASH_CACHE_REALLOC(p_cache, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"p_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void cache_list_push_front ( cache *const p_cache, size_t *const p_head, size_t *const p_tail, size_t slot )
+{
+
+    // Initialized data
+    cache_node *p_node = &p_cache->index.p_nodes[slot];
+
+    // Link the slot in front of the head
+    p_node->prev = CACHE_NIL;
+    p_node->next = *p_head;
+
+    // Link the old head, or the tail of an empty list
+    if ( *p_head != CACHE_NIL ) p_cache->index.p_nodes[*p_head].prev = slot;
+    else                        *p_tail                              = slot;
+
+    // Update the head
+    *p_head = slot;
+
+    // Done
+    return;
+}
+
+void cache_list_remove ( cache *const p_cache, size_t *const p_head, size_t *const p_tail, size_t slot )
+{
+
+    // Initialized data
+    cache_node *p_node = &p_cache->index.p_nodes[slot];
+
+    // Unlink the slot from its predecessor ...
+    if ( p_node->prev != CACHE_NIL ) p_cache->index.p_nodes[p_node->prev].next = p_node->next;
+    else                             *p_head                                   = p_node->next;
+
+    // ... and from its successor
+    if ( p_node->next != CACHE_NIL ) p_cache->index.p_nodes[p_node->next].prev = p_node->prev;
+    else                             *p_tail                                   = p_node->prev;
+
+    // Done
+    return;
+}
+
+static size_t cache_find ( const cache *const p_cache, const void *const p_key, hash64 h, size_t *const p_probes )
+{
+
+    // Initialized data
+    size_t slot = CACHE_NIL;
+
+    // Scan the tags of a small cache ...
+    if ( p_cache->index.p_tags ) slot = cache_scan(p_cache, p_key, h, p_probes);
+
+    // ... or walk the bucket
+    else for (slot = p_cache->index.p_buckets[h & p_cache->index.mask]; slot != CACHE_NIL; slot = p_cache->index.p_nodes[slot].chain)
+    {
+
+        // Count the probe
+        (*p_probes)++;
+
+        // Compare the hash first, and the key only if the hash matches
+        if ( p_cache->index.p_nodes[slot].hash == h && p_cache->pfn_equality(p_cache->pfn_key_get(p_cache->properties.pp_data[slot]), p_key) == 0 ) break;
+    }
+
+    // Hit, or CACHE_NIL on miss
+    return slot;
+}
+
+static size_t cache_scan ( const cache *const p_cache, const void *const p_key, hash64 h, size_t *const p_probes )
+{
+
+    // Initialized data
+    unsigned char tag = cache_tag(h);
+
+    // Compare CACHE_TAGS tags at a time
+    for (size_t i = 0; i < p_cache->properties.max; i += CACHE_TAGS)
+
+        // Compare the hash and the key of each slot with a matching tag
+        for (unsigned int mask = cache_tags_match(&p_cache->index.p_tags[i], tag); mask; mask &= mask - 1)
+        {
+
+            // Initialized data
+            size_t  slot    = i + (size_t) __builtin_ctz(mask);
+            void   *p_value = (void *) 0;
+
+            // Count the probe
+            (*p_probes)++;
+
+            // Compare the hash first, so a mismatch never loads the value
+            if ( __atomic_load_n(&p_cache->index.p_nodes[slot].hash, __ATOMIC_RELAXED) != h ) continue;
+
+            // Load the value
+            p_value = __atomic_load_n(&p_cache->properties.pp_data[slot], __ATOMIC_RELAXED);
+
+            // Hit
+            if ( p_value && p_cache->pfn_equality(p_cache->pfn_key_get(p_value), p_key) == 0 ) return slot;
+        }
+
+    // Miss
+    return CACHE_NIL;
+}
+
+static int cache_fetch ( cache *const p_cache, const void *const p_key, hash64 h, void **const pp_result )
+{
+
+    // Initialized data
+    size_t slot   = 0,
+           probes = 0;
+
+    // Sample the reference
+    if ( p_cache->mrc.p_mrc ) hash_cache_mrc_reference(p_cache->mrc.p_mrc, h);
+
+    // The bloom filter resolves most misses with one cache line
+    if ( p_cache->bloom.p_bloom && hash_cache_bloom_query(p_cache->bloom.p_bloom, h) == false ) slot = CACHE_NIL;
+
+    // Search the index
+    else slot = cache_find(p_cache, p_key, h, &probes);
+
+    // Count the probes of the search
+    HASH_CACHE_COUNT(p_cache->p_counters, probes, probes);
+
+    // An expired property is a miss
+    if ( slot != CACHE_NIL && cache_expired(p_cache, slot) ) cache_expire(p_cache, slot), slot = CACHE_NIL;
+
+    // Hit
+    if ( slot != CACHE_NIL )
+    {
+
+        // Count the hit
+        HASH_CACHE_COUNT(p_cache->p_counters, hits, 1);
+
+        // Tell the policy
+        p_cache->policy.p_policy->pfn_hit(p_cache, slot);
+
+        // Return the value to the caller
+        *pp_result = p_cache->properties.pp_data[slot];
+
+        // Success
+        return 1;
+    }
+
+    // Count the miss
+    HASH_CACHE_COUNT(p_cache->p_counters, misses, 1);
+
+    // Miss
+    return 0;
+}
+
+static void cache_prefetch ( const cache *const p_cache, const void *const *const pp_keys, size_t n, hash64 *const p_hashes )
+{
+
+    // Hash each key, and start loading its bucket
+    for (size_t i = 0; i < n; i++)
+    {
+
+        // Hash the key
+        p_hashes[i] = ( pp_keys[i] ) ? cache_hash(p_cache, pp_keys[i]) : 0;
+
+        // Prefetch the bucket, unless the cache scans tags
+        if ( p_cache->index.p_tags == (void *) 0 ) __builtin_prefetch(&p_cache->index.p_buckets[p_hashes[i] & p_cache->index.mask]);
+    }
+
+    // The tags of a small cache are a few cache lines, which every search touches
+    if ( p_cache->index.p_tags ) return;
+
+    // Prefetch the node of each bucket's first slot, now that the buckets are on their way
+    for (size_t i = 0; i < n; i++)
+    {
+
+        // Initialized data
+        size_t slot = p_cache->index.p_buckets[p_hashes[i] & p_cache->index.mask];
+
+        // Prefetch the node
+        if ( slot != CACHE_NIL ) __builtin_prefetch(&p_cache->index.p_nodes[slot]);
+    }
+
+    // Done
+    return;
+}
+
+static void cache_store ( cache *const p_cache, void *p_value, hash64 h, size_t cost, timestamp deadline )
+{
+
+    // Initialized data
+    size_t      slot   = 0,
+                bucket = h & p_cache->index.mask;
+    cache_node *p_node = (void *) 0;
+
+    // While the cache is full, or the value doesn't fit the budget ...
+    while ( p_cache->properties.count == p_cache->properties.max || ( p_cache->cost.budget && p_cache->properties.count && p_cache->cost.used + cost > p_cache->cost.budget ) )
+    {
+
+        // Initialized data
+        size_t  victim   = CACHE_NIL;
+        void   *p_victim = (void *) 0;
+
+        // ... take an expired property. The timer wheel skips the ticks
+        // that expire nothing, so catching it up here is cheap ...
+        if ( p_cache->ttl.p_wheel )
+        {
+
+            // Move every expired timer to the expired list
+            hash_cache_wheel_advance(p_cache->ttl.p_wheel, timer_high_precision());
+
+            // Take an expired property
+            victim = hash_cache_wheel_pop(p_cache->ttl.p_wheel);
+        }
+
+        // ... or ask the policy for a victim ...
+        if ( victim == CACHE_NIL ) victim = p_cache->policy.p_policy->pfn_victim(p_cache, h);
+
+        // Store the victim
+        p_victim = p_cache->properties.pp_data[victim];
+
+        // ... evict it ...
+        cache_unlink(p_cache, victim);
+
+        // ... and hand it to the caller
+        if ( p_cache->evict.pfn_evict ) p_cache->evict.pfn_evict(p_victim, p_cache->evict.p_context);
+
+        // Count the eviction
+        HASH_CACHE_COUNT(p_cache->p_counters, evictions, 1);
+    }
+
+    // Take a slot from the free list
+    slot                = p_cache->index.free;
+    p_node              = &p_cache->index.p_nodes[slot];
+    p_cache->index.free = p_node->chain;
+
+    // Store the value and its cost
+    p_cache->properties.pp_data[slot] = p_value;
+    p_cache->cost.p_costs[slot]       = cost;
+    p_cache->cost.used               += cost;
+
+    // Add the slot to the front of the bucket
+    p_node->hash                     = h;
+    p_node->chain                    = p_cache->index.p_buckets[bucket];
+    p_cache->index.p_buckets[bucket] = slot;
+
+    // Tag the slot
+    if ( p_cache->index.p_tags ) p_cache->index.p_tags[slot] = cache_tag(h);
+
+    // Increment the quantity of entries
+    p_cache->properties.count++;
+
+    // Tell the policy
+    p_cache->policy.p_policy->pfn_insert(p_cache, slot);
+
+    // Start the property's timer
+    if ( deadline ) hash_cache_wheel_schedule(p_cache->ttl.p_wheel, slot, deadline);
+
+    // Update the bloom filter
+    if ( p_cache->bloom.p_bloom ) cache_bloom_insert(p_cache, h);
+
+    // Count the insert
+    HASH_CACHE_COUNT(p_cache->p_counters, inserts, 1);
+
+    // Done
+    return;
+}
+
+static void cache_put ( cache *const p_cache, const void *const p_key, const void *const p_value, hash64 h, size_t cost, timestamp deadline )
+{
+
+    // Initialized data
+    size_t probes = 0,
+           slot   = cache_find(p_cache, p_key, h, &probes);
+
+    // If the key is already in the cache ...
+    if ( slot != CACHE_NIL )
+    {
+
+        // Initialized data
+        void   *p_old    = p_cache->properties.pp_data[slot];
+        size_t  old_cost = p_cache->cost.p_costs[slot];
+
+        // If the new value doesn't fit the budget in place ...
+        if ( p_cache->cost.budget && cost > old_cost && p_cache->cost.used - old_cost + cost > p_cache->cost.budget )
+        {
+
+            // ... remove the old value, and store the new value, evicting to make room
+            cache_unlink(p_cache, slot);
+            cache_store(p_cache, (void *) p_value, h, cost, deadline);
+        }
+
+        // ... otherwise ...
+        else
+        {
+
+            // ... replace the value and its cost ...
+            p_cache->properties.pp_data[slot] = (void *) p_value;
+            p_cache->cost.p_costs[slot]       = cost;
+            p_cache->cost.used                = p_cache->cost.used - old_cost + cost;
+
+            // ... tell the policy ...
+            p_cache->policy.p_policy->pfn_hit(p_cache, slot);
+
+            // ... and restart the property's timer
+            if      ( deadline             ) hash_cache_wheel_schedule(p_cache->ttl.p_wheel, slot, deadline);
+            else if ( p_cache->ttl.p_wheel ) hash_cache_wheel_cancel(p_cache->ttl.p_wheel, slot);
+
+            // Count the insert
+            HASH_CACHE_COUNT(p_cache->p_counters, inserts, 1);
+        }
+
+        // Hand the old value to the caller
+        if ( p_cache->evict.pfn_evict && p_old != p_value ) p_cache->evict.pfn_evict(p_old, p_cache->evict.p_context);
+    }
+
+    // ... otherwise, add the value to the cache
+    else cache_store(p_cache, (void *) p_value, h, cost, deadline);
+
+    // Done
+    return;
+}
+
+static void cache_expire ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    void *p_value = p_cache->properties.pp_data[slot];
+
+    // Reclaim the slot
+    cache_unlink(p_cache, slot);
+
+    // Hand the value to the caller
+    if ( p_cache->evict.pfn_evict ) p_cache->evict.pfn_evict(p_value, p_cache->evict.p_context);
+
+    // Count the eviction
+    HASH_CACHE_COUNT(p_cache->p_counters, evictions, 1);
+
+    // Done
+    return;
+}
+
+static void cache_unlink ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_node *p_node  = &p_cache->index.p_nodes[slot];
+    size_t     *p_chain = &p_cache->index.p_buckets[p_node->hash & p_cache->index.mask];
+
+    // Tell the policy
+    p_cache->policy.p_policy->pfn_remove(p_cache, slot);
+
+    // Stop the property's timer
+    if ( p_cache->ttl.p_wheel ) hash_cache_wheel_cancel(p_cache->ttl.p_wheel, slot);
+
+    // Find the link to the slot
+    while ( *p_chain != slot ) p_chain = &p_cache->index.p_nodes[*p_chain].chain;
+
+    // Remove the slot from the bucket
+    *p_chain = p_node->chain;
+
+    // Clear the slot's tag
+    if ( p_cache->index.p_tags ) p_cache->index.p_tags[slot] = 0;
+
+    // Release the slot's cost
+    p_cache->cost.used -= p_cache->cost.p_costs[slot];
+
+    // Return the slot to the free list
+    p_cache->properties.pp_data[slot] = (void *) 0;
+    p_node->chain                     = p_cache->index.free;
+    p_cache->index.free               = slot;
+
+    // Decrement the quantity of entries
+    p_cache->properties.count--;
+
+    // Done
+    return;
+}
+
+static void cache_reset ( cache *const p_cache )
+{
+
+    // Empty the slots
+    memset(p_cache->properties.pp_data, 0, sizeof(void *) * p_cache->properties.max);
+
+    // Empty the buckets
+    memset(p_cache->index.p_buckets, 0xff, sizeof(size_t) * ( p_cache->index.mask + 1 ));
+
+    // Clear the tags, including the padding after the last slot
+    if ( p_cache->index.p_tags ) memset(p_cache->index.p_tags, 0, ( p_cache->properties.max + CACHE_TAGS - 1 ) & ~(size_t) ( CACHE_TAGS - 1 ));
+
+    // Thread every slot onto the free list
+    for (size_t i = 0; i < p_cache->properties.max; i++)
+        p_cache->index.p_nodes[i].chain = i + 1;
+
+    // Terminate the free list
+    p_cache->index.p_nodes[p_cache->properties.max - 1].chain = CACHE_NIL;
+    p_cache->index.free                                       = 0;
+
+    // Empty the policy's list
+    p_cache->policy.head = CACHE_NIL;
+    p_cache->policy.tail = CACHE_NIL;
+
+    // Clear the property counter and the total cost
+    p_cache->properties.count = 0;
+    p_cache->cost.used        = 0;
+
+    // Tell the policy
+    if ( p_cache->policy.p_policy->pfn_reset ) p_cache->policy.p_policy->pfn_reset(p_cache);
+
+    // Stop every timer
+    if ( p_cache->ttl.p_wheel ) hash_cache_wheel_clear(p_cache->ttl.p_wheel);
+
+    // Done
+    return;
+}
+
+static void cache_bloom_insert ( cache *const p_cache, hash64 h )
+{
+
+    // Add the key to the bloom filter
+    hash_cache_bloom_insert(p_cache->bloom.p_bloom, h);
+
+    // Done?
+    if ( ++p_cache->bloom.inserts < 2 * p_cache->bloom.p_bloom->expected ) return;
+
+    // Rebuild the bloom filter from the resident keys
+    hash_cache_bloom_clear(p_cache->bloom.p_bloom);
+
+    // Add each resident key
+    for (size_t i = 0; i < p_cache->properties.max; i++)
+        if ( p_cache->properties.pp_data[i] ) hash_cache_bloom_insert(p_cache->bloom.p_bloom, p_cache->index.p_nodes[i].hash);
+
+    // Reset the counter
+    p_cache->bloom.inserts = p_cache->properties.count;
+
+    // Done
+    return;
+}
+
+static void cache_lru_hit ( cache *const p_cache, size_t slot )
+{
+
+    // Done?
+    if ( p_cache->policy.head == slot ) return;
+
+    // Move the slot to the front of the recency list
+    cache_list_remove(p_cache, &p_cache->policy.head, &p_cache->policy.tail, slot);
+    cache_list_push_front(p_cache, &p_cache->policy.head, &p_cache->policy.tail, slot);
+
+    // Done
+    return;
+}
+
+static void cache_lru_insert ( cache *const p_cache, size_t slot )
+{
+
+    // Add the slot to the front of the recency list
+    cache_list_push_front(p_cache, &p_cache->policy.head, &p_cache->policy.tail, slot);
+
+    // Done
+    return;
+}
+
+static size_t cache_lru_victim ( cache *const p_cache, hash64 h )
+{
+
+    // Unused
+    (void) h;
+
+    // Success
+    return p_cache->policy.tail;
+}
+
+static void cache_lru_remove ( cache *const p_cache, size_t slot )
+{
+
+    // Remove the slot from the recency list
+    cache_list_remove(p_cache, &p_cache->policy.head, &p_cache->policy.tail, slot);
+
+    // Done
+    return;
+}
+
+static size_t cache_lru_next ( const cache *const p_cache, size_t slot )
+{
+
+    // Success
+    return ( slot == CACHE_NIL ) ? p_cache->policy.head : p_cache->index.p_nodes[slot].next;
+}
@@ -0,0 +1,403 @@
+/** !
+ * Implementation of the ARC eviction policy
+ *
+ * @file cache_arc.c
+ *
+ * @author Jacob Smith
+ */
+
+// Headers
+#include <hash_cache/cache.h>
+#include <hash_cache/ghost.h>
+
+// Preprocessor definitions
+#define CACHE_ARC_T1 0
+#define CACHE_ARC_T2 1
+#define CACHE_ARC_B1 0
+#define CACHE_ARC_B2 1
+
+// Structure declarations
+struct cache_arc_s;
+
+// Type definitions
+typedef struct cache_arc_s cache_arc;
+
+// Structure definitions
+struct cache_arc_s
+{
+    unsigned char    *p_lists; // The resident list of each slot
+    struct
+    {
+        size_t head, tail, count;
+    } t[2];                    // T1 holds keys seen once recently, T2 holds keys seen at least twice
+    size_t            p;       // The adaptive target size of T1
+    hash_cache_ghost *p_ghost; // B1 and B2 remember the hashes of keys evicted from T1 and T2
+    hash64            pending; // The hash of a key whose ghost was consumed by the victim function
+    bool              ghost;   // True if pending is valid
+};
+
+// Function declarations
+/** !
+ * Allocate the lists and the ghost lists
+ *
+ * @param p_cache the cache
+ *
+ * @return 1 on success, 0 on error
+ */
+static int cache_arc_construct ( cache *const p_cache );
+
+/** !
+ * Release the lists and the ghost lists
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_arc_destroy ( cache *const p_cache );
+
+/** !
+ * Empty every list, and reset the target
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_arc_reset ( cache *const p_cache );
+
+/** !
+ * Move a slot to the front of T2
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_arc_hit ( cache *const p_cache, size_t slot );
+
+/** !
+ * Add a slot to the front of T2 if its key was in a ghost list, else to
+ * the front of T1. Then trim the ghost lists.
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_arc_insert ( cache *const p_cache, size_t slot );
+
+/** !
+ * Adapt the target if the incoming key is in a ghost list, then evict the
+ * back of T1 or T2 into its ghost list
+ *
+ * @param p_cache the cache
+ * @param h       the hash of the incoming key
+ *
+ * @return the victim
+ */
+static size_t cache_arc_victim ( cache *const p_cache, hash64 h );
+
+/** !
+ * Remove a slot from its list
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_arc_remove ( cache *const p_cache, size_t slot );
+
+/** !
+ * Walk T1, then T2, each from most to least recently used
+ *
+ * @param p_cache the cache
+ * @param slot    the slot, or CACHE_NIL for the first slot
+ *
+ * @return the next slot, or CACHE_NIL after the last slot
+ */
+static size_t cache_arc_next ( const cache *const p_cache, size_t slot );
+
+/** !
+ * Adapt the target to a ghost hit. A hit in B1 means T1 was too small, and a
+ * hit in B2 means T2 was too small.
+ *
+ * @param p_cache the cache
+ * @param entry   the ghost entry of the key
+ *
+ * @return void
+ */
+static void cache_arc_adapt ( cache *const p_cache, size_t entry );
+
+// Data
+const cache_policy cache_policy_arc =
+{
+    .pfn_construct = cache_arc_construct,
+    .pfn_destroy   = cache_arc_destroy,
+    .pfn_reset     = cache_arc_reset,
+    .pfn_hit       = cache_arc_hit,
+    .pfn_insert    = cache_arc_insert,
+    .pfn_victim    = cache_arc_victim,
+    .pfn_remove    = cache_arc_remove,
+    .pfn_next      = cache_arc_next
+};
+
+// Function definitions
+static int cache_arc_construct ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_arc *p_arc = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, 0, sizeof(cache_arc) + p_cache->properties.max);
+
+    // Error check
+    if ( p_arc == (void *) 0 ) goto no_mem;
+
+    // The list of each slot follows the state
+    p_arc->p_lists = (unsigned char *) ( p_arc + 1 );
+
+    // Construct the ghost lists. While the cache is full, B1 and B2 hold at most as many keys as the cache
+    if ( hash_cache_ghost_construct(&p_arc->p_ghost, p_cache->properties.max) == 0 ) goto failed_to_construct_ghost;
+
+    // Store the state
+    p_cache->policy.p_state = p_arc;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Hash cache errors
+        {
+            failed_to_construct_ghost:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to construct ghost list in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the state
+                p_arc = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_arc, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void cache_arc_destroy ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_arc *p_arc = p_cache->policy.p_state;
+
+    // Destroy the ghost lists
+    hash_cache_ghost_destroy(&p_arc->p_ghost);
+
+    // Free the state
+    p_cache->policy.p_state = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_arc, 0);
+
+    // Done
+    return;
+}
+
+static void cache_arc_reset ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_arc *p_arc = p_cache->policy.p_state;
+
+    // Empty the resident lists
+    for (size_t i = 0; i < 2; i++)
+        p_arc->t[i].head  = CACHE_NIL,
+        p_arc->t[i].tail  = CACHE_NIL,
+        p_arc->t[i].count = 0;
+
+    // Empty the ghost lists
+    hash_cache_ghost_clear(p_arc->p_ghost);
+
+    // Reset the target
+    p_arc->p     = 0;
+    p_arc->ghost = false;
+
+    // Done
+    return;
+}
+
+static void cache_arc_hit ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_arc *p_arc = p_cache->policy.p_state;
+
+    // Done?
+    if ( p_arc->p_lists[slot] == CACHE_ARC_T2 && p_arc->t[CACHE_ARC_T2].head == slot ) return;
+
+    // Remove the slot from its list
+    cache_arc_remove(p_cache, slot);
+
+    // Add the slot to the front of T2
+    cache_list_push_front(p_cache, &p_arc->t[CACHE_ARC_T2].head, &p_arc->t[CACHE_ARC_T2].tail, slot);
+    p_arc->p_lists[slot] = CACHE_ARC_T2;
+    p_arc->t[CACHE_ARC_T2].count++;
+
+    // Done
+    return;
+}
+
+static void cache_arc_insert ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_arc *p_arc = p_cache->policy.p_state;
+    hash64     h     = p_cache->index.p_nodes[slot].hash;
+    size_t     c     = p_cache->properties.max,
+               entry = HASH_CACHE_GHOST_NIL,
+               list  = CACHE_ARC_T1;
+
+    // The victim function already consumed the key's ghost ...
+    if ( p_arc->ghost && p_arc->pending == h ) list = CACHE_ARC_T2;
+
+    // ... or the key may still be in a ghost list
+    else if ( ( entry = hash_cache_ghost_find(p_arc->p_ghost, h) ) != HASH_CACHE_GHOST_NIL )
+    {
+
+        // Adapt the target
+        cache_arc_adapt(p_cache, entry);
+
+        // Forget the ghost
+        hash_cache_ghost_remove(p_arc->p_ghost, entry);
+
+        // A key seen again goes to T2
+        list = CACHE_ARC_T2;
+    }
+
+    // Clear the pending ghost
+    p_arc->ghost = false;
+
+    // Add the slot to the front of its list
+    cache_list_push_front(p_cache, &p_arc->t[list].head, &p_arc->t[list].tail, slot);
+    p_arc->p_lists[slot] = (unsigned char) list;
+    p_arc->t[list].count++;
+
+    // Keep T1 and B1 within the size of the cache ...
+    while ( p_arc->t[CACHE_ARC_T1].count + p_arc->p_ghost->lists[CACHE_ARC_B1].count > c )
+        if ( hash_cache_ghost_pop(p_arc->p_ghost, CACHE_ARC_B1) == 0 ) break;
+
+    // ... and every list within twice the size of the cache
+    while ( p_arc->t[CACHE_ARC_T1].count + p_arc->t[CACHE_ARC_T2].count + p_arc->p_ghost->lists[CACHE_ARC_B1].count + p_arc->p_ghost->lists[CACHE_ARC_B2].count > 2 * c )
+        if ( hash_cache_ghost_pop(p_arc->p_ghost, CACHE_ARC_B2) == 0 ) break;
+
+    // Done
+    return;
+}
+
+static size_t cache_arc_victim ( cache *const p_cache, hash64 h )
+{
+
+    // Initialized data
+    cache_arc *p_arc = p_cache->policy.p_state;
+    size_t     entry = hash_cache_ghost_find(p_arc->p_ghost, h),
+               t1    = p_arc->t[CACHE_ARC_T1].count,
+               slot  = CACHE_NIL,
+               from  = CACHE_ARC_T2;
+    bool       in_b2 = false;
+
+    // If the incoming key is in a ghost list ...
+    if ( entry != HASH_CACHE_GHOST_NIL )
+    {
+
+        // ... remember which one ...
+        in_b2 = ( p_arc->p_ghost->p_entries[entry].list == CACHE_ARC_B2 );
+
+        // ... adapt the target ...
+        cache_arc_adapt(p_cache, entry);
+
+        // ... and consume the ghost, so evicting into a full ghost list can't forget it
+        hash_cache_ghost_remove(p_arc->p_ghost, entry);
+        p_arc->pending = h;
+        p_arc->ghost   = true;
+    }
+
+    // Evict from T1 if it is over the target, or T2 is empty
+    if ( t1 && ( t1 > p_arc->p || ( in_b2 && t1 == p_arc->p ) || p_arc->t[CACHE_ARC_T2].count == 0 ) ) from = CACHE_ARC_T1;
+
+    // The victim is the least recently used slot of the list
+    slot = p_arc->t[from].tail;
+
+    // Remember the victim's key in the matching ghost list
+    hash_cache_ghost_push(p_arc->p_ghost, ( from == CACHE_ARC_T1 ) ? CACHE_ARC_B1 : CACHE_ARC_B2, p_cache->index.p_nodes[slot].hash);
+
+    // Success
+    return slot;
+}
+
+static void cache_arc_remove ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_arc *p_arc = p_cache->policy.p_state;
+    size_t     list  = p_arc->p_lists[slot];
+
+    // Remove the slot from its list
+    cache_list_remove(p_cache, &p_arc->t[list].head, &p_arc->t[list].tail, slot);
+    p_arc->t[list].count--;
+
+    // Done
+    return;
+}
+
+static size_t cache_arc_next ( const cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    const cache_arc *p_arc = p_cache->policy.p_state;
+
+    // Start with T1
+    if ( slot == CACHE_NIL ) return ( p_arc->t[CACHE_ARC_T1].head != CACHE_NIL ) ? p_arc->t[CACHE_ARC_T1].head : p_arc->t[CACHE_ARC_T2].head;
+
+    // Continue through the slot's list
+    if ( p_cache->index.p_nodes[slot].next != CACHE_NIL ) return p_cache->index.p_nodes[slot].next;
+
+    // Continue from the end of T1 to T2
+    return ( p_arc->p_lists[slot] == CACHE_ARC_T1 ) ? p_arc->t[CACHE_ARC_T2].head : CACHE_NIL;
+}
+
+static void cache_arc_adapt ( cache *const p_cache, size_t entry )
+{
+
+    // Initialized data
+    cache_arc *p_arc = p_cache->policy.p_state;
+    size_t     b1    = p_arc->p_ghost->lists[CACHE_ARC_B1].count,
+               b2    = p_arc->p_ghost->lists[CACHE_ARC_B2].count,
+               c     = p_cache->properties.max,
+               delta = 0;
+
+    // A hit in B1 grows the target of T1 ...
+    if ( p_arc->p_ghost->p_entries[entry].list == CACHE_ARC_B1 )
+    {
+
+        // Grow faster when B2 is the bigger ghost list
+        delta    = ( b2 > b1 ) ? b2 / b1 : 1;
+        p_arc->p = ( p_arc->p + delta < c ) ? p_arc->p + delta : c;
+    }
+
+    // ... and a hit in B2 shrinks it
+    else
+    {
+
+        // Shrink faster when B1 is the bigger ghost list
+        delta    = ( b1 > b2 ) ? b1 / b2 : 1;
+        p_arc->p = ( p_arc->p > delta ) ? p_arc->p - delta : 0;
+    }
+
+    // Done
+    return;
+}
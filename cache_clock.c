@@ -0,0 +1,661 @@
+/** !
+ * Implementation of CLOCK and CLOCK-Pro eviction policies
+ *
+ * @file cache_clock.c
+ *
+ * @author Jacob Smith
+ */
+
+// Headers
+#include <hash_cache/cache.h>
+#include <hash_cache/ghost.h>
+
+// Preprocessor definitions
+#define CACHE_CLOCK_REFERENCED 0x1
+#define CACHE_CLOCK_HOT        0x2
+#define CACHE_CLOCK_TEST       0x4
+
+// Structure declarations
+struct cache_clock_s;
+struct cache_clock_pro_s;
+
+// Type definitions
+typedef struct cache_clock_s     cache_clock;
+typedef struct cache_clock_pro_s cache_clock_pro;
+
+// Structure definitions
+struct cache_clock_s
+{
+    unsigned char *p_flags; // One byte per slot
+    size_t         hand;    // The next slot to sweep
+};
+
+struct cache_clock_pro_s
+{
+    unsigned char    *p_flags;     // One byte per slot
+    size_t            hand_cold,   // The next cold property to sweep for a victim, or CACHE_NIL if every property is hot
+                      hand_hot,    // The next hot property to sweep for one to demote, or CACHE_NIL if every property is cold
+                      hot,         // The quantity of hot properties
+                      cold_target; // The adaptive quantity of slots for cold properties, at least 1% of the slots
+    hash_cache_ghost *p_ghost;     // Cold keys that were evicted during their test period
+};
+
+// Function declarations
+
+// Shared
+/** !
+ * Walk the occupied slots in order
+ *
+ * @param p_cache the cache
+ * @param slot    the slot, or CACHE_NIL for the first slot
+ *
+ * @return the next occupied slot, or CACHE_NIL after the last slot
+ */
+static size_t cache_clock_next ( const cache *const p_cache, size_t slot );
+
+// CLOCK
+/** !
+ * Allocate a reference bit for each slot
+ *
+ * @param p_cache the cache
+ *
+ * @return 1 on success, 0 on error
+ */
+static int cache_clock_construct ( cache *const p_cache );
+
+/** !
+ * Release the reference bits
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_clock_destroy ( cache *const p_cache );
+
+/** !
+ * Clear every reference bit, and return the hand to the first slot
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_clock_reset ( cache *const p_cache );
+
+/** !
+ * Set a slot's reference bit
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_clock_hit ( cache *const p_cache, size_t slot );
+
+/** !
+ * Clear a slot's reference bit
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_clock_insert ( cache *const p_cache, size_t slot );
+
+/** !
+ * Sweep the hand until it finds a slot whose reference bit is clear,
+ * clearing each set reference bit on the way
+ *
+ * @param p_cache the cache
+ * @param h       unused
+ *
+ * @return the victim
+ */
+static size_t cache_clock_victim ( cache *const p_cache, hash64 h );
+
+// CLOCK-Pro
+/** !
+ * Allocate the flags and the test period ghost list
+ *
+ * @param p_cache the cache
+ *
+ * @return 1 on success, 0 on error
+ */
+static int cache_clock_pro_construct ( cache *const p_cache );
+
+/** !
+ * Release the flags and the test period ghost list
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_clock_pro_destroy ( cache *const p_cache );
+
+/** !
+ * Forget every slot and every test period
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_clock_pro_reset ( cache *const p_cache );
+
+/** !
+ * Add a slot as a cold property in its test period, or as a hot property if
+ * its key was evicted during its test period
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_clock_pro_insert ( cache *const p_cache, size_t slot );
+
+/** !
+ * Sweep the cold hand around the ring of cold properties until it finds an
+ * unreferenced cold property. A referenced cold property in its test period
+ * is promoted to hot.
+ *
+ * @param p_cache the cache
+ * @param h       unused
+ *
+ * @return the victim
+ */
+static size_t cache_clock_pro_victim ( cache *const p_cache, hash64 h );
+
+/** !
+ * Forget a slot's flags
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_clock_pro_remove ( cache *const p_cache, size_t slot );
+
+/** !
+ * Sweep the hot hand around the ring of hot properties, demoting unreferenced
+ * hot properties to cold, until the hot properties fit in the slots that
+ * aren't reserved for cold ones
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_clock_pro_balance ( cache *const p_cache );
+
+/** !
+ * Add a property to the ring of cold properties or the ring of hot properties,
+ * just behind the ring's hand. The rings are linked through the nodes, so each
+ * hand only sweeps the properties it can act on.
+ *
+ * @param p_cache the cache
+ * @param p_hand  the hand of the ring
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_clock_pro_link ( cache *const p_cache, size_t *const p_hand, size_t slot );
+
+/** !
+ * Remove a property from its ring
+ *
+ * @param p_cache the cache
+ * @param p_hand  the hand of the ring
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_clock_pro_unlink ( cache *const p_cache, size_t *const p_hand, size_t slot );
+
+// Data
+const cache_policy cache_policy_clock =
+{
+    .pfn_construct = cache_clock_construct,
+    .pfn_destroy   = cache_clock_destroy,
+    .pfn_reset     = cache_clock_reset,
+    .pfn_hit       = cache_clock_hit,
+    .pfn_insert    = cache_clock_insert,
+    .pfn_victim    = cache_clock_victim,
+    .pfn_remove    = cache_clock_insert,
+    .pfn_next      = cache_clock_next
+};
+
+const cache_policy cache_policy_clock_pro =
+{
+    .pfn_construct = cache_clock_pro_construct,
+    .pfn_destroy   = cache_clock_pro_destroy,
+    .pfn_reset     = cache_clock_pro_reset,
+    .pfn_hit       = cache_clock_hit,
+    .pfn_insert    = cache_clock_pro_insert,
+    .pfn_victim    = cache_clock_pro_victim,
+    .pfn_remove    = cache_clock_pro_remove,
+    .pfn_next      = cache_clock_next
+};
+
+// Function definitions
+static size_t cache_clock_next ( const cache *const p_cache, size_t slot )
+{
+
+    // Skip the empty slots
+    for (size_t i = ( slot == CACHE_NIL ) ? 0 : slot + 1; i < p_cache->properties.max; i++)
+        if ( p_cache->properties.pp_data[i] ) return i;
+
+    // Done
+    return CACHE_NIL;
+}
+
+static int cache_clock_construct ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_clock *p_clock = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, 0, sizeof(cache_clock) + p_cache->properties.max);
+
+    // Error check
+    if ( p_clock == (void *) 0 ) goto no_mem;
+
+    // The flags follow the state
+    p_clock->p_flags = (unsigned char *) ( p_clock + 1 );
+
+    // Store the state
+    p_cache->policy.p_state = p_clock;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void cache_clock_destroy ( cache *const p_cache )
+{
+
+    // Free the state
+    p_cache->policy.p_state = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_cache->policy.p_state, 0);
+
+    // Done
+    return;
+}
+
+static void cache_clock_reset ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_clock *p_clock = p_cache->policy.p_state;
+
+    // Clear every flag
+    memset(p_clock->p_flags, 0, p_cache->properties.max);
+
+    // Return the hand to the first slot
+    p_clock->hand = 0;
+
+    // Done
+    return;
+}
+
+static void cache_clock_hit ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data. The flags are the first member of both states
+    unsigned char *p_flag = &((cache_clock *) p_cache->policy.p_state)->p_flags[slot];
+
+    // Set the reference bit, without dirtying the cache line if it's already set
+    if ( ( *p_flag & CACHE_CLOCK_REFERENCED ) == 0 ) *p_flag |= CACHE_CLOCK_REFERENCED;
+
+    // Done
+    return;
+}
+
+static void cache_clock_insert ( cache *const p_cache, size_t slot )
+{
+
+    // Clear the reference bit
+    ((cache_clock *) p_cache->policy.p_state)->p_flags[slot] = 0;
+
+    // Done
+    return;
+}
+
+static size_t cache_clock_victim ( cache *const p_cache, hash64 h )
+{
+
+    // Initialized data
+    cache_clock *p_clock = p_cache->policy.p_state;
+    size_t       slot    = 0;
+
+    // Unused
+    (void) h;
+
+    // Sweep. The cache isn't empty, so some slot is occupied
+    for (;;)
+    {
+
+        // Advance the hand
+        slot          = p_clock->hand;
+        p_clock->hand = ( slot + 1 == p_cache->properties.max ) ? 0 : slot + 1;
+
+        // Skip empty slots. A cache with a budget may evict before it's full
+        if ( p_cache->properties.pp_data[slot] == (void *) 0 ) continue;
+
+        // Found the victim
+        if ( p_clock->p_flags[slot] == 0 ) return slot;
+
+        // Give the property a second chance
+        p_clock->p_flags[slot] = 0;
+    }
+}
+
+static int cache_clock_pro_construct ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_clock_pro *p_clock_pro = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, 0, sizeof(cache_clock_pro) + p_cache->properties.max);
+
+    // Error check
+    if ( p_clock_pro == (void *) 0 ) goto no_mem;
+
+    // The flags follow the state
+    p_clock_pro->p_flags = (unsigned char *) ( p_clock_pro + 1 );
+
+    // Construct the test period ghost list. It remembers as many keys as the cache holds
+    if ( hash_cache_ghost_construct(&p_clock_pro->p_ghost, p_cache->properties.max) == 0 ) goto failed_to_construct_ghost;
+
+    // Store the state
+    p_cache->policy.p_state = p_clock_pro;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Hash cache errors
+        {
+            failed_to_construct_ghost:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to construct ghost list in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the state
+                p_clock_pro = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_clock_pro, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void cache_clock_pro_destroy ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_clock_pro *p_clock_pro = p_cache->policy.p_state;
+
+    // Destroy the ghost list
+    hash_cache_ghost_destroy(&p_clock_pro->p_ghost);
+
+    // Free the state
+    p_cache->policy.p_state = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_clock_pro, 0);
+
+    // Done
+    return;
+}
+
+static void cache_clock_pro_reset ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_clock_pro *p_clock_pro = p_cache->policy.p_state;
+
+    // Clear every flag
+    memset(p_clock_pro->p_flags, 0, p_cache->properties.max);
+
+    // Forget every test period
+    hash_cache_ghost_clear(p_clock_pro->p_ghost);
+
+    // Start with half of the slots for cold properties
+    p_clock_pro->hand_cold   = CACHE_NIL;
+    p_clock_pro->hand_hot    = CACHE_NIL;
+    p_clock_pro->hot         = 0;
+    p_clock_pro->cold_target = ( p_cache->properties.max + 1 ) / 2;
+
+    // Done
+    return;
+}
+
+static void cache_clock_pro_insert ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_clock_pro *p_clock_pro = p_cache->policy.p_state;
+    size_t           entry       = hash_cache_ghost_find(p_clock_pro->p_ghost, p_cache->index.p_nodes[slot].hash);
+
+    // A new key starts cold, in its test period
+    if ( entry == HASH_CACHE_GHOST_NIL )
+    {
+
+        // Set the flags
+        p_clock_pro->p_flags[slot] = CACHE_CLOCK_TEST;
+
+        // Add the property to the cold ring
+        cache_clock_pro_link(p_cache, &p_clock_pro->hand_cold, slot);
+
+        // Done
+        return;
+    }
+
+    // The key came back during its test period, so cold properties need more room ...
+    if ( p_clock_pro->cold_target < p_cache->properties.max ) p_clock_pro->cold_target++;
+
+    // ... and the key ends its test period ...
+    hash_cache_ghost_remove(p_clock_pro->p_ghost, entry);
+
+    // ... as a hot property
+    p_clock_pro->p_flags[slot] = CACHE_CLOCK_HOT;
+    p_clock_pro->hot++;
+    cache_clock_pro_link(p_cache, &p_clock_pro->hand_hot, slot);
+
+    // Demote hot properties to make room
+    cache_clock_pro_balance(p_cache);
+
+    // Done
+    return;
+}
+
+static size_t cache_clock_pro_victim ( cache *const p_cache, hash64 h )
+{
+
+    // Initialized data
+    cache_clock_pro *p_clock_pro = p_cache->policy.p_state;
+    size_t           slot        = 0;
+
+    // Unused
+    (void) h;
+
+    // Demote a hot property if every property is hot. A cache with a budget
+    // may evict every cold property before it's full
+    cache_clock_pro_balance(p_cache);
+
+    // Sweep the cold hand around the cold ring. The cache isn't empty, and at least one property is cold
+    for (;;)
+    {
+
+        // Initialized data
+        unsigned char *p_flag = (void *) 0;
+
+        // Advance the hand
+        slot                   = p_clock_pro->hand_cold;
+        p_flag                 = &p_clock_pro->p_flags[slot];
+        p_clock_pro->hand_cold = p_cache->index.p_nodes[slot].next;
+
+        // Found the victim
+        if ( ( *p_flag & CACHE_CLOCK_REFERENCED ) == 0 ) break;
+
+        // A cold property referenced during its test period is promoted ...
+        if ( *p_flag & CACHE_CLOCK_TEST )
+        {
+
+            // ... to a hot property ...
+            *p_flag = CACHE_CLOCK_HOT;
+            p_clock_pro->hot++;
+            cache_clock_pro_unlink(p_cache, &p_clock_pro->hand_cold, slot);
+            cache_clock_pro_link(p_cache, &p_clock_pro->hand_hot, slot);
+
+            // ... which may demote another
+            cache_clock_pro_balance(p_cache);
+        }
+
+        // ... else it starts a new test period
+        else *p_flag = CACHE_CLOCK_TEST;
+    }
+
+    // Remember the victim's key until its test period ends
+    if ( p_clock_pro->p_flags[slot] & CACHE_CLOCK_TEST )
+    {
+
+        // The oldest test period ends, so cold properties need less room. Keep at least 1% of the slots for cold properties
+        if ( p_clock_pro->p_ghost->free == HASH_CACHE_GHOST_NIL && p_clock_pro->cold_target > ( p_cache->properties.max + 99 ) / 100 ) p_clock_pro->cold_target--;
+
+        // Remember the key
+        hash_cache_ghost_push(p_clock_pro->p_ghost, 0, p_cache->index.p_nodes[slot].hash);
+    }
+
+    // Success
+    return slot;
+}
+
+static void cache_clock_pro_remove ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_clock_pro *p_clock_pro = p_cache->policy.p_state;
+
+    // Leave the property's ring, and update the quantity of hot properties
+    if ( p_clock_pro->p_flags[slot] & CACHE_CLOCK_HOT ) p_clock_pro->hot--, cache_clock_pro_unlink(p_cache, &p_clock_pro->hand_hot, slot);
+    else                                                cache_clock_pro_unlink(p_cache, &p_clock_pro->hand_cold, slot);
+
+    // Clear the flags
+    p_clock_pro->p_flags[slot] = 0;
+
+    // Done
+    return;
+}
+
+static void cache_clock_pro_balance ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_clock_pro *p_clock_pro = p_cache->policy.p_state;
+
+    // Sweep the hot hand around the hot ring, until the cold properties have room, and at least one property is cold
+    while ( p_clock_pro->hot + p_clock_pro->cold_target > p_cache->properties.max || ( p_clock_pro->hot && p_clock_pro->hot == p_cache->properties.count ) )
+    {
+
+        // Initialized data
+        size_t         slot   = p_clock_pro->hand_hot;
+        unsigned char *p_flag = &p_clock_pro->p_flags[slot];
+
+        // Advance the hand
+        p_clock_pro->hand_hot = p_cache->index.p_nodes[slot].next;
+
+        // A referenced hot property stays hot ...
+        if ( *p_flag & CACHE_CLOCK_REFERENCED ) *p_flag = CACHE_CLOCK_HOT;
+
+        // ... else it's demoted to cold
+        else
+        {
+
+            // Clear the flags
+            *p_flag = 0;
+            p_clock_pro->hot--;
+
+            // Move the property to the cold ring
+            cache_clock_pro_unlink(p_cache, &p_clock_pro->hand_hot, slot);
+            cache_clock_pro_link(p_cache, &p_clock_pro->hand_cold, slot);
+        }
+    }
+
+    // Done
+    return;
+}
+
+static void cache_clock_pro_link ( cache *const p_cache, size_t *const p_hand, size_t slot )
+{
+
+    // Initialized data
+    cache_node *p_nodes = p_cache->index.p_nodes;
+    size_t      hand    = *p_hand;
+
+    // The first property is a ring of one ...
+    if ( hand == CACHE_NIL )
+    {
+
+        // Link the property to itself
+        p_nodes[slot].prev = slot;
+        p_nodes[slot].next = slot;
+        *p_hand            = slot;
+
+        // Done
+        return;
+    }
+
+    // ... else the property goes behind the hand, so the hand reaches it last
+    p_nodes[slot].prev               = p_nodes[hand].prev;
+    p_nodes[slot].next               = hand;
+    p_nodes[p_nodes[hand].prev].next = slot;
+    p_nodes[hand].prev               = slot;
+
+    // Done
+    return;
+}
+
+static void cache_clock_pro_unlink ( cache *const p_cache, size_t *const p_hand, size_t slot )
+{
+
+    // Initialized data
+    cache_node *p_nodes = p_cache->index.p_nodes;
+
+    // The last property empties the ring ...
+    if ( p_nodes[slot].next == slot )
+    {
+
+        // Empty the ring
+        *p_hand = CACHE_NIL;
+
+        // Done
+        return;
+    }
+
+    // ... else its neighbors link to each other
+    p_nodes[p_nodes[slot].prev].next = p_nodes[slot].next;
+    p_nodes[p_nodes[slot].next].prev = p_nodes[slot].prev;
+
+    // Move the hand off the property
+    if ( *p_hand == slot ) *p_hand = p_nodes[slot].next;
+
+    // Done
+    return;
+}
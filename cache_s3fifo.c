@@ -0,0 +1,360 @@
+/** !
+ * Implementation of the S3-FIFO eviction policy
+ *
+ * @file cache_s3fifo.c
+ *
+ * @author Jacob Smith
+ */
+
+// Headers
+#include <hash_cache/cache.h>
+#include <hash_cache/ghost.h>
+
+// Preprocessor definitions
+#define CACHE_S3FIFO_SMALL     0
+#define CACHE_S3FIFO_MAIN      1
+#define CACHE_S3FIFO_FREQUENCY 0x3
+#define CACHE_S3FIFO_QUEUE     0x4
+
+// Structure declarations
+struct cache_s3fifo_s;
+
+// Type definitions
+typedef struct cache_s3fifo_s cache_s3fifo;
+
+// Structure definitions
+struct cache_s3fifo_s
+{
+    unsigned char    *p_flags;  // The queue and the 2 bit frequency of each slot
+    struct
+    {
+        size_t head, tail, count;
+    } queues[2];                // The small and main FIFO queues
+    size_t            small;    // The target size of the small queue
+    hash_cache_ghost *p_ghost;  // The hashes of keys evicted from the small queue
+};
+
+// Function declarations
+/** !
+ * Allocate the flags and the ghost queue
+ *
+ * @param p_cache the cache
+ *
+ * @return 1 on success, 0 on error
+ */
+static int cache_s3fifo_construct ( cache *const p_cache );
+
+/** !
+ * Release the flags and the ghost queue
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_s3fifo_destroy ( cache *const p_cache );
+
+/** !
+ * Empty every queue
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_s3fifo_reset ( cache *const p_cache );
+
+/** !
+ * Increment a slot's frequency, saturating at 3. A hit never reorders a
+ * queue.
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_s3fifo_hit ( cache *const p_cache, size_t slot );
+
+/** !
+ * Add a slot to the main queue if its key is in the ghost queue, else to
+ * the small queue
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_s3fifo_insert ( cache *const p_cache, size_t slot );
+
+/** !
+ * Evict from the small queue while it's over its target, else from the main
+ * queue. A small property that was hit moves to the main queue, and a main
+ * property that was hit is reinserted with a lower frequency.
+ *
+ * @param p_cache the cache
+ * @param h       unused
+ *
+ * @return the victim
+ */
+static size_t cache_s3fifo_victim ( cache *const p_cache, hash64 h );
+
+/** !
+ * Remove a slot from its queue
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_s3fifo_remove ( cache *const p_cache, size_t slot );
+
+/** !
+ * Walk the small queue, then the main queue, each from newest to oldest
+ *
+ * @param p_cache the cache
+ * @param slot    the slot, or CACHE_NIL for the first slot
+ *
+ * @return the next slot, or CACHE_NIL after the last slot
+ */
+static size_t cache_s3fifo_next ( const cache *const p_cache, size_t slot );
+
+/** !
+ * Add a slot to the front of a queue
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ * @param queue   the queue
+ *
+ * @return void
+ */
+static void cache_s3fifo_push ( cache *const p_cache, size_t slot, size_t queue );
+
+// Data
+const cache_policy cache_policy_s3fifo =
+{
+    .pfn_construct = cache_s3fifo_construct,
+    .pfn_destroy   = cache_s3fifo_destroy,
+    .pfn_reset     = cache_s3fifo_reset,
+    .pfn_hit       = cache_s3fifo_hit,
+    .pfn_insert    = cache_s3fifo_insert,
+    .pfn_victim    = cache_s3fifo_victim,
+    .pfn_remove    = cache_s3fifo_remove,
+    .pfn_next      = cache_s3fifo_next
+};
+
+// Function definitions
+static int cache_s3fifo_construct ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_s3fifo *p_s3fifo = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, 0, sizeof(cache_s3fifo) + p_cache->properties.max);
+    size_t        c        = p_cache->properties.max;
+
+    // Error check
+    if ( p_s3fifo == (void *) 0 ) goto no_mem;
+
+    // The flags follow the state
+    p_s3fifo->p_flags = (unsigned char *) ( p_s3fifo + 1 );
+
+    // The small queue gets 10% of the slots
+    p_s3fifo->small = ( c / 10 ) ? c / 10 : 1;
+
+    // The ghost queue remembers as many keys as the main queue holds
+    if ( hash_cache_ghost_construct(&p_s3fifo->p_ghost, ( c > p_s3fifo->small ) ? c - p_s3fifo->small : 1) == 0 ) goto failed_to_construct_ghost;
+
+    // Store the state
+    p_cache->policy.p_state = p_s3fifo;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Hash cache errors
+        {
+            failed_to_construct_ghost:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to construct ghost list in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the state
+                p_s3fifo = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_s3fifo, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void cache_s3fifo_destroy ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_s3fifo *p_s3fifo = p_cache->policy.p_state;
+
+    // Destroy the ghost queue
+    hash_cache_ghost_destroy(&p_s3fifo->p_ghost);
+
+    // Free the state
+    p_cache->policy.p_state = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_s3fifo, 0);
+
+    // Done
+    return;
+}
+
+static void cache_s3fifo_reset ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_s3fifo *p_s3fifo = p_cache->policy.p_state;
+
+    // Empty each queue
+    for (size_t i = 0; i < 2; i++)
+        p_s3fifo->queues[i].head  = CACHE_NIL,
+        p_s3fifo->queues[i].tail  = CACHE_NIL,
+        p_s3fifo->queues[i].count = 0;
+
+    // Empty the ghost queue
+    hash_cache_ghost_clear(p_s3fifo->p_ghost);
+
+    // Done
+    return;
+}
+
+static void cache_s3fifo_hit ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    unsigned char *p_flag = &((cache_s3fifo *) p_cache->policy.p_state)->p_flags[slot];
+
+    // Increment the frequency, without dirtying the cache line if it's saturated
+    if ( ( *p_flag & CACHE_S3FIFO_FREQUENCY ) != CACHE_S3FIFO_FREQUENCY ) (*p_flag)++;
+
+    // Done
+    return;
+}
+
+static void cache_s3fifo_insert ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_s3fifo *p_s3fifo = p_cache->policy.p_state;
+    size_t        entry    = hash_cache_ghost_find(p_s3fifo->p_ghost, p_cache->index.p_nodes[slot].hash);
+
+    // A new key goes to the small queue
+    if ( entry == HASH_CACHE_GHOST_NIL )
+    {
+
+        // Add the slot to the small queue
+        cache_s3fifo_push(p_cache, slot, CACHE_S3FIFO_SMALL);
+
+        // Done
+        return;
+    }
+
+    // A key that was evicted from the small queue recently goes to the main queue
+    hash_cache_ghost_remove(p_s3fifo->p_ghost, entry);
+
+    // Add the slot to the main queue
+    cache_s3fifo_push(p_cache, slot, CACHE_S3FIFO_MAIN);
+
+    // Done
+    return;
+}
+
+static size_t cache_s3fifo_victim ( cache *const p_cache, hash64 h )
+{
+
+    // Initialized data
+    cache_s3fifo *p_s3fifo = p_cache->policy.p_state;
+
+    // Unused
+    (void) h;
+
+    // Evict. The cache is full, so at least one queue isn't empty
+    for (;;)
+    {
+
+        // Initialized data
+        bool          small = ( p_s3fifo->queues[CACHE_S3FIFO_SMALL].count >= p_s3fifo->small || p_s3fifo->queues[CACHE_S3FIFO_MAIN].count == 0 );
+        size_t        slot  = p_s3fifo->queues[small ? CACHE_S3FIFO_SMALL : CACHE_S3FIFO_MAIN].tail;
+        unsigned char flags = p_s3fifo->p_flags[slot];
+
+        // Found the victim
+        if ( ( flags & CACHE_S3FIFO_FREQUENCY ) == 0 )
+        {
+
+            // Remember the keys evicted from the small queue
+            if ( small ) hash_cache_ghost_push(p_s3fifo->p_ghost, 0, p_cache->index.p_nodes[slot].hash);
+
+            // Success
+            return slot;
+        }
+
+        // Take the slot off its queue. A small property that was hit moves to
+        // the main queue, and a main property that was hit goes around again
+        cache_s3fifo_remove(p_cache, slot);
+        cache_s3fifo_push(p_cache, slot, CACHE_S3FIFO_MAIN);
+
+        // A main property keeps its frequency, less one
+        if ( small == false ) p_s3fifo->p_flags[slot] = (unsigned char) ( CACHE_S3FIFO_QUEUE | ( ( flags & CACHE_S3FIFO_FREQUENCY ) - 1 ) );
+    }
+}
+
+static void cache_s3fifo_remove ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_s3fifo *p_s3fifo = p_cache->policy.p_state;
+    size_t        queue    = ( p_s3fifo->p_flags[slot] & CACHE_S3FIFO_QUEUE ) ? CACHE_S3FIFO_MAIN : CACHE_S3FIFO_SMALL;
+
+    // Remove the slot from its queue
+    cache_list_remove(p_cache, &p_s3fifo->queues[queue].head, &p_s3fifo->queues[queue].tail, slot);
+    p_s3fifo->queues[queue].count--;
+
+    // Done
+    return;
+}
+
+static size_t cache_s3fifo_next ( const cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    const cache_s3fifo *p_s3fifo = p_cache->policy.p_state;
+
+    // Start with the small queue
+    if ( slot == CACHE_NIL ) return ( p_s3fifo->queues[CACHE_S3FIFO_SMALL].head != CACHE_NIL ) ? p_s3fifo->queues[CACHE_S3FIFO_SMALL].head : p_s3fifo->queues[CACHE_S3FIFO_MAIN].head;
+
+    // Continue through the slot's queue
+    if ( p_cache->index.p_nodes[slot].next != CACHE_NIL ) return p_cache->index.p_nodes[slot].next;
+
+    // Continue from the end of the small queue to the main queue
+    return ( p_s3fifo->p_flags[slot] & CACHE_S3FIFO_QUEUE ) ? CACHE_NIL : p_s3fifo->queues[CACHE_S3FIFO_MAIN].head;
+}
+
+static void cache_s3fifo_push ( cache *const p_cache, size_t slot, size_t queue )
+{
+
+    // Initialized data
+    cache_s3fifo *p_s3fifo = p_cache->policy.p_state;
+
+    // Add the slot to the front of the queue
+    cache_list_push_front(p_cache, &p_s3fifo->queues[queue].head, &p_s3fifo->queues[queue].tail, slot);
+    p_s3fifo->queues[queue].count++;
+
+    // The slot starts with a frequency of zero
+    p_s3fifo->p_flags[slot] = ( queue == CACHE_S3FIFO_MAIN ) ? CACHE_S3FIFO_QUEUE : 0;
+
+    // Done
+    return;
+}
@@ -0,0 +1,681 @@
+/** !
+ * A tool for comparing cache eviction
+ * policies by replaying a trace of keys
+ *
+ * @file cache_sim.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// glibc 2.33 and later
+#if defined(__GLIBC__) && ( __GLIBC__ > 2 || __GLIBC_MINOR__ >= 33 )
+#define CACHE_SIM_MALLINFO
+#include <malloc.h>
+#endif
+
+// log
+#include <log/log.h>
+
+// sync
+#include <sync/sync.h>
+
+// hash cache
+#include <hash_cache/hash.h>
+#include <hash_cache/cache.h>
+
+// Preprocessor definitions
+#define CACHE_SIM_WORD_LENGTH_MAX 255+1
+#define CACHE_SIM_CAPACITIES_MAX  16
+
+// Enumeration definitions
+enum cache_sim_format_e
+{
+    CACHE_SIM_TEXT = 0,
+    CACHE_SIM_U64  = 1
+};
+
+// Structure definitions
+struct cache_sim_policy_s
+{
+    const char         *name;
+    const cache_policy *p_policy;
+};
+
+struct cache_sim_arguments_s
+{
+    const char              *p_trace,
+                            *p_csv;
+    enum cache_sim_format_e  format;
+    size_t                   capacities[CACHE_SIM_CAPACITIES_MAX],
+                             capacity_quantity,
+                             batch;
+};
+
+struct cache_sim_result_s
+{
+    size_t hits;
+    double ns_per_op,
+           bytes_per_entry;
+};
+
+// Type definitions
+typedef struct cache_sim_policy_s    cache_sim_policy;
+typedef struct cache_sim_arguments_s cache_sim_arguments;
+typedef struct cache_sim_result_s    cache_sim_result;
+
+// Data
+static const cache_sim_policy policies[] =
+{
+    { "lru",       &cache_policy_lru       },
+    { "clock",     &cache_policy_clock     },
+    { "clock_pro", &cache_policy_clock_pro },
+    { "arc",       &cache_policy_arc       },
+    { "tinylfu",   &cache_policy_tinylfu   },
+    { "s3fifo",    &cache_policy_s3fifo    }
+};
+
+// Forward declarations
+/** !
+ * Print a usage message to standard out
+ *
+ * @param argv0 the name of the program
+ *
+ * @return void
+ */
+void print_usage ( const char *argv0 );
+
+/** !
+ * Parse command line arguments
+ *
+ * @param argc        the argc parameter of the entry point
+ * @param argv        the argv parameter of the entry point
+ * @param p_arguments result
+ *
+ * @return void on success, program abort on failure
+ */
+void parse_command_line_arguments ( int argc, const char *argv[], cache_sim_arguments *p_arguments );
+
+/** !
+ * Read a trace of keys from a file. Each word of a text trace is hashed to
+ * a key. A binary trace is a sequence of native 64 bit keys.
+ *
+ * @param p_path       the path to the trace
+ * @param format       the format of the trace
+ * @param pp_keys      result
+ * @param p_quantity   result
+ *
+ * @return 1 on success, 0 on error
+ */
+int cache_sim_load ( const char *p_path, enum cache_sim_format_e format, unsigned long long **pp_keys, size_t *p_quantity );
+
+/** !
+ * Replay a trace through a cache. Each miss inserts the key. A batch of
+ * more than one key searches the batch with cache_get_many, then inserts
+ * the batch's misses.
+ *
+ * @param p_policy   the eviction policy
+ * @param capacity   the maximum quantity of properties of the cache
+ * @param batch      the quantity of keys searched at a time
+ * @param p_keys     the trace
+ * @param quantity   the quantity of keys in the trace
+ * @param p_result   result
+ *
+ * @return 1 on success, 0 on error
+ */
+int cache_sim_run ( const cache_policy *p_policy, size_t capacity, size_t batch, unsigned long long *p_keys, size_t quantity, cache_sim_result *p_result );
+
+/** !
+ * Compare the keys of two references
+ *
+ * @param p_a pointer to a key
+ * @param p_b pointer to a key
+ *
+ * @return 0 if the keys are equal, 1 otherwise
+ */
+int cache_sim_key_equals ( const void *const p_a, const void *const p_b );
+
+/** !
+ * Hash the key of a reference
+ *
+ * @param p_key pointer to the key
+ *
+ * @return the hash of the key
+ */
+hash64 cache_sim_key_hash ( const void *const p_key );
+
+/** !
+ * Compute the quantity of bytes in use on the heap
+ *
+ * @param void
+ *
+ * @return the quantity of bytes, or 0 if unknown
+ */
+size_t cache_sim_heap_bytes ( void );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Initialized data
+    cache_sim_arguments  _arguments = { 0 };
+    unsigned long long  *p_keys     = (void *) 0;
+    size_t               quantity   = 0;
+    FILE                *p_csv      = (void *) 0;
+
+    // Parse command line arguments
+    parse_command_line_arguments(argc, argv, &_arguments);
+
+    // Read the trace
+    if ( cache_sim_load(_arguments.p_trace, _arguments.format, &p_keys, &quantity) == 0 ) goto failed_to_load_trace;
+
+    // Open the CSV file
+    if ( _arguments.p_csv )
+    {
+
+        // Open the file
+        p_csv = fopen(_arguments.p_csv, "w");
+
+        // Error check
+        if ( p_csv == (void *) 0 ) goto failed_to_open_csv;
+
+        // Write the header
+        fprintf(p_csv, "policy,capacity,references,hit_ratio,ns_per_op,bytes_per_entry\n");
+    }
+
+    // Formatting
+    printf("%zu references\n\n", quantity);
+    printf("| Policy    | Capacity   | Hit ratio | ns/op    | Bytes/entry |\n");
+    printf("|-----------|------------|-----------|----------|-------------|\n");
+
+    // Replay the trace at each capacity ...
+    for (size_t i = 0; i < _arguments.capacity_quantity; i++)
+    {
+
+        // ... through each policy
+        for (size_t j = 0; j < sizeof(policies) / sizeof(*policies); j++)
+        {
+
+            // Initialized data
+            cache_sim_result _result   = { 0 };
+            double           hit_ratio = 0;
+
+            // Replay the trace
+            if ( cache_sim_run(policies[j].p_policy, _arguments.capacities[i], _arguments.batch, p_keys, quantity, &_result) == 0 ) goto failed_to_run;
+
+            // Compute the hit ratio
+            hit_ratio = (double) _result.hits / (double) quantity;
+
+            // Print the row
+            printf("| %-9s | %10zu | %9.4f | %8.1f | %11.1f |\n", policies[j].name, _arguments.capacities[i], hit_ratio, _result.ns_per_op, _result.bytes_per_entry);
+
+            // Write the row
+            if ( p_csv ) fprintf(p_csv, "%s,%zu,%zu,%f,%f,%f\n", policies[j].name, _arguments.capacities[i], quantity, hit_ratio, _result.ns_per_op, _result.bytes_per_entry);
+        }
+    }
+
+    // Close the CSV file
+    if ( p_csv ) fclose(p_csv);
+
+    // Release the trace
+    p_keys = HASH_CACHE_REALLOC(p_keys, 0);
+
+    // Success
+    return EXIT_SUCCESS;
+
+    // Error handling
+    {
+
+        // Hash cache errors
+        {
+            failed_to_load_trace:
+                #ifndef NDEBUG
+                    log_error("[hash-cache] [cache-sim] Failed to load trace \"%s\" in call to function \"%s\"\n", _arguments.p_trace, __FUNCTION__);
+                #endif
+
+                // Error
+                return EXIT_FAILURE;
+
+            failed_to_run:
+                #ifndef NDEBUG
+                    log_error("[hash-cache] [cache-sim] Failed to replay trace in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_csv ) fclose(p_csv);
+                p_keys = HASH_CACHE_REALLOC(p_keys, 0);
+
+                // Error
+                return EXIT_FAILURE;
+        }
+
+        // Standard library errors
+        {
+            failed_to_open_csv:
+                #ifndef NDEBUG
+                    log_error("[hash-cache] [cache-sim] Failed to open \"%s\" in call to function \"%s\"\n", _arguments.p_csv, __FUNCTION__);
+                #endif
+
+                // Clean up
+                p_keys = HASH_CACHE_REALLOC(p_keys, 0);
+
+                // Error
+                return EXIT_FAILURE;
+        }
+    }
+}
+
+void print_usage ( const char *argv0 )
+{
+
+    // Argument check
+    if ( argv0 == (void *) 0 ) exit(EXIT_FAILURE);
+
+    // Print a usage message to standard out
+    printf("Usage: %s [ -f text | u64 ] [ -b batch ] [ -o results.csv ] trace [ capacity ... ]\n\n", argv0);
+    printf("    -f text   Each word of the trace is a key (default)\n");
+    printf("    -f u64    The trace is a sequence of native 64 bit keys\n");
+    printf("    -b batch  Search the trace batch keys at a time with cache_get_many (default 1)\n");
+    printf("    -o path   Also write the results to a CSV file\n");
+    printf("    capacity  The maximum quantity of properties of each cache (default 100 1000 10000)\n");
+
+    // Done
+    return;
+}
+
+void parse_command_line_arguments ( int argc, const char *argv[], cache_sim_arguments *p_arguments )
+{
+
+    // Initialized data
+    int i = 1;
+
+    // Search one key at a time
+    p_arguments->batch = 1;
+
+    // Parse the options
+    for (; i < argc && argv[i][0] == '-'; i += 2)
+    {
+
+        // Error check
+        if ( i + 1 == argc ) goto invalid_arguments;
+
+        // Format
+        if ( strcmp(argv[i], "-f") == 0 )
+        {
+
+            // Text
+            if      ( strcmp(argv[i + 1], "text") == 0 ) p_arguments->format = CACHE_SIM_TEXT;
+
+            // Binary
+            else if ( strcmp(argv[i + 1], "u64")  == 0 ) p_arguments->format = CACHE_SIM_U64;
+
+            // Default
+            else goto invalid_arguments;
+        }
+
+        // Batch
+        else if ( strcmp(argv[i], "-b") == 0 )
+        {
+
+            // Initialized data
+            char               *p_end = (void *) 0;
+            unsigned long long  batch = strtoull(argv[i + 1], &p_end, 10);
+
+            // Error check
+            if ( *p_end != '\0' || batch == 0 ) goto invalid_arguments;
+
+            // Store the batch
+            p_arguments->batch = (size_t) batch;
+        }
+
+        // CSV file
+        else if ( strcmp(argv[i], "-o") == 0 ) p_arguments->p_csv = argv[i + 1];
+
+        // Default
+        else goto invalid_arguments;
+    }
+
+    // Error check
+    if ( i == argc ) goto invalid_arguments;
+
+    // Store the path to the trace
+    p_arguments->p_trace = argv[i++];
+
+    // Parse each capacity
+    for (; i < argc; i++)
+    {
+
+        // Initialized data
+        char               *p_end    = (void *) 0;
+        unsigned long long  capacity = strtoull(argv[i], &p_end, 10);
+
+        // Error check
+        if ( *p_end != '\0' || capacity == 0 || p_arguments->capacity_quantity == CACHE_SIM_CAPACITIES_MAX ) goto invalid_arguments;
+
+        // Store the capacity
+        p_arguments->capacities[p_arguments->capacity_quantity++] = (size_t) capacity;
+    }
+
+    // Default capacities
+    if ( p_arguments->capacity_quantity == 0 )
+        p_arguments->capacities[0] = 100,
+        p_arguments->capacities[1] = 1000,
+        p_arguments->capacities[2] = 10000,
+        p_arguments->capacity_quantity = 3;
+
+    // Success
+    return;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            invalid_arguments:
+
+                // Print a usage message to standard out
+                print_usage(argv[0]);
+
+                // Abort
+                exit(EXIT_FAILURE);
+        }
+    }
+}
+
+int cache_sim_load ( const char *p_path, enum cache_sim_format_e format, unsigned long long **pp_keys, size_t *p_quantity )
+{
+
+    // Initialized data
+    FILE               *p_file   = fopen(p_path, ( format == CACHE_SIM_U64 ) ? "rb" : "r");
+    unsigned long long *p_keys   = (void *) 0;
+    size_t              quantity = 0,
+                        max      = 1024;
+
+    // Error check
+    if ( p_file == (void *) 0 ) goto failed_to_open_trace;
+
+    // Initial allocation
+    p_keys = HASH_CACHE_REALLOC(0, sizeof(unsigned long long) * max);
+
+    // Error check
+    if ( p_keys == (void *) 0 ) goto failed_to_realloc;
+
+    // Read until EOF
+    while ( true )
+    {
+
+        // Resize?
+        if ( quantity == max )
+        {
+
+            // Initialized data
+            unsigned long long *p_grown = HASH_CACHE_REALLOC(p_keys, sizeof(unsigned long long) * max * 2);
+
+            // Error check
+            if ( p_grown == (void *) 0 ) goto failed_to_realloc;
+
+            // Double the maximum
+            p_keys  = p_grown;
+            max    *= 2;
+        }
+
+        // Read a binary key ...
+        if ( format == CACHE_SIM_U64 )
+        {
+
+            // Done?
+            if ( fread(&p_keys[quantity], sizeof(unsigned long long), 1, p_file) != 1 ) break;
+        }
+
+        // ... or hash a word
+        else
+        {
+
+            // Initialized data
+            char _word[CACHE_SIM_WORD_LENGTH_MAX] = { 0 };
+
+            // Done?
+            if ( fscanf(p_file, "%255s", _word) != 1 ) break;
+
+            // Hash the word
+            p_keys[quantity] = hash_xxh64(_word, strlen(_word));
+        }
+
+        // Increment the quantity of keys
+        quantity++;
+    }
+
+    // Close the file
+    fclose(p_file);
+
+    // Error check
+    if ( quantity == 0 ) goto empty_trace;
+
+    // Return the trace to the caller
+    *pp_keys    = p_keys;
+    *p_quantity = quantity;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Hash cache errors
+        {
+            empty_trace:
+                #ifndef NDEBUG
+                    log_error("[hash-cache] [cache-sim] The trace is empty in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                p_keys = HASH_CACHE_REALLOC(p_keys, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_open_trace:
+                #ifndef NDEBUG
+                    log_error("[hash-cache] [cache-sim] Failed to open \"%s\" in call to function \"%s\"\n", p_path, __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            failed_to_realloc:
+                #ifndef NDEBUG
+                    log_error("[hash-cache] [cache-sim] Call to \"realloc\" returned an erroneous value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                fclose(p_file);
+                p_keys = HASH_CACHE_REALLOC(p_keys, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_sim_run ( const cache_policy *p_policy, size_t capacity, size_t batch, unsigned long long *p_keys, size_t quantity, cache_sim_result *p_result )
+{
+
+    // Initialized data
+    cache               *p_cache   = (void *) 0;
+    const void         **pp_batch  = (void *) 0;
+    void               **pp_values = (void *) 0;
+    unsigned long long  *p_mask    = (void *) 0;
+    size_t         before   = cache_sim_heap_bytes(),
+                   after    = 0,
+                   hits     = 0;
+    timestamp      start    = 0,
+                   end      = 0;
+    cache_options  _options =
+    {
+        .pfn_equality = cache_sim_key_equals,
+        .pfn_key_hash = cache_sim_key_hash,
+        .p_policy     = p_policy
+    };
+
+    // Allocate the keys, values and hit mask of a batch
+    if ( batch > 1 )
+    {
+
+        // Allocate memory for a batch
+        pp_batch  = HASH_CACHE_REALLOC(0, sizeof(const void *) * batch);
+        pp_values = HASH_CACHE_REALLOC(0, sizeof(void *) * batch);
+        p_mask    = HASH_CACHE_REALLOC(0, sizeof(unsigned long long) * ( ( batch + 63 ) / 64 ));
+
+        // Error check
+        if ( pp_batch == (void *) 0 || pp_values == (void *) 0 || p_mask == (void *) 0 ) goto failed_to_realloc;
+    }
+
+    // Construct the cache. Each reference is its own key and value
+    if ( cache_construct_options(&p_cache, capacity, &_options) == 0 ) goto failed_to_construct_cache;
+
+    // Start the timer
+    start = timer_high_precision();
+
+    // Replay each reference ...
+    if ( batch == 1 ) for (size_t i = 0; i < quantity; i++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Hit
+        if ( cache_get(p_cache, &p_keys[i], &p_value) ) hits++;
+
+        // Miss
+        else cache_insert(p_cache, &p_keys[i], &p_keys[i]);
+    }
+
+    // ... or each batch of references
+    else for (size_t i = 0; i < quantity; i += batch)
+    {
+
+        // Initialized data
+        size_t n = ( quantity - i < batch ) ? quantity - i : batch;
+
+        // Point to each key of the batch
+        for (size_t j = 0; j < n; j++) pp_batch[j] = &p_keys[i + j];
+
+        // Search the batch
+        hits += cache_get_many(p_cache, pp_batch, n, pp_values, p_mask);
+
+        // Insert each miss
+        for (size_t j = 0; j < n; j++)
+            if ( ( p_mask[j / 64] & ( 1ULL << ( j % 64 ) ) ) == 0 )
+                cache_insert(p_cache, &p_keys[i + j], &p_keys[i + j]);
+    }
+
+    // Stop the timer
+    end = timer_high_precision();
+
+    // Measure the heap, with the cache full
+    after = cache_sim_heap_bytes();
+
+    // Release the cache
+    cache_destroy(&p_cache, (void *) 0);
+
+    // Release the batch
+    if ( pp_batch  ) pp_batch  = HASH_CACHE_REALLOC(pp_batch, 0);
+    if ( pp_values ) pp_values = HASH_CACHE_REALLOC(pp_values, 0);
+    if ( p_mask    ) p_mask    = HASH_CACHE_REALLOC(p_mask, 0);
+
+    // Return the result to the caller
+    *p_result = (cache_sim_result)
+    {
+        .hits            = hits,
+        .ns_per_op       = (double) ( end - start ) * 1e9 / (double) timer_seconds_divisor() / (double) quantity,
+        .bytes_per_entry = ( after > before ) ? (double) ( after - before ) / (double) capacity : 0.0
+    };
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Hash cache errors
+        {
+            failed_to_construct_cache:
+                #ifndef NDEBUG
+                    log_error("[hash-cache] [cache-sim] Failed to construct cache in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( pp_batch  ) pp_batch  = HASH_CACHE_REALLOC(pp_batch, 0);
+                if ( pp_values ) pp_values = HASH_CACHE_REALLOC(pp_values, 0);
+                if ( p_mask    ) p_mask    = HASH_CACHE_REALLOC(p_mask, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_realloc:
+                #ifndef NDEBUG
+                    log_error("[hash-cache] [cache-sim] Call to \"realloc\" returned an erroneous value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( pp_batch  ) pp_batch  = HASH_CACHE_REALLOC(pp_batch, 0);
+                if ( pp_values ) pp_values = HASH_CACHE_REALLOC(pp_values, 0);
+                if ( p_mask    ) p_mask    = HASH_CACHE_REALLOC(p_mask, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int cache_sim_key_equals ( const void *const p_a, const void *const p_b )
+{
+
+    // Success
+    return *(const unsigned long long *) p_a != *(const unsigned long long *) p_b;
+}
+
+hash64 cache_sim_key_hash ( const void *const p_key )
+{
+
+    // Initialized data
+    unsigned long long x = *(const unsigned long long *) p_key;
+
+    // Mix every bit of the key into the low bits
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+
+    // Success
+    return x;
+}
+
+size_t cache_sim_heap_bytes ( void )
+{
+
+    // Ask the allocator
+    #ifdef CACHE_SIM_MALLINFO
+
+        // Initialized data
+        struct mallinfo2 _info = mallinfo2();
+
+        // Success
+        return _info.uordblks + _info.hblkhd;
+    #else
+
+        // Unknown
+        return 0;
+    #endif
+}
@@ -0,0 +1,375 @@
+/** !
+ * Implementation of the W-TinyLFU eviction policy
+ *
+ * @file cache_tinylfu.c
+ *
+ * @author Jacob Smith
+ */
+
+// Headers
+#include <hash_cache/cache.h>
+#include <hash_cache/sketch.h>
+
+// Preprocessor definitions
+#define CACHE_TINYLFU_WINDOW    0
+#define CACHE_TINYLFU_PROBATION 1
+#define CACHE_TINYLFU_PROTECTED 2
+#define CACHE_TINYLFU_REGIONS   3
+
+// Structure declarations
+struct cache_tinylfu_s;
+
+// Type definitions
+typedef struct cache_tinylfu_s cache_tinylfu;
+
+// Structure definitions
+struct cache_tinylfu_s
+{
+    unsigned char     *p_regions;        // The region of each slot
+    struct
+    {
+        size_t head, tail, count, max;
+    } regions[CACHE_TINYLFU_REGIONS];    // The window LRU, and the probation and protected segments of the main LRU
+    hash_cache_sketch *p_sketch;         // The frequency of recently seen keys
+};
+
+// Function declarations
+/** !
+ * Allocate the regions and the sketch
+ *
+ * @param p_cache the cache
+ *
+ * @return 1 on success, 0 on error
+ */
+static int cache_tinylfu_construct ( cache *const p_cache );
+
+/** !
+ * Release the regions and the sketch
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_tinylfu_destroy ( cache *const p_cache );
+
+/** !
+ * Empty every region, and forget every frequency
+ *
+ * @param p_cache the cache
+ *
+ * @return void
+ */
+static void cache_tinylfu_reset ( cache *const p_cache );
+
+/** !
+ * Count the key, and move its slot to the front of its region. A hit in
+ * probation promotes the slot to protected.
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_tinylfu_hit ( cache *const p_cache, size_t slot );
+
+/** !
+ * Count the key, and add its slot to the front of the window. While the
+ * cache has room, slots that overflow the window move to probation.
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_tinylfu_insert ( cache *const p_cache, size_t slot );
+
+/** !
+ * If the window is full, its least recently used slot is a candidate for the
+ * main region. The candidate is admitted to probation only if the sketch says
+ * it's more frequent than the main region's victim. Whichever loses is
+ * evicted.
+ *
+ * @param p_cache the cache
+ * @param h       unused
+ *
+ * @return the victim
+ */
+static size_t cache_tinylfu_victim ( cache *const p_cache, hash64 h );
+
+/** !
+ * Remove a slot from its region
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ *
+ * @return void
+ */
+static void cache_tinylfu_remove ( cache *const p_cache, size_t slot );
+
+/** !
+ * Walk the window, probation, then protected, each from most to least
+ * recently used
+ *
+ * @param p_cache the cache
+ * @param slot    the slot, or CACHE_NIL for the first slot
+ *
+ * @return the next slot, or CACHE_NIL after the last slot
+ */
+static size_t cache_tinylfu_next ( const cache *const p_cache, size_t slot );
+
+/** !
+ * Move a slot to the front of a region
+ *
+ * @param p_cache the cache
+ * @param slot    the slot
+ * @param region  the region
+ *
+ * @return void
+ */
+static void cache_tinylfu_move ( cache *const p_cache, size_t slot, size_t region );
+
+// Data
+const cache_policy cache_policy_tinylfu =
+{
+    .pfn_construct = cache_tinylfu_construct,
+    .pfn_destroy   = cache_tinylfu_destroy,
+    .pfn_reset     = cache_tinylfu_reset,
+    .pfn_hit       = cache_tinylfu_hit,
+    .pfn_insert    = cache_tinylfu_insert,
+    .pfn_victim    = cache_tinylfu_victim,
+    .pfn_remove    = cache_tinylfu_remove,
+    .pfn_next      = cache_tinylfu_next
+};
+
+// Function definitions
+static int cache_tinylfu_construct ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_tinylfu *p_tinylfu = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, 0, sizeof(cache_tinylfu) + p_cache->properties.max);
+    size_t         c         = p_cache->properties.max,
+                   window    = ( c / 100 ) ? c / 100 : 1;
+
+    // Error check
+    if ( p_tinylfu == (void *) 0 ) goto no_mem;
+
+    // The region of each slot follows the state
+    p_tinylfu->p_regions = (unsigned char *) ( p_tinylfu + 1 );
+
+    // The window gets 1% of the slots, and protected gets 80% of the rest
+    p_tinylfu->regions[CACHE_TINYLFU_WINDOW].max    = window;
+    p_tinylfu->regions[CACHE_TINYLFU_PROTECTED].max = ( c - window ) * 8 / 10;
+    p_tinylfu->regions[CACHE_TINYLFU_PROBATION].max = c - window - p_tinylfu->regions[CACHE_TINYLFU_PROTECTED].max;
+
+    // Construct the sketch
+    if ( hash_cache_sketch_construct(&p_tinylfu->p_sketch, c) == 0 ) goto failed_to_construct_sketch;
+
+    // Store the state
+    p_cache->policy.p_state = p_tinylfu;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Hash cache errors
+        {
+            failed_to_construct_sketch:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to construct frequency sketch in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the state
+                p_tinylfu = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_tinylfu, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void cache_tinylfu_destroy ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_tinylfu *p_tinylfu = p_cache->policy.p_state;
+
+    // Destroy the sketch
+    hash_cache_sketch_destroy(&p_tinylfu->p_sketch);
+
+    // Free the state
+    p_cache->policy.p_state = HASH_CACHE_ALLOCATOR_REALLOC(p_cache->allocator.p_allocator, p_tinylfu, 0);
+
+    // Done
+    return;
+}
+
+static void cache_tinylfu_reset ( cache *const p_cache )
+{
+
+    // Initialized data
+    cache_tinylfu *p_tinylfu = p_cache->policy.p_state;
+
+    // Empty every region
+    for (size_t i = 0; i < CACHE_TINYLFU_REGIONS; i++)
+        p_tinylfu->regions[i].head  = CACHE_NIL,
+        p_tinylfu->regions[i].tail  = CACHE_NIL,
+        p_tinylfu->regions[i].count = 0;
+
+    // Forget every frequency
+    hash_cache_sketch_clear(p_tinylfu->p_sketch);
+
+    // Done
+    return;
+}
+
+static void cache_tinylfu_hit ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_tinylfu *p_tinylfu = p_cache->policy.p_state;
+
+    // Count the key
+    hash_cache_sketch_increment(p_tinylfu->p_sketch, p_cache->index.p_nodes[slot].hash);
+
+    // A hit in the window or protected is a move to the front ...
+    if ( p_tinylfu->p_regions[slot] != CACHE_TINYLFU_PROBATION )
+    {
+
+        // Move the slot to the front of its region
+        if ( p_tinylfu->regions[p_tinylfu->p_regions[slot]].head != slot ) cache_tinylfu_move(p_cache, slot, p_tinylfu->p_regions[slot]);
+
+        // Done
+        return;
+    }
+
+    // ... and a hit in probation is a promotion to protected ...
+    cache_tinylfu_move(p_cache, slot, CACHE_TINYLFU_PROTECTED);
+
+    // ... which may demote the least recently used protected slot
+    if ( p_tinylfu->regions[CACHE_TINYLFU_PROTECTED].count > p_tinylfu->regions[CACHE_TINYLFU_PROTECTED].max )
+        cache_tinylfu_move(p_cache, p_tinylfu->regions[CACHE_TINYLFU_PROTECTED].tail, CACHE_TINYLFU_PROBATION);
+
+    // Done
+    return;
+}
+
+static void cache_tinylfu_insert ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_tinylfu *p_tinylfu = p_cache->policy.p_state;
+
+    // Count the key
+    hash_cache_sketch_increment(p_tinylfu->p_sketch, p_cache->index.p_nodes[slot].hash);
+
+    // Add the slot to the front of the window
+    cache_list_push_front(p_cache, &p_tinylfu->regions[CACHE_TINYLFU_WINDOW].head, &p_tinylfu->regions[CACHE_TINYLFU_WINDOW].tail, slot);
+    p_tinylfu->p_regions[slot] = CACHE_TINYLFU_WINDOW;
+    p_tinylfu->regions[CACHE_TINYLFU_WINDOW].count++;
+
+    // While the cache has room, the window overflows into probation without a contest
+    if ( p_tinylfu->regions[CACHE_TINYLFU_WINDOW].count > p_tinylfu->regions[CACHE_TINYLFU_WINDOW].max )
+        cache_tinylfu_move(p_cache, p_tinylfu->regions[CACHE_TINYLFU_WINDOW].tail, CACHE_TINYLFU_PROBATION);
+
+    // Done
+    return;
+}
+
+static size_t cache_tinylfu_victim ( cache *const p_cache, hash64 h )
+{
+
+    // Initialized data
+    cache_tinylfu *p_tinylfu = p_cache->policy.p_state;
+    size_t         candidate = p_tinylfu->regions[CACHE_TINYLFU_WINDOW].tail,
+                   victim    = ( p_tinylfu->regions[CACHE_TINYLFU_PROBATION].tail != CACHE_NIL ) ? p_tinylfu->regions[CACHE_TINYLFU_PROBATION].tail : p_tinylfu->regions[CACHE_TINYLFU_PROTECTED].tail;
+
+    // Unused
+    (void) h;
+
+    // If the window has room, the main region gives up its victim
+    if ( candidate == CACHE_NIL || p_tinylfu->regions[CACHE_TINYLFU_WINDOW].count < p_tinylfu->regions[CACHE_TINYLFU_WINDOW].max ) return victim;
+
+    // If the main region is empty, the candidate is the victim
+    if ( victim == CACHE_NIL ) return candidate;
+
+    // The candidate loses ties, so one hit wonders don't churn the main region
+    if ( hash_cache_sketch_estimate(p_tinylfu->p_sketch, p_cache->index.p_nodes[candidate].hash) <= hash_cache_sketch_estimate(p_tinylfu->p_sketch, p_cache->index.p_nodes[victim].hash) ) return candidate;
+
+    // Admit the candidate to probation
+    cache_tinylfu_move(p_cache, candidate, CACHE_TINYLFU_PROBATION);
+
+    // Success
+    return victim;
+}
+
+static void cache_tinylfu_remove ( cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    cache_tinylfu *p_tinylfu = p_cache->policy.p_state;
+    size_t         region    = p_tinylfu->p_regions[slot];
+
+    // Remove the slot from its region
+    cache_list_remove(p_cache, &p_tinylfu->regions[region].head, &p_tinylfu->regions[region].tail, slot);
+    p_tinylfu->regions[region].count--;
+
+    // Done
+    return;
+}
+
+static size_t cache_tinylfu_next ( const cache *const p_cache, size_t slot )
+{
+
+    // Initialized data
+    const cache_tinylfu *p_tinylfu = p_cache->policy.p_state;
+    size_t               region    = 0;
+
+    // Continue through the slot's region
+    if ( slot != CACHE_NIL )
+    {
+
+        // Next in the region
+        if ( p_cache->index.p_nodes[slot].next != CACHE_NIL ) return p_cache->index.p_nodes[slot].next;
+
+        // Next region
+        region = (size_t) p_tinylfu->p_regions[slot] + 1;
+    }
+
+    // Find the next region that isn't empty
+    for (; region < CACHE_TINYLFU_REGIONS; region++)
+        if ( p_tinylfu->regions[region].head != CACHE_NIL ) return p_tinylfu->regions[region].head;
+
+    // Done
+    return CACHE_NIL;
+}
+
+static void cache_tinylfu_move ( cache *const p_cache, size_t slot, size_t region )
+{
+
+    // Initialized data
+    cache_tinylfu *p_tinylfu = p_cache->policy.p_state;
+
+    // Remove the slot from its region
+    cache_tinylfu_remove(p_cache, slot);
+
+    // Add the slot to the front of the region
+    cache_list_push_front(p_cache, &p_tinylfu->regions[region].head, &p_tinylfu->regions[region].tail, slot);
+    p_tinylfu->p_regions[slot] = (unsigned char) region;
+    p_tinylfu->regions[region].count++;
+
+    // Done
+    return;
+}
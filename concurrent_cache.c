@@ -0,0 +1,1688 @@
+/** !
+ * Implementation of concurrent cache
+ *
+ * @file concurrent_cache.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/concurrent_cache.h>
+
+// POSIX
+#include <pthread.h>
+
+// Structure declarations
+struct concurrent_cache_reload_s;
+
+// Type definitions
+typedef struct concurrent_cache_reload_s concurrent_cache_reload;
+
+// Structure definitions
+struct concurrent_cache_reload_s
+{
+    concurrent_cache_shard *p_shard; // The shard of the property
+    size_t                  slot;    // The slot of the property
+    void                   *p_value; // The stale value
+    hash64                  hash;    // The hash of the stale value's key
+};
+
+struct concurrent_cache_refresh_s
+{
+    fn_hash_cache_loader    *pfn_loader; // Loads a fresh value
+    void                    *p_context;  // Passed to the loader
+    timestamp                window;     // How long before its expiry a read reloads a property
+    struct
+    {
+        concurrent_cache_reload *p_reloads;
+        size_t                   head, count, max;
+    } queue;                             // The waiting reloads
+    mutex                    _mutex;     // Guards the queue
+    condition_variable       _ready;     // Signaled when a reload is queued, or the workers stop
+    condition_variable       _unpinned;  // Signaled when a reload releases its pin
+    unsigned char           *p_flags;    // The in flight flags of every shard
+    pthread_t               *p_workers;
+    size_t                   workers;    // The quantity of workers that started
+    bool                     running;    // Cleared to stop the workers
+};
+
+// Data
+static __thread unsigned char concurrent_cache_thread;
+
+// Function declarations
+/** !
+ * Pick the shard of a key. The shard comes from the high bits of the hash,
+ * because each shard's index uses the low bits.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_key              the key
+ *
+ * @return the shard
+ */
+static inline concurrent_cache_shard *concurrent_cache_shard_of ( const concurrent_cache *const p_concurrent_cache, const void *const p_key )
+{
+
+    // Success
+    return &p_concurrent_cache->p_shards[(size_t) ( p_concurrent_cache->pfn_key_hash(p_key) >> 40 ) & p_concurrent_cache->mask];
+}
+
+/** !
+ * Pick the hit buffer of the calling thread. The address of a thread local
+ * variable is different in each thread.
+ *
+ * @param p_shard the shard
+ *
+ * @return the hit buffer
+ */
+static inline concurrent_cache_buffer *concurrent_cache_buffer_of ( concurrent_cache_shard *const p_shard )
+{
+
+    // Success
+    return &p_shard->buffers[(size_t) ( ( (unsigned long long) (size_t) &concurrent_cache_thread * 0x9E3779B97F4A7C15ULL ) >> 59 ) % CONCURRENT_CACHE_STRIPES];
+}
+
+/** !
+ * Report every buffered hit of a shard to its policy. The caller owns the
+ * shard.
+ *
+ * @param p_shard the shard
+ *
+ * @return void
+ */
+static void concurrent_cache_drain ( concurrent_cache_shard *const p_shard );
+
+/** !
+ * Drain a shard's hit buffers, if no other thread owns the shard. Never
+ * waits.
+ *
+ * @param p_shard the shard
+ *
+ * @return void
+ */
+static void concurrent_cache_try_drain ( concurrent_cache_shard *const p_shard );
+
+/** !
+ * Lock a shard for writing, and wait for the readers that are searching
+ * the shard. Readers that arrive later retry when the writer is done.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_shard            the shard
+ *
+ * @return void
+ */
+static void concurrent_cache_lock ( const concurrent_cache *const p_concurrent_cache, concurrent_cache_shard *const p_shard );
+
+/** !
+ * Unlock a shard
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_shard            the shard
+ *
+ * @return void
+ */
+static void concurrent_cache_unlock ( const concurrent_cache *const p_concurrent_cache, concurrent_cache_shard *const p_shard );
+
+/** !
+ * Start the reloading threads of a concurrent cache
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_options          the options
+ *
+ * @return 1 on success, 0 on error
+ */
+static int concurrent_cache_refresh_construct ( concurrent_cache *const p_concurrent_cache, const concurrent_cache_options *const p_options );
+
+/** !
+ * Stop the reloading threads of a concurrent cache, and drop the waiting
+ * reloads
+ *
+ * @param p_concurrent_cache the concurrent cache
+ *
+ * @return void
+ */
+static void concurrent_cache_refresh_destroy ( concurrent_cache *const p_concurrent_cache );
+
+/** !
+ * Queue a reload of a property, unless the property is already reloading,
+ * or the queue is full
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_shard            the shard of the property
+ * @param slot               the slot of the property
+ * @param p_value            the stale value
+ * @param h                  the hash of the stale value's key
+ *
+ * @return void
+ */
+static void concurrent_cache_refresh_push ( concurrent_cache *const p_concurrent_cache, concurrent_cache_shard *const p_shard, size_t slot, void *p_value, hash64 h );
+
+/** !
+ * Reload queued properties until the workers stop. The stale value is 
+ * pinned while the shard is locked, and the loader runs without a lock. 
+ * The fresh value replaces the stale value only if the stale value stayed
+ * in the cache.
+ *
+ * @param p_parameter the concurrent cache
+ *
+ * @return null pointer
+ */
+static void *concurrent_cache_refresh_worker ( void *p_parameter );
+
+/** !
+ * Pass an evicted value to the evict function of a shard that refreshes
+ * ahead, unless the value is pinned by a reload. The reload releases a 
+ * pinned value when it's done.
+ *
+ * @param p_value   the evicted value
+ * @param p_context the shard
+ *
+ * @return void
+ */
+static void concurrent_cache_evict ( void *p_value, void *p_context );
+
+/** !
+ * Test if a reload pinned the value of a key. The caller owns the shard.
+ *
+ * @param p_shard the shard
+ * @param p_key   the key
+ *
+ * @return true if the value of the key is pinned, else false
+ */
+static bool concurrent_cache_pinned ( const concurrent_cache_shard *const p_shard, const void *const p_key );
+
+/** !
+ * Unlock a shard, wait for a reload of the shard to release its pin, and
+ * lock the shard again
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_shard            the shard
+ *
+ * @return void
+ */
+static void concurrent_cache_unpinned_wait ( const concurrent_cache *const p_concurrent_cache, concurrent_cache_shard *const p_shard );
+
+/** !
+ * Destroy the first shards of a concurrent cache, and free the concurrent cache
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param shards             the quantity of shards to destroy
+ * @param pfn_free           called with each value, or 0
+ *
+ * @return 1 on success, 0 on error
+ */
+static int concurrent_cache_release ( concurrent_cache *const p_concurrent_cache, size_t shards, fn_hash_cache_free *pfn_free );
+
+// Function definitions
+int concurrent_cache_construct ( concurrent_cache **const pp_concurrent_cache, size_t size, const concurrent_cache_options *const p_options )
+{
+
+    // Argument check
+    if ( pp_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+    if ( size                ==          0 ) goto invalid_size;
+
+    // Initialized data
+    concurrent_cache_options  _options           = ( p_options ) ? *p_options : (concurrent_cache_options) { 0 };
+    concurrent_cache         *p_concurrent_cache = (void *) 0;
+    cache_options             _cache_options     = _options.cache;
+    size_t                    shards             = 1,
+                              i                  = 0;
+
+    // Compute the quantity of shards
+    while ( shards < ( ( _options.shards ) ? _options.shards : CONCURRENT_CACHE_SHARDS ) ) shards <<= 1;
+
+    // The default key hash only agrees with the default equality function
+    if ( _cache_options.pfn_key_hash == (void *) 0 && _cache_options.pfn_equality == (void *) 0 ) _cache_options.pfn_key_hash = (fn_hash_cache_key_hash *) hash_cache_key_hash;
+
+    // Error check
+    if ( _cache_options.pfn_key_hash == (void *) 0 ) goto no_key_hash;
+    if ( _options.pfn_loader && _options.refresh <= 0 ) goto invalid_refresh;
+    if ( _options.pfn_loader && _cache_options.ttl == 0 && _cache_options.expire == false ) goto no_expiration;
+    if ( _options.pfn_loader && _cache_options.pfn_evict == (void *) 0 ) goto no_evict;
+
+    // Divide the budget and the bloom filter between the shards
+    if ( _cache_options.budget ) _cache_options.budget = ( _cache_options.budget + shards - 1 ) / shards;
+    if ( _cache_options.bloom  ) _cache_options.bloom  = ( _cache_options.bloom  + shards - 1 ) / shards;
+
+    // Allocate memory for the concurrent cache
+    p_concurrent_cache = HASH_CACHE_REALLOC(0, sizeof(concurrent_cache));
+
+    // Error check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_mem;
+
+    // Initialize the concurrent cache
+    *p_concurrent_cache = (concurrent_cache)
+    {
+        .p_shards     = HASH_CACHE_REALLOC(0, sizeof(concurrent_cache_shard) * shards),
+        .mask         = shards - 1,
+        .pfn_key_hash = _cache_options.pfn_key_hash,
+        .spinlock     = _options.spinlock
+    };
+
+    // Error check
+    if ( p_concurrent_cache->p_shards == (void *) 0 ) goto no_mem;
+
+    // Construct each shard
+    for (i = 0; i < shards; i++)
+    {
+
+        // Initialized data
+        concurrent_cache_shard *p_shard = &p_concurrent_cache->p_shards[i];
+
+        // Initialized data
+        cache_options _shard_options = _cache_options;
+
+        // Initialize the shard
+        *p_shard = (concurrent_cache_shard) { 0 };
+
+        // A shard that refreshes ahead defers the evictions of pinned values
+        if ( _options.pfn_loader )
+            p_shard->pfn_evict       = _cache_options.pfn_evict,
+            p_shard->p_context       = _cache_options.p_context,
+            _shard_options.pfn_evict = concurrent_cache_evict,
+            _shard_options.p_context = p_shard;
+
+        // Construct the shard's cache
+        if ( cache_construct_options(&p_shard->p_cache, ( size + shards - 1 ) / shards, &_shard_options) == 0 ) goto failed_to_construct_shard;
+
+        // Create the shard's lock
+        if ( ( _options.spinlock ) ? spinlock_create(&p_shard->_spinlock) == 0 : mutex_create(&p_shard->_mutex) == 0 )
+        {
+
+            // Destroy the shard's cache
+            cache_destroy(&p_shard->p_cache, (void *) 0);
+
+            // Error
+            goto failed_to_create_lock;
+        }
+
+        // Create the lock of the shard's loads
+        if ( mutex_create(&p_shard->_loading) == 0 )
+        {
+
+            // Destroy the shard's lock and cache
+            if ( _options.spinlock ) spinlock_destroy(&p_shard->_spinlock);
+            else                     mutex_destroy(&p_shard->_mutex);
+            cache_destroy(&p_shard->p_cache, (void *) 0);
+
+            // Error
+            goto failed_to_create_lock;
+        }
+
+        // Create the condition of the shard's loads
+        if ( condition_variable_create(&p_shard->_loaded) == 0 )
+        {
+
+            // Destroy the shard's locks and cache
+            mutex_destroy(&p_shard->_loading);
+            if ( _options.spinlock ) spinlock_destroy(&p_shard->_spinlock);
+            else                     mutex_destroy(&p_shard->_mutex);
+            cache_destroy(&p_shard->p_cache, (void *) 0);
+
+            // Error
+            goto failed_to_create_lock;
+        }
+    }
+
+    // Start refreshing ahead
+    if ( _options.pfn_loader && concurrent_cache_refresh_construct(p_concurrent_cache, &_options) == 0 ) goto failed_to_construct_refresh;
+
+    // Return a pointer to the caller
+    *pp_concurrent_cache = p_concurrent_cache;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"pp_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Parameter \"size\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash cache errors
+        {
+            no_key_hash:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Sharding requires a key hashing function when the equality function is not the default in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_refresh:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Option \"refresh\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_expiration:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Refreshing ahead requires the shards to track expiration in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_evict:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Refreshing ahead requires an evict function in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            failed_to_construct_shard:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Failed to construct shard in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Destroy the shards that were constructed
+                concurrent_cache_release(p_concurrent_cache, i, (void *) 0);
+
+                // Error
+                return 0;
+
+            failed_to_construct_refresh:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Failed to start refreshing ahead in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Destroy the shards
+                concurrent_cache_release(p_concurrent_cache, shards, (void *) 0);
+
+                // Error
+                return 0;
+        }
+
+        // Sync errors
+        {
+            failed_to_create_lock:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Failed to create lock in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Destroy the shards that were constructed
+                concurrent_cache_release(p_concurrent_cache, i, (void *) 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_concurrent_cache ) p_concurrent_cache = HASH_CACHE_REALLOC(p_concurrent_cache, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_get ( concurrent_cache *const p_concurrent_cache, const void *const p_key, void **const pp_result )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+    if ( p_key              == (void *) 0 ) goto no_key;
+
+    // Initialized data
+    concurrent_cache_shard  *p_shard  = concurrent_cache_shard_of(p_concurrent_cache, p_key);
+    concurrent_cache_buffer *p_buffer = concurrent_cache_buffer_of(p_shard);
+    int                      result   = 0;
+
+    // Search the shard without locking, while no writer holds it
+    for (size_t i = 0; i < CONCURRENT_CACHE_RETRIES; i++)
+    {
+
+        // Initialized data
+        size_t              epoch    = __atomic_load_n(&p_shard->epoch, __ATOMIC_SEQ_CST),
+                            slot     = CACHE_NIL,
+                            tail     = 0;
+        unsigned long long  entry    = 0,
+                            empty    = 0;
+        hash64              h        = 0;
+        void               *p_value  = (void *) 0;
+        timestamp           deadline = 0;
+
+        // Enter the shard. A writer waits for the readers of its epoch, before it changes the shard
+        __atomic_fetch_add(&p_buffer->readers[epoch & 1], 1, __ATOMIC_SEQ_CST);
+
+        // A writer holds the shard, or started after the epoch was loaded
+        if ( ( __atomic_load_n(&p_shard->sequence, __ATOMIC_SEQ_CST) & 1 ) || __atomic_load_n(&p_shard->epoch, __ATOMIC_SEQ_CST) != epoch )
+        {
+
+            // Leave the shard
+            __atomic_fetch_sub(&p_buffer->readers[epoch & 1], 1, __ATOMIC_RELEASE);
+
+            // Try again
+            continue;
+        }
+
+        // Search the index
+        slot = cache_lookup(p_shard->p_cache, p_key);
+
+        // Load the value, its hash, and its deadline if the cache refreshes ahead
+        if ( slot != CACHE_NIL ) p_value = __atomic_load_n(&p_shard->p_cache->properties.pp_data[slot], __ATOMIC_RELAXED),
+                                 h       = __atomic_load_n(&p_shard->p_cache->index.p_nodes[slot].hash, __ATOMIC_RELAXED);
+        if ( slot != CACHE_NIL && p_concurrent_cache->p_refresh ) deadline = cache_expiry(p_shard->p_cache, slot);
+
+        // Tag the hit with the high bits of the hash
+        if ( slot < 0xFFFFFFFF ) entry = ( slot + 1 ) | ( h & 0xFFFFFFFF00000000ULL );
+
+        // Leave the shard. The value isn't dereferenced again
+        __atomic_fetch_sub(&p_buffer->readers[epoch & 1], 1, __ATOMIC_RELEASE);
+
+        // Miss
+        if ( p_value == (void *) 0 )
+        {
+
+            // Count the miss
+            __atomic_fetch_add(&p_buffer->misses, 1, __ATOMIC_RELAXED);
+
+            // Miss
+            return 0;
+        }
+
+        // Count the hit
+        __atomic_fetch_add(&p_buffer->hits, 1, __ATOMIC_RELAXED);
+
+        // Take an entry of the buffer
+        tail = __atomic_fetch_add(&p_buffer->tail, 1, __ATOMIC_RELAXED);
+
+        // Record the hit, unless the entry is still waiting to be drained. Drain 
+        // the buffers when a hit is dropped, or the buffer wraps around
+        if ( entry && ( __atomic_compare_exchange_n(&p_buffer->entries[tail % CONCURRENT_CACHE_BUFFER], &empty, entry, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED) == false || ( tail + 1 ) % CONCURRENT_CACHE_BUFFER == 0 ) )
+            concurrent_cache_try_drain(p_shard);
+
+        // Reload a property that is about to expire, and serve the stale value meanwhile
+        if ( deadline && deadline - timer_high_precision() <= p_concurrent_cache->p_refresh->window )
+            concurrent_cache_refresh_push(p_concurrent_cache, p_shard, slot, p_value, h);
+
+        // Return the value to the caller
+        *pp_result = p_value;
+
+        // Success
+        return 1;
+    }
+
+    // A busy shard falls back to the lock
+    concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+    // Get the value
+    result = cache_get(p_shard->p_cache, p_key, pp_result);
+
+    // Count the hit or the miss
+    if ( result ) __atomic_fetch_add(&p_buffer->hits, 1, __ATOMIC_RELAXED);
+    else          __atomic_fetch_add(&p_buffer->misses, 1, __ATOMIC_RELAXED);
+
+    // Reload a property that is about to expire, as a lock free hit does
+    if ( result && p_concurrent_cache->p_refresh )
+    {
+
+        // Initialized data
+        size_t    slot     = cache_lookup(p_shard->p_cache, p_key);
+        timestamp deadline = ( slot != CACHE_NIL ) ? cache_expiry(p_shard->p_cache, slot) : 0;
+
+        // Queue the reload, and serve the stale value meanwhile
+        if ( deadline && deadline - timer_high_precision() <= p_concurrent_cache->p_refresh->window )
+            concurrent_cache_refresh_push(p_concurrent_cache, p_shard, slot, *pp_result, p_shard->p_cache->index.p_nodes[slot].hash);
+    }
+
+    // Unlock the shard
+    concurrent_cache_unlock(p_concurrent_cache, p_shard);
+
+    // Success
+    return result;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_get_or_load ( concurrent_cache *const p_concurrent_cache, const void *const p_key, fn_hash_cache_loader *pfn_loader, void *p_context, void **const pp_result )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+    if ( p_key              == (void *) 0 ) goto no_key;
+    if ( pfn_loader         == (void *) 0 ) goto no_loader;
+    if ( pp_result          == (void *) 0 ) goto no_result;
+
+    // Initialized data
+    concurrent_cache_shard   *p_shard  = concurrent_cache_shard_of(p_concurrent_cache, p_key);
+    concurrent_cache_flight   _flight  = { .hash = p_concurrent_cache->pfn_key_hash(p_key), .p_key = p_key },
+                             *p_flight = (void *) 0,
+                            **pp_next  = (void *) 0;
+    int                       result   = 0,
+                              loaded   = 0;
+
+    // Hit
+    if ( concurrent_cache_get(p_concurrent_cache, p_key, pp_result) ) return 1;
+
+    // Lock the loads
+    mutex_lock(&p_shard->_loading);
+
+    // Search the loads in flight for the key
+    for (p_flight = p_shard->p_flights; p_flight; p_flight = p_flight->p_next)
+        if ( p_flight->hash == _flight.hash && p_shard->p_cache->pfn_equality(p_flight->p_key, p_key) == 0 ) break;
+
+    // Another thread is loading the key
+    if ( p_flight )
+    {
+
+        // Wait for the load
+        p_flight->waiters++;
+        while ( p_flight->done == false ) condition_variable_wait(&p_shard->_loaded, &p_shard->_loading);
+
+        // Take the result
+        result = p_flight->result;
+        if ( result ) *pp_result = p_flight->p_value;
+
+        // The loader waits for the last waiter, because the load is on its stack
+        if ( --p_flight->waiters == 0 ) condition_variable_broadcast(&p_shard->_loaded);
+
+        // Unlock the loads
+        mutex_unlock(&p_shard->_loading);
+
+        // Done
+        return result;
+    }
+
+    // A load may have finished since the miss. Its value was inserted before
+    // the load left the list, so search again while the list is locked
+    concurrent_cache_lock(p_concurrent_cache, p_shard);
+    result = cache_get(p_shard->p_cache, p_key, pp_result);
+    concurrent_cache_unlock(p_concurrent_cache, p_shard);
+
+    // Hit
+    if ( result )
+    {
+
+        // Unlock the loads
+        mutex_unlock(&p_shard->_loading);
+
+        // Success
+        return 1;
+    }
+
+    // Add the load to the list
+    _flight.p_next     = p_shard->p_flights;
+    p_shard->p_flights = &_flight;
+
+    // Unlock the loads
+    mutex_unlock(&p_shard->_loading);
+
+    // Load the value, without holding a lock
+    loaded = pfn_loader(p_key, p_context, &_flight.p_value);
+
+    // Insert the value, before the load leaves the list
+    _flight.result = loaded && concurrent_cache_insert(p_concurrent_cache, p_key, _flight.p_value);
+
+    // The cache owns the value, so a value that the cache rejects is evicted
+    if ( loaded && _flight.result == 0 && p_shard->p_cache->evict.pfn_evict ) p_shard->p_cache->evict.pfn_evict(_flight.p_value, p_shard->p_cache->evict.p_context);
+
+    // Lock the loads
+    mutex_lock(&p_shard->_loading);
+
+    // Remove the load from the list
+    for (pp_next = &p_shard->p_flights; *pp_next != &_flight; pp_next = &(*pp_next)->p_next);
+    *pp_next = _flight.p_next;
+
+    // Wake the waiters
+    _flight.done = true;
+    condition_variable_broadcast(&p_shard->_loaded);
+
+    // Wait for each waiter to take the result
+    while ( _flight.waiters ) condition_variable_wait(&p_shard->_loaded, &p_shard->_loading);
+
+    // Unlock the loads
+    mutex_unlock(&p_shard->_loading);
+
+    // Error check
+    if ( loaded         == 0 ) goto failed_to_load;
+    if ( _flight.result == 0 ) goto failed_to_insert;
+
+    // Return the value to the caller
+    *pp_result = _flight.p_value;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_loader:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"pfn_loader\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_result:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"pp_result\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash cache errors
+        {
+            failed_to_load:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Failed to load value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            failed_to_insert:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Failed to insert value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_stats_get ( concurrent_cache *const p_concurrent_cache, concurrent_cache_stats *const p_stats )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+    if ( p_stats            == (void *) 0 ) goto no_stats;
+
+    // Initialized data
+    concurrent_cache_stats _stats = { 0 };
+
+    // Sum each shard
+    for (size_t i = 0; i <= p_concurrent_cache->mask; i++)
+    {
+
+        // Initialized data
+        concurrent_cache_shard *p_shard = &p_concurrent_cache->p_shards[i];
+
+        // Lock the shard
+        concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+        // Add the shard's statistics
+        for (size_t j = 0; j < CONCURRENT_CACHE_STRIPES; j++)
+            _stats.hits   += __atomic_load_n(&p_shard->buffers[j].hits, __ATOMIC_RELAXED),
+            _stats.misses += __atomic_load_n(&p_shard->buffers[j].misses, __ATOMIC_RELAXED);
+        _stats.count  += p_shard->p_cache->properties.count;
+        _stats.max    += p_shard->p_cache->properties.max;
+        _stats.cost   += cache_cost(p_shard->p_cache);
+
+        // Unlock the shard
+        concurrent_cache_unlock(p_concurrent_cache, p_shard);
+    }
+
+    // Return the statistics to the caller
+    *p_stats = _stats;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_stats:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_stats\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_insert ( concurrent_cache *const p_concurrent_cache, const void *const p_key, const void *const p_value )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+    if ( p_key              == (void *) 0 ) goto no_key;
+
+    // Initialized data
+    concurrent_cache_shard *p_shard = concurrent_cache_shard_of(p_concurrent_cache, p_key);
+    int                     result  = 0;
+
+    // Lock the shard
+    concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+    // Insert the value
+    result = cache_insert(p_shard->p_cache, p_key, p_value);
+
+    // Unlock the shard
+    concurrent_cache_unlock(p_concurrent_cache, p_shard);
+
+    // Success
+    return result;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+size_t concurrent_cache_insert_many ( concurrent_cache *const p_concurrent_cache, const void *const *const pp_keys, const void *const *const pp_values, size_t n )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+    if ( pp_keys            == (void *) 0 ) goto no_keys;
+    if ( pp_values          == (void *) 0 ) goto no_values;
+
+    // Initialized data
+    size_t      shards[CACHE_BATCH],
+                inserted = 0;
+    const void *keys[CACHE_BATCH],
+               *values[CACHE_BATCH];
+
+    // Insert each batch
+    for (size_t i = 0; i < n; i += CACHE_BATCH)
+    {
+
+        // Initialized data
+        size_t             batch = ( n - i < CACHE_BATCH ) ? n - i : CACHE_BATCH;
+        unsigned long long done  = 0;
+
+        // Find the shard of each key. Null keys are skipped
+        for (size_t j = 0; j < batch; j++)
+            if   ( pp_keys[i + j] ) shards[j] = (size_t) ( concurrent_cache_shard_of(p_concurrent_cache, pp_keys[i + j]) - p_concurrent_cache->p_shards );
+            else done |= 1ULL << j;
+
+        // Insert each group of properties with the same shard ...
+        for (size_t j = 0; j < batch; j++)
+        {
+
+            // Initialized data
+            concurrent_cache_shard *p_shard  = (void *) 0;
+            size_t                  quantity = 0;
+
+            // Skip inserted properties
+            if ( done & ( 1ULL << j ) ) continue;
+
+            // Gather the properties of the shard
+            for (size_t k = j; k < batch; k++)
+                if ( ( done & ( 1ULL << k ) ) == 0 && shards[k] == shards[j] )
+                    keys[quantity]   = pp_keys[i + k],
+                    values[quantity] = pp_values[i + k],
+                    quantity++,
+                    done            |= 1ULL << k;
+
+            // Initialized data
+            p_shard = &p_concurrent_cache->p_shards[shards[j]];
+
+            // ... with one lock of the shard
+            concurrent_cache_lock(p_concurrent_cache, p_shard);
+            inserted += cache_insert_many(p_shard->p_cache, keys, values, quantity);
+            concurrent_cache_unlock(p_concurrent_cache, p_shard);
+        }
+    }
+
+    // Success
+    return inserted;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_keys:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"pp_keys\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_values:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"pp_values\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_upsert ( concurrent_cache *const p_concurrent_cache, const void *const p_key, fn_hash_cache_upsert_found *pfn_on_found, fn_hash_cache_upsert_create *pfn_on_create, void *p_context )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+    if ( p_key              == (void *) 0 ) goto no_key;
+
+    // Initialized data
+    concurrent_cache_shard *p_shard = concurrent_cache_shard_of(p_concurrent_cache, p_key);
+    int                     result  = 0;
+
+    // Lock the shard
+    concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+    // Update or create the value
+    result = cache_upsert(p_shard->p_cache, p_key, pfn_on_found, pfn_on_create, p_context);
+
+    // Unlock the shard
+    concurrent_cache_unlock(p_concurrent_cache, p_shard);
+
+    // Success
+    return result;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_remove ( concurrent_cache *const p_concurrent_cache, const void *const p_key, void **const pp_result )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+    if ( p_key              == (void *) 0 ) goto no_key;
+
+    // Initialized data
+    concurrent_cache_shard *p_shard = concurrent_cache_shard_of(p_concurrent_cache, p_key);
+    int                     result  = 0;
+
+    // Lock the shard
+    concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+    // Wait for a reload that reads the key of the value
+    while ( p_shard->p_pins && concurrent_cache_pinned(p_shard, p_key) ) concurrent_cache_unpinned_wait(p_concurrent_cache, p_shard);
+
+    // Remove the value
+    result = cache_remove(p_shard->p_cache, p_key, pp_result);
+
+    // Unlock the shard
+    concurrent_cache_unlock(p_concurrent_cache, p_shard);
+
+    // Success
+    return result;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_maintain ( concurrent_cache *const p_concurrent_cache, timestamp now )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+
+    // Maintain each shard
+    for (size_t i = 0; i <= p_concurrent_cache->mask; i++)
+    {
+
+        // Initialized data
+        concurrent_cache_shard *p_shard = &p_concurrent_cache->p_shards[i];
+
+        // Lock the shard
+        concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+        // Reclaim the shard's expired properties
+        cache_maintain(p_shard->p_cache, now);
+
+        // Unlock the shard
+        concurrent_cache_unlock(p_concurrent_cache, p_shard);
+    }
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_clear ( concurrent_cache *const p_concurrent_cache, fn_hash_cache_free *pfn_free )
+{
+
+    // Argument check
+    if ( p_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+
+    // Clear each shard
+    for (size_t i = 0; i <= p_concurrent_cache->mask; i++)
+    {
+
+        // Initialized data
+        concurrent_cache_shard *p_shard = &p_concurrent_cache->p_shards[i];
+
+        // Lock the shard
+        concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+        // Wait for the shard's reloads
+        while ( p_shard->p_pins ) concurrent_cache_unpinned_wait(p_concurrent_cache, p_shard);
+
+        // Clear the shard's cache
+        cache_clear(p_shard->p_cache, pfn_free);
+
+        // Reset the shard's statistics
+        for (size_t j = 0; j < CONCURRENT_CACHE_STRIPES; j++)
+            __atomic_store_n(&p_shard->buffers[j].hits, 0, __ATOMIC_RELAXED),
+            __atomic_store_n(&p_shard->buffers[j].misses, 0, __ATOMIC_RELAXED);
+
+        // Unlock the shard
+        concurrent_cache_unlock(p_concurrent_cache, p_shard);
+    }
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"p_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int concurrent_cache_destroy ( concurrent_cache **const pp_concurrent_cache, fn_hash_cache_free *pfn_free )
+{
+
+    // Argument check
+    if ( pp_concurrent_cache  == (void *) 0 ) goto no_concurrent_cache;
+    if ( *pp_concurrent_cache == (void *) 0 ) goto no_concurrent_cache;
+
+    // Initialized data
+    concurrent_cache *p_concurrent_cache = *pp_concurrent_cache;
+
+    // No more pointer for caller
+    *pp_concurrent_cache = (void *) 0;
+
+    // Success
+    return concurrent_cache_release(p_concurrent_cache, p_concurrent_cache->mask + 1, pfn_free);
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_concurrent_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Null pointer provided for parameter \"pp_concurrent_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static int concurrent_cache_release ( concurrent_cache *const p_concurrent_cache, size_t shards, fn_hash_cache_free *pfn_free )
+{
+
+    // Stop refreshing ahead, before the shards go away
+    concurrent_cache_refresh_destroy(p_concurrent_cache);
+
+    // Destroy each shard
+    for (size_t i = 0; i < shards; i++)
+    {
+
+        // Initialized data
+        concurrent_cache_shard *p_shard = &p_concurrent_cache->p_shards[i];
+
+        // Destroy the shard's cache
+        cache_destroy(&p_shard->p_cache, pfn_free);
+
+        // Destroy the shard's locks
+        if ( p_concurrent_cache->spinlock ) spinlock_destroy(&p_shard->_spinlock);
+        else                                mutex_destroy(&p_shard->_mutex);
+        mutex_destroy(&p_shard->_loading);
+        condition_variable_destroy(&p_shard->_loaded);
+    }
+
+    // Free the shards
+    if ( HASH_CACHE_REALLOC(p_concurrent_cache->p_shards, 0) ) goto failed_to_free;
+
+    // Free the concurrent cache
+    if ( HASH_CACHE_REALLOC(p_concurrent_cache, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void concurrent_cache_drain ( concurrent_cache_shard *const p_shard )
+{
+
+    // Take each buffered hit
+    for (size_t i = 0; i < CONCURRENT_CACHE_STRIPES; i++)
+        for (size_t j = 0; j < CONCURRENT_CACHE_BUFFER; j++)
+        {
+
+            // Initialized data
+            unsigned long long entry = __atomic_exchange_n(&p_shard->buffers[i].entries[j], 0, __ATOMIC_ACQUIRE);
+            size_t             slot  = (size_t) ( entry & 0xFFFFFFFF ) - 1;
+
+            // Skip an empty entry
+            if ( entry == 0 ) continue;
+
+            // Skip a slot that was refilled with another key since the hit
+            if ( slot >= p_shard->p_cache->properties.max || ( p_shard->p_cache->index.p_nodes[slot].hash & 0xFFFFFFFF00000000ULL ) != ( entry & 0xFFFFFFFF00000000ULL ) ) continue;
+
+            // Tell the policy
+            cache_touch(p_shard->p_cache, slot);
+        }
+
+    // Done
+    return;
+}
+
+static void concurrent_cache_try_drain ( concurrent_cache_shard *const p_shard )
+{
+
+    // Initialized data
+    int idle = 0;
+
+    // Another thread owns the shard
+    if ( __atomic_compare_exchange_n(&p_shard->busy, &idle, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == false ) return;
+
+    // Drain the buffers. The policy's state isn't part of the index, so readers are undisturbed
+    concurrent_cache_drain(p_shard);
+
+    // Release the shard
+    __atomic_store_n(&p_shard->busy, 0, __ATOMIC_RELEASE);
+
+    // Done
+    return;
+}
+
+static void concurrent_cache_lock ( const concurrent_cache *const p_concurrent_cache, concurrent_cache_shard *const p_shard )
+{
+
+    // Initialized data
+    size_t epoch = 0;
+
+    // Spin, or sleep
+    if ( p_concurrent_cache->spinlock ) spinlock_lock(&p_shard->_spinlock);
+    else                                mutex_lock(&p_shard->_mutex);
+
+    // Wait for a draining reader
+    for (int idle = 0; __atomic_compare_exchange_n(&p_shard->busy, &idle, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == false; idle = 0);
+
+    // Tell readers that the shard is changing
+    __atomic_store_n(&p_shard->sequence, p_shard->sequence + 1, __ATOMIC_SEQ_CST);
+
+    // Start an epoch. Readers that enter from now on see the odd sequence, or
+    // the new epoch, and leave without searching
+    epoch = __atomic_fetch_add(&p_shard->epoch, 1, __ATOMIC_SEQ_CST);
+
+    // Wait for the readers of the previous epoch, so no reader holds a value 
+    // that the writer evicts or frees
+    for (size_t i = 0; i < CONCURRENT_CACHE_STRIPES; i++)
+        while ( __atomic_load_n(&p_shard->buffers[i].readers[epoch & 1], __ATOMIC_SEQ_CST) );
+
+    // Report the buffered hits before the policy picks a victim
+    concurrent_cache_drain(p_shard);
+
+    // Done
+    return;
+}
+
+static void concurrent_cache_unlock ( const concurrent_cache *const p_concurrent_cache, concurrent_cache_shard *const p_shard )
+{
+
+    // Tell readers that the shard is stable
+    __atomic_store_n(&p_shard->sequence, p_shard->sequence + 1, __ATOMIC_RELEASE);
+
+    // Release the shard
+    __atomic_store_n(&p_shard->busy, 0, __ATOMIC_RELEASE);
+
+    // Release the lock
+    if ( p_concurrent_cache->spinlock ) spinlock_unlock(&p_shard->_spinlock);
+    else                                mutex_unlock(&p_shard->_mutex);
+
+    // Done
+    return;
+}
+
+static int concurrent_cache_refresh_construct ( concurrent_cache *const p_concurrent_cache, const concurrent_cache_options *const p_options )
+{
+
+    // Initialized data
+    concurrent_cache_refresh *p_refresh = HASH_CACHE_REALLOC(0, sizeof(concurrent_cache_refresh));
+    size_t                    workers   = ( p_options->workers ) ? p_options->workers : CONCURRENT_CACHE_WORKERS,
+                              max       = ( p_options->queue   ) ? p_options->queue   : CONCURRENT_CACHE_QUEUE,
+                              slots     = 0;
+
+    // Error check
+    if ( p_refresh == (void *) 0 ) goto no_mem;
+
+    // Count the slots of every shard
+    for (size_t i = 0; i <= p_concurrent_cache->mask; i++) slots += p_concurrent_cache->p_shards[i].p_cache->properties.max;
+
+    // Initialize the refresh
+    *p_refresh = (concurrent_cache_refresh)
+    {
+        .pfn_loader = p_options->pfn_loader,
+        .p_context  = p_options->p_loader_context,
+        .window     = p_options->refresh,
+        .queue      =
+        {
+            .p_reloads = HASH_CACHE_REALLOC(0, sizeof(concurrent_cache_reload) * max),
+            .max       = max
+        },
+        .p_flags    = HASH_CACHE_REALLOC(0, slots),
+        .p_workers  = HASH_CACHE_REALLOC(0, sizeof(pthread_t) * workers),
+        .running    = true
+    };
+
+    // Error check
+    if ( p_refresh->queue.p_reloads == (void *) 0 || p_refresh->p_flags == (void *) 0 || p_refresh->p_workers == (void *) 0 ) goto no_mem;
+
+    // Create the lock of the queue
+    if ( mutex_create(&p_refresh->_mutex) == 0 ) goto failed_to_create_lock;
+
+    // Create the condition of the queue
+    if ( condition_variable_create(&p_refresh->_ready) == 0 )
+    {
+
+        // Destroy the lock of the queue
+        mutex_destroy(&p_refresh->_mutex);
+
+        // Error
+        goto failed_to_create_lock;
+    }
+
+    // Create the condition of the pins
+    if ( condition_variable_create(&p_refresh->_unpinned) == 0 )
+    {
+
+        // Destroy the lock and the condition of the queue
+        condition_variable_destroy(&p_refresh->_ready);
+        mutex_destroy(&p_refresh->_mutex);
+
+        // Error
+        goto failed_to_create_lock;
+    }
+
+    // Give each shard its share of the flags
+    memset(p_refresh->p_flags, 0, slots);
+    for (size_t i = 0, offset = 0; i <= p_concurrent_cache->mask; i++)
+        p_concurrent_cache->p_shards[i].p_reloading  = p_refresh->p_flags + offset,
+        offset                                     += p_concurrent_cache->p_shards[i].p_cache->properties.max;
+
+    // Store the refresh
+    p_concurrent_cache->p_refresh = p_refresh;
+
+    // Start the workers
+    while ( p_refresh->workers < workers && pthread_create(&p_refresh->p_workers[p_refresh->workers], NULL, concurrent_cache_refresh_worker, p_concurrent_cache) == 0 )
+        p_refresh->workers++;
+
+    // Error check
+    if ( p_refresh->workers == 0 ) goto failed_to_start_workers;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Sync errors
+        {
+            failed_to_create_lock:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Failed to create lock in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                p_refresh->queue.p_reloads = HASH_CACHE_REALLOC(p_refresh->queue.p_reloads, 0);
+                p_refresh->p_flags         = HASH_CACHE_REALLOC(p_refresh->p_flags, 0);
+                p_refresh->p_workers       = HASH_CACHE_REALLOC(p_refresh->p_workers, 0);
+                p_refresh                  = HASH_CACHE_REALLOC(p_refresh, 0);
+
+                // Error
+                return 0;
+        }
+
+        // POSIX errors
+        {
+            failed_to_start_workers:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [concurrent cache] Failed to start worker thread in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                concurrent_cache_refresh_destroy(p_concurrent_cache);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_refresh )
+                    p_refresh->queue.p_reloads = HASH_CACHE_REALLOC(p_refresh->queue.p_reloads, 0),
+                    p_refresh->p_flags         = HASH_CACHE_REALLOC(p_refresh->p_flags, 0),
+                    p_refresh->p_workers       = HASH_CACHE_REALLOC(p_refresh->p_workers, 0),
+                    p_refresh                  = HASH_CACHE_REALLOC(p_refresh, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void concurrent_cache_refresh_destroy ( concurrent_cache *const p_concurrent_cache )
+{
+
+    // Initialized data
+    concurrent_cache_refresh *p_refresh = p_concurrent_cache->p_refresh;
+
+    // The cache doesn't refresh ahead
+    if ( p_refresh == (void *) 0 ) return;
+
+    // Stop the workers
+    mutex_lock(&p_refresh->_mutex);
+    p_refresh->running = false;
+    condition_variable_broadcast(&p_refresh->_ready);
+    mutex_unlock(&p_refresh->_mutex);
+
+    // Wait for each worker to finish its reload
+    for (size_t i = 0; i < p_refresh->workers; i++) pthread_join(p_refresh->p_workers[i], NULL);
+
+    // Destroy the lock and the conditions of the queue
+    mutex_destroy(&p_refresh->_mutex);
+    condition_variable_destroy(&p_refresh->_ready);
+    condition_variable_destroy(&p_refresh->_unpinned);
+
+    // Clear each shard's flags
+    for (size_t i = 0; i <= p_concurrent_cache->mask; i++) p_concurrent_cache->p_shards[i].p_reloading = (void *) 0;
+
+    // Free the refresh
+    p_refresh->queue.p_reloads    = HASH_CACHE_REALLOC(p_refresh->queue.p_reloads, 0);
+    p_refresh->p_flags            = HASH_CACHE_REALLOC(p_refresh->p_flags, 0);
+    p_refresh->p_workers          = HASH_CACHE_REALLOC(p_refresh->p_workers, 0);
+    p_concurrent_cache->p_refresh = HASH_CACHE_REALLOC(p_refresh, 0);
+
+    // Done
+    return;
+}
+
+static void concurrent_cache_refresh_push ( concurrent_cache *const p_concurrent_cache, concurrent_cache_shard *const p_shard, size_t slot, void *p_value, hash64 h )
+{
+
+    // Initialized data
+    concurrent_cache_refresh *p_refresh = p_concurrent_cache->p_refresh;
+    unsigned char             idle      = 0;
+
+    // Another read already queued a reload of the slot
+    if ( __atomic_compare_exchange_n(&p_shard->p_reloading[slot], &idle, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED) == false ) return;
+
+    // Lock the queue
+    mutex_lock(&p_refresh->_mutex);
+
+    // Queue the reload
+    if ( p_refresh->queue.count < p_refresh->queue.max )
+    {
+
+        // Add the reload to the back of the queue
+        p_refresh->queue.p_reloads[( p_refresh->queue.head + p_refresh->queue.count ) % p_refresh->queue.max] = (concurrent_cache_reload)
+        {
+            .p_shard = p_shard,
+            .slot    = slot,
+            .p_value = p_value,
+            .hash    = h
+        };
+        p_refresh->queue.count++;
+
+        // Wake a worker
+        condition_variable_signal(&p_refresh->_ready);
+
+        // Unlock the queue
+        mutex_unlock(&p_refresh->_mutex);
+
+        // Done
+        return;
+    }
+
+    // Unlock the queue
+    mutex_unlock(&p_refresh->_mutex);
+
+    // The queue is full. Drop the reload, so a later read can queue it again
+    __atomic_store_n(&p_shard->p_reloading[slot], 0, __ATOMIC_RELEASE);
+
+    // Done
+    return;
+}
+
+static void *concurrent_cache_refresh_worker ( void *p_parameter )
+{
+
+    // Initialized data
+    concurrent_cache         *p_concurrent_cache = p_parameter;
+    concurrent_cache_refresh *p_refresh          = p_concurrent_cache->p_refresh;
+
+    // Reload until the workers stop
+    for (;;)
+    {
+
+        // Initialized data
+        concurrent_cache_reload  _reload = { 0 };
+        concurrent_cache_pin     _pin    = { 0 },
+                               **pp_pin  = (void *) 0;
+        concurrent_cache_shard  *p_shard = (void *) 0;
+        cache                   *p_cache = (void *) 0;
+        const void              *p_key   = (void *) 0;
+        void                    *p_value = (void *) 0;
+        int                      result  = 0;
+
+        // Wait for a reload
+        mutex_lock(&p_refresh->_mutex);
+        while ( p_refresh->running && p_refresh->queue.count == 0 ) condition_variable_wait(&p_refresh->_ready, &p_refresh->_mutex);
+
+        // The workers are stopping. Waiting reloads are dropped
+        if ( p_refresh->running == false )
+        {
+
+            // Unlock the queue
+            mutex_unlock(&p_refresh->_mutex);
+
+            // Done
+            return (void *) 0;
+        }
+
+        // Take the reload from the front of the queue
+        _reload                = p_refresh->queue.p_reloads[p_refresh->queue.head];
+        p_refresh->queue.head  = ( p_refresh->queue.head + 1 ) % p_refresh->queue.max;
+        p_refresh->queue.count--;
+
+        // Unlock the queue
+        mutex_unlock(&p_refresh->_mutex);
+
+        // Initialized data
+        p_shard = _reload.p_shard;
+        p_cache = p_shard->p_cache;
+
+        // Lock the shard
+        concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+        // Pin the stale value, unless it left the cache since the read. The 
+        // cache can't release a pinned value, so its key outlives the load
+        if ( p_cache->properties.pp_data[_reload.slot] == _reload.p_value && p_cache->index.p_nodes[_reload.slot].hash == _reload.hash )
+            _pin            = (concurrent_cache_pin) { .p_value = _reload.p_value, .p_next = p_shard->p_pins },
+            p_shard->p_pins = &_pin,
+            p_key           = p_cache->pfn_key_get(_reload.p_value);
+
+        // Unlock the shard
+        concurrent_cache_unlock(p_concurrent_cache, p_shard);
+
+        // Load a fresh value, without a lock. Readers get the stale value meanwhile
+        if ( p_key ) result = p_refresh->pfn_loader(p_key, p_refresh->p_context, &p_value);
+
+        // Lock the shard
+        concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+        // If the stale value was pinned ...
+        if ( p_key )
+        {
+
+            // ... unpin it
+            for (pp_pin = &p_shard->p_pins; *pp_pin != &_pin; pp_pin = &(*pp_pin)->p_next);
+            *pp_pin = _pin.p_next;
+
+            // Replace the stale value, unless it was evicted or replaced during the load
+            if ( result && _pin.evicted == false && cache_insert(p_cache, p_cache->pfn_key_get(p_value), p_value) ) result = 0;
+
+            // Release a stale value that was evicted during the load
+            if ( _pin.evicted ) p_shard->pfn_evict(_reload.p_value, p_shard->p_context);
+
+            // Release a fresh value that the cache didn't take
+            if ( result ) p_shard->pfn_evict(p_value, p_shard->p_context);
+
+            // Wake the removes that wait for the pin
+            mutex_lock(&p_refresh->_mutex);
+            condition_variable_broadcast(&p_refresh->_unpinned);
+            mutex_unlock(&p_refresh->_mutex);
+        }
+
+        // The slot can reload again
+        __atomic_store_n(&p_shard->p_reloading[_reload.slot], 0, __ATOMIC_RELEASE);
+
+        // Unlock the shard
+        concurrent_cache_unlock(p_concurrent_cache, p_shard);
+    }
+}
+
+static void concurrent_cache_evict ( void *p_value, void *p_context )
+{
+
+    // Initialized data
+    concurrent_cache_shard *p_shard = p_context;
+
+    // Defer the eviction of a pinned value to its reload
+    for (concurrent_cache_pin *p_pin = p_shard->p_pins; p_pin; p_pin = p_pin->p_next)
+        if ( p_pin->p_value == p_value )
+        {
+
+            // Mark the value
+            p_pin->evicted = true;
+
+            // Done
+            return;
+        }
+
+    // Release the value
+    p_shard->pfn_evict(p_value, p_shard->p_context);
+
+    // Done
+    return;
+}
+
+static bool concurrent_cache_pinned ( const concurrent_cache_shard *const p_shard, const void *const p_key )
+{
+
+    // Compare the key of each pinned value. A pinned value is never released
+    for (const concurrent_cache_pin *p_pin = p_shard->p_pins; p_pin; p_pin = p_pin->p_next)
+        if ( p_shard->p_cache->pfn_equality(p_shard->p_cache->pfn_key_get(p_pin->p_value), p_key) == 0 ) return true;
+
+    // Not pinned
+    return false;
+}
+
+static void concurrent_cache_unpinned_wait ( const concurrent_cache *const p_concurrent_cache, concurrent_cache_shard *const p_shard )
+{
+
+    // Initialized data
+    concurrent_cache_refresh *p_refresh = p_concurrent_cache->p_refresh;
+
+    // Lock the condition before the shard is unlocked, so the wake can't be missed
+    mutex_lock(&p_refresh->_mutex);
+
+    // Unlock the shard, so the reload can release its pin
+    concurrent_cache_unlock(p_concurrent_cache, p_shard);
+
+    // Wait for a pin to be released
+    condition_variable_wait(&p_refresh->_unpinned, &p_refresh->_mutex);
+
+    // Unlock the condition
+    mutex_unlock(&p_refresh->_mutex);
+
+    // Lock the shard again
+    concurrent_cache_lock(p_concurrent_cache, p_shard);
+
+    // Done
+    return;
+}
@@ -0,0 +1,284 @@
+/** !
+ * Implementation of ghost lists
+ *
+ * @file ghost.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/ghost.h>
+
+// Standard library
+#include <stdlib.h>
+#include <string.h>
+
+// Function definitions
+int hash_cache_ghost_construct ( hash_cache_ghost **const pp_ghost, size_t max )
+{
+
+    // Argument check
+    if ( pp_ghost == (void *) 0 ) goto no_ghost;
+    if ( max      ==          0 ) goto invalid_max;
+
+    // Initialized data
+    hash_cache_ghost *p_ghost = HASH_CACHE_REALLOC(0, sizeof(hash_cache_ghost));
+    size_t            buckets = 1;
+
+    // Error check
+    if ( p_ghost == (void *) 0 ) goto no_mem;
+
+    // Compute the size of the index
+    while ( buckets < max ) buckets <<= 1;
+
+    // Initialize the ghost lists
+    *p_ghost = (hash_cache_ghost)
+    {
+        .p_entries = HASH_CACHE_REALLOC(0, sizeof(hash_cache_ghost_entry) * max + sizeof(size_t) * buckets),
+        .mask      = buckets - 1,
+        .max       = max
+    };
+
+    // Error check
+    if ( p_ghost->p_entries == (void *) 0 ) goto no_mem;
+
+    // The buckets follow the entries
+    p_ghost->p_buckets = (size_t *) ( p_ghost->p_entries + max );
+
+    // Every list starts empty
+    hash_cache_ghost_clear(p_ghost);
+
+    // Return a pointer to the caller
+    *pp_ghost = p_ghost;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_ghost:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [ghost] Null pointer provided for parameter \"pp_ghost\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_max:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [ghost] Parameter \"max\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_ghost ) p_ghost = HASH_CACHE_REALLOC(p_ghost, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+size_t hash_cache_ghost_find ( const hash_cache_ghost *const p_ghost, hash64 h )
+{
+
+    // Walk the bucket
+    for (size_t i = p_ghost->p_buckets[h & p_ghost->mask]; i != HASH_CACHE_GHOST_NIL; i = p_ghost->p_entries[i].chain)
+
+        // Hit
+        if ( p_ghost->p_entries[i].hash == h ) return i;
+
+    // Miss
+    return HASH_CACHE_GHOST_NIL;
+}
+
+void hash_cache_ghost_push ( hash_cache_ghost *const p_ghost, size_t list, hash64 h )
+{
+
+    // Initialized data
+    size_t                  i       = 0,
+                            bucket  = h & p_ghost->mask;
+    hash_cache_ghost_entry *p_entry = (void *) 0;
+
+    // Make room
+    if ( p_ghost->free == HASH_CACHE_GHOST_NIL )
+        if ( hash_cache_ghost_pop(p_ghost, list) == 0 )
+            for (size_t j = 0; j < HASH_CACHE_GHOST_LISTS; j++)
+                if ( hash_cache_ghost_pop(p_ghost, j) ) break;
+
+    // Take an entry from the free list
+    i             = p_ghost->free;
+    p_entry       = &p_ghost->p_entries[i];
+    p_ghost->free = p_entry->chain;
+
+    // Add the entry to the front of the bucket
+    p_entry->hash              = h;
+    p_entry->list              = list;
+    p_entry->chain             = p_ghost->p_buckets[bucket];
+    p_ghost->p_buckets[bucket] = i;
+
+    // Add the entry to the front of the list
+    p_entry->prev = HASH_CACHE_GHOST_NIL;
+    p_entry->next = p_ghost->lists[list].head;
+
+    // Link the old head, or the tail of an empty list
+    if ( p_ghost->lists[list].head != HASH_CACHE_GHOST_NIL ) p_ghost->p_entries[p_ghost->lists[list].head].prev = i;
+    else                                                     p_ghost->lists[list].tail                          = i;
+
+    // Update the head
+    p_ghost->lists[list].head = i;
+
+    // Increment the quantity of entries
+    p_ghost->lists[list].count++;
+
+    // Done
+    return;
+}
+
+int hash_cache_ghost_pop ( hash_cache_ghost *const p_ghost, size_t list )
+{
+
+    // Done?
+    if ( p_ghost->lists[list].tail == HASH_CACHE_GHOST_NIL ) return 0;
+
+    // Forget the oldest entry
+    hash_cache_ghost_remove(p_ghost, p_ghost->lists[list].tail);
+
+    // Success
+    return 1;
+}
+
+void hash_cache_ghost_remove ( hash_cache_ghost *const p_ghost, size_t entry )
+{
+
+    // Initialized data
+    hash_cache_ghost_entry *p_entry = &p_ghost->p_entries[entry];
+    size_t                 *p_chain = &p_ghost->p_buckets[p_entry->hash & p_ghost->mask];
+    size_t                  list    = p_entry->list;
+
+    // Find the link to the entry
+    while ( *p_chain != entry ) p_chain = &p_ghost->p_entries[*p_chain].chain;
+
+    // Remove the entry from the bucket
+    *p_chain = p_entry->chain;
+
+    // Remove the entry from the list
+    if ( p_entry->prev != HASH_CACHE_GHOST_NIL ) p_ghost->p_entries[p_entry->prev].next = p_entry->next;
+    else                                         p_ghost->lists[list].head             = p_entry->next;
+    if ( p_entry->next != HASH_CACHE_GHOST_NIL ) p_ghost->p_entries[p_entry->next].prev = p_entry->prev;
+    else                                         p_ghost->lists[list].tail             = p_entry->prev;
+
+    // Decrement the quantity of entries
+    p_ghost->lists[list].count--;
+
+    // Return the entry to the free list
+    p_entry->chain = p_ghost->free;
+    p_ghost->free  = entry;
+
+    // Done
+    return;
+}
+
+int hash_cache_ghost_clear ( hash_cache_ghost *const p_ghost )
+{
+
+    // Argument check
+    if ( p_ghost == (void *) 0 ) goto no_ghost;
+
+    // Empty the buckets
+    memset(p_ghost->p_buckets, 0xff, sizeof(size_t) * ( p_ghost->mask + 1 ));
+
+    // Thread every entry onto the free list
+    for (size_t i = 0; i < p_ghost->max; i++)
+        p_ghost->p_entries[i].chain = i + 1;
+
+    // Terminate the free list
+    p_ghost->p_entries[p_ghost->max - 1].chain = HASH_CACHE_GHOST_NIL;
+    p_ghost->free                              = 0;
+
+    // Empty each list
+    for (size_t i = 0; i < HASH_CACHE_GHOST_LISTS; i++)
+        p_ghost->lists[i].head  = HASH_CACHE_GHOST_NIL,
+        p_ghost->lists[i].tail  = HASH_CACHE_GHOST_NIL,
+        p_ghost->lists[i].count = 0;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_ghost:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [ghost] Null pointer provided for parameter \"p_ghost\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_ghost_destroy ( hash_cache_ghost **const pp_ghost )
+{
+
+    // Argument check
+    if ( pp_ghost  == (void *) 0 ) goto no_ghost;
+    if ( *pp_ghost == (void *) 0 ) goto no_ghost;
+
+    // Initialized data
+    hash_cache_ghost *p_ghost = *pp_ghost;
+
+    // No more pointer for caller
+    *pp_ghost = (void *) 0;
+
+    // Free the entries and the buckets
+    if ( HASH_CACHE_REALLOC(p_ghost->p_entries, 0) ) goto failed_to_free;
+
+    // Free the ghost lists
+    if ( HASH_CACHE_REALLOC(p_ghost, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_ghost:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [ghost] Null pointer provided for parameter \"pp_ghost\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
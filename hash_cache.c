@@ -12,6 +12,7 @@
 // Data
 static bool initialized = false;
 unsigned long long crc64_table[256] = { 0 };
+__thread unsigned char hash_cache_thread;
 
 void hash_cache_init ( void )
 {
@@ -62,6 +63,144 @@ void *hash_cache_key_accessor ( const void *const p_value )
     return (void *)p_value;
 }
 
+int hash_cache_counters_construct ( hash_cache_counters **const pp_counters )
+{
+
+    // Argument check
+    if ( pp_counters == (void *) 0 ) goto no_counters;
+
+    // Initialized data
+    void                *p_allocation = HASH_CACHE_REALLOC(0, sizeof(hash_cache_counters) + 64);
+    hash_cache_counters *p_counters   = (void *) 0;
+
+    // Error check
+    if ( p_allocation == (void *) 0 ) goto no_mem;
+
+    // Align the counters to a cache line, so each stripe fills exactly one
+    p_counters = (void *) ( ( ( (size_t) p_allocation ) + 63 ) & ~(size_t) 63 );
+
+    // Zero the counters
+    *p_counters = (hash_cache_counters)
+    {
+        .stripes      = { { { 0 } } },
+        .p_allocation = p_allocation
+    };
+
+    // Return a pointer to the caller
+    *pp_counters = p_counters;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_counters:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"pp_counters\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void hash_cache_counters_sum ( const hash_cache_counters *const p_counters, hash_cache_stats *const p_stats )
+{
+
+    // Initialized data
+    hash_cache_stats _stats = { 0 };
+
+    // Add each stripe
+    for (size_t i = 0; i < HASH_CACHE_STATS_STRIPES; i++)
+        _stats.hits      += __atomic_load_n(&p_counters->stripes[i].stats.hits, __ATOMIC_RELAXED),
+        _stats.misses    += __atomic_load_n(&p_counters->stripes[i].stats.misses, __ATOMIC_RELAXED),
+        _stats.inserts   += __atomic_load_n(&p_counters->stripes[i].stats.inserts, __ATOMIC_RELAXED),
+        _stats.evictions += __atomic_load_n(&p_counters->stripes[i].stats.evictions, __ATOMIC_RELAXED),
+        _stats.probes    += __atomic_load_n(&p_counters->stripes[i].stats.probes, __ATOMIC_RELAXED),
+        _stats.resizes   += __atomic_load_n(&p_counters->stripes[i].stats.resizes, __ATOMIC_RELAXED);
+
+    // Return the statistics to the caller
+    *p_stats = _stats;
+
+    // Done
+    return;
+}
+
+int hash_cache_counters_destroy ( hash_cache_counters **const pp_counters )
+{
+
+    // Argument check
+    if ( pp_counters == (void *) 0 ) goto no_counters;
+
+    // Initialized data
+    hash_cache_counters *p_counters = *pp_counters;
+
+    // No more pointer for caller
+    *pp_counters = (void *) 0;
+
+    // Free the allocation the counters were aligned in
+    if ( p_counters && HASH_CACHE_REALLOC(p_counters->p_allocation, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_counters:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Null pointer provided for parameter \"pp_counters\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+hash64 hash_cache_key_hash ( const void *const p_key )
+{
+
+    // Initialized data
+    hash64 h = (hash64) (size_t) p_key;
+
+    // Mix the bits of the address
+    h ^= h >> 33, h *= 0xFF51AFD7ED558CCD,
+    h ^= h >> 33, h *= 0xC4CEB9FE1A85EC53,
+    h ^= h >> 33;
+
+    // Success
+    return h;
+}
+
 void hash_cache_exit ( void )
 {
 
@@ -1,7 +1,209 @@
 // Header
 #include <hash_cache/hash_table.h>
 
+// POSIX
+#include <pthread.h>
+
+// __umulh
+#if defined(_MSC_VER) && !defined(__SIZEOF_INT128__)
+    #include <intrin.h>
+#endif
+
+// Preprocessor definitions
+#define HASH_TABLE_WORKERS_MAX 63
+
+// Structure definitions
+struct hash_table_pool_s
+{
+    pthread_mutex_t   _run,                             // Held by the caller of a run
+                      _mutex;                           // Guards the rest of the pool
+    pthread_cond_t    _start,                           // Signaled when a run starts
+                      _done;                            // Signaled when a run's last task is done
+    size_t            workers,                          // The quantity of threads in the pool
+                      generation,                       // Incremented when a run starts
+                      next, finished, quantity,         // The next task to take, the quantity of tasks done, and the quantity of tasks
+                      task_size;                        // The size of a task in bytes
+    void           *(*pfn_worker)(void *);              // The worker function of the run
+    void             *p_tasks;                          // The tasks of the run
+};
+
+struct hash_table_parallel_task_s
+{
+    const hash_table        *p_hash_table;
+    fn_hash_cache_property  *pfn_function;
+    size_t                   begin, end;
+};
+
+struct hash_table_build_task_s
+{
+    hash_table   *p_hash_table;
+    void *const  *pp_properties;
+    hash64       *p_hashes;
+    void        **pp_partitioned;
+    hash64       *p_partitioned_hashes;
+    size_t       *p_offsets,
+                 *p_overflow;
+    size_t        begin, end,
+                  thread, nthreads,
+                  partition_bits, partitions;
+};
+
+// Type definitions
+typedef struct hash_table_pool_s          hash_table_pool;
+typedef struct hash_table_parallel_task_s hash_table_parallel_task;
+typedef struct hash_table_build_task_s    hash_table_build_task;
+
+// Data
+static hash_table_pool _pool =
+{
+    ._run   = PTHREAD_MUTEX_INITIALIZER,
+    ._mutex = PTHREAD_MUTEX_INITIALIZER,
+    ._start = PTHREAD_COND_INITIALIZER,
+    ._done  = PTHREAD_COND_INITIALIZER
+};
+
 // Function declarations
+/** !
+ * Compute the home slot of a hash. The home slot is monotonic in the hash, 
+ * so hashes that share their high bits have neighboring home slots.
+ * 
+ * @param p_hash_table the hash table
+ * @param h            the hash
+ * 
+ * @return the index of the home slot
+ */
+static inline size_t hash_table_home ( const hash_table *const p_hash_table, hash64 h )
+{
+
+    // The high word of the 128 bit product ...
+    #if defined(__SIZEOF_INT128__)
+
+        // Success
+        return (size_t) (((unsigned __int128) h * p_hash_table->properties.max) >> 64);
+    #elif defined(_MSC_VER) && ( defined(_M_X64) || defined(_M_ARM64) )
+
+        // Success
+        return (size_t) __umulh(h, (unsigned long long) p_hash_table->properties.max);
+    #else
+
+        // ... from 32 bit halves, where there's no 128 bit multiply
+        unsigned long long m      = (unsigned long long) p_hash_table->properties.max,
+                           lo_lo  = ( h & 0xFFFFFFFF ) * ( m & 0xFFFFFFFF ),
+                           hi_lo  = ( h >> 32 )        * ( m & 0xFFFFFFFF ),
+                           lo_hi  = ( h & 0xFFFFFFFF ) * ( m >> 32 ),
+                           hi_hi  = ( h >> 32 )        * ( m >> 32 ),
+                           middle = ( lo_lo >> 32 ) + ( hi_lo & 0xFFFFFFFF ) + lo_hi;
+
+        // Success
+        return (size_t) ( hi_hi + ( hi_lo >> 32 ) + ( middle >> 32 ) );
+    #endif
+}
+
+/** !
+ * Store a property in the first empty slot at or after its home slot
+ * 
+ * @param p_hash_table the hash table
+ * @param p_property   the property
+ * @param h            the hash of the key of the property
+ * 
+ * @return 1 on success, 0 if the hash table is full
+ */
+static int hash_table_place ( hash_table *const p_hash_table, void *const p_property, hash64 h );
+
+/** !
+ * Allocate zeroed memory for slots, either mapped or from the allocator.
+ * The hash of each slot's key follows the slots.
+ * 
+ * @param p_hash_table the hash table
+ * @param size         the quantity of slots
+ * 
+ * @return pointer to the slots on success, null pointer on error
+ */
+static void **hash_table_slots_allocate ( hash_table *const p_hash_table, size_t size );
+
+/** !
+ * Free slots allocated by hash_table_slots_allocate
+ * 
+ * @param p_hash_table the hash table
+ * @param pp_data      the slots
+ * 
+ * @return 1 on success, 0 on error
+ */
+static int hash_table_slots_free ( hash_table *const p_hash_table, void **pp_data );
+
+/** !
+ * Run a worker function on each task, on a pool of threads that lives as 
+ * long as the process. The pool grows to nthreads - 1 threads, up to 
+ * HASH_TABLE_WORKERS_MAX, on first use, and is reused by later runs. The
+ * calling thread takes tasks too. If another run holds the pool, or no
+ * thread can start, the calling thread runs every task itself.
+ * 
+ * @param pfn_worker the worker function
+ * @param p_tasks    the tasks
+ * @param task_size  the size of a task in bytes
+ * @param nthreads   the quantity of tasks
+ * 
+ * @return void
+ */
+static void hash_table_run_workers ( void *(*pfn_worker)(void *), void *p_tasks, size_t task_size, size_t nthreads );
+
+/** !
+ * Take tasks from the current run of the pool until none are left. The
+ * caller holds the pool's mutex.
+ * 
+ * @param void
+ * 
+ * @return void
+ */
+static void hash_table_pool_drain ( void );
+
+/** !
+ * Wait for each run of the pool, and take its tasks
+ * 
+ * @param p_unused unused
+ * 
+ * @return null pointer
+ */
+static void *hash_table_pool_worker ( void *p_unused );
+
+/** !
+ * Call a function on each property in a chunk of slots
+ * 
+ * @param p_task the chunk
+ * 
+ * @return null pointer
+ */
+static void *hash_table_for_each_worker ( void *p_task );
+
+/** !
+ * Hash a chunk of the input, and count the properties in each partition
+ * 
+ * @param p_task the chunk
+ * 
+ * @return null pointer
+ */
+static void *hash_table_build_histogram_worker ( void *p_task );
+
+/** !
+ * Copy a chunk of the input into the partitions
+ * 
+ * @param p_task the chunk
+ * 
+ * @return null pointer
+ */
+static void *hash_table_build_scatter_worker ( void *p_task );
+
+/** !
+ * Store the properties of each partition owned by a thread in the partition's
+ * range of slots. Properties that run off the end of the range are moved to 
+ * the front of the partition, and left for the caller.
+ * 
+ * @param p_task the thread
+ * 
+ * @return null pointer
+ */
+static void *hash_table_build_place_worker ( void *p_task );
+
 /** !
  * Is an integer a prime number?
  * 
@@ -47,6 +249,11 @@ int hash_table_create ( hash_table **const pp_hash_table )
     // Initialize memory
     memset(p_hash_table, 0, sizeof(hash_table));
 
+    // Allocate the counters
+    #ifdef HASH_CACHE_STATS
+        if ( hash_cache_counters_construct(&p_hash_table->p_counters) == 0 ) goto failed_to_allocate_counters;
+    #endif
+
     // Return a pointer to the caller
     *pp_hash_table = p_hash_table;
 
@@ -67,6 +274,22 @@ int hash_table_create ( hash_table **const pp_hash_table )
                 return 0;
         }
 
+        // Hash table errors
+        {
+            #ifdef HASH_CACHE_STATS
+            failed_to_allocate_counters:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Failed to allocate counters in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the hash table
+                p_hash_table = HASH_CACHE_REALLOC(p_hash_table, 0);
+
+                // Error
+                return 0;
+            #endif
+        }
+
         // Standard library errors
         {
             no_mem:
@@ -80,22 +303,82 @@ int hash_table_create ( hash_table **const pp_hash_table )
     }
 }
 
-int hash_table_construct ( hash_table **const pp_hash_table, size_t size )
+int hash_table_construct (
+    hash_table                 **const pp_hash_table,
+    size_t                             size,
+    fn_hash_cache_equality            *pfn_equality,
+    fn_hash_cache_key_accessor        *pfn_key_get,
+    fn_hash_cache_key_hash            *pfn_key_hash
+)
+{
+
+    // Initialized data
+    hash_table_options _options =
+    {
+        .pfn_equality = pfn_equality,
+        .pfn_key_get  = pfn_key_get,
+        .pfn_key_hash = pfn_key_hash
+    };
+
+    // Success
+    return hash_table_construct_options(pp_hash_table, size, &_options);
+}
+
+int hash_table_construct_options ( hash_table **const pp_hash_table, size_t size, const hash_table_options *const p_options )
 {
 
     // Argument check
     if ( pp_hash_table == (void *) 0 ) goto no_hash_table;
+    if ( size          ==          0 ) goto invalid_size;
 
     // Initialized data
-    hash_table *p_hash_table = (void *) 0;
+    hash_table           *p_hash_table = (void *) 0;
+    hash_table_options    _options     = ( p_options ) ? *p_options : (hash_table_options) { 0 };
+    hash_cache_allocator *p_allocator  = ( _options.p_allocator ) ? _options.p_allocator : &hash_cache_heap_allocator;
 
-    // Unused
-    (void)size;
+    // Claim the allocator. The hash table rewinds an arena when it's destroyed
+    if ( hash_cache_allocator_acquire(p_allocator) == 0 ) goto allocator_owned;
 
     // Allocate memory for a hash table
     if ( hash_table_create(&p_hash_table) == 0 ) goto failed_to_allocate_hash_table;
 
-    //
+    // Store the size
+    p_hash_table->properties.max = size;
+
+    // Set the equality function
+    p_hash_table->pfn_equality = _options.pfn_equality ? _options.pfn_equality : (fn_hash_cache_equality *) hash_cache_equals;
+
+    // Set the key getter function
+    p_hash_table->pfn_key_get = _options.pfn_key_get ? _options.pfn_key_get : (fn_hash_cache_key_accessor *) hash_cache_key_accessor;
+
+    // Set the key hashing function
+    p_hash_table->pfn_key_hash = _options.pfn_key_hash ? _options.pfn_key_hash : (fn_hash_cache_key_hash *) hash_cache_key_hash;
+
+    // Store the allocator
+    p_hash_table->allocator.p_allocator = p_allocator;
+
+    // Mark the start of the hash table's allocations
+    if ( p_allocator->pfn_mark ) p_hash_table->allocator.begin = p_allocator->pfn_mark(p_allocator);
+
+    // Store the huge page options
+    p_hash_table->allocator.mapped   = ( _options.huge_pages ) ? ( sizeof(void *) + sizeof(hash64) ) * size : 0;
+    p_hash_table->allocator.prefault = _options.prefault;
+
+    // Allocate memory for the slots
+    p_hash_table->properties.pp_data = hash_table_slots_allocate(p_hash_table, size);
+
+    // Error check
+    if ( p_hash_table->properties.pp_data == (void *) 0 ) goto no_mem;
+
+    // The hashes follow the slots
+    p_hash_table->properties.p_hashes = (hash64 *) ( p_hash_table->properties.pp_data + size );
+
+    // Construct a bloom filter
+    if ( _options.bloom )
+        if ( hash_cache_bloom_construct(&p_hash_table->p_bloom, _options.bloom) == 0 ) goto failed_to_construct_bloom;
+
+    // Return a pointer to the caller
+    *pp_hash_table = p_hash_table;
 
     // Success
     return 1;
@@ -110,109 +393,200 @@ int hash_table_construct ( hash_table **const pp_hash_table, size_t size )
                     log_error("[hash cache] [hash table] Null pointer provided for parameter \"pp_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
+                // Error
+                return 0;
+
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Parameter \"size\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
                 // Error
                 return 0;
         }
 
         // Hash table errors
         {
+            allocator_owned:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] The allocator is in use by another cache or hash table in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
             failed_to_allocate_hash_table:
                 #ifndef NDEBUG
                     log_error("[hash cache] [hash table] Failed to allocate memory for hash table in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
+                // Release the allocator
+                hash_cache_allocator_release(p_allocator);
+
+                // Error
+                return 0;
+
+            failed_to_construct_bloom:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Failed to construct bloom filter in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the hash table
+                hash_table_destroy(&p_hash_table, (void *) 0);
+
                 // Error
                 return 0;
         }
 
-        // // Standard library errors
-        // {
-        //     no_mem:
-        //         #ifndef NDEBUG
-        //             log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
-        //         #endif
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the counters
+                hash_cache_counters_destroy(&p_hash_table->p_counters);
 
-        //         // Error
-        //         return 0;
-        // }
+                // Free the hash table
+                p_hash_table = HASH_CACHE_REALLOC(p_hash_table, 0);
+
+                // Release the allocator
+                hash_cache_allocator_release(p_allocator);
+
+                // Error
+                return 0;
+        }
     }
 }
 
-int hash_table_search ( hash_table *const p_hash_table, void *p_key, void **pp_value )
+int hash_table_build_parallel ( hash_table *const p_hash_table, void *const *const pp_properties, size_t n, size_t nthreads )
 {
 
+    // Argument check
+    if ( p_hash_table  == (void *) 0 ) goto no_hash_table;
+    if ( pp_properties == (void *) 0 ) goto no_properties;
+    if ( nthreads      ==          0 ) goto invalid_nthreads;
+
+    // State check
+    if ( p_hash_table->properties.count != 0                    ) goto hash_table_not_empty;
+    if ( n                              > p_hash_table->properties.max ) goto hash_table_full;
+
     // Initialized data
-    size_t i = 0, q = 0;
+    size_t                 partition_bits = 0,
+                           partitions     = 1,
+                           placed         = 0;
+    hash64                *p_hashes             = HASH_CACHE_REALLOC(0, sizeof(hash64) * (n + 1)),
+                          *p_partitioned_hashes = HASH_CACHE_REALLOC(0, sizeof(hash64) * (n + 1));
+    void                 **pp_partitioned       = HASH_CACHE_REALLOC(0, sizeof(void *) * (n + 1));
+    hash_table_build_task *p_tasks              = HASH_CACHE_REALLOC(0, sizeof(hash_table_build_task) * nthreads);
+    size_t                *p_offsets            = (void *) 0,
+                          *p_overflow           = (void *) 0;
+
+    // Use at least one partition per thread
+    while ( partitions < nthreads ) partitions <<= 1, partition_bits++;
+
+    // Allocate memory for the histograms
+    p_offsets  = HASH_CACHE_REALLOC(0, sizeof(size_t) * (nthreads * partitions + partitions + 1));
+    p_overflow = HASH_CACHE_REALLOC(0, sizeof(size_t) * partitions * 2);
 
-    // Repeat this block
-    do 
+    // Error check
+    if ( p_hashes       == (void *) 0 ) goto no_mem;
+    if ( pp_partitioned == (void *) 0 ) goto no_mem;
+    if ( p_tasks        == (void *) 0 ) goto no_mem;
+    if ( p_offsets      == (void *) 0 ) goto no_mem;
+    if ( p_overflow     == (void *) 0 ) goto no_mem;
+    if ( p_partitioned_hashes == (void *) 0 ) goto no_mem;
+
+    // Initialize the histograms
+    memset(p_offsets, 0, sizeof(size_t) * (nthreads * partitions + partitions + 1));
+    memset(p_overflow, 0, sizeof(size_t) * partitions * 2);
+
+    // Split the input into equal chunks
+    for (size_t i = 0; i < nthreads; i++)
+        p_tasks[i] = (hash_table_build_task)
+        {
+            .p_hash_table         = p_hash_table,
+            .pp_properties        = pp_properties,
+            .p_hashes             = p_hashes,
+            .pp_partitioned       = pp_partitioned,
+            .p_partitioned_hashes = p_partitioned_hashes,
+            .p_offsets            = p_offsets,
+            .p_overflow           = p_overflow,
+            .begin                = n * i / nthreads,
+            .end                  = n * (i + 1) / nthreads,
+            .thread               = i,
+            .nthreads             = nthreads,
+            .partition_bits       = partition_bits,
+            .partitions           = partitions
+        };
+
+    // Hash the input, and count the size of each partition
+    hash_table_run_workers(hash_table_build_histogram_worker, p_tasks, sizeof(hash_table_build_task), nthreads);
+
+    // Compute where each thread writes each partition
+    for (size_t p = 0, offset = 0; p < partitions; p++)
     {
 
-        // Compute the hash
-        q = p_hash_table->pfn_hash_function(p_key, p_hash_table->properties.length,i);
+        // Store the start of the partition
+        p_offsets[nthreads * partitions + p] = offset;
 
-        // If there is a property stored in this slot ...
-        if ( p_hash_table->properties.pp_data[q] != (void *) 0 ) 
+        // Store the start of each thread's share of the partition
+        for (size_t t = 0; t < nthreads; t++)
         {
 
-            // ... and the property is what the caller asked for ...
-            if ( p_hash_table->pfn_equality(p_hash_table->properties.pp_data[q], p_key) == 0 )
-            {
+            // Initialized data
+            size_t quantity = p_offsets[t * partitions + p];
 
-                // ... return a pointer to the caller 
-                *pp_value = p_hash_table->properties.pp_data[q];
+            // Store the offset
+            p_offsets[t * partitions + p] = offset;
 
-                // Success
-                return 1;
-            }
+            // Advance
+            offset += quantity;
         }
     }
 
-    // Continuation condition
-    while ( p_hash_table->properties.pp_data[q] != (void *) 0 && i != p_hash_table->properties.max );
+    // Store the end of the last partition
+    p_offsets[nthreads * partitions + partitions] = n;
 
-    // Error
-    return 0;
+    // Scatter the input into the partitions
+    hash_table_run_workers(hash_table_build_scatter_worker, p_tasks, sizeof(hash_table_build_task), nthreads);
 
-}
+    // Fill each partition's range of slots
+    hash_table_run_workers(hash_table_build_place_worker, p_tasks, sizeof(hash_table_build_task), nthreads);
 
-int hash_table_insert ( hash_table *const p_hash_table, void *property )
-{
+    // Count the properties that were placed in parallel
+    for (size_t p = 0; p < partitions; p++) placed += p_overflow[partitions + p];
 
-    // Argument check
-    if ( p_hash_table == (void *) 0 ) goto no_hash_table;
-    
-    // Initialized data
-    size_t i = 0;
+    // Store the count
+    p_hash_table->properties.count += placed;
 
-    // Repeat this block
-    do
+    // Each partition keeps the properties that ran off the end of its range at its front
+    for (size_t p = 0; p < partitions; p++)
     {
-        
+
         // Initialized data
-        size_t q = p_hash_table->pfn_hash_function(p_hash_table->pfn_key_get(property), p_hash_table->properties.length, i);
+        size_t begin = p_offsets[nthreads * partitions + p];
 
-        // If this slot is empty ...
-        if ( p_hash_table->properties.pp_data[q] == (void *) 0 )
-        {
+        // Store each property with the serial probe sequence. This can't fail, because n <= max
+        for (size_t i = 0; i < p_overflow[p]; i++)
+            (void) hash_table_place(p_hash_table, pp_partitioned[begin + i], p_partitioned_hashes[begin + i]);
+    }
 
-            // ... store the property ...
-            p_hash_table->properties.pp_data[q] = property;
+    // Count the inserts
+    HASH_CACHE_COUNT(p_hash_table->p_counters, inserts, n);
 
-            // Success
-            return 1;
-        }
+    // Clean up
+    p_hashes             = HASH_CACHE_REALLOC(p_hashes, 0);
+    p_partitioned_hashes = HASH_CACHE_REALLOC(p_partitioned_hashes, 0);
+    pp_partitioned       = HASH_CACHE_REALLOC(pp_partitioned, 0);
+    p_tasks              = HASH_CACHE_REALLOC(p_tasks, 0);
+    p_offsets            = HASH_CACHE_REALLOC(p_offsets, 0);
+    p_overflow           = HASH_CACHE_REALLOC(p_overflow, 0);
+
+    // Success
+    return 1;
 
-        // Increment the counter
-        i++;
-    }
-    
-    // Continuation condition
-    while (i != p_hash_table->properties.max);
-        
-    // Error
-    return 0;
-    
     // Error handling
     {
 
@@ -223,35 +597,119 @@ int hash_table_insert ( hash_table *const p_hash_table, void *property )
                     log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
+                // Error
+                return 0;
+
+            no_properties:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"pp_properties\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_nthreads:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Parameter \"nthreads\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash table errors
+        {
+            hash_table_not_empty:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Hash table must be empty in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            hash_table_full:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Hash table is full in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                p_hashes             = HASH_CACHE_REALLOC(p_hashes, 0);
+                p_partitioned_hashes = HASH_CACHE_REALLOC(p_partitioned_hashes, 0);
+                pp_partitioned       = HASH_CACHE_REALLOC(pp_partitioned, 0);
+                p_tasks              = HASH_CACHE_REALLOC(p_tasks, 0);
+                p_offsets            = HASH_CACHE_REALLOC(p_offsets, 0);
+                p_overflow           = HASH_CACHE_REALLOC(p_overflow, 0);
+
                 // Error
                 return 0;
         }
     }
 }
 
-int hash_table_for_i ( const hash_table *const p_hash_table, fn_hash_cache_property_i pfn_function )
+int hash_table_search ( hash_table *const p_hash_table, void *p_key, void **pp_value )
 {
-    
+
     // Argument check
     if ( p_hash_table == (void *) 0 ) goto no_hash_table;
-    if ( pfn_function == (void *) 0 ) goto no_function;
+    if ( p_key        == (void *) 0 ) goto no_key;
+    if ( pp_value     == (void *) 0 ) goto no_value;
 
-    // Iterate through each cell
-    for (size_t i = 0; i < p_hash_table->properties.max; i++)
+    // Initialized data
+    hash64 h = p_hash_table->pfn_key_hash(p_key);
+    size_t q = hash_table_home(p_hash_table, h);
+
+    size_t i = 0,
+           n = p_hash_table->properties.max;
+
+    // The bloom filter resolves most misses with one cache line
+    if ( p_hash_table->p_bloom && hash_cache_bloom_query(p_hash_table->p_bloom, h) == false ) n = 0;
+
+    // Probe each slot, starting at the home slot
+    for (; i < n; i++)
     {
-        
+
         // Initialized data
-        void *p_property = p_hash_table->properties.pp_data[i];
+        void *p_property = p_hash_table->properties.pp_data[q];
 
-        // Skip condition
-        if ( p_property == (void *) 0 ) continue;
+        // An empty slot ends the probe sequence
+        if ( p_property == (void *) 0 ) break;
 
-        // Call the function on this property
-        pfn_function(p_property, i);
+        // If the property is what the caller asked for, comparing the hash first ...
+        if ( p_hash_table->properties.p_hashes[q] == h && p_hash_table->pfn_equality(p_hash_table->pfn_key_get(p_property), p_key) == 0 )
+        {
+
+            // ... count the hit ...
+            HASH_CACHE_COUNT(p_hash_table->p_counters, hits, 1);
+            HASH_CACHE_COUNT(p_hash_table->p_counters, probes, i + 1);
+
+            // ... and return a pointer to the caller 
+            *pp_value = p_property;
+
+            // Success
+            return 1;
+        }
+
+        // Next slot
+        q = ( q + 1 == p_hash_table->properties.max ) ? 0 : q + 1;
     }
-    
-    // Success
-    return 1;
+
+    // Count the miss
+    HASH_CACHE_COUNT(p_hash_table->p_counters, misses, 1);
+    HASH_CACHE_COUNT(p_hash_table->p_counters, probes, i);
+
+    // Miss
+    return 0;
 
     // Error handling
     {
@@ -266,9 +724,17 @@ int hash_table_for_i ( const hash_table *const p_hash_table, fn_hash_cache_prope
                 // Error
                 return 0;
 
-            no_function:
+            no_key:
                 #ifndef NDEBUG
-                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"pfn_function\" in call to function \"%s\"\n", __FUNCTION__);
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"pp_value\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
                 // Error
@@ -277,27 +743,498 @@ int hash_table_for_i ( const hash_table *const p_hash_table, fn_hash_cache_prope
     }
 }
 
-int hash_table_for_each ( const hash_table *const p_hash_table, fn_hash_cache_property pfn_function )
+size_t hash_table_huge_pages ( const hash_table *const p_hash_table )
 {
-    
+
     // Argument check
     if ( p_hash_table == (void *) 0 ) goto no_hash_table;
-    if ( pfn_function == (void *) 0 ) goto no_function;
 
-    // Iterate through each cell
+    // Success
+    return ( p_hash_table->allocator.mapped ) ? hash_cache_pages_huge(p_hash_table->properties.pp_data, p_hash_table->allocator.mapped) : 0;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_hash_table:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_table_stats ( const hash_table *const p_hash_table, hash_cache_stats *const p_stats )
+{
+
+    // Argument check
+    if ( p_hash_table == (void *) 0 ) goto no_hash_table;
+    if ( p_stats      == (void *) 0 ) goto no_stats;
+
+    // State check
+    if ( p_hash_table->p_counters == (void *) 0 ) goto no_statistics;
+
+    // Sum the counters
+    hash_cache_counters_sum(p_hash_table->p_counters, p_stats);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_hash_table:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_stats:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_stats\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash table errors
+        {
+            no_statistics:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] The library was built without HASH_CACHE_STATS in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_table_insert ( hash_table *const p_hash_table, void *property )
+{
+
+    // Argument check
+    if ( p_hash_table == (void *) 0 ) goto no_hash_table;
+    if ( property     == (void *) 0 ) goto no_property;
+
+    // Insert the property
+    if ( hash_table_place(p_hash_table, property, p_hash_table->pfn_key_hash(p_hash_table->pfn_key_get(property))) == 0 ) goto hash_table_full;
+
+    // Count the insert
+    HASH_CACHE_COUNT(p_hash_table->p_counters, inserts, 1);
+
+    // Success
+    return 1;
+    
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_hash_table:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_property:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"property\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash table errors
+        {
+            hash_table_full:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Hash table is full in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_table_upsert ( hash_table *const p_hash_table, void *p_key, fn_hash_cache_upsert_found *pfn_on_found, fn_hash_cache_upsert_create *pfn_on_create, void *p_context )
+{
+
+    // Argument check
+    if ( p_hash_table  == (void *) 0 ) goto no_hash_table;
+    if ( p_key         == (void *) 0 ) goto no_key;
+    if ( pfn_on_create == (void *) 0 ) goto no_create;
+
+    // Initialized data
+    hash64  h       = p_hash_table->pfn_key_hash(p_key);
+    size_t  q       = hash_table_home(p_hash_table, h);
+    bool    absent  = ( p_hash_table->p_bloom && hash_cache_bloom_query(p_hash_table->p_bloom, h) == false );
+    void   *p_value = (void *) 0;
+
+    // Probe each slot, starting at the home slot
+    for (size_t i = 0; i < p_hash_table->properties.max; i++)
+    {
+
+        // Initialized data
+        void *p_property = p_hash_table->properties.pp_data[q];
+
+        // The first empty slot is reserved for the new property
+        if ( p_property == (void *) 0 )
+        {
+
+            // Make the value
+            p_value = pfn_on_create(p_key, p_context);
+
+            // Error check
+            if ( p_value == (void *) 0 ) goto failed_to_create;
+
+            // Store the value and its hash in the reserved slot
+            p_hash_table->properties.pp_data[q]  = p_value;
+            p_hash_table->properties.p_hashes[q] = h;
+
+            // Increment the quantity of properties
+            p_hash_table->properties.count++;
+
+            // Update the bloom filter
+            if ( p_hash_table->p_bloom ) hash_cache_bloom_insert(p_hash_table->p_bloom, h);
+
+            // Count the insert
+            HASH_CACHE_COUNT(p_hash_table->p_counters, inserts, 1);
+
+            // Success
+            return 1;
+        }
+
+        // If the bloom filter can't rule the key out, and the property is what the caller asked for ...
+        if ( absent == false && p_hash_table->properties.p_hashes[q] == h && p_hash_table->pfn_equality(p_hash_table->pfn_key_get(p_property), p_key) == 0 )
+        {
+
+            // ... mutate it in place
+            if ( pfn_on_found ) pfn_on_found(p_property, p_context);
+
+            // Success
+            return 1;
+        }
+
+        // Next slot
+        q = ( q + 1 == p_hash_table->properties.max ) ? 0 : q + 1;
+    }
+
+    // The hash table is full
+    goto hash_table_full;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_hash_table:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_create:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"pfn_on_create\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash table errors
+        {
+            failed_to_create:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Failed to create value in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            hash_table_full:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Hash table is full in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_table_resize ( hash_table *const p_hash_table, size_t size )
+{
+
+    // Argument check
+    if ( p_hash_table == (void *) 0                        ) goto no_hash_table;
+    if ( size         <  p_hash_table->properties.count    ) goto invalid_size;
+    if ( size         ==                                 0 ) goto invalid_size;
+
+    // Initialized data
+    void             **pp_data  = p_hash_table->properties.pp_data;
+    hash64            *p_hashes = p_hash_table->properties.p_hashes;
+    size_t             max      = p_hash_table->properties.max,
+                       mapped   = p_hash_table->allocator.mapped;
+    hash_cache_bloom  *p_bloom  = (void *) 0;
+
+    // Construct a new bloom filter, grown with the slots. It never shrinks
+    if ( p_hash_table->p_bloom )
+    {
+
+        // Initialized data
+        size_t expected = p_hash_table->p_bloom->expected;
+
+        // Scale the expected quantity of properties
+        if ( size > max ) expected = ( expected * size + max - 1 ) / max;
+
+        // Construct the bloom filter
+        if ( hash_cache_bloom_construct(&p_bloom, expected) == 0 ) goto failed_to_construct_bloom;
+    }
+
+    // Allocate memory for the new slots
+    if ( mapped ) p_hash_table->allocator.mapped = ( sizeof(void *) + sizeof(hash64) ) * size;
+    p_hash_table->properties.pp_data = hash_table_slots_allocate(p_hash_table, size);
+
+    // Error check
+    if ( p_hash_table->properties.pp_data == (void *) 0 ) goto no_mem;
+
+    // The hashes follow the slots
+    p_hash_table->properties.p_hashes = (hash64 *) ( p_hash_table->properties.pp_data + size );
+
+    // Swap in the new bloom filter
+    if ( p_bloom ) hash_cache_bloom_destroy(&p_hash_table->p_bloom), p_hash_table->p_bloom = p_bloom;
+
+    // Store the new size
+    p_hash_table->properties.max   = size;
+    p_hash_table->properties.count = 0;
+
+    // Move each property to the new slots, without hashing its key again
+    for (size_t i = 0; i < max; i++)
+        if ( pp_data[i] )
+            (void) hash_table_place(p_hash_table, pp_data[i], p_hashes[i]);
+
+    // Free the old slots
+    if ( mapped ) hash_cache_pages_unmap(pp_data, mapped);
+    else          HASH_CACHE_ALLOCATOR_REALLOC(p_hash_table->allocator.p_allocator, pp_data, 0);
+
+    // Count the resize
+    HASH_CACHE_COUNT(p_hash_table->p_counters, resizes, 1);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_hash_table:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Parameter \"size\" must be at least the quantity of properties, and greater than zero, in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash table errors
+        {
+            failed_to_construct_bloom:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Failed to construct bloom filter in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Restore the old slots
+                p_hash_table->properties.pp_data  = pp_data;
+                p_hash_table->properties.p_hashes = p_hashes;
+                p_hash_table->allocator.mapped    = mapped;
+
+                // Clean up
+                if ( p_bloom ) hash_cache_bloom_destroy(&p_bloom);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_table_for_i ( const hash_table *const p_hash_table, fn_hash_cache_property_i pfn_function )
+{
+    
+    // Argument check
+    if ( p_hash_table == (void *) 0 ) goto no_hash_table;
+    if ( pfn_function == (void *) 0 ) goto no_function;
+
+    // Iterate through each cell
+    for (size_t i = 0; i < p_hash_table->properties.max; i++)
+    {
+        
+        // Initialized data
+        void *p_property = p_hash_table->properties.pp_data[i];
+
+        // Skip condition
+        if ( p_property == (void *) 0 ) continue;
+
+        // Call the function on this property
+        pfn_function(p_property, i);
+    }
+    
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_hash_table:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_function:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"pfn_function\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_table_for_each ( const hash_table *const p_hash_table, fn_hash_cache_property pfn_function )
+{
+    
+    // Argument check
+    if ( p_hash_table == (void *) 0 ) goto no_hash_table;
+    if ( pfn_function == (void *) 0 ) goto no_function;
+
+    // Iterate through each cell
     for (size_t i = 0; i < p_hash_table->properties.max; i++)
     {
         
         // Initialized data
         void *p_property = p_hash_table->properties.pp_data[i];
 
-        // Skip condition
-        if ( p_property == (void *) 0 ) continue;
+        // Skip condition
+        if ( p_property == (void *) 0 ) continue;
+
+        // Call the function on this property
+        pfn_function(p_property);
+    }
+    
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_hash_table:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"p_hash_table\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
 
-        // Call the function on this property
-        pfn_function(p_property);
+                // Error
+                return 0;
+
+            no_function:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Null pointer provided for parameter \"pfn_function\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
     }
-    
+}
+
+int hash_table_for_each_parallel ( const hash_table *const p_hash_table, fn_hash_cache_property pfn_function, size_t nthreads )
+{
+
+    // Argument check
+    if ( p_hash_table == (void *) 0 ) goto no_hash_table;
+    if ( pfn_function == (void *) 0 ) goto no_function;
+    if ( nthreads     ==          0 ) goto invalid_nthreads;
+
+    // Initialized data
+    size_t                    max     = p_hash_table->properties.max;
+    hash_table_parallel_task *p_tasks = (void *) 0;
+
+    // Don't start more threads than there are slots
+    if ( nthreads > max ) nthreads = max;
+
+    // Allocate memory for the tasks
+    p_tasks = HASH_CACHE_REALLOC(0, sizeof(hash_table_parallel_task) * nthreads);
+
+    // Error check
+    if ( p_tasks == (void *) 0 ) goto no_mem;
+
+    // Split the slots into equal chunks
+    for (size_t i = 0; i < nthreads; i++)
+        p_tasks[i] = (hash_table_parallel_task)
+        {
+            .p_hash_table = p_hash_table,
+            .pfn_function = pfn_function,
+            .begin        = max * i / nthreads,
+            .end          = max * (i + 1) / nthreads
+        };
+
+    // Call the function on each chunk
+    hash_table_run_workers(hash_table_for_each_worker, p_tasks, sizeof(hash_table_parallel_task), nthreads);
+
+    // Release the tasks
+    p_tasks = HASH_CACHE_REALLOC(p_tasks, 0);
+
     // Success
     return 1;
 
@@ -319,6 +1256,25 @@ int hash_table_for_each ( const hash_table *const p_hash_table, fn_hash_cache_pr
                     log_error("[hash cache] [hash table] Null pointer provided for parameter \"pfn_function\" in call to function \"%s\"\n", __FUNCTION__);
                 #endif
 
+                // Error
+                return 0;
+
+            invalid_nthreads:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [hash table] Parameter \"nthreads\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
                 // Error
                 return 0;
         }
@@ -331,8 +1287,25 @@ int hash_table_clear ( hash_table *p_hash_table, fn_hash_cache_free *pfn_free )
     // Argument check
     if ( p_hash_table == (void *) 0 ) goto no_hash_table;
 
-    // Unused
-    (void) pfn_free;
+    // Iterate through each slot
+    for (size_t i = 0; i < p_hash_table->properties.max; i++)
+    {
+
+        // Skip empty slots
+        if ( p_hash_table->properties.pp_data[i] == (void *) 0 ) continue;
+
+        // Free the property
+        if ( pfn_free ) pfn_free(p_hash_table->properties.pp_data[i]);
+
+        // Empty the slot
+        p_hash_table->properties.pp_data[i] = (void *) 0;
+    }
+
+    // Clear the property counter
+    p_hash_table->properties.count = 0;
+
+    // Clear the bloom filter
+    if ( p_hash_table->p_bloom ) hash_cache_bloom_clear(p_hash_table->p_bloom);
 
     // Success
     return 1;
@@ -357,10 +1330,36 @@ int hash_table_destroy ( hash_table **const pp_hash_table, fn_hash_cache_free *p
 {
 
     // Argument check
-    if ( pp_hash_table == (void *) 0 ) goto no_hash_table;
+    if ( pp_hash_table  == (void *) 0 ) goto no_hash_table;
+    if ( *pp_hash_table == (void *) 0 ) goto no_hash_table;
 
-    // Unused
-    (void) pfn_free;
+    // Initialized data
+    hash_table *p_hash_table = *pp_hash_table;
+
+    // No more pointer for caller
+    *pp_hash_table = (void *) 0;
+
+    // Free each property
+    if ( pfn_free ) hash_table_clear(p_hash_table, pfn_free);
+
+    // Destroy the bloom filter
+    if ( p_hash_table->p_bloom ) hash_cache_bloom_destroy(&p_hash_table->p_bloom);
+
+    // Free everything allocated after the hash table was created ...
+    if ( p_hash_table->allocator.mapped == 0 && p_hash_table->allocator.p_allocator->pfn_rewind )
+        p_hash_table->allocator.p_allocator->pfn_rewind(p_hash_table->allocator.p_allocator, p_hash_table->allocator.begin);
+
+    // ... or free the slots
+    else if ( hash_table_slots_free(p_hash_table, p_hash_table->properties.pp_data) == 0 ) goto failed_to_free;
+
+    // Release the allocator
+    hash_cache_allocator_release(p_hash_table->allocator.p_allocator);
+
+    // Free the counters
+    hash_cache_counters_destroy(&p_hash_table->p_counters);
+
+    // Free the hash table
+    if ( HASH_CACHE_REALLOC(p_hash_table, 0) ) goto failed_to_free;
 
     // Success
     return 1;
@@ -378,6 +1377,17 @@ int hash_table_destroy ( hash_table **const pp_hash_table, fn_hash_cache_free *p
                 // Error
                 return 0;
         }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
     }
 }
 
@@ -424,4 +1434,345 @@ signed hash_table_positive_mod ( signed dividend, signed divisor )
     return ( quotient < 0 ) ? quotient + divisor : quotient;
 }
 
+static int hash_table_place ( hash_table *const p_hash_table, void *const p_property, hash64 h )
+{
+
+    // Initialized data
+    size_t q = hash_table_home(p_hash_table, h);
+
+    // Probe each slot, starting at the home slot
+    for (size_t i = 0; i < p_hash_table->properties.max; i++)
+    {
+
+        // If this slot is empty ...
+        if ( p_hash_table->properties.pp_data[q] == (void *) 0 )
+        {
+
+            // ... store the property and its hash ...
+            p_hash_table->properties.pp_data[q]  = p_property;
+            p_hash_table->properties.p_hashes[q] = h;
+
+            // ... and increment the quantity of properties
+            p_hash_table->properties.count++;
+
+            // Update the bloom filter
+            if ( p_hash_table->p_bloom ) hash_cache_bloom_insert(p_hash_table->p_bloom, h);
+
+            // Success
+            return 1;
+        }
+
+        // Next slot
+        q = ( q + 1 == p_hash_table->properties.max ) ? 0 : q + 1;
+    }
+
+    // Error
+    return 0;
+}
+
+static void **hash_table_slots_allocate ( hash_table *const p_hash_table, size_t size )
+{
+
+    // Initialized data
+    void **pp_data = (void *) 0;
+
+    // Map the slots, which start zeroed
+    if ( p_hash_table->allocator.mapped ) return hash_cache_pages_map(( sizeof(void *) + sizeof(hash64) ) * size, p_hash_table->allocator.prefault);
+
+    // Allocate memory for the slots and their hashes
+    pp_data = HASH_CACHE_ALLOCATOR_REALLOC(p_hash_table->allocator.p_allocator, 0, ( sizeof(void *) + sizeof(hash64) ) * size);
+
+    // Error check
+    if ( pp_data == (void *) 0 ) return (void *) 0;
+
+    // Every slot starts empty
+    memset(pp_data, 0, ( sizeof(void *) + sizeof(hash64) ) * size);
+
+    // Success
+    return pp_data;
+}
+
+static int hash_table_slots_free ( hash_table *const p_hash_table, void **pp_data )
+{
+
+    // Unmap the slots ...
+    if ( p_hash_table->allocator.mapped ) return hash_cache_pages_unmap(pp_data, p_hash_table->allocator.mapped);
+
+    // ... or free the slots
+    return ( HASH_CACHE_ALLOCATOR_REALLOC(p_hash_table->allocator.p_allocator, pp_data, 0) == (void *) 0 );
+}
+
+static void hash_table_run_workers ( void *(*pfn_worker)(void *), void *p_tasks, size_t task_size, size_t nthreads )
+{
+
+    // If another run holds the pool ...
+    if ( pthread_mutex_trylock(&_pool._run) )
+    {
+
+        // ... do every task on this thread
+        for (size_t i = 0; i < nthreads; i++) pfn_worker((char *)p_tasks + i * task_size);
+
+        // Done
+        return;
+    }
+
+    // Lock the pool
+    pthread_mutex_lock(&_pool._mutex);
+
+    // Grow the pool to a thread per task, except the first
+    while ( _pool.workers + 1 < nthreads && _pool.workers < HASH_TABLE_WORKERS_MAX )
+    {
+
+        // Initialized data
+        pthread_t _thread;
+
+        // Start a worker. A task whose worker can't start runs on this thread
+        if ( pthread_create(&_thread, NULL, hash_table_pool_worker, (void *) 0) ) break;
+
+        // The worker lives as long as the process
+        pthread_detach(_thread);
+        _pool.workers++;
+    }
+
+    // Store the run
+    _pool.pfn_worker = pfn_worker;
+    _pool.p_tasks    = p_tasks;
+    _pool.task_size  = task_size;
+    _pool.quantity   = nthreads;
+    _pool.next       = 0;
+    _pool.finished   = 0;
+
+    // Start the run
+    _pool.generation++;
+    pthread_cond_broadcast(&_pool._start);
+
+    // Take tasks on this thread
+    hash_table_pool_drain();
+
+    // Wait for the workers to finish their tasks
+    while ( _pool.finished < _pool.quantity ) pthread_cond_wait(&_pool._done, &_pool._mutex);
+
+    // Unlock the pool
+    pthread_mutex_unlock(&_pool._mutex);
+
+    // Release the pool
+    pthread_mutex_unlock(&_pool._run);
+
+    // Done
+    return;
+}
+
+static void hash_table_pool_drain ( void )
+{
+
+    // Take tasks until none are left
+    while ( _pool.next < _pool.quantity )
+    {
+
+        // Initialized data
+        void *p_task = (char *)_pool.p_tasks + _pool.next++ * _pool.task_size;
+
+        // Do the task without the lock
+        pthread_mutex_unlock(&_pool._mutex);
+        _pool.pfn_worker(p_task);
+        pthread_mutex_lock(&_pool._mutex);
+
+        // The last task ends the run
+        if ( ++_pool.finished == _pool.quantity ) pthread_cond_signal(&_pool._done);
+    }
+
+    // Done
+    return;
+}
+
+static void *hash_table_pool_worker ( void *p_unused )
+{
+
+    // Initialized data
+    size_t generation = 0;
+
+    // Unused
+    (void) p_unused;
+
+    // Lock the pool
+    pthread_mutex_lock(&_pool._mutex);
+
+    // The worker was started for the current run
+    generation = _pool.generation;
+    hash_table_pool_drain();
+
+    // Wait for each run, and help with it
+    for (;;)
+    {
+
+        // Wait for the next run
+        while ( _pool.generation == generation ) pthread_cond_wait(&_pool._start, &_pool._mutex);
+
+        // Take tasks from the run
+        generation = _pool.generation;
+        hash_table_pool_drain();
+    }
+
+    // Done
+    return (void *) 0;
+}
+
+static void *hash_table_for_each_worker ( void *p_task )
+{
+
+    // Initialized data
+    hash_table_parallel_task *p_parallel_task = p_task;
+    void **pp_data = p_parallel_task->p_hash_table->properties.pp_data;
+
+    // Iterate through each slot in the chunk
+    for (size_t i = p_parallel_task->begin; i < p_parallel_task->end; i++)
+    {
+
+        // Skip condition
+        if ( pp_data[i] == (void *) 0 ) continue;
+
+        // Call the function on this property
+        p_parallel_task->pfn_function(pp_data[i]);
+    }
+
+    // Done
+    return (void *) 0;
+}
+
+/** !
+ * Compute the partition of a hash from its high bits
+ * 
+ * @param p_build_task the build task
+ * @param h            the hash
+ * 
+ * @return the partition
+ */
+static inline size_t hash_table_partition ( const hash_table_build_task *const p_build_task, hash64 h )
+{
+
+    // Success
+    return ( p_build_task->partition_bits ) ? (size_t) (h >> (64 - p_build_task->partition_bits)) : 0;
+}
+
+/** !
+ * Compute the first slot in a partition's range of slots
+ * 
+ * @param p_build_task the build task
+ * @param partition    the partition
+ * 
+ * @return the index of the first slot
+ */
+static inline size_t hash_table_partition_begin ( const hash_table_build_task *const p_build_task, size_t partition )
+{
+
+    // The last partition ends at the end of the slots
+    if ( partition == p_build_task->partitions ) return p_build_task->p_hash_table->properties.max;
+
+    // Success
+    return ( p_build_task->partition_bits ) ? hash_table_home(p_build_task->p_hash_table, (hash64) partition << (64 - p_build_task->partition_bits)) : 0;
+}
+
+static void *hash_table_build_histogram_worker ( void *p_task )
+{
+
+    // Initialized data
+    hash_table_build_task *p_build_task = p_task;
+    hash_table            *p_hash_table = p_build_task->p_hash_table;
+    size_t                *p_histogram  = &p_build_task->p_offsets[p_build_task->thread * p_build_task->partitions];
+
+    // Iterate through the chunk
+    for (size_t i = p_build_task->begin; i < p_build_task->end; i++)
+    {
+
+        // Hash the key
+        p_build_task->p_hashes[i] = p_hash_table->pfn_key_hash(p_hash_table->pfn_key_get(p_build_task->pp_properties[i]));
+
+        // Count the property
+        p_histogram[hash_table_partition(p_build_task, p_build_task->p_hashes[i])]++;
+    }
+
+    // Done
+    return (void *) 0;
+}
+
+static void *hash_table_build_scatter_worker ( void *p_task )
+{
+
+    // Initialized data
+    hash_table_build_task *p_build_task = p_task;
+    size_t                *p_offsets    = &p_build_task->p_offsets[p_build_task->thread * p_build_task->partitions];
+
+    // Iterate through the chunk
+    for (size_t i = p_build_task->begin; i < p_build_task->end; i++)
+    {
+
+        // Initialized data
+        size_t j = p_offsets[hash_table_partition(p_build_task, p_build_task->p_hashes[i])]++;
+
+        // Copy the property into its partition
+        p_build_task->pp_partitioned[j]       = p_build_task->pp_properties[i];
+        p_build_task->p_partitioned_hashes[j] = p_build_task->p_hashes[i];
+    }
+
+    // Done
+    return (void *) 0;
+}
+
+static void *hash_table_build_place_worker ( void *p_task )
+{
+
+    // Initialized data
+    hash_table_build_task *p_build_task = p_task;
+    void                 **pp_data      = p_build_task->p_hash_table->properties.pp_data;
+    hash64                *p_hashes     = p_build_task->p_hash_table->properties.p_hashes;
+    const size_t          *p_partition  = &p_build_task->p_offsets[p_build_task->nthreads * p_build_task->partitions];
+
+    // Iterate through each partition owned by this thread
+    for (size_t p = p_build_task->thread; p < p_build_task->partitions; p += p_build_task->nthreads)
+    {
+
+        // Initialized data
+        size_t end      = hash_table_partition_begin(p_build_task, p + 1),
+               overflow = 0,
+               placed   = 0;
+
+        // Iterate through the partition
+        for (size_t i = p_partition[p]; i < p_partition[p + 1]; i++)
+        {
+
+            // Initialized data
+            void   *p_property = p_build_task->pp_partitioned[i];
+            hash64  h          = p_build_task->p_partitioned_hashes[i];
+            size_t  q          = hash_table_home(p_build_task->p_hash_table, h);
+
+            // Probe the slots in this partition's range
+            while ( q < end && pp_data[q] ) q++;
+
+            // Store the property ...
+            if ( q < end )
+            {
+
+                // Store the property and its hash
+                pp_data[q] = p_property, p_hashes[q] = h, placed++;
+
+                // Update the bloom filter, which is shared between threads
+                if ( p_build_task->p_hash_table->p_bloom ) hash_cache_bloom_insert_atomic(p_build_task->p_hash_table->p_bloom, h);
+            }
+
+            // ... or leave it at the front of the partition for the caller
+            else
+            {
+                p_build_task->pp_partitioned[p_partition[p] + overflow]       = p_property;
+                p_build_task->p_partitioned_hashes[p_partition[p] + overflow] = h;
+                overflow++;
+            }
+        }
+
+        // Store the results
+        p_build_task->p_overflow[p]                            = overflow;
+        p_build_task->p_overflow[p_build_task->partitions + p] = placed;
+    }
 
+    // Done
+    return (void *) 0;
+}
@@ -0,0 +1,222 @@
+/** !
+ * Header for pluggable allocators
+ *
+ * @file hash_cache/allocator.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+
+// Preprocessor definitions
+#define HASH_CACHE_ALLOCATOR_ALIGNMENT 16
+#define HASH_CACHE_SLAB_THREAD_CACHES  8
+#define HASH_CACHE_SLAB_THREAD_MAX     64
+#define HASH_CACHE_HUGE_PAGE_SIZE      ( 2 * 1024 * 1024 )
+
+// Memory management macro
+#define HASH_CACHE_ALLOCATOR_REALLOC(p_allocator, p, sz) (p_allocator)->pfn_realloc((p_allocator), (p), (sz))
+
+// Structure declarations
+struct hash_cache_allocator_s;
+struct hash_cache_arena_s;
+struct hash_cache_slab_s;
+struct hash_cache_slab_thread_cache_s;
+
+// Type definitions
+typedef struct hash_cache_allocator_s hash_cache_allocator;
+typedef struct hash_cache_arena_s     hash_cache_arena;
+typedef struct hash_cache_slab_s      hash_cache_slab;
+
+typedef void  *(fn_hash_cache_allocator_realloc) ( hash_cache_allocator *const p_allocator, void *p, size_t size );
+typedef size_t (fn_hash_cache_allocator_mark)    ( hash_cache_allocator *const p_allocator );
+typedef void   (fn_hash_cache_allocator_rewind)  ( hash_cache_allocator *const p_allocator, size_t mark );
+
+// Structure definitions
+struct hash_cache_allocator_s
+{
+    fn_hash_cache_allocator_realloc *pfn_realloc; // Same semantics as realloc. A size of zero frees
+    fn_hash_cache_allocator_mark    *pfn_mark;    // Optional. Remember the current position
+    fn_hash_cache_allocator_rewind  *pfn_rewind;  // Optional. Free everything allocated after a mark
+    bool                             owned;       // Set while a structure that rewinds the allocator uses it
+};
+
+struct hash_cache_arena_s
+{
+    hash_cache_allocator  _allocator;
+    unsigned char        *p_base;
+    size_t                size, offset, last;
+};
+
+struct hash_cache_slab_s
+{
+    hash_cache_allocator   _allocator;
+    spinlock               _lock;
+    void                  *p_free;
+    void                 **pp_blocks;
+    size_t                 object_size, objects_per_block,
+                           blocks, blocks_max;
+    struct hash_cache_slab_thread_cache_s *p_caches; // The thread caches that hold the slab's objects
+};
+
+// Data
+extern hash_cache_allocator hash_cache_heap_allocator;
+
+// Function declarations
+
+// Arena
+/** !
+ * Construct a bump arena. Allocations are O(1) and are never freed
+ * individually. Everything after a mark is freed in O(1) by a rewind. A
+ * cache or a hash table rewinds its arena, so an arena backs at most one
+ * of them at a time.
+ *
+ * @param pp_arena result
+ * @param size     the capacity of the arena in bytes
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_arena_construct ( hash_cache_arena **const pp_arena, size_t size );
+
+/** !
+ * Allocate memory from an arena
+ *
+ * @param p_arena the arena
+ * @param size    the size of the allocation in bytes
+ *
+ * @return pointer to memory on success, null pointer on error
+ */
+DLLEXPORT void *hash_cache_arena_alloc ( hash_cache_arena *const p_arena, size_t size );
+
+/** !
+ * Free everything in an arena
+ *
+ * @param p_arena the arena
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_arena_reset ( hash_cache_arena *const p_arena );
+
+/** !
+ * Release an arena and all its allocations
+ *
+ * @param pp_arena the arena
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_arena_destroy ( hash_cache_arena **const pp_arena );
+
+// Ownership
+/** !
+ * Claim an allocator for a structure that rewinds it. A rewind frees every
+ * allocation after a mark, including another structure's, so an allocator
+ * that rewinds has one owner at a time. An allocator that can't rewind is
+ * shared freely.
+ *
+ * @param p_allocator the allocator
+ *
+ * @return 1 on success, 0 if another structure owns the allocator
+ */
+DLLEXPORT int hash_cache_allocator_acquire ( hash_cache_allocator *const p_allocator );
+
+/** !
+ * Release an allocator claimed by hash_cache_allocator_acquire
+ *
+ * @param p_allocator the allocator
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_allocator_release ( hash_cache_allocator *const p_allocator );
+
+// Slab
+/** !
+ * Construct a pool of fixed size objects. Each thread keeps a short free
+ * list, so most allocations and frees never touch the shared lock. A thread
+ * keeps free lists for up to HASH_CACHE_SLAB_THREAD_CACHES slabs. Using
+ * another slab returns the objects of the least recently used list to its
+ * slab, and a thread's lists return to their slabs when the thread exits.
+ *
+ * @param pp_slab           result
+ * @param object_size       the size of an object in bytes
+ * @param objects_per_block the quantity of objects to allocate at a time
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_slab_construct ( hash_cache_slab **const pp_slab, size_t object_size, size_t objects_per_block );
+
+/** !
+ * Allocate an object from a slab
+ *
+ * @param p_slab the slab
+ *
+ * @return pointer to an object on success, null pointer on error
+ */
+DLLEXPORT void *hash_cache_slab_alloc ( hash_cache_slab *const p_slab );
+
+/** !
+ * Return an object to a slab
+ *
+ * @param p_slab   the slab
+ * @param p_object the object
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_slab_free ( hash_cache_slab *const p_slab, void *p_object );
+
+/** !
+ * Release a slab and all its objects. No other thread may use the slab
+ * after this call.
+ *
+ * @param pp_slab the slab
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_slab_destroy ( hash_cache_slab **const pp_slab );
+
+// Pages
+/** !
+ * Map memory aligned to a huge page, and ask the kernel to back it with 
+ * transparent huge pages. Pre-faulting moves the page faults out of the 
+ * request path. Falls back to the heap where mmap is unavailable.
+ *
+ * @param size     the size of the mapping in bytes
+ * @param prefault true to fault in every page now, else false
+ *
+ * @return pointer to zeroed memory on success, null pointer on error
+ */
+DLLEXPORT void *hash_cache_pages_map ( size_t size, bool prefault );
+
+/** !
+ * Compute the quantity of bytes in a mapping that are backed by huge pages
+ *
+ * @param p    the mapping
+ * @param size the size of the mapping in bytes
+ *
+ * @return the quantity of bytes backed by huge pages
+ */
+DLLEXPORT size_t hash_cache_pages_huge ( const void *const p, size_t size );
+
+/** !
+ * Unmap memory mapped by hash_cache_pages_map
+ *
+ * @param p    the mapping
+ * @param size the size of the mapping in bytes
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_pages_unmap ( void *p, size_t size );
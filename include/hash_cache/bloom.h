@@ -0,0 +1,107 @@
+/** !
+ * Header for blocked bloom filter
+ *
+ * @file hash_cache/bloom.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+
+// Preprocessor definitions
+#define HASH_CACHE_BLOOM_BITS_PER_KEY 12
+#define HASH_CACHE_BLOOM_BLOCK_WORDS  8
+
+// Structure declarations
+struct hash_cache_bloom_s;
+
+// Type definitions
+typedef struct hash_cache_bloom_s hash_cache_bloom;
+
+// Structure definitions
+struct hash_cache_bloom_s
+{
+    unsigned long long (*p_blocks)[HASH_CACHE_BLOOM_BLOCK_WORDS];
+    void               *p_allocation;
+    size_t              blocks, expected;
+};
+
+// Function declarations
+
+// Constructors
+/** !
+ * Construct a blocked bloom filter. Each key sets one bit in each word of a
+ * single 64 byte block, so every query touches exactly one cache line.
+ *
+ * @param pp_bloom result
+ * @param expected the expected quantity of keys
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_bloom_construct ( hash_cache_bloom **const pp_bloom, size_t expected );
+
+// Accessors
+/** !
+ * Test if a hash may have been inserted into a bloom filter
+ *
+ * @param p_bloom the bloom filter
+ * @param h       the hash of the key
+ *
+ * @return false if the hash was never inserted, true if it may have been
+ */
+DLLEXPORT bool hash_cache_bloom_query ( const hash_cache_bloom *const p_bloom, hash64 h );
+
+// Mutators
+/** !
+ * Insert a hash into a bloom filter
+ *
+ * @param p_bloom the bloom filter
+ * @param h       the hash of the key
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_bloom_insert ( hash_cache_bloom *const p_bloom, hash64 h );
+
+/** !
+ * Insert a hash into a bloom filter that other threads are inserting into
+ *
+ * @param p_bloom the bloom filter
+ * @param h       the hash of the key
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_bloom_insert_atomic ( hash_cache_bloom *const p_bloom, hash64 h );
+
+/** !
+ * Remove every hash from a bloom filter
+ *
+ * @param p_bloom the bloom filter
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_bloom_clear ( hash_cache_bloom *const p_bloom );
+
+// Destructors
+/** !
+ * Release a bloom filter
+ *
+ * @param pp_bloom the bloom filter
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_bloom_destroy ( hash_cache_bloom **const pp_bloom );
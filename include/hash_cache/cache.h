@@ -22,6 +22,10 @@
 // hash cache
 #include <hash_cache/hash_cache.h>
 #include <hash_cache/hash.h>
+#include <hash_cache/allocator.h>
+#include <hash_cache/bloom.h>
+#include <hash_cache/wheel.h>
+#include <hash_cache/mrc.h>
 
 // Platform dependent macros
 #ifdef _WIN64
@@ -35,13 +39,85 @@
 #define HASH_CACHE_REALLOC(p, sz) realloc(p,sz)
 #endif
 
+// Preprocessor definitions
+#define CACHE_NIL   ((size_t) -1)
+#define CACHE_BATCH 64
+#define CACHE_SMALL 256
+#define CACHE_TAGS  32
+
 // Structure declarations
 struct cache_s;
+struct cache_options_s;
+struct cache_node_s;
+struct cache_policy_s;
 
 // Type definitions
-typedef struct cache_s cache;
+typedef struct cache_s         cache;
+typedef struct cache_options_s cache_options;
+typedef struct cache_node_s    cache_node;
+typedef struct cache_policy_s  cache_policy;
+
+typedef int    (fn_cache_policy_construct) ( cache *const p_cache );
+typedef void   (fn_cache_policy_destroy)   ( cache *const p_cache );
+typedef void   (fn_cache_policy_reset)     ( cache *const p_cache );
+typedef void   (fn_cache_policy_hit)       ( cache *const p_cache, size_t slot );
+typedef void   (fn_cache_policy_insert)    ( cache *const p_cache, size_t slot );
+typedef size_t (fn_cache_policy_victim)    ( cache *const p_cache, hash64 h );
+typedef void   (fn_cache_policy_remove)    ( cache *const p_cache, size_t slot );
+typedef size_t (fn_cache_policy_next)      ( const cache *const p_cache, size_t slot );
 
 // Structure definitions
+struct cache_options_s
+{
+    fn_hash_cache_equality     *pfn_equality; // Pointer to a equality function, or 0 for default
+    fn_hash_cache_key_accessor *pfn_key_get;  // Pointer to a key getter, or 0 for key == value
+    fn_hash_cache_key_hash     *pfn_key_hash; // Pointer to a key hashing function, or 0 for default. See below
+    hash_cache_allocator       *p_allocator;  // Pointer to an allocator, or 0 for the heap. An arena backs one cache or hash table at a time
+    bool                        huge_pages;   // Map the slots aligned to huge pages, instead of using the allocator
+    bool                        prefault;     // Fault in the mapped slots during construction
+    size_t                      bloom;        // The expected quantity of properties for a bloom filter, or 0 for none
+    const cache_policy         *p_policy;     // Pointer to an eviction policy, or 0 for LRU
+    fn_hash_cache_evict        *pfn_evict;    // Called with each evicted or replaced value, or 0
+    void                       *p_context;    // Passed to the evict function
+    fn_hash_cache_cost         *pfn_cost;     // The cost of a value inserted without a cost, or 0 for a cost of 1
+    size_t                      budget;       // The maximum total cost of the cache's properties, or 0 for no budget
+    timestamp                   ttl;          // The default time to live, in timer_high_precision units, or 0 for none
+    bool                        expire;       // Track expiration without a default time to live, for cache_insert_ttl
+    size_t                      mrc;          // Estimate the miss ratio curve from one in this many keys, or 0 for none
+};
+
+// The default key hash hashes the address of the key, which only agrees with
+// the default equality function. A cache with a custom equality function and
+// no key hash puts every key in one bucket, so lookups are O(n). A bloom
+// filter or a miss ratio curve estimator requires a key hash.
+
+// A cache of at most CACHE_SMALL properties also keeps a one byte tag of each
+// slot's hash, and searches compare CACHE_TAGS tags at a time with SIMD
+// instructions, instead of walking a bucket. An empty slot's tag is 0.
+
+struct cache_node_s
+{
+    hash64 hash;        // The hash of the key
+    size_t chain;       // The next slot in the same bucket
+    size_t prev, next;  // The neighboring slots in the policy's list
+};
+
+// An eviction policy. The cache owns the slots and the index, and tells the 
+// policy when a slot is hit, filled, or emptied. When the cache is full, the
+// policy picks the victim. Each function runs with the cache's index in a 
+// consistent state. The construct, destroy and reset functions are optional.
+struct cache_policy_s
+{
+    fn_cache_policy_construct *pfn_construct; // Allocate the policy's state
+    fn_cache_policy_destroy   *pfn_destroy;   // Release the policy's state
+    fn_cache_policy_reset     *pfn_reset;     // Forget every slot
+    fn_cache_policy_hit       *pfn_hit;       // A search found the slot
+    fn_cache_policy_insert    *pfn_insert;    // The slot was filled
+    fn_cache_policy_victim    *pfn_victim;    // Pick a slot to evict, to make room for a key with hash h
+    fn_cache_policy_remove    *pfn_remove;    // The slot is about to be emptied
+    fn_cache_policy_next      *pfn_next;      // The slot after a slot, or the first slot after CACHE_NIL
+};
+
 struct cache_s
 {
     struct
@@ -51,8 +127,62 @@ struct cache_s
     } properties;
     fn_hash_cache_equality   *pfn_equality;
     fn_hash_cache_key_accessor *pfn_key_get;
+    fn_hash_cache_key_hash   *pfn_key_hash;
+    struct
+    {
+        size_t        *p_buckets;
+        cache_node    *p_nodes;
+        unsigned char *p_tags;
+        size_t         mask, free;
+    } index;
+    struct
+    {
+        const cache_policy *p_policy;
+        void               *p_state;
+        size_t              head, tail;
+    } policy;
+    struct
+    {
+        fn_hash_cache_evict *pfn_evict;
+        void                *p_context;
+    } evict;
+    struct
+    {
+        fn_hash_cache_cost *pfn_cost;
+        size_t             *p_costs;
+        size_t              used, budget;
+    } cost;
+    struct
+    {
+        hash_cache_wheel *p_wheel;
+        timestamp         ttl;
+    } ttl;
+    struct
+    {
+        hash_cache_bloom *p_bloom;
+        size_t            inserts;
+    } bloom;
+    struct
+    {
+        hash_cache_mrc *p_mrc;
+    } mrc;
+    struct
+    {
+        hash_cache_allocator *p_allocator;
+        size_t                begin, end,
+                              mapped;
+    } allocator;
+    hash_cache_counters *p_counters; // Aligned to a cache line, or 0 if the library doesn't count statistics
 };
 
+// Data
+extern const cache_policy cache_policy_lru;       // Least recently used. Every hit moves the property to the front of a list
+extern const cache_policy cache_policy_clock;     // A hit sets a reference bit. A sweeping hand evicts the first unreferenced property
+extern const cache_policy cache_policy_clock_pro; // CLOCK with hot and cold properties, and an adaptive cold target, for scan resistance
+extern const cache_policy cache_policy_arc;       // Adaptive replacement. Balances recency and frequency lists using ghost lists of evicted hashes
+extern const cache_policy cache_policy_tinylfu;   // W-TinyLFU. A window LRU, and a segmented main LRU guarded by a frequency sketch
+extern const cache_policy cache_policy_s3fifo;    // S3-FIFO. Small, main and ghost FIFO queues. A hit only bumps a 2 bit counter
+
 // Function declarations 
 
 // Allocators
@@ -71,7 +201,7 @@ DLLEXPORT int cache_create ( cache **const pp_cache );
  * 
  * @param pp_cache        result
  * @param size            the maximum quantity of properties the cache can fit
- * @param pfn_equality    pointer to a equality function, or 0 for default
+ * @param pfn_equality    pointer to a equality function, or 0 for default. A custom equality function has no key hash, so lookups are O(n). See cache_construct_options
  * @param pfn_key_get     pointer to a key getter, or 0 for key == value
  * 
  * @return 1 on success, 0 on error
@@ -83,9 +213,24 @@ DLLEXPORT int cache_construct (
     fn_hash_cache_key_accessor    *pfn_key_get
 );
 
+/** !
+ * Construct a cache with options. If the allocator can rewind, clearing 
+ * the cache frees everything allocated from the allocator after the cache
+ * was constructed, and destroying the cache frees everything allocated 
+ * from the allocator after the cache was created, each in O(1).
+ * 
+ * @param pp_cache  result
+ * @param size      the maximum quantity of properties the cache can fit
+ * @param p_options the options, or 0 for defaults
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int cache_construct_options ( cache **const pp_cache, size_t size, const cache_options *const p_options );
+
 // Accessors
 /** !
- * Search a cache for a value using a key
+ * Search a cache for a value using a key. A hit is reported to the 
+ * cache's eviction policy. 
  * 
  * @param p_cache   the cache
  * @param p_key     the key
@@ -93,11 +238,116 @@ DLLEXPORT int cache_construct (
  * 
  * @return 1 on success, 0 on error
  */
-DLLEXPORT int cache_get ( const cache *const p_cache, const void *const p_key, void **const pp_result );
+DLLEXPORT int cache_get ( cache *const p_cache, const void *const p_key, void **const pp_result );
+
+/** !
+ * Search a cache for many keys. Every key of a batch of CACHE_BATCH keys is
+ * hashed, and its bucket prefetched, before the first key is searched, so 
+ * the searches overlap their cache misses. Each hit is reported to the 
+ * cache's eviction policy, as by cache_get.
+ * 
+ * @param p_cache    the cache
+ * @param pp_keys    the keys
+ * @param n          the quantity of keys
+ * @param pp_results return the value of each key, or 0 on miss
+ * @param p_hits     return a bit per key, set on hit, in ( n + 63 ) / 64 words, or 0
+ * 
+ * @return the quantity of hits
+ */
+DLLEXPORT size_t cache_get_many ( cache *const p_cache, const void *const *const pp_keys, size_t n, void **const pp_results, unsigned long long *const p_hits );
+
+/** !
+ * Search a cache for a value using a key. On a miss, the loader makes the
+ * value, whose key must equal the key, and the value is inserted. If the
+ * cache rejects the value, it's passed to the evict function. A cache
+ * isn't shared between threads, so there's never more than one load of a
+ * key in flight. See concurrent_cache_get_or_load.
+ *
+ * @param p_cache    the cache
+ * @param p_key      the key
+ * @param pfn_loader called with the key and the context to load a value on a miss
+ * @param p_context  passed to the loader
+ * @param pp_result  return
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int cache_get_or_load ( cache *const p_cache, const void *const p_key, fn_hash_cache_loader *pfn_loader, void *p_context, void **const pp_result );
+
+/** !
+ * Find the slot of a key without telling the policy, or reclaiming an 
+ * expired property. Every read is a single load, and a chain is walked at 
+ * most once around the cache, so a reader racing a writer gets a wrong 
+ * answer, never a fault. The caller validates the answer, with a sequence 
+ * lock for example.
+ * 
+ * @param p_cache the cache
+ * @param p_key   the key
+ * 
+ * @return the slot of the key, or CACHE_NIL on miss or if the property expired
+ */
+DLLEXPORT size_t cache_lookup ( const cache *const p_cache, const void *const p_key );
+
+/** !
+ * Get the time a slot's property expires. Every read is a single load, like
+ * cache_lookup.
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot, from cache_lookup
+ * 
+ * @return the deadline, or 0 if the property never expires
+ */
+DLLEXPORT timestamp cache_expiry ( const cache *const p_cache, size_t slot );
+
+/** !
+ * Compute the quantity of bytes of a cache's slots that are backed by huge pages
+ * 
+ * @param p_cache the cache
+ * 
+ * @return the quantity of bytes backed by huge pages
+ */
+DLLEXPORT size_t cache_huge_pages ( const cache *const p_cache );
+
+/** !
+ * Compute the total cost of a cache's properties
+ * 
+ * @param p_cache the cache
+ * 
+ * @return the total cost
+ */
+DLLEXPORT size_t cache_cost ( const cache *const p_cache );
+
+/** !
+ * Take a snapshot of a cache's statistics. A cache only counts if the 
+ * library is built with HASH_CACHE_STATS. The searches of cache_get, 
+ * cache_get_many, cache_get_or_load, cache_upsert and cache_lookup count a 
+ * hit or a miss, and their probes. A cache is never resized, so resizes is 
+ * always 0.
+ * 
+ * @param p_cache the cache
+ * @param p_stats return
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int cache_stats ( const cache *const p_cache, hash_cache_stats *const p_stats );
+
+/** !
+ * Estimate the hit ratio an LRU cache would get at half, once, twice, and 
+ * four times the size of a cache, from the sampled keys of cache_get and 
+ * cache_upsert. The cache must estimate the miss ratio curve. 
+ * 
+ * @param p_cache  the cache
+ * @param p_points return, HASH_CACHE_MRC_POINTS points
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int cache_miss_ratio_curve ( const cache *const p_cache, hash_cache_mrc_point *const p_points );
 
 // Mutators
 /** !
- * Add a property to a cache
+ * Add a property to a cache. If the key is already in the cache, its value 
+ * is replaced. If the cache is full, the eviction policy picks a property
+ * to evict. Replaced and evicted values are passed to the evict function.
+ * The cost of the value comes from the cost function, or is 1.
  * 
  * @param p_cache the cache
  * @param p_key   the key of the property
@@ -108,7 +358,65 @@ DLLEXPORT int cache_get ( const cache *const p_cache, const void *const p_key, v
 DLLEXPORT int cache_insert ( cache *const p_cache, const void *const p_key, const void *const p_value );
 
 /** !
- * Remove a property from the cache
+ * Add many properties to a cache, as by cache_insert. Every key of a batch 
+ * of CACHE_BATCH keys is hashed, and its bucket prefetched, before the 
+ * first property is added. A value whose cost exceeds the budget isn't 
+ * added, and is passed to the evict function, as by cache_get_or_load.
+ * 
+ * @param p_cache   the cache
+ * @param pp_keys   the keys of the properties
+ * @param pp_values the values of the properties
+ * @param n         the quantity of properties
+ * 
+ * @return the quantity of properties added
+ */
+DLLEXPORT size_t cache_insert_many ( cache *const p_cache, const void *const *const pp_keys, const void *const *const pp_values, size_t n );
+
+/** !
+ * Add a property with a time to live to a cache. The cache must track 
+ * expiration. An expired property is a miss, and is passed to the evict 
+ * function when it's reclaimed.
+ * 
+ * @param p_cache the cache
+ * @param p_key   the key of the property
+ * @param p_value the value of the property
+ * @param ttl     the time to live, in timer_high_precision units, or 0 to never expire
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int cache_insert_ttl ( cache *const p_cache, const void *const p_key, const void *const p_value, timestamp ttl );
+
+/** !
+ * Add a property with a cost to a cache. If the cache has a budget, the 
+ * eviction policy evicts properties until the total cost fits the budget. 
+ * 
+ * @param p_cache the cache
+ * @param p_key   the key of the property
+ * @param p_value the value of the property
+ * @param cost    the cost of the property, such as its size in bytes
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int cache_insert_cost ( cache *const p_cache, const void *const p_key, const void *const p_value, size_t cost );
+
+/** !
+ * Update or insert a property with a single search. If the key is found, 
+ * the found function mutates the value in place. Else, the create function
+ * makes a value, whose key must equal the key, and the value is inserted.
+ * 
+ * @param p_cache       the cache
+ * @param p_key         the key
+ * @param pfn_on_found  called with the value if the key is found, or 0
+ * @param pfn_on_create called with the key to make a value if the key isn't found
+ * @param p_context     passed to the found and create functions
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int cache_upsert ( cache *const p_cache, const void *const p_key, fn_hash_cache_upsert_found *pfn_on_found, fn_hash_cache_upsert_create *pfn_on_create, void *p_context );
+
+/** !
+ * Remove a property from the cache. The value is not passed to the evict 
+ * function.
  * 
  * @param p_cache   the cache
  * @param p_key     the key of the property
@@ -118,6 +426,30 @@ DLLEXPORT int cache_insert ( cache *const p_cache, const void *const p_key, cons
  */
 DLLEXPORT int cache_remove ( cache *const p_cache, const void *const p_key, void **const pp_result );
 
+/** !
+ * Reclaim every expired property of a cache, passing each to the evict 
+ * function. Expired properties are also reclaimed when they're accessed, 
+ * and a full cache evicts an expired property before a live one, so 
+ * calling this function is optional. It releases expired values sooner.
+ * 
+ * @param p_cache the cache
+ * @param now     the current time, from timer_high_precision
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int cache_maintain ( cache *const p_cache, timestamp now );
+
+/** !
+ * Report a deferred hit on a slot to the policy. A slot that was emptied 
+ * since the hit is skipped.
+ * 
+ * @param p_cache the cache
+ * @param slot    the slot, from cache_lookup
+ * 
+ * @return void
+ */
+DLLEXPORT void cache_touch ( cache *const p_cache, size_t slot );
+
 /** !
  * Clear the cache of all properties
  * 
@@ -130,7 +462,8 @@ DLLEXPORT int cache_clear ( cache *p_cache, fn_hash_cache_free *pfn_free );
 
 // Iterators
 /** !
- * Call a function on each element of the cache
+ * Call a function on each element of the cache, in the eviction policy's order.
+ * The LRU policy goes from most to least recently used.
  * 
  * @param p_cache      the cache
  * @param pfn_function pointer to the function
@@ -140,7 +473,8 @@ DLLEXPORT int cache_clear ( cache *p_cache, fn_hash_cache_free *pfn_free );
 DLLEXPORT int cache_for_i ( const cache *const p_cache, fn_hash_cache_property_i pfn_function );
 
 /** !
- * Call a function on each element of the cache
+ * Call a function on each element of the cache, in the eviction policy's order.
+ * The LRU policy goes from most to least recently used.
  * 
  * @param p_cache      the cache
  * @param pfn_function pointer to the function
@@ -149,6 +483,33 @@ DLLEXPORT int cache_for_i ( const cache *const p_cache, fn_hash_cache_property_i
  */
 DLLEXPORT int cache_for_each ( const cache *const p_cache, fn_hash_cache_property pfn_function );
 
+// Policies
+/** !
+ * Add a slot to the front of a list threaded through the cache's nodes.
+ * For use by eviction policies.
+ * 
+ * @param p_cache the cache
+ * @param p_head  the head of the list
+ * @param p_tail  the tail of the list
+ * @param slot    the slot
+ * 
+ * @return void
+ */
+DLLEXPORT void cache_list_push_front ( cache *const p_cache, size_t *const p_head, size_t *const p_tail, size_t slot );
+
+/** !
+ * Remove a slot from a list threaded through the cache's nodes. For use by
+ * eviction policies.
+ * 
+ * @param p_cache the cache
+ * @param p_head  the head of the list
+ * @param p_tail  the tail of the list
+ * @param slot    the slot
+ * 
+ * @return void
+ */
+DLLEXPORT void cache_list_remove ( cache *const p_cache, size_t *const p_head, size_t *const p_tail, size_t slot );
+
 // Destructors
 /** !
  * Release a cache and all its allocations
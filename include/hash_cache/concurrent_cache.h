@@ -0,0 +1,288 @@
+/** !
+ * Header for concurrent cache
+ *
+ * @file hash_cache/concurrent_cache.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+#include <hash_cache/cache.h>
+
+// Preprocessor definitions
+#define CONCURRENT_CACHE_SHARDS  16
+#define CONCURRENT_CACHE_STRIPES 8
+#define CONCURRENT_CACHE_BUFFER  32
+#define CONCURRENT_CACHE_RETRIES 16
+#define CONCURRENT_CACHE_WORKERS 2
+#define CONCURRENT_CACHE_QUEUE   256
+
+// Structure declarations
+struct concurrent_cache_s;
+struct concurrent_cache_options_s;
+struct concurrent_cache_buffer_s;
+struct concurrent_cache_flight_s;
+struct concurrent_cache_pin_s;
+struct concurrent_cache_refresh_s;
+struct concurrent_cache_shard_s;
+struct concurrent_cache_stats_s;
+
+// Type definitions
+typedef struct concurrent_cache_s         concurrent_cache;
+typedef struct concurrent_cache_options_s concurrent_cache_options;
+typedef struct concurrent_cache_buffer_s  concurrent_cache_buffer;
+typedef struct concurrent_cache_flight_s  concurrent_cache_flight;
+typedef struct concurrent_cache_pin_s     concurrent_cache_pin;
+typedef struct concurrent_cache_refresh_s concurrent_cache_refresh;
+typedef struct concurrent_cache_shard_s   concurrent_cache_shard;
+typedef struct concurrent_cache_stats_s   concurrent_cache_stats;
+
+// Structure definitions
+struct concurrent_cache_options_s
+{
+    cache_options         cache;            // The options of each shard. The budget is divided between the shards
+    size_t                shards;           // The quantity of shards, rounded up to a power of 2, or 0 for CONCURRENT_CACHE_SHARDS
+    bool                  spinlock;         // Guard each shard with a spinlock, instead of a mutex
+    fn_hash_cache_loader *pfn_loader;       // Reloads properties that are read shortly before they expire, or 0 for no refresh ahead. Requires an evict function
+    void                 *p_loader_context; // Passed to the loader
+    timestamp             refresh;          // How long before its expiry a read reloads a property, in timer_high_precision units
+    size_t                workers;          // The quantity of reloading threads, or 0 for CONCURRENT_CACHE_WORKERS
+    size_t                queue;            // The maximum quantity of waiting reloads, or 0 for CONCURRENT_CACHE_QUEUE
+};
+
+struct concurrent_cache_buffer_s
+{
+    unsigned long long  entries[CONCURRENT_CACHE_BUFFER]; // The slot of a recent hit plus one in the low 32 bits, and the high 32 bits of its hash in the high 32 bits, or 0 for an empty entry
+    size_t              tail;                             // The next entry to write
+    size_t              hits, misses;                     // The quantity of gets that found their key, and that didn't
+    size_t              readers[2];                       // The quantity of lock free readers in the shard, by the parity of the epoch they entered in
+    unsigned char       _padding[64];                     // Keeps neighboring buffers off the same cache line
+};
+
+struct concurrent_cache_flight_s
+{
+    hash64                   hash;     // The hash of the key
+    const void              *p_key;    // The key being loaded
+    void                    *p_value;  // The loaded value
+    int                      result;   // The loader's result
+    bool                     done;     // Set when the load finishes
+    size_t                   waiters;  // The quantity of threads waiting for the load
+    concurrent_cache_flight *p_next;   // The next load of the same shard
+};
+
+struct concurrent_cache_pin_s
+{
+    void                 *p_value; // A value whose key is being reloaded
+    bool                  evicted; // Set when the cache evicts the value during the reload
+    concurrent_cache_pin *p_next;  // The next pin of the same shard
+};
+
+struct concurrent_cache_shard_s
+{
+    cache                   *p_cache;
+    mutex                    _mutex;
+    spinlock                 _spinlock;
+    size_t                   sequence;                         // Odd while a writer changes the cache
+    size_t                   epoch;                            // Advanced by each writer, which waits for the readers of the previous epoch
+    int                      busy;                             // Set while one thread owns the cache
+    concurrent_cache_buffer  buffers[CONCURRENT_CACHE_STRIPES]; // Hits waiting for the policy, striped by thread
+    mutex                    _loading;                         // Guards the loads in flight
+    condition_variable       _loaded;                          // Signaled when a load finishes, or a waiter leaves
+    concurrent_cache_flight *p_flights;                        // The loads in flight
+    unsigned char           *p_reloading;                      // One flag per slot, set while the slot's property reloads
+    concurrent_cache_pin    *p_pins;                           // The values being reloaded, which are released after the reload
+    fn_hash_cache_evict     *pfn_evict;                        // The evict function of the options, when the cache refreshes ahead
+    void                    *p_context;                        // Passed to the evict function
+};
+
+struct concurrent_cache_stats_s
+{
+    size_t hits,   // The quantity of gets that found their key
+           misses, // The quantity of gets that didn't
+           count,  // The quantity of properties
+           max,    // The maximum quantity of properties
+           cost;   // The total cost of the properties
+};
+
+struct concurrent_cache_s
+{
+    concurrent_cache_shard   *p_shards;
+    size_t                    mask;
+    fn_hash_cache_key_hash   *pfn_key_hash;
+    bool                      spinlock;
+    concurrent_cache_refresh *p_refresh;    // The reloading threads and their queue, or 0 for no refresh ahead
+};
+
+// Function declarations
+
+// Constructors
+/** !
+ * Construct a concurrent cache from independent cache shards. Each key
+ * belongs to the shard picked by its hash, and each shard has its own lock,
+ * so threads that touch different shards don't contend.
+ *
+ * With a loader, the cache refreshes ahead. A get that hits a property 
+ * within the refresh window before its expiry queues a reload, and keeps
+ * returning the stale value until a worker thread replaces it. Each slot
+ * has one reload in flight at most, and a reload is dropped when the queue
+ * is full. Refreshing ahead requires the shards to track expiration, and an
+ * evict function. The stale value stays pinned while the loader reads its 
+ * key, so an eviction of the stale value is deferred until the reload is 
+ * done, and a remove of its key waits for the reload. A fresh value that 
+ * the cache doesn't keep is passed to the evict function.
+ *
+ * @param pp_concurrent_cache result
+ * @param size                the maximum quantity of properties, divided between the shards
+ * @param p_options           the options, or 0 for defaults
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_construct ( concurrent_cache **const pp_concurrent_cache, size_t size, const concurrent_cache_options *const p_options );
+
+// Accessors
+/** !
+ * Get a value from a concurrent cache without locking. A reader counts 
+ * itself in its thread's stripe of the shard, and leaves if a writer holds
+ * the shard. A writer waits for the readers that entered before it, so the 
+ * evict function may free a value as soon as it's called. A hit is recorded
+ * in a lossy ring buffer that is drained into the policy in batches. The 
+ * returned value belongs to the cache, like the value from cache_get.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_key              the key of the property
+ * @param pp_result          return
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_get ( concurrent_cache *const p_concurrent_cache, const void *const p_key, void **const pp_result );
+
+/** !
+ * Get a value from a concurrent cache, loading it on a miss. Concurrent 
+ * misses on the same key share one call to the loader. The first thread
+ * loads and inserts the value, while the others wait for its result, so an 
+ * expired hot key doesn't stampede the backing store. No lock is held while
+ * the loader runs, and a failed load fails every waiter. The cache owns a
+ * loaded value, so a value that the cache rejects, for a cost over the 
+ * budget, is passed to the evict function, and fails every waiter.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_key              the key of the property
+ * @param pfn_loader         called with the key and the context to load a value on a miss
+ * @param p_context          passed to the loader
+ * @param pp_result          return
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_get_or_load ( concurrent_cache *const p_concurrent_cache, const void *const p_key, fn_hash_cache_loader *pfn_loader, void *p_context, void **const pp_result );
+
+/** !
+ * Sum the statistics of every shard. Each shard is locked in turn, so the
+ * sum isn't a snapshot of the whole cache.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_stats            return
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_stats_get ( concurrent_cache *const p_concurrent_cache, concurrent_cache_stats *const p_stats );
+
+// Mutators
+/** !
+ * Add a property to a concurrent cache. The evict function runs while the
+ * shard is locked.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_key              the key of the property
+ * @param p_value            the value of the property
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_insert ( concurrent_cache *const p_concurrent_cache, const void *const p_key, const void *const p_value );
+
+/** !
+ * Add many properties to a concurrent cache. The properties of a batch of
+ * CACHE_BATCH keys are grouped by shard, and each shard is locked once per
+ * batch. A value whose cost exceeds the budget of its shard isn't added,
+ * and is passed to the evict function. See cache_insert_many.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param pp_keys            the keys of the properties
+ * @param pp_values          the values of the properties
+ * @param n                  the quantity of properties
+ *
+ * @return the quantity of properties added
+ */
+DLLEXPORT size_t concurrent_cache_insert_many ( concurrent_cache *const p_concurrent_cache, const void *const *const pp_keys, const void *const *const pp_values, size_t n );
+
+/** !
+ * Update a property in place, or create it. The callbacks run while the
+ * shard is locked, so an upsert is atomic.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_key              the key of the property
+ * @param pfn_on_found       called with the value and the context on a hit, or 0
+ * @param pfn_on_create      called with the key and the context on a miss
+ * @param p_context          passed to the callbacks
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_upsert ( concurrent_cache *const p_concurrent_cache, const void *const p_key, fn_hash_cache_upsert_found *pfn_on_found, fn_hash_cache_upsert_create *pfn_on_create, void *p_context );
+
+/** !
+ * Remove a property from a concurrent cache. A remove of a key that is
+ * being reloaded waits for the reload.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param p_key              the key of the property
+ * @param pp_result          return if not null pointer else value is discarded
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_remove ( concurrent_cache *const p_concurrent_cache, const void *const p_key, void **const pp_result );
+
+/** !
+ * Reclaim every expired property of every shard
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param now                the current time, from timer_high_precision
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_maintain ( concurrent_cache *const p_concurrent_cache, timestamp now );
+
+/** !
+ * Clear every shard, and reset the statistics. Each shard waits for its
+ * reloads.
+ *
+ * @param p_concurrent_cache the concurrent cache
+ * @param pfn_free           called with each value, or 0
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_clear ( concurrent_cache *const p_concurrent_cache, fn_hash_cache_free *pfn_free );
+
+// Destructors
+/** !
+ * Destroy a concurrent cache. No other thread may use it.
+ *
+ * @param pp_concurrent_cache the concurrent cache
+ * @param pfn_free            called with each value, or 0
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int concurrent_cache_destroy ( concurrent_cache **const pp_concurrent_cache, fn_hash_cache_free *pfn_free );
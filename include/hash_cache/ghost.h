@@ -0,0 +1,135 @@
+/** !
+ * Header for ghost lists
+ *
+ * @file hash_cache/ghost.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+
+// Preprocessor definitions
+#define HASH_CACHE_GHOST_LISTS 2
+#define HASH_CACHE_GHOST_NIL   ((size_t) -1)
+
+// Structure declarations
+struct hash_cache_ghost_s;
+struct hash_cache_ghost_entry_s;
+
+// Type definitions
+typedef struct hash_cache_ghost_s       hash_cache_ghost;
+typedef struct hash_cache_ghost_entry_s hash_cache_ghost_entry;
+
+// Structure definitions
+struct hash_cache_ghost_entry_s
+{
+    hash64 hash;        // The hash of the evicted key
+    size_t chain;       // The next entry in the same bucket, or the next free entry
+    size_t prev, next;  // The neighboring entries in the same list
+    size_t list;        // The list that holds the entry
+};
+
+struct hash_cache_ghost_s
+{
+    hash_cache_ghost_entry *p_entries;
+    size_t                 *p_buckets;
+    size_t                  mask, free, max;
+    struct
+    {
+        size_t head, tail, count;
+    } lists[HASH_CACHE_GHOST_LISTS];
+};
+
+// Function declarations
+
+// Constructors
+/** !
+ * Construct a set of ghost lists. A ghost list remembers only the hashes of
+ * evicted keys, newest first, so a policy can tell when an evicted key comes
+ * back without keeping its value.
+ *
+ * @param pp_ghost result
+ * @param max      the maximum quantity of hashes across every list
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_ghost_construct ( hash_cache_ghost **const pp_ghost, size_t max );
+
+// Accessors
+/** !
+ * Search the ghost lists for a hash
+ *
+ * @param p_ghost the ghost lists
+ * @param h       the hash of the key
+ *
+ * @return the entry of the hash, or HASH_CACHE_GHOST_NIL if no list holds it
+ */
+DLLEXPORT size_t hash_cache_ghost_find ( const hash_cache_ghost *const p_ghost, hash64 h );
+
+// Mutators
+/** !
+ * Add a hash to the front of a ghost list. If every entry is in use, the
+ * oldest hash of the list is forgotten first, or of the other list if the
+ * list is empty.
+ *
+ * @param p_ghost the ghost lists
+ * @param list    the list
+ * @param h       the hash of the key
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_ghost_push ( hash_cache_ghost *const p_ghost, size_t list, hash64 h );
+
+/** !
+ * Forget the oldest hash of a ghost list
+ *
+ * @param p_ghost the ghost lists
+ * @param list    the list
+ *
+ * @return 1 if a hash was forgotten, 0 if the list is empty
+ */
+DLLEXPORT int hash_cache_ghost_pop ( hash_cache_ghost *const p_ghost, size_t list );
+
+/** !
+ * Forget an entry
+ *
+ * @param p_ghost the ghost lists
+ * @param entry   the entry
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_ghost_remove ( hash_cache_ghost *const p_ghost, size_t entry );
+
+/** !
+ * Forget every hash
+ *
+ * @param p_ghost the ghost lists
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_ghost_clear ( hash_cache_ghost *const p_ghost );
+
+// Destructors
+/** !
+ * Release a set of ghost lists
+ *
+ * @param pp_ghost the ghost lists
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_ghost_destroy ( hash_cache_ghost **const pp_ghost );
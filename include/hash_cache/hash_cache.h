@@ -31,16 +31,69 @@
 #define HASH_CACHE_REALLOC(p, sz) realloc(p,sz)
 #endif
 
+// Preprocessor definitions
+#define HASH_CACHE_STATS_STRIPES 8
+
+// Statistics. Define HASH_CACHE_STATS when building the library to count 
+// statistics. Otherwise, no counters are allocated and each count compiles 
+// to nothing. The layout of every structure is the same either way
+#ifdef HASH_CACHE_STATS
+#define HASH_CACHE_COUNT(p_counters, counter, n) __atomic_fetch_add(&(p_counters)->stripes[HASH_CACHE_STRIPE()].stats.counter, (size_t) (n), __ATOMIC_RELAXED)
+#else
+#define HASH_CACHE_COUNT(p_counters, counter, n) ((void) (n))
+#endif
+
+// Pick the calling thread's stripe. The address of a thread local variable is different in each thread
+#define HASH_CACHE_STRIPE() ((size_t) ( ( (unsigned long long) (size_t) &hash_cache_thread * 0x9E3779B97F4A7C15ULL ) >> 59 ) % HASH_CACHE_STATS_STRIPES)
+
+// Structure declarations
+struct hash_cache_stats_s;
+struct hash_cache_counters_s;
+
 // Type definitions
 typedef unsigned long long hash64;
 
+typedef struct hash_cache_stats_s    hash_cache_stats;
+typedef struct hash_cache_counters_s hash_cache_counters;
+
 typedef hash64 (fn_hash64)                  ( const void *const k, size_t l );
 typedef hash64 (fn_hash_cache_hash_index)   ( const void *const k, size_t l, size_t i );
 typedef int    (fn_hash_cache_equality)     ( const void *const p_a, const void *const p_b );
 typedef void  *(fn_hash_cache_key_accessor) ( const void *const p_value );
+typedef hash64 (fn_hash_cache_key_hash)     ( const void *const p_key );
 typedef void   (fn_hash_cache_free)         ( void *p_property );
 typedef int    (fn_hash_cache_property)     ( void *p_property );
 typedef int    (fn_hash_cache_property_i)   ( void *p_property, size_t i );
+typedef void   (fn_hash_cache_upsert_found)  ( void *p_value, void *p_context );
+typedef void  *(fn_hash_cache_upsert_create) ( const void *const p_key, void *p_context );
+typedef void   (fn_hash_cache_evict)         ( void *p_value, void *p_context );
+typedef size_t (fn_hash_cache_cost)          ( const void *const p_value );
+typedef int    (fn_hash_cache_loader)        ( const void *const p_key, void *p_context, void **const pp_value );
+
+// Structure definitions
+struct hash_cache_stats_s
+{
+    size_t hits,      // The quantity of searches that found their key
+           misses,    // The quantity of searches that didn't
+           inserts,   // The quantity of values stored
+           evictions, // The quantity of values evicted, or expired
+           probes,    // The quantity of slots compared by the searches counted in hits and misses. Divide by both for the mean probe length
+           resizes;   // The quantity of times the slots were resized
+};
+
+// Counters are allocated on a cache line boundary by hash_cache_counters_construct
+struct hash_cache_counters_s
+{
+    struct
+    {
+        hash_cache_stats stats;
+        unsigned char    _padding[64 - sizeof(hash_cache_stats)]; // Keeps neighboring stripes off the same cache line
+    } stripes[HASH_CACHE_STATS_STRIPES];                         // Each thread counts in its own stripe
+    void *p_allocation;                                          // The allocation the counters were aligned in
+};
+
+// Data
+extern __thread unsigned char hash_cache_thread;
 
 // Function declarations 
 
@@ -75,6 +128,46 @@ DLLEXPORT int hash_cache_equals ( const void *const p_a, const void *p_b );
  */
 void *hash_cache_key_accessor ( const void *const p_value );
 
+// Statistics
+/** !
+ * Allocate a set of zeroed counters, aligned to a cache line
+ * 
+ * @param pp_counters result
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_counters_construct ( hash_cache_counters **const pp_counters );
+
+/** !
+ * Sum the stripes of a set of counters
+ * 
+ * @param p_counters the counters
+ * @param p_stats    return
+ * 
+ * @return void
+ */
+DLLEXPORT void hash_cache_counters_sum ( const hash_cache_counters *const p_counters, hash_cache_stats *const p_stats );
+
+/** !
+ * Free a set of counters
+ * 
+ * @param pp_counters the counters
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_counters_destroy ( hash_cache_counters **const pp_counters );
+
+// Key hashing
+/** !
+ * Default key hash. Hashes the address of the key, which
+ * is consistent with the default comparator
+ * 
+ * @param p_key the key
+ * 
+ * @return the 64-bit hash of the key
+ */
+DLLEXPORT hash64 hash_cache_key_hash ( const void *const p_key );
+
 // Cleanup
 /** !
  * This gets called at runtime after main
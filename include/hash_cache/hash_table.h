@@ -24,9 +24,12 @@
 // hash cache
 #include <hash_cache/hash_cache.h>
 #include <hash_cache/hash.h>
+#include <hash_cache/allocator.h>
+#include <hash_cache/bloom.h>
 
 // Forward declarations
 struct hash_table_s;
+struct hash_table_options_s;
 
 // Type definitions
 /** !
@@ -34,31 +37,140 @@ struct hash_table_s;
  */
 typedef struct hash_table_s hash_table;
 
+/** !
+ *  @brief The type definition of a hash table options struct
+ */
+typedef struct hash_table_options_s hash_table_options;
+
 // Structure definitions
+struct hash_table_options_s
+{
+    fn_hash_cache_equality     *pfn_equality; // Pointer to a equality function, or 0 for default
+    fn_hash_cache_key_accessor *pfn_key_get;  // Pointer to a key getter, or 0 for key == value
+    fn_hash_cache_key_hash     *pfn_key_hash; // Pointer to a key hashing function, or 0 for default
+    hash_cache_allocator       *p_allocator;  // Pointer to an allocator, or 0 for the heap. An arena backs one cache or hash table at a time
+    bool                        huge_pages;   // Map the slots aligned to huge pages, instead of using the allocator
+    bool                        prefault;     // Fault in the mapped slots during construction
+    size_t                      bloom;        // The expected quantity of properties for a bloom filter, or 0 for none
+};
+
 struct hash_table_s
 {
     struct
     {
         void   **pp_data;
-        size_t   count, max, length;
+        hash64  *p_hashes; // The hash of each slot's key, compared before the key
+        size_t   count, max;
     } properties;
-    fn_hash_cache_equality   *pfn_equality;
+    fn_hash_cache_equality     *pfn_equality;
     fn_hash_cache_key_accessor *pfn_key_get;
-    fn_hash_cache_hash_index *pfn_hash_function;
+    fn_hash_cache_key_hash     *pfn_key_hash;
+    hash_cache_bloom           *p_bloom;
+    struct
+    {
+        hash_cache_allocator *p_allocator;
+        size_t                begin,
+                              mapped;
+        bool                  prefault;
+    } allocator;
+    hash_cache_counters *p_counters; // Aligned to a cache line, or 0 if the library doesn't count statistics
 };
 
 // TODO: Allocaters
 DLLEXPORT int hash_table_create ( hash_table **const pp_hash_table );
 
 // Constructors
-DLLEXPORT int hash_table_construct ( hash_table **const pp_hash_table, size_t size );
+/** !
+ * Construct a hash table
+ * 
+ * @param pp_hash_table result
+ * @param size          the quantity of slots in the hash table
+ * @param pfn_equality  pointer to a equality function, or 0 for default
+ * @param pfn_key_get   pointer to a key getter, or 0 for key == value
+ * @param pfn_key_hash  pointer to a key hashing function, or 0 for default
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_table_construct (
+    hash_table                 **const pp_hash_table,
+    size_t                             size,
+    fn_hash_cache_equality            *pfn_equality,
+    fn_hash_cache_key_accessor        *pfn_key_get,
+    fn_hash_cache_key_hash            *pfn_key_hash
+);
+
+/** !
+ * Construct a hash table with options. If the allocator can rewind, 
+ * destroying the hash table frees everything allocated from the allocator 
+ * after the hash table was created in O(1).
+ * 
+ * @param pp_hash_table result
+ * @param size          the quantity of slots in the hash table
+ * @param p_options     the options, or 0 for defaults
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_table_construct_options ( hash_table **const pp_hash_table, size_t size, const hash_table_options *const p_options );
+
+/** !
+ * Insert many properties into an empty hash table using many threads. The 
+ * properties are radix partitioned by the high bits of their hash, and each 
+ * partition is placed into a disjoint range of slots without locking. The 
+ * threads come from a pool that's shared by every hash table and reused 
+ * between calls. Like hash_table_insert, keys aren't checked for 
+ * duplicates, so the keys of the properties must be distinct.
+ * 
+ * @param p_hash_table  the hash table
+ * @param pp_properties the properties
+ * @param n             the quantity of properties
+ * @param nthreads      the quantity of threads
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_table_build_parallel ( hash_table *const p_hash_table, void *const *const pp_properties, size_t n, size_t nthreads );
 
 // TODO: Accessors
 DLLEXPORT int hash_table_search ( hash_table *const p_hash_table, void *p_key, void **pp_value );
 
+/** !
+ * Compute the quantity of bytes of a hash table's slots that are backed by huge pages
+ * 
+ * @param p_hash_table the hash table
+ * 
+ * @return the quantity of bytes backed by huge pages
+ */
+DLLEXPORT size_t hash_table_huge_pages ( const hash_table *const p_hash_table );
+
+/** !
+ * Take a snapshot of a hash table's statistics. A hash table only counts if
+ * the library is built with HASH_CACHE_STATS. A hash table never evicts.
+ * 
+ * @param p_hash_table the hash table
+ * @param p_stats      return
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_table_stats ( const hash_table *const p_hash_table, hash_cache_stats *const p_stats );
+
 // TODO: Mutators
 DLLEXPORT int hash_table_insert ( hash_table *const p_hash_table, void *property );
 
+/** !
+ * Update or insert a property with a single probe sequence. If the key is 
+ * found, the found function mutates the value in place. Else, the create 
+ * function makes a value, whose key must equal the key, and the value is 
+ * stored in the first empty slot of the probe sequence.
+ * 
+ * @param p_hash_table  the hash table
+ * @param p_key         the key
+ * @param pfn_on_found  called with the value if the key is found, or 0
+ * @param pfn_on_create called with the key to make a value if the key isn't found
+ * @param p_context     passed to the found and create functions
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_table_upsert ( hash_table *const p_hash_table, void *p_key, fn_hash_cache_upsert_found *pfn_on_found, fn_hash_cache_upsert_create *pfn_on_create, void *p_context );
+
 // TODO: Iterators
 /** !
  * Call a function on each element of the hash table
@@ -80,6 +192,32 @@ DLLEXPORT int hash_table_for_i ( const hash_table *const p_hash_table, fn_hash_c
  */
 DLLEXPORT int hash_table_for_each ( const hash_table *const p_hash_table, fn_hash_cache_property pfn_function );
 
+/** !
+ * Call a function on each element of the hash table using many threads. The 
+ * slots are split into equal chunks, one per thread. The function may be 
+ * called concurrently, and in no particular order. The threads come from a
+ * pool that's shared by every hash table and reused between calls. While
+ * another parallel call holds the pool, the calling thread does every chunk.
+ * 
+ * @param hash_table   the hash table
+ * @param pfn_function pointer to the function
+ * @param nthreads     the quantity of threads
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_table_for_each_parallel ( const hash_table *const p_hash_table, fn_hash_cache_property pfn_function, size_t nthreads );
+
+/** !
+ * Change the quantity of slots in a hash table. Each property is moved 
+ * to the new slots, and the bloom filter, if any, is rebuilt.
+ * 
+ * @param p_hash_table the hash table
+ * @param size         the new quantity of slots
+ * 
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_table_resize ( hash_table *const p_hash_table, size_t size );
+
 // TODO: Shallow copy
 //
 
@@ -89,4 +227,3 @@ DLLEXPORT int hash_table_clear ( hash_table *pp_hash_table, fn_hash_cache_free *
 
 // TODO: Destructors
 DLLEXPORT int hash_table_destroy ( hash_table **const pp_hash_table, fn_hash_cache_free *pfn_free );
-
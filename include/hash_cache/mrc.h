@@ -0,0 +1,120 @@
+/** !
+ * Header for miss ratio curve estimation
+ *
+ * @file hash_cache/mrc.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+#include <hash_cache/ghost.h>
+
+// Preprocessor definitions
+#define HASH_CACHE_MRC_POINTS    4
+#define HASH_CACHE_MRC_BITS      24
+#define HASH_CACHE_MRC_HALF_LIFE (1 << 16)
+
+// Structure declarations
+struct hash_cache_mrc_s;
+struct hash_cache_mrc_point_s;
+
+// Type definitions
+typedef struct hash_cache_mrc_s       hash_cache_mrc;
+typedef struct hash_cache_mrc_point_s hash_cache_mrc_point;
+
+// Structure definitions
+struct hash_cache_mrc_point_s
+{
+    size_t size;      // The maximum quantity of properties of the cache
+    double hit_ratio; // The estimated hit ratio of an LRU cache of that size. The miss ratio is 1 - hit_ratio
+};
+
+struct hash_cache_mrc_s
+{
+    hash_cache_ghost *p_ghost;                         // The sampled hashes, most recently referenced first
+    size_t           *p_times,                         // The time of each ghost entry's last reference
+                     *p_tree;                          // A Fenwick tree counting the hashes last referenced at each time
+    size_t            clock,                           // The time of the next reference
+                      window,                          // The quantity of times before the times are compacted
+                      threshold,                       // A hash is sampled if its top HASH_CACHE_MRC_BITS scrambled bits are less than the threshold
+                      references;                      // The quantity of sampled references, halved every HASH_CACHE_MRC_HALF_LIFE
+    size_t            sizes[HASH_CACHE_MRC_POINTS],    // Half, once, twice, and four times the size of the cache
+                      limits[HASH_CACHE_MRC_POINTS],   // The sampled reuse distance under which a reference hits each size
+                      hits[HASH_CACHE_MRC_POINTS];     // The quantity of sampled references that hit each size
+};
+
+// Function declarations
+
+// Constructors
+/** !
+ * Construct a miss ratio curve estimator. Spatial sampling (SHARDS) keeps
+ * one in a sample of the hashes, chosen by the hash alone, so a sampled key
+ * is sampled on every reference. The reuse distance of each sampled
+ * reference, in sampled keys, scaled by the sample rate, estimates the
+ * reuse distance of the full trace, which decides whether an LRU cache of
+ * each size would hit.
+ *
+ * @param pp_mrc result
+ * @param size   the maximum quantity of properties of the cache
+ * @param sample sample one in this many hashes
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_mrc_construct ( hash_cache_mrc **const pp_mrc, size_t size, size_t sample );
+
+// Accessors
+/** !
+ * Estimate the hit ratio at half, once, twice, and four times the size of
+ * the cache. Old references fade, so the curve follows the workload.
+ *
+ * @param p_mrc    the estimator
+ * @param p_points return, HASH_CACHE_MRC_POINTS points
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_mrc_curve ( const hash_cache_mrc *const p_mrc, hash_cache_mrc_point *const p_points );
+
+// Mutators
+/** !
+ * Record a reference to a hash. Unsampled hashes return after a multiply.
+ *
+ * @param p_mrc the estimator
+ * @param h     the hash of the key
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_mrc_reference ( hash_cache_mrc *const p_mrc, hash64 h );
+
+/** !
+ * Forget every reference
+ *
+ * @param p_mrc the estimator
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_mrc_clear ( hash_cache_mrc *const p_mrc );
+
+// Destructors
+/** !
+ * Release a miss ratio curve estimator
+ *
+ * @param pp_mrc the estimator
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_mrc_destroy ( hash_cache_mrc **const pp_mrc );
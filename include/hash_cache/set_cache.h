@@ -0,0 +1,153 @@
+/** !
+ * Header for set associative cache
+ *
+ * @file hash_cache/set_cache.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+
+// Preprocessor definitions
+#define SET_CACHE_WAYS 7
+
+// Structure declarations
+struct set_cache_s;
+struct set_cache_options_s;
+struct set_cache_set_s;
+
+// Type definitions
+typedef struct set_cache_s         set_cache;
+typedef struct set_cache_options_s set_cache_options;
+typedef struct set_cache_set_s     set_cache_set;
+
+// Structure definitions
+struct set_cache_options_s
+{
+    fn_hash_cache_equality     *pfn_equality; // Pointer to a equality function, or 0 for default
+    fn_hash_cache_key_accessor *pfn_key_get;  // Pointer to a key getter, or 0 for key == value
+    fn_hash_cache_key_hash     *pfn_key_hash; // Pointer to a key hashing function, or 0 for default. Required with a custom equality function
+    fn_hash_cache_evict        *pfn_evict;    // Called with each evicted or replaced value, or 0
+    void                       *p_context;    // Passed to the evict function
+};
+
+// A set fills one 64 byte cache line on a 64 bit target
+struct set_cache_set_s
+{
+    void          *p_values[SET_CACHE_WAYS]; // The value of each way, or 0 for an empty way
+    unsigned char  tags[SET_CACHE_WAYS];     // The tag of each way's hash, or 0 for an empty way
+    unsigned char  recent;                   // Bit i is set if way i was used since every way was last used
+};
+
+struct set_cache_s
+{
+    set_cache_set              *p_sets;       // The sets, aligned to a cache line
+    void                       *p_allocation;
+    size_t                      mask;         // The quantity of sets, less one
+    fn_hash_cache_equality     *pfn_equality;
+    fn_hash_cache_key_accessor *pfn_key_get;
+    fn_hash_cache_key_hash     *pfn_key_hash;
+    fn_hash_cache_evict        *pfn_evict;
+    void                       *p_context;
+};
+
+// Function declarations
+
+// Constructors
+/** !
+ * Construct a set associative cache. The low bits of a key's hash pick a
+ * set of SET_CACHE_WAYS ways, and the high bits tag the key's way, so every
+ * search touches one cache line of the cache. A full set evicts the first
+ * way that wasn't used since every way of the set was last used. There's no
+ * index and no resizing, so the memory of the cache is fixed at construction
+ * to one cache line per set, and a key may be evicted before the cache is
+ * full.
+ *
+ * @param pp_set_cache result
+ * @param size         the quantity of properties, rounded up to a power of 2 quantity of sets
+ * @param p_options    the options, or 0 for defaults
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int set_cache_construct ( set_cache **const pp_set_cache, size_t size, const set_cache_options *const p_options );
+
+// Accessors
+/** !
+ * Get a value from a set associative cache
+ *
+ * @param p_set_cache the set associative cache
+ * @param p_key       the key of the property
+ * @param pp_result   return
+ *
+ * @return 1 on hit, 0 on miss or error
+ */
+DLLEXPORT int set_cache_get ( set_cache *const p_set_cache, const void *const p_key, void **const pp_result );
+
+/** !
+ * Compute the quantity of bytes of a set associative cache's sets
+ *
+ * @param p_set_cache the set associative cache
+ *
+ * @return the quantity of bytes
+ */
+DLLEXPORT size_t set_cache_bytes ( const set_cache *const p_set_cache );
+
+// Mutators
+/** !
+ * Add a property to a set associative cache, replacing the value of an
+ * equal key, or evicting a property of the key's set if the set is full
+ *
+ * @param p_set_cache the set associative cache
+ * @param p_key       the key of the property
+ * @param p_value     the value of the property
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int set_cache_insert ( set_cache *const p_set_cache, const void *const p_key, const void *const p_value );
+
+/** !
+ * Remove a property from a set associative cache
+ *
+ * @param p_set_cache the set associative cache
+ * @param p_key       the key of the property
+ * @param pp_result   return if not null pointer else value is discarded
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int set_cache_remove ( set_cache *const p_set_cache, const void *const p_key, void **const pp_result );
+
+/** !
+ * Remove every property from a set associative cache
+ *
+ * @param p_set_cache the set associative cache
+ * @param pfn_free    called with each value, or 0
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int set_cache_clear ( set_cache *const p_set_cache, fn_hash_cache_free *pfn_free );
+
+// Destructors
+/** !
+ * Destroy a set associative cache
+ *
+ * @param pp_set_cache the set associative cache
+ * @param pfn_free     called with each value, or 0
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int set_cache_destroy ( set_cache **const pp_set_cache, fn_hash_cache_free *pfn_free );
@@ -0,0 +1,99 @@
+/** !
+ * Header for count-min frequency sketch
+ *
+ * @file hash_cache/sketch.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+
+// Preprocessor definitions
+#define HASH_CACHE_SKETCH_DEPTH       4
+#define HASH_CACHE_SKETCH_COUNTER_MAX 15
+#define HASH_CACHE_SKETCH_SAMPLE      10
+
+// Structure declarations
+struct hash_cache_sketch_s;
+
+// Type definitions
+typedef struct hash_cache_sketch_s hash_cache_sketch;
+
+// Structure definitions
+struct hash_cache_sketch_s
+{
+    unsigned long long *p_table;   // Sixteen 4 bit counters per word
+    size_t              mask,      // The quantity of words, minus one
+                        additions, // The quantity of increments since the last halving
+                        sample;    // The quantity of increments between halvings
+};
+
+// Function declarations
+
+// Constructors
+/** !
+ * Construct a count-min sketch of 4 bit counters. Every counter is halved
+ * after a sample of increments, so old popularity fades.
+ *
+ * @param pp_sketch result
+ * @param expected  the expected quantity of distinct keys
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_sketch_construct ( hash_cache_sketch **const pp_sketch, size_t expected );
+
+// Accessors
+/** !
+ * Estimate the frequency of a hash
+ *
+ * @param p_sketch the sketch
+ * @param h        the hash of the key
+ *
+ * @return the estimated frequency, at most HASH_CACHE_SKETCH_COUNTER_MAX
+ */
+DLLEXPORT unsigned int hash_cache_sketch_estimate ( const hash_cache_sketch *const p_sketch, hash64 h );
+
+// Mutators
+/** !
+ * Count an occurrence of a hash
+ *
+ * @param p_sketch the sketch
+ * @param h        the hash of the key
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_sketch_increment ( hash_cache_sketch *const p_sketch, hash64 h );
+
+/** !
+ * Reset every counter to zero
+ *
+ * @param p_sketch the sketch
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_sketch_clear ( hash_cache_sketch *const p_sketch );
+
+// Destructors
+/** !
+ * Release a sketch
+ *
+ * @param pp_sketch the sketch
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_sketch_destroy ( hash_cache_sketch **const pp_sketch );
@@ -0,0 +1,167 @@
+/** !
+ * Header for tiered cache
+ *
+ * @file hash_cache/tiered_cache.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// POSIX
+#include <pthread.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+#include <hash_cache/cache.h>
+#include <hash_cache/concurrent_cache.h>
+
+// Preprocessor definitions
+#define TIERED_CACHE_L1          256
+#define TIERED_CACHE_GENERATIONS 1024
+#define TIERED_CACHE_FORWARD     64
+
+// Structure declarations
+struct tiered_cache_s;
+struct tiered_cache_options_s;
+struct tiered_cache_entry_s;
+struct tiered_cache_l1_s;
+
+// Type definitions
+typedef struct tiered_cache_s         tiered_cache;
+typedef struct tiered_cache_options_s tiered_cache_options;
+typedef struct tiered_cache_entry_s   tiered_cache_entry;
+typedef struct tiered_cache_l1_s      tiered_cache_l1;
+
+// Structure definitions
+struct tiered_cache_options_s
+{
+    concurrent_cache_options l2; // The options of the shared L2 cache
+    size_t                   l1; // The quantity of entries of each thread's L1 cache, rounded up to a power of 2, or 0 for TIERED_CACHE_L1
+};
+
+struct tiered_cache_entry_s
+{
+    hash64  hash;       // The hash of the key
+    void   *p_value;    // The value, or 0 for an empty entry
+    size_t  generation; // The generation of the key's stripe when the entry was filled
+    size_t  hits;       // The quantity of hits until the next hit is forwarded to the L2 cache
+};
+
+struct tiered_cache_l1_s
+{
+    tiered_cache       *p_tiered_cache; // The owner of the L1 cache
+    tiered_cache_l1    *p_next;         // The next L1 cache of the same tiered cache
+    tiered_cache_entry *p_entries;      // The direct mapped entries
+    size_t              sequence;       // Odd while the thread searches its L1 cache
+};
+
+struct tiered_cache_s
+{
+    concurrent_cache           *p_l2;
+    pthread_key_t               l1;                                   // Each thread's L1 cache
+    size_t                      mask;                                 // The quantity of entries of an L1 cache, less one
+    mutex                       _mutex;                               // Guards the list of L1 caches
+    tiered_cache_l1            *p_l1s;                                // Every thread's L1 cache, freed with the tiered cache
+    fn_hash_cache_equality     *pfn_equality;
+    fn_hash_cache_key_accessor *pfn_key_get;
+    fn_hash_cache_key_hash     *pfn_key_hash;
+    fn_hash_cache_evict        *pfn_evict;                            // The caller's evict function
+    void                       *p_context;                            // Passed to the caller's evict function
+    size_t                      generations[TIERED_CACHE_GENERATIONS]; // Bumped after a key of the stripe leaves the L2 cache
+};
+
+// Function declarations
+
+// Constructors
+/** !
+ * Construct a tiered cache. Each thread reads through its own direct mapped
+ * L1 cache, without synchronization, in front of a shared concurrent L2
+ * cache. An L1 entry remembers the generation of its key's stripe. Removing,
+ * replacing, or evicting a key from the L2 cache bumps the generation, which
+ * lazily invalidates every L1 copy. A value leaves the tiered cache only 
+ * after every thread that may be comparing its key in an L1 cache is done,
+ * so the evict function may free it. Every TIERED_CACHE_FORWARD-th L1 hit 
+ * of an entry reads the L2 cache again, so the L2 policy sees the hot keys.
+ *
+ * @param pp_tiered_cache result
+ * @param size            the maximum quantity of properties of the L2 cache
+ * @param p_options       the options, or 0 for defaults
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int tiered_cache_construct ( tiered_cache **const pp_tiered_cache, size_t size, const tiered_cache_options *const p_options );
+
+// Accessors
+/** !
+ * Get a value from a tiered cache. The calling thread's L1 cache is searched
+ * first, then the L2 cache, which fills the L1 cache.
+ *
+ * @param p_tiered_cache the tiered cache
+ * @param p_key          the key of the property
+ * @param pp_result      return
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int tiered_cache_get ( tiered_cache *const p_tiered_cache, const void *const p_key, void **const pp_result );
+
+// Mutators
+/** !
+ * Add a property to the L2 cache of a tiered cache. A replaced value is
+ * invalidated in every L1 cache.
+ *
+ * @param p_tiered_cache the tiered cache
+ * @param p_key          the key of the property
+ * @param p_value        the value of the property
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int tiered_cache_insert ( tiered_cache *const p_tiered_cache, const void *const p_key, const void *const p_value );
+
+/** !
+ * Remove a property from the L2 cache of a tiered cache, and invalidate it
+ * in every L1 cache. The value is returned after no thread can read it from
+ * an L1 cache.
+ *
+ * @param p_tiered_cache the tiered cache
+ * @param p_key          the key of the property
+ * @param pp_result      return if not null pointer else value is discarded
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int tiered_cache_remove ( tiered_cache *const p_tiered_cache, const void *const p_key, void **const pp_result );
+
+/** !
+ * Clear the L2 cache of a tiered cache, and invalidate every L1 cache. Each
+ * value is freed after no thread can read it from an L1 cache.
+ *
+ * @param p_tiered_cache the tiered cache
+ * @param pfn_free       called with each value, or 0
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int tiered_cache_clear ( tiered_cache *const p_tiered_cache, fn_hash_cache_free *pfn_free );
+
+// Destructors
+/** !
+ * Destroy a tiered cache, and every thread's L1 cache. No other thread may
+ * use it.
+ *
+ * @param pp_tiered_cache the tiered cache
+ * @param pfn_free        called with each value, or 0
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int tiered_cache_destroy ( tiered_cache **const pp_tiered_cache, fn_hash_cache_free *pfn_free );
@@ -0,0 +1,135 @@
+/** !
+ * Header for hierarchical timer wheel
+ *
+ * @file hash_cache/wheel.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// sync module
+#include <sync/sync.h>
+
+// log module
+#include <log/log.h>
+
+// hash cache
+#include <hash_cache/hash_cache.h>
+
+// Preprocessor definitions
+#define HASH_CACHE_WHEEL_LEVELS  4
+#define HASH_CACHE_WHEEL_BITS    6
+#define HASH_CACHE_WHEEL_BUCKETS ( 1 << HASH_CACHE_WHEEL_BITS )
+#define HASH_CACHE_WHEEL_NIL     ((size_t) -1)
+
+// Structure declarations
+struct hash_cache_wheel_s;
+struct hash_cache_wheel_timer_s;
+
+// Type definitions
+typedef struct hash_cache_wheel_s       hash_cache_wheel;
+typedef struct hash_cache_wheel_timer_s hash_cache_wheel_timer;
+
+// Structure definitions
+struct hash_cache_wheel_timer_s
+{
+    timestamp deadline;   // The time the timer expires
+    size_t    prev, next; // The neighboring timers in the same bucket, or HASH_CACHE_WHEEL_NIL if not scheduled
+};
+
+struct hash_cache_wheel_s
+{
+    hash_cache_wheel_timer *p_timers;   // One timer per slot, then one sentinel per bucket, then the expired sentinel
+    size_t                  max,        // The quantity of slots
+                            scheduled;  // The quantity of timers in a bucket
+    unsigned long long      occupied[HASH_CACHE_WHEEL_LEVELS], // Bit i of a level is set if the level's bucket i has a timer
+                            tick;       // The current tick
+    timestamp               resolution; // The length of a tick
+};
+
+// Function declarations
+
+// Constructors
+/** !
+ * Construct a hierarchical timer wheel. Each level has 64 buckets, and each
+ * bucket of a level spans every bucket of the level below, so scheduling,
+ * canceling, and expiring a timer cost amortized O(1).
+ *
+ * @param pp_wheel   result
+ * @param max        the quantity of slots
+ * @param resolution the length of a tick
+ * @param now        the current time
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_wheel_construct ( hash_cache_wheel **const pp_wheel, size_t max, timestamp resolution, timestamp now );
+
+// Mutators
+/** !
+ * Schedule a slot's timer, replacing its deadline if it's already scheduled
+ *
+ * @param p_wheel  the timer wheel
+ * @param slot     the slot
+ * @param deadline the time the timer expires
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_wheel_schedule ( hash_cache_wheel *const p_wheel, size_t slot, timestamp deadline );
+
+/** !
+ * Cancel a slot's timer, if it's scheduled
+ *
+ * @param p_wheel the timer wheel
+ * @param slot    the slot
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_wheel_cancel ( hash_cache_wheel *const p_wheel, size_t slot );
+
+/** !
+ * Advance the timer wheel, moving every timer that expires by a time to the
+ * expired list. The wheel skips ahead to the next tick with a timer to expire
+ * or cascade, so advancing costs the quantity of timers it moves, not the
+ * quantity of ticks.
+ *
+ * @param p_wheel the timer wheel
+ * @param now     the current time
+ *
+ * @return void
+ */
+DLLEXPORT void hash_cache_wheel_advance ( hash_cache_wheel *const p_wheel, timestamp now );
+
+/** !
+ * Take a timer off the expired list
+ *
+ * @param p_wheel the timer wheel
+ *
+ * @return the slot of the timer, or HASH_CACHE_WHEEL_NIL if no timer expired
+ */
+DLLEXPORT size_t hash_cache_wheel_pop ( hash_cache_wheel *const p_wheel );
+
+/** !
+ * Cancel every timer
+ *
+ * @param p_wheel the timer wheel
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_wheel_clear ( hash_cache_wheel *const p_wheel );
+
+// Destructors
+/** !
+ * Release a timer wheel
+ *
+ * @param pp_wheel the timer wheel
+ *
+ * @return 1 on success, 0 on error
+ */
+DLLEXPORT int hash_cache_wheel_destroy ( hash_cache_wheel **const pp_wheel );
@@ -98,6 +98,45 @@ int hash_cache_hash_table_example ( int argc, const char *argv[] );
  */
 char *hash_cache_word_frequency_key_get ( const word_frequency *const p_word_frequency );
 
+/** !
+ * Increment the frequency of a word frequency struct
+ * 
+ * @param p_value   pointer to the word frequency struct
+ * @param p_context unused
+ * 
+ * @return void
+ */
+void hash_cache_word_frequency_increment ( void *p_value, void *p_context );
+
+/** !
+ * Make a word frequency struct for a word that was seen once
+ * 
+ * @param p_key     the word
+ * @param p_context unused
+ * 
+ * @return pointer to the word frequency struct on success, null pointer on error
+ */
+void *hash_cache_word_frequency_create ( const void *const p_key, void *p_context );
+
+/** !
+ * Free a word frequency struct that was evicted from the cache
+ * 
+ * @param p_value   pointer to the word frequency struct
+ * @param p_context unused
+ * 
+ * @return void
+ */
+void hash_cache_word_frequency_evict ( void *p_value, void *p_context );
+
+/** !
+ * Hash a word
+ * 
+ * @param p_key the word
+ * 
+ * @return the hash of the word
+ */
+hash64 hash_cache_word_hash ( const void *const p_key );
+
 /** !
  * Print a word frequency struct to standard out
  * 
@@ -327,14 +366,21 @@ int hash_cache_cache_example ( int argc, const char *argv[] )
     );
 
     // Initialized data
-    cache *p_cache = (void *) 0;
-    FILE  *p_file  = fopen("lorem_ipsum.txt", "r");
+    cache         *p_cache  = (void *) 0;
+    FILE          *p_file   = fopen("lorem_ipsum.txt", "r");
+    cache_options  _options =
+    {
+        .pfn_equality = (fn_hash_cache_equality *)strcmp,
+        .pfn_key_get  = (fn_hash_cache_key_accessor *)hash_cache_word_frequency_key_get,
+        .pfn_key_hash = hash_cache_word_hash,
+        .pfn_evict    = hash_cache_word_frequency_evict
+    };
 
     // Error check
     if ( p_file == (void *) 0 ) goto failed_to_open_lorem_ipsum;
 
     // Construct the cache
-    if ( cache_construct(&p_cache, 1000, (fn_hash_cache_equality *)strcmp, (fn_hash_cache_key_accessor *)hash_cache_word_frequency_key_get) == 0 ) goto failed_to_construct_cache;
+    if ( cache_construct_options(&p_cache, 1000, &_options) == 0 ) goto failed_to_construct_cache;
 
     // Read each word
     while ( feof(p_file) == false )
@@ -342,7 +388,6 @@ int hash_cache_cache_example ( int argc, const char *argv[] )
 
         // Initialized data
         char _word[16] = { 0 };
-        word_frequency *p_word_frequency = (void *) 0;
         int r = 0;
 
         // Read the word
@@ -351,31 +396,8 @@ int hash_cache_cache_example ( int argc, const char *argv[] )
         // Done?
         if ( r == EOF ) continue;
 
-        // Search the cache
-        cache_get(p_cache, _word, (void **)&p_word_frequency);
-
-        // Hit
-        if ( p_word_frequency )
-            
-            // Increment the frequency
-            p_word_frequency->frequency++;
-        
-        // Miss
-        else
-        {
-            
-            // Allocate memory for the cache entry
-            p_word_frequency = malloc(sizeof(word_frequency));
-
-            // Initialize the frequency
-            p_word_frequency->frequency = 1;
-
-            // Copy the word
-            strncpy(p_word_frequency->_word, _word, 16);
-
-            // Insert the word into the cache
-            cache_insert(p_cache, p_word_frequency->_word, p_word_frequency);
-        }
+        // Count the word, creating a cache entry on a miss
+        cache_upsert(p_cache, _word, hash_cache_word_frequency_increment, hash_cache_word_frequency_create, (void *) 0);
     }
 
     // Formatting
@@ -387,6 +409,12 @@ int hash_cache_cache_example ( int argc, const char *argv[] )
     // Formatting
     printf("\nFor a total of %zu words\n", total_words);
 
+    // Release the cache and its word frequency structs
+    cache_destroy(&p_cache, free);
+
+    // Close the file
+    fclose(p_file);
+
     // Success
     return EXIT_SUCCESS;
     
@@ -502,3 +530,58 @@ char *hash_cache_word_frequency_key_get ( const word_frequency *const p_word_fre
         }
     }
 }
+
+void hash_cache_word_frequency_increment ( void *p_value, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Increment the frequency
+    ((word_frequency *)p_value)->frequency++;
+
+    // Done
+    return;
+}
+
+void *hash_cache_word_frequency_create ( const void *const p_key, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Initialized data
+    word_frequency *p_word_frequency = malloc(sizeof(word_frequency));
+
+    // Error check
+    if ( p_word_frequency == (void *) 0 ) return (void *) 0;
+
+    // Initialize the frequency
+    p_word_frequency->frequency = 1;
+
+    // Copy the word
+    strncpy(p_word_frequency->_word, p_key, 16);
+
+    // Success
+    return p_word_frequency;
+}
+
+void hash_cache_word_frequency_evict ( void *p_value, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Free the word frequency struct
+    free(p_value);
+
+    // Done
+    return;
+}
+
+hash64 hash_cache_word_hash ( const void *const p_key )
+{
+
+    // Success
+    return hash_xxh64(p_key, strlen(p_key));
+}
@@ -0,0 +1,400 @@
+/** !
+ * Implementation of miss ratio curve estimation
+ *
+ * @file mrc.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/mrc.h>
+
+// Standard library
+#include <stdlib.h>
+#include <string.h>
+
+// Function declarations
+/** !
+ * Add to the count of hashes last referenced at a time
+ *
+ * @param p_mrc the estimator
+ * @param time  the time
+ * @param delta the amount to add, which wraps around to subtract
+ *
+ * @return void
+ */
+static inline void hash_cache_mrc_tree_add ( hash_cache_mrc *const p_mrc, size_t time, size_t delta )
+{
+
+    // Walk up the tree
+    for (size_t i = time + 1; i <= p_mrc->window; i += i & ( ~i + 1 ))
+        p_mrc->p_tree[i] += delta;
+
+    // Done
+    return;
+}
+
+/** !
+ * Count the hashes last referenced at or before a time
+ *
+ * @param p_mrc the estimator
+ * @param time  the time
+ *
+ * @return the quantity of hashes
+ */
+static inline size_t hash_cache_mrc_tree_sum ( const hash_cache_mrc *const p_mrc, size_t time )
+{
+
+    // Initialized data
+    size_t sum = 0;
+
+    // Walk down the tree
+    for (size_t i = time + 1; i > 0; i -= i & ( ~i + 1 ))
+        sum += p_mrc->p_tree[i];
+
+    // Success
+    return sum;
+}
+
+/** !
+ * Renumber the times of the sampled hashes, oldest first, from zero
+ *
+ * @param p_mrc the estimator
+ *
+ * @return void
+ */
+static void hash_cache_mrc_compact ( hash_cache_mrc *const p_mrc );
+
+// Function definitions
+int hash_cache_mrc_construct ( hash_cache_mrc **const pp_mrc, size_t size, size_t sample )
+{
+
+    // Argument check
+    if ( pp_mrc == (void *) 0 ) goto no_mrc;
+    if ( size   ==          0 ) goto invalid_size;
+    if ( sample ==          0 ) goto invalid_sample;
+
+    // Initialized data
+    hash_cache_mrc *p_mrc     = HASH_CACHE_REALLOC(0, sizeof(hash_cache_mrc));
+    size_t          threshold = (size_t) ( ( 1ULL << HASH_CACHE_MRC_BITS ) / sample ),
+                    max       = 0;
+
+    // Error check
+    if ( p_mrc == (void *) 0 ) goto no_mem;
+
+    // Sample at least one hash
+    if ( threshold == 0 ) threshold = 1;
+
+    // Initialize the estimator
+    *p_mrc = (hash_cache_mrc) { .threshold = threshold };
+
+    // Scale each size by the sample rate
+    for (size_t i = 0; i < HASH_CACHE_MRC_POINTS; i++)
+        p_mrc->sizes[i]  = ( size << i ) >> 1,
+        p_mrc->limits[i] = (size_t) ( (double) p_mrc->sizes[i] * (double) threshold / (double) ( 1ULL << HASH_CACHE_MRC_BITS ) + 0.5 );
+
+    // A hash further than the largest size is a miss at every size, so it's forgotten
+    max            = p_mrc->limits[HASH_CACHE_MRC_POINTS - 1] + 1;
+    p_mrc->window  = 2 * max;
+
+    // Construct the ghost list
+    if ( hash_cache_ghost_construct(&p_mrc->p_ghost, max) == 0 ) goto failed_to_construct_ghost;
+
+    // Allocate the times and the tree
+    p_mrc->p_times = HASH_CACHE_REALLOC(0, sizeof(size_t) * ( max + p_mrc->window + 1 ));
+
+    // Error check
+    if ( p_mrc->p_times == (void *) 0 ) goto no_mem;
+
+    // The tree follows the times
+    p_mrc->p_tree = p_mrc->p_times + max;
+
+    // Forget every reference
+    hash_cache_mrc_clear(p_mrc);
+
+    // Return a pointer to the caller
+    *pp_mrc = p_mrc;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_mrc:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [mrc] Null pointer provided for parameter \"pp_mrc\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [mrc] Parameter \"size\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_sample:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [mrc] Parameter \"sample\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash cache errors
+        {
+            failed_to_construct_ghost:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [mrc] Failed to construct ghost list in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Free the estimator
+                p_mrc = HASH_CACHE_REALLOC(p_mrc, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_mrc )
+                {
+                    if ( p_mrc->p_ghost ) hash_cache_ghost_destroy(&p_mrc->p_ghost);
+                    p_mrc = HASH_CACHE_REALLOC(p_mrc, 0);
+                }
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_mrc_curve ( const hash_cache_mrc *const p_mrc, hash_cache_mrc_point *const p_points )
+{
+
+    // Argument check
+    if ( p_mrc    == (void *) 0 ) goto no_mrc;
+    if ( p_points == (void *) 0 ) goto no_points;
+
+    // Compute each point
+    for (size_t i = 0; i < HASH_CACHE_MRC_POINTS; i++)
+        p_points[i] = (hash_cache_mrc_point)
+        {
+            .size      = p_mrc->sizes[i],
+            .hit_ratio = ( p_mrc->references ) ? (double) p_mrc->hits[i] / (double) p_mrc->references : 0.0
+        };
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_mrc:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [mrc] Null pointer provided for parameter \"p_mrc\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_points:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [mrc] Null pointer provided for parameter \"p_points\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void hash_cache_mrc_reference ( hash_cache_mrc *const p_mrc, hash64 h )
+{
+
+    // Initialized data
+    hash_cache_ghost *p_ghost = p_mrc->p_ghost;
+    size_t            entry   = 0;
+
+    // Skip unsampled hashes
+    if ( ( ( h * 0x9E3779B97F4A7C15ULL ) >> ( 64 - HASH_CACHE_MRC_BITS ) ) >= p_mrc->threshold ) return;
+
+    // Search the sampled hashes
+    entry = hash_cache_ghost_find(p_ghost, h);
+
+    // If the hash was referenced before ...
+    if ( entry != HASH_CACHE_GHOST_NIL )
+    {
+
+        // Initialized data
+        size_t time     = p_mrc->p_times[entry],
+               distance = p_ghost->lists[0].count - hash_cache_mrc_tree_sum(p_mrc, time);
+
+        // ... the reference hits every size further than the quantity of hashes referenced since
+        for (size_t i = 0; i < HASH_CACHE_MRC_POINTS; i++)
+            if ( distance < p_mrc->limits[i] ) p_mrc->hits[i]++;
+
+        // Forget the last reference
+        hash_cache_mrc_tree_add(p_mrc, time, (size_t) -1);
+        hash_cache_ghost_remove(p_ghost, entry);
+    }
+
+    // Count the reference
+    p_mrc->references++;
+
+    // Forget the oldest hash to make room
+    if ( p_ghost->lists[0].count == p_ghost->max )
+        hash_cache_mrc_tree_add(p_mrc, p_mrc->p_times[p_ghost->lists[0].tail], (size_t) -1),
+        hash_cache_ghost_pop(p_ghost, 0);
+
+    // Renumber the times, if every time is used
+    if ( p_mrc->clock == p_mrc->window ) hash_cache_mrc_compact(p_mrc);
+
+    // Move the hash to the front
+    hash_cache_ghost_push(p_ghost, 0, h);
+
+    // Store the time of the reference
+    p_mrc->p_times[p_ghost->lists[0].head] = p_mrc->clock;
+    hash_cache_mrc_tree_add(p_mrc, p_mrc->clock, 1);
+    p_mrc->clock++;
+
+    // Fade old references
+    if ( p_mrc->references == HASH_CACHE_MRC_HALF_LIFE )
+    {
+
+        // Halve the references
+        p_mrc->references >>= 1;
+
+        // Halve the hits
+        for (size_t i = 0; i < HASH_CACHE_MRC_POINTS; i++)
+            p_mrc->hits[i] >>= 1;
+    }
+
+    // Done
+    return;
+}
+
+int hash_cache_mrc_clear ( hash_cache_mrc *const p_mrc )
+{
+
+    // Argument check
+    if ( p_mrc == (void *) 0 ) goto no_mrc;
+
+    // Forget the sampled hashes
+    hash_cache_ghost_clear(p_mrc->p_ghost);
+
+    // Empty the tree
+    memset(p_mrc->p_tree, 0, sizeof(size_t) * ( p_mrc->window + 1 ));
+
+    // Reset the clock and the counts
+    p_mrc->clock      = 0;
+    p_mrc->references = 0;
+    memset(p_mrc->hits, 0, sizeof(p_mrc->hits));
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_mrc:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [mrc] Null pointer provided for parameter \"p_mrc\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_mrc_destroy ( hash_cache_mrc **const pp_mrc )
+{
+
+    // Argument check
+    if ( pp_mrc  == (void *) 0 ) goto no_mrc;
+    if ( *pp_mrc == (void *) 0 ) goto no_mrc;
+
+    // Initialized data
+    hash_cache_mrc *p_mrc = *pp_mrc;
+
+    // No more pointer for caller
+    *pp_mrc = (void *) 0;
+
+    // Destroy the ghost list
+    hash_cache_ghost_destroy(&p_mrc->p_ghost);
+
+    // Free the times and the tree
+    if ( HASH_CACHE_REALLOC(p_mrc->p_times, 0) ) goto failed_to_free;
+
+    // Free the estimator
+    if ( HASH_CACHE_REALLOC(p_mrc, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_mrc:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [mrc] Null pointer provided for parameter \"pp_mrc\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void hash_cache_mrc_compact ( hash_cache_mrc *const p_mrc )
+{
+
+    // Initialized data
+    hash_cache_ghost *p_ghost = p_mrc->p_ghost;
+    size_t            time    = 0;
+
+    // Empty the tree
+    memset(p_mrc->p_tree, 0, sizeof(size_t) * ( p_mrc->window + 1 ));
+
+    // Walk the sampled hashes, oldest first
+    for (size_t i = p_ghost->lists[0].tail; i != HASH_CACHE_GHOST_NIL; i = p_ghost->p_entries[i].prev, time++)
+        p_mrc->p_times[i] = time,
+        hash_cache_mrc_tree_add(p_mrc, time, 1);
+
+    // The next reference follows the newest hash
+    p_mrc->clock = time;
+
+    // Done
+    return;
+}
@@ -0,0 +1,473 @@
+/** !
+ * Implementation of set associative cache
+ *
+ * @file set_cache.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/set_cache.h>
+
+// Standard library
+#include <stdlib.h>
+#include <string.h>
+
+// Function declarations
+/** !
+ * Compute the tag of a hash from its high bits, which is never 0
+ *
+ * @param h the hash
+ *
+ * @return the tag
+ */
+static inline unsigned char set_cache_tag ( hash64 h )
+{
+
+    // Initialized data
+    unsigned char tag = (unsigned char) ( h >> 56 );
+
+    // Success
+    return ( tag ) ? tag : 1;
+}
+
+/** !
+ * Find the way of a key in a set
+ *
+ * @param p_set_cache the set associative cache
+ * @param p_set       the set
+ * @param p_key       the key
+ * @param tag         the tag of the key's hash
+ *
+ * @return the way of the key on hit, SET_CACHE_WAYS on miss
+ */
+static inline size_t set_cache_find ( const set_cache *const p_set_cache, const set_cache_set *const p_set, const void *const p_key, unsigned char tag )
+{
+
+    // Initialized data
+    size_t way = 0;
+
+    // Compare the tag first, and the key only if the tag matches
+    for (; way < SET_CACHE_WAYS; way++)
+        if ( p_set->tags[way] == tag && p_set_cache->pfn_equality(p_set_cache->pfn_key_get(p_set->p_values[way]), p_key) == 0 ) break;
+
+    // Hit, or SET_CACHE_WAYS on miss
+    return way;
+}
+
+/** !
+ * Mark a way of a set as used. When every way has been used, the other
+ * ways' bits are cleared.
+ *
+ * @param p_set the set
+ * @param way   the way
+ *
+ * @return void
+ */
+static inline void set_cache_use ( set_cache_set *const p_set, size_t way )
+{
+
+    // Mark the way
+    p_set->recent |= (unsigned char) ( 1U << way );
+
+    // Start a new round, if every way was used
+    if ( p_set->recent == ( 1U << SET_CACHE_WAYS ) - 1 ) p_set->recent = (unsigned char) ( 1U << way );
+
+    // Done
+    return;
+}
+
+// Function definitions
+int set_cache_construct ( set_cache **const pp_set_cache, size_t size, const set_cache_options *const p_options )
+{
+
+    // Argument check
+    if ( pp_set_cache == (void *) 0 ) goto no_set_cache;
+    if ( size         ==          0 ) goto invalid_size;
+
+    // Initialized data
+    set_cache_options  _options    = ( p_options ) ? *p_options : (set_cache_options) { 0 };
+    set_cache         *p_set_cache = (void *) 0;
+    size_t             sets        = 1;
+
+    // The default key hash only agrees with the default equality function
+    if ( _options.pfn_key_hash == (void *) 0 && _options.pfn_equality == (void *) 0 ) _options.pfn_key_hash = (fn_hash_cache_key_hash *) hash_cache_key_hash;
+
+    // Error check
+    if ( _options.pfn_key_hash == (void *) 0 ) goto no_key_hash;
+
+    // Compute the quantity of sets
+    while ( sets * SET_CACHE_WAYS < size ) sets <<= 1;
+
+    // Allocate memory for the set associative cache
+    p_set_cache = HASH_CACHE_REALLOC(0, sizeof(set_cache));
+
+    // Error check
+    if ( p_set_cache == (void *) 0 ) goto no_mem;
+
+    // Initialize the set associative cache
+    *p_set_cache = (set_cache)
+    {
+        .p_sets       = (void *) 0,
+        .p_allocation = HASH_CACHE_REALLOC(0, sets * sizeof(set_cache_set) + 64),
+        .mask         = sets - 1,
+        .pfn_equality = ( _options.pfn_equality ) ? _options.pfn_equality : (fn_hash_cache_equality *) hash_cache_equals,
+        .pfn_key_get  = ( _options.pfn_key_get ) ? _options.pfn_key_get : (fn_hash_cache_key_accessor *) hash_cache_key_accessor,
+        .pfn_key_hash = _options.pfn_key_hash,
+        .pfn_evict    = _options.pfn_evict,
+        .p_context    = _options.p_context
+    };
+
+    // Error check
+    if ( p_set_cache->p_allocation == (void *) 0 ) goto no_mem;
+
+    // Align the sets to a cache line
+    p_set_cache->p_sets = (void *) ((((size_t) p_set_cache->p_allocation) + 63) & ~(size_t) 63);
+
+    // Every way starts empty
+    memset(p_set_cache->p_sets, 0, sets * sizeof(set_cache_set));
+
+    // Return a pointer to the caller
+    *pp_set_cache = p_set_cache;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_set_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"pp_set_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Parameter \"size\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key_hash:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Picking a set requires a key hashing function when the equality function is not the default in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_set_cache ) p_set_cache = HASH_CACHE_REALLOC(p_set_cache, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int set_cache_get ( set_cache *const p_set_cache, const void *const p_key, void **const pp_result )
+{
+
+    // Argument check
+    if ( p_set_cache == (void *) 0 ) goto no_set_cache;
+    if ( p_key       == (void *) 0 ) goto no_key;
+    if ( pp_result   == (void *) 0 ) goto no_result;
+
+    // Initialized data
+    hash64         h     = p_set_cache->pfn_key_hash(p_key);
+    set_cache_set *p_set = &p_set_cache->p_sets[h & p_set_cache->mask];
+    size_t         way   = set_cache_find(p_set_cache, p_set, p_key, set_cache_tag(h));
+
+    // Miss
+    if ( way == SET_CACHE_WAYS ) return 0;
+
+    // Mark the way
+    set_cache_use(p_set, way);
+
+    // Return the value to the caller
+    *pp_result = p_set->p_values[way];
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_set_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_set_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_result:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"pp_result\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+size_t set_cache_bytes ( const set_cache *const p_set_cache )
+{
+
+    // Argument check
+    if ( p_set_cache == (void *) 0 ) goto no_set_cache;
+
+    // Success
+    return ( p_set_cache->mask + 1 ) * sizeof(set_cache_set);
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_set_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_set_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int set_cache_insert ( set_cache *const p_set_cache, const void *const p_key, const void *const p_value )
+{
+
+    // Argument check
+    if ( p_set_cache == (void *) 0 ) goto no_set_cache;
+    if ( p_key       == (void *) 0 ) goto no_key;
+    if ( p_value     == (void *) 0 ) goto no_value;
+
+    // Initialized data
+    hash64         h     = p_set_cache->pfn_key_hash(p_key);
+    unsigned char  tag   = set_cache_tag(h);
+    set_cache_set *p_set = &p_set_cache->p_sets[h & p_set_cache->mask];
+    size_t         way   = set_cache_find(p_set_cache, p_set, p_key, tag);
+    void          *p_old = (void *) 0;
+
+    // If the key isn't in the set ...
+    if ( way == SET_CACHE_WAYS )
+    {
+
+        // ... take an empty way ...
+        for (way = 0; way < SET_CACHE_WAYS && p_set->tags[way]; way++);
+
+        // ... or the first way that wasn't used this round
+        if ( way == SET_CACHE_WAYS )
+            for (way = 0; p_set->recent & ( 1U << way ); way++);
+    }
+
+    // Store the old value
+    p_old = p_set->p_values[way];
+
+    // Store the value and its tag
+    p_set->p_values[way] = (void *) p_value;
+    p_set->tags[way]     = tag;
+
+    // Mark the way
+    set_cache_use(p_set, way);
+
+    // Hand the replaced or evicted value to the caller
+    if ( p_set_cache->pfn_evict && p_old && p_old != p_value ) p_set_cache->pfn_evict(p_old, p_set_cache->p_context);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_set_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_set_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_value:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_value\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int set_cache_remove ( set_cache *const p_set_cache, const void *const p_key, void **const pp_result )
+{
+
+    // Argument check
+    if ( p_set_cache == (void *) 0 ) goto no_set_cache;
+    if ( p_key       == (void *) 0 ) goto no_key;
+
+    // Initialized data
+    hash64         h     = p_set_cache->pfn_key_hash(p_key);
+    set_cache_set *p_set = &p_set_cache->p_sets[h & p_set_cache->mask];
+    size_t         way   = set_cache_find(p_set_cache, p_set, p_key, set_cache_tag(h));
+
+    // Miss
+    if ( way == SET_CACHE_WAYS ) return 0;
+
+    // Return the value to the caller
+    if ( pp_result ) *pp_result = p_set->p_values[way];
+
+    // Empty the way
+    p_set->p_values[way]  = (void *) 0;
+    p_set->tags[way]      = 0;
+    p_set->recent        &= (unsigned char) ~( 1U << way );
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_set_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_set_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int set_cache_clear ( set_cache *const p_set_cache, fn_hash_cache_free *pfn_free )
+{
+
+    // Argument check
+    if ( p_set_cache == (void *) 0 ) goto no_set_cache;
+
+    // Free each value
+    if ( pfn_free )
+        for (size_t i = 0; i <= p_set_cache->mask; i++)
+            for (size_t way = 0; way < SET_CACHE_WAYS; way++)
+                if ( p_set_cache->p_sets[i].p_values[way] ) pfn_free(p_set_cache->p_sets[i].p_values[way]);
+
+    // Empty every way
+    memset(p_set_cache->p_sets, 0, ( p_set_cache->mask + 1 ) * sizeof(set_cache_set));
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_set_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"p_set_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int set_cache_destroy ( set_cache **const pp_set_cache, fn_hash_cache_free *pfn_free )
+{
+
+    // Argument check
+    if ( pp_set_cache  == (void *) 0 ) goto no_set_cache;
+    if ( *pp_set_cache == (void *) 0 ) goto no_set_cache;
+
+    // Initialized data
+    set_cache *p_set_cache = *pp_set_cache;
+
+    // No more pointer for caller
+    *pp_set_cache = (void *) 0;
+
+    // Free each value
+    set_cache_clear(p_set_cache, pfn_free);
+
+    // Free the sets
+    if ( HASH_CACHE_REALLOC(p_set_cache->p_allocation, 0) ) goto failed_to_free;
+
+    // Free the set associative cache
+    if ( HASH_CACHE_REALLOC(p_set_cache, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_set_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [set cache] Null pointer provided for parameter \"pp_set_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
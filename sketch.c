@@ -0,0 +1,265 @@
+/** !
+ * Implementation of count-min frequency sketch
+ *
+ * @file sketch.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/sketch.h>
+
+// Standard library
+#include <stdlib.h>
+#include <string.h>
+
+// Data
+static const unsigned long long sketch_seeds[HASH_CACHE_SKETCH_DEPTH] =
+{
+    0xC3A5C85C97CB3127, 0xB492B66FBE98F273,
+    0x9AE16A3B2F90404F, 0xCBF29CE484222325
+};
+
+// Function declarations
+/** !
+ * Compute the position of a hash's counter in one row of a sketch. The high
+ * bits pick the word and the low bits pick the counter in the word.
+ *
+ * @param p_sketch the sketch
+ * @param h        the hash
+ * @param i        the row
+ * @param p_shift  return the shift of the counter in the word
+ *
+ * @return the index of the word
+ */
+static inline size_t hash_cache_sketch_index ( const hash_cache_sketch *const p_sketch, hash64 h, size_t i, unsigned int *p_shift )
+{
+
+    // Initialized data
+    unsigned long long x = ( h + sketch_seeds[i] ) * sketch_seeds[i];
+
+    // Mix the high bits down
+    x ^= x >> 29;
+
+    // Each row uses a different counter in the word
+    *p_shift = (unsigned int) ( ( ( x & 3 ) << 2 | i ) << 2 );
+
+    // Success
+    return (size_t) ( x >> 2 ) & p_sketch->mask;
+}
+
+// Function definitions
+int hash_cache_sketch_construct ( hash_cache_sketch **const pp_sketch, size_t expected )
+{
+
+    // Argument check
+    if ( pp_sketch == (void *) 0 ) goto no_sketch;
+    if ( expected  ==          0 ) goto invalid_expected;
+
+    // Initialized data
+    hash_cache_sketch *p_sketch = HASH_CACHE_REALLOC(0, sizeof(hash_cache_sketch));
+    size_t             words    = 1;
+
+    // Error check
+    if ( p_sketch == (void *) 0 ) goto no_mem;
+
+    // One word of counters per expected key
+    while ( words < expected ) words <<= 1;
+
+    // Initialize the sketch
+    *p_sketch = (hash_cache_sketch)
+    {
+        .p_table   = HASH_CACHE_REALLOC(0, words * sizeof(unsigned long long)),
+        .mask      = words - 1,
+        .additions = 0,
+        .sample    = HASH_CACHE_SKETCH_SAMPLE * expected
+    };
+
+    // Error check
+    if ( p_sketch->p_table == (void *) 0 ) goto no_mem;
+
+    // Every counter starts at zero
+    hash_cache_sketch_clear(p_sketch);
+
+    // Return a pointer to the caller
+    *pp_sketch = p_sketch;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_sketch:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [sketch] Null pointer provided for parameter \"pp_sketch\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_expected:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [sketch] Parameter \"expected\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_sketch ) p_sketch = HASH_CACHE_REALLOC(p_sketch, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+unsigned int hash_cache_sketch_estimate ( const hash_cache_sketch *const p_sketch, hash64 h )
+{
+
+    // Initialized data
+    unsigned int result = HASH_CACHE_SKETCH_COUNTER_MAX;
+
+    // The estimate is the smallest counter
+    for (size_t i = 0; i < HASH_CACHE_SKETCH_DEPTH; i++)
+    {
+
+        // Initialized data
+        unsigned int shift = 0;
+        size_t       word  = hash_cache_sketch_index(p_sketch, h, i, &shift);
+        unsigned int count = (unsigned int) ( p_sketch->p_table[word] >> shift ) & 0xF;
+
+        // Keep the minimum
+        if ( count < result ) result = count;
+    }
+
+    // Success
+    return result;
+}
+
+void hash_cache_sketch_increment ( hash_cache_sketch *const p_sketch, hash64 h )
+{
+
+    // Initialized data
+    bool added = false;
+
+    // Increment each row's counter, unless it's saturated
+    for (size_t i = 0; i < HASH_CACHE_SKETCH_DEPTH; i++)
+    {
+
+        // Initialized data
+        unsigned int shift = 0;
+        size_t       word  = hash_cache_sketch_index(p_sketch, h, i, &shift);
+
+        // Saturated?
+        if ( ( ( p_sketch->p_table[word] >> shift ) & 0xF ) == HASH_CACHE_SKETCH_COUNTER_MAX ) continue;
+
+        // Increment the counter
+        p_sketch->p_table[word] += 1ULL << shift;
+        added = true;
+    }
+
+    // Done?
+    if ( added == false || ++p_sketch->additions < p_sketch->sample ) return;
+
+    // Halve every counter
+    for (size_t i = 0; i <= p_sketch->mask; i++)
+        p_sketch->p_table[i] = ( p_sketch->p_table[i] >> 1 ) & 0x7777777777777777;
+
+    // Halve the sample
+    p_sketch->additions /= 2;
+
+    // Done
+    return;
+}
+
+int hash_cache_sketch_clear ( hash_cache_sketch *const p_sketch )
+{
+
+    // Argument check
+    if ( p_sketch == (void *) 0 ) goto no_sketch;
+
+    // Zero every counter
+    memset(p_sketch->p_table, 0, ( p_sketch->mask + 1 ) * sizeof(unsigned long long));
+
+    // Reset the sample
+    p_sketch->additions = 0;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_sketch:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [sketch] Null pointer provided for parameter \"p_sketch\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_sketch_destroy ( hash_cache_sketch **const pp_sketch )
+{
+
+    // Argument check
+    if ( pp_sketch  == (void *) 0 ) goto no_sketch;
+    if ( *pp_sketch == (void *) 0 ) goto no_sketch;
+
+    // Initialized data
+    hash_cache_sketch *p_sketch = *pp_sketch;
+
+    // No more pointer for caller
+    *pp_sketch = (void *) 0;
+
+    // Free the counters
+    if ( HASH_CACHE_REALLOC(p_sketch->p_table, 0) ) goto failed_to_free;
+
+    // Free the sketch
+    if ( HASH_CACHE_REALLOC(p_sketch, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_sketch:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [sketch] Null pointer provided for parameter \"pp_sketch\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
@@ -0,0 +1,348 @@
+/** !
+ * Tests for the arena and slab allocators
+ *
+ * @file tests/allocator_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+// hash cache
+#include <hash_cache/allocator.h>
+#include <hash_cache/cache.h>
+#include <hash_cache/hash_table.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define ALLOCATOR_TEST_SLABS   12
+#define ALLOCATOR_TEST_THREADS 6
+#define ALLOCATOR_TEST_HELD    40
+#define ALLOCATOR_TEST_BLOCK   32
+
+// Data
+static hash_cache_slab *p_slabs[ALLOCATOR_TEST_SLABS] = { 0 };
+
+// Forward declarations
+/** !
+ * Allocate from an arena, run out of space, and reset it
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_arena ( void );
+
+/** !
+ * Back a cache with an arena. A second structure can't use the arena until
+ * the cache is destroyed, and destroying the cache rewinds the arena
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_arena_owner ( void );
+
+/** !
+ * Allocate, free, and allocate again from a slab on one thread. Freed
+ * objects are reused, so the slab doesn't grow
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_slab ( void );
+
+/** !
+ * Allocate and free objects of many slabs from many threads. Each thread
+ * uses more slabs than it keeps free lists for. After the threads exit,
+ * every object of every slab is back on its slab's free list
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_slab_threads ( void );
+
+/** !
+ * Randomly allocate and free objects of each slab, checking that no object
+ * is handed out twice
+ *
+ * @param p_parameter the seed of the thread
+ *
+ * @return 0 on pass, else the thread's parameter
+ */
+static void *test_slab_thread ( void *p_parameter );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_arena, passed);
+    HASH_CACHE_TEST_RUN(test_arena_owner, passed);
+    HASH_CACHE_TEST_RUN(test_slab, passed);
+    HASH_CACHE_TEST_RUN(test_slab_threads, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_arena ( void )
+{
+
+    // Initialized data
+    hash_cache_arena *p_arena = (void *) 0;
+    unsigned char    *p_a     = (void *) 0,
+                     *p_b     = (void *) 0;
+
+    // Construct an arena
+    HASH_CACHE_TEST(hash_cache_arena_construct(&p_arena, 4096));
+
+    // Allocations are aligned, and don't overlap
+    p_a = hash_cache_arena_alloc(p_arena, 10);
+    p_b = hash_cache_arena_alloc(p_arena, 10);
+    HASH_CACHE_TEST(p_a && p_b);
+    HASH_CACHE_TEST(( (size_t) p_a % HASH_CACHE_ALLOCATOR_ALIGNMENT ) == 0);
+    HASH_CACHE_TEST(( (size_t) p_b % HASH_CACHE_ALLOCATOR_ALIGNMENT ) == 0);
+    HASH_CACHE_TEST(p_b >= p_a + 10);
+
+    // An allocation larger than the arena fails
+    HASH_CACHE_TEST(hash_cache_arena_alloc(p_arena, 8192) == (void *) 0);
+
+    // Reset the arena, and the next allocation starts over
+    HASH_CACHE_TEST(hash_cache_arena_reset(p_arena));
+    HASH_CACHE_TEST(hash_cache_arena_alloc(p_arena, 10) == p_a);
+
+    // Destroy the arena
+    HASH_CACHE_TEST(hash_cache_arena_destroy(&p_arena));
+    HASH_CACHE_TEST(p_arena == (void *) 0);
+
+    // An arena can't be destroyed twice
+    HASH_CACHE_TEST(hash_cache_arena_destroy(&p_arena) == 0);
+
+    // Pass
+    return 1;
+}
+
+static int test_arena_owner ( void )
+{
+
+    // Initialized data
+    hash_cache_arena   *p_arena      = (void *) 0;
+    cache              *p_cache      = (void *) 0,
+                       *p_other      = (void *) 0;
+    hash_table         *p_hash_table = (void *) 0;
+    cache_options       _options     = { 0 };
+    hash_table_options  _ht_options  = { 0 };
+    size_t              mark         = 0;
+
+    // Construct an arena
+    HASH_CACHE_TEST(hash_cache_arena_construct(&p_arena, 1 << 20));
+
+    // Use the arena
+    _options.p_allocator    = &p_arena->_allocator;
+    _ht_options.p_allocator = &p_arena->_allocator;
+
+    // Remember where the arena was before the cache
+    mark = p_arena->offset;
+
+    // Back a cache with the arena
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, 100, &_options));
+    HASH_CACHE_TEST(p_arena->offset > mark);
+
+    // Nothing else may use the arena while the cache does
+    HASH_CACHE_TEST(cache_construct_options(&p_other, 100, &_options) == 0);
+    HASH_CACHE_TEST(hash_table_construct_options(&p_hash_table, 100, &_ht_options) == 0);
+
+    // Destroying the cache rewinds the arena, and releases it
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+    HASH_CACHE_TEST(p_arena->offset == mark);
+
+    // Now a hash table may use the arena
+    HASH_CACHE_TEST(hash_table_construct_options(&p_hash_table, 100, &_ht_options));
+    HASH_CACHE_TEST(hash_table_destroy(&p_hash_table, (void *) 0));
+
+    // The heap is shared by any quantity of caches
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, 10, (void *) 0));
+    HASH_CACHE_TEST(cache_construct_options(&p_other, 10, (void *) 0));
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+    HASH_CACHE_TEST(cache_destroy(&p_other, (void *) 0));
+
+    // Destroy the arena
+    HASH_CACHE_TEST(hash_cache_arena_destroy(&p_arena));
+
+    // Pass
+    return 1;
+}
+
+static int test_slab ( void )
+{
+
+    // Initialized data
+    hash_cache_slab *p_slab       = (void *) 0;
+    void            *objects[100] = { 0 };
+    size_t           blocks       = 0;
+
+    // Construct a slab
+    HASH_CACHE_TEST(hash_cache_slab_construct(&p_slab, 24, 16));
+
+    // Allocate each object, and write to it
+    for (size_t i = 0; i < 100; i++)
+    {
+
+        // Allocate an object
+        objects[i] = hash_cache_slab_alloc(p_slab);
+        HASH_CACHE_TEST(objects[i]);
+
+        // Write to the object
+        *(size_t *) objects[i] = i;
+    }
+
+    // No object was handed out twice
+    for (size_t i = 0; i < 100; i++)
+        HASH_CACHE_TEST(*(size_t *) objects[i] == i);
+
+    // Remember the size of the slab
+    blocks = p_slab->blocks;
+
+    // Free each object, and allocate it again
+    for (size_t i = 0; i < 100; i++) HASH_CACHE_TEST(hash_cache_slab_free(p_slab, objects[i]));
+    for (size_t i = 0; i < 100; i++) HASH_CACHE_TEST(objects[i] = hash_cache_slab_alloc(p_slab));
+
+    // The freed objects were reused
+    HASH_CACHE_TEST(p_slab->blocks == blocks);
+
+    // Destroy the slab
+    HASH_CACHE_TEST(hash_cache_slab_destroy(&p_slab));
+    HASH_CACHE_TEST(p_slab == (void *) 0);
+
+    // A slab can't be destroyed twice
+    HASH_CACHE_TEST(hash_cache_slab_destroy(&p_slab) == 0);
+
+    // Pass
+    return 1;
+}
+
+static int test_slab_threads ( void )
+{
+
+    // Initialized data
+    pthread_t threads[ALLOCATOR_TEST_THREADS] = { 0 };
+
+    // Construct each slab
+    for (size_t i = 0; i < ALLOCATOR_TEST_SLABS; i++)
+        HASH_CACHE_TEST(hash_cache_slab_construct(&p_slabs[i], sizeof(size_t) * 3, ALLOCATOR_TEST_BLOCK));
+
+    // Run a few rounds of threads, so the free lists of exited threads are reused
+    for (size_t round = 0; round < 3; round++)
+    {
+
+        // Start each thread
+        for (size_t i = 0; i < ALLOCATOR_TEST_THREADS; i++)
+            HASH_CACHE_TEST(pthread_create(&threads[i], (void *) 0, test_slab_thread, (void *) ( round * ALLOCATOR_TEST_THREADS + i + 1 )) == 0);
+
+        // Wait for each thread
+        for (size_t i = 0; i < ALLOCATOR_TEST_THREADS; i++)
+        {
+
+            // Initialized data
+            void *p_result = (void *) 0;
+
+            // Join the thread
+            HASH_CACHE_TEST(pthread_join(threads[i], &p_result) == 0);
+
+            // The thread didn't see an object twice
+            HASH_CACHE_TEST(p_result == (void *) 0);
+        }
+    }
+
+    // Every object of each slab is on its free list
+    for (size_t i = 0; i < ALLOCATOR_TEST_SLABS; i++)
+    {
+
+        // Initialized data
+        size_t available = 0;
+
+        // Count the free objects
+        for (void *p = p_slabs[i]->p_free; p; p = *(void **) p) available++;
+
+        // No object was lost
+        HASH_CACHE_TEST(available == p_slabs[i]->blocks * ALLOCATOR_TEST_BLOCK);
+    }
+
+    // Destroy each slab
+    for (size_t i = 0; i < ALLOCATOR_TEST_SLABS; i++)
+        HASH_CACHE_TEST(hash_cache_slab_destroy(&p_slabs[i]));
+
+    // Pass
+    return 1;
+}
+
+static void *test_slab_thread ( void *p_parameter )
+{
+
+    // Initialized data
+    unsigned  seed                                            = (unsigned) (size_t) p_parameter;
+    void     *held[ALLOCATOR_TEST_SLABS][ALLOCATOR_TEST_HELD] = { { 0 } };
+    size_t    quantity[ALLOCATOR_TEST_SLABS]                  = { 0 };
+
+    // Allocate and free at random
+    for (size_t i = 0; i < 100000; i++)
+    {
+
+        // Initialized data
+        size_t s = 0;
+
+        // Pick a slab
+        seed = seed * 1103515245 + 12345;
+        s    = ( seed >> 16 ) % ALLOCATOR_TEST_SLABS;
+
+        // Allocate an object, and mark it with its slab ...
+        if ( quantity[s] < ALLOCATOR_TEST_HELD && ( ( seed >> 8 ) & 1 ) )
+        {
+
+            // Initialized data
+            size_t *p_object = hash_cache_slab_alloc(p_slabs[s]);
+
+            // Error check
+            if ( p_object == (void *) 0 ) return p_parameter;
+
+            // Mark the object
+            *p_object = s, held[s][quantity[s]++] = p_object;
+        }
+
+        // ... or check the mark of an object, and free it
+        else if ( quantity[s] )
+        {
+
+            // Initialized data
+            size_t *p_object = held[s][--quantity[s]];
+
+            // Error check
+            if ( *p_object != s ) return p_parameter;
+
+            // Free the object
+            hash_cache_slab_free(p_slabs[s], p_object);
+        }
+    }
+
+    // Free each held object
+    for (size_t s = 0; s < ALLOCATOR_TEST_SLABS; s++)
+        while ( quantity[s] ) hash_cache_slab_free(p_slabs[s], held[s][--quantity[s]]);
+
+    // Pass
+    return (void *) 0;
+}
@@ -0,0 +1,240 @@
+/** !
+ * Tests for the blocked bloom filter
+ *
+ * @file tests/bloom_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+
+// hash cache
+#include <hash_cache/bloom.h>
+#include <hash_cache/cache.h>
+#include <hash_cache/hash_table.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define BLOOM_TEST_KEYS    10000
+#define BLOOM_TEST_QUERIES 100000
+
+// Data
+static bool evicted[4096] = { 0 };
+
+// Forward declarations
+/** !
+ * Insert keys into a bloom filter. Every inserted key is found, few other
+ * keys are, and no key is found after the filter is cleared
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_bloom ( void );
+
+/** !
+ * Insert many more keys into a cache than its bloom filter expects, so the
+ * filter is rebuilt from the cache's keys. Every key that wasn't evicted is
+ * still found
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_bloom_cache ( void );
+
+/** !
+ * Grow a hash table with a bloom filter. Every key is still found, and the
+ * keys that were never inserted aren't
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_bloom_hash_table ( void );
+
+/** !
+ * Remember that a key was evicted
+ *
+ * @param p_value   the value of the evicted key
+ * @param p_context unused
+ *
+ * @return void
+ */
+static void test_bloom_evict ( void *p_value, void *p_context );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_bloom, passed);
+    HASH_CACHE_TEST_RUN(test_bloom_cache, passed);
+    HASH_CACHE_TEST_RUN(test_bloom_hash_table, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_bloom ( void )
+{
+
+    // Initialized data
+    hash_cache_bloom *p_bloom         = (void *) 0;
+    size_t            false_positives = 0;
+
+    // Construct a bloom filter
+    HASH_CACHE_TEST(hash_cache_bloom_construct(&p_bloom, BLOOM_TEST_KEYS));
+
+    // Insert each key
+    for (size_t i = 0; i < BLOOM_TEST_KEYS; i++)
+        hash_cache_bloom_insert(p_bloom, hash_cache_key_hash(HASH_CACHE_TEST_KEY(i)));
+
+    // Every inserted key is found
+    for (size_t i = 0; i < BLOOM_TEST_KEYS; i++)
+        HASH_CACHE_TEST(hash_cache_bloom_query(p_bloom, hash_cache_key_hash(HASH_CACHE_TEST_KEY(i))));
+
+    // Count the keys that are found, but were never inserted
+    for (size_t i = BLOOM_TEST_KEYS; i < BLOOM_TEST_KEYS + BLOOM_TEST_QUERIES; i++)
+        false_positives += hash_cache_bloom_query(p_bloom, hash_cache_key_hash(HASH_CACHE_TEST_KEY(i)));
+
+    // Few of them are. 12 bits per key is about 1% in theory
+    HASH_CACHE_TEST(false_positives < BLOOM_TEST_QUERIES / 20);
+
+    // Clear the filter, and no key is found
+    HASH_CACHE_TEST(hash_cache_bloom_clear(p_bloom));
+    for (size_t i = 0; i < BLOOM_TEST_KEYS; i++)
+        HASH_CACHE_TEST(hash_cache_bloom_query(p_bloom, hash_cache_key_hash(HASH_CACHE_TEST_KEY(i))) == false);
+
+    // Destroy the bloom filter
+    HASH_CACHE_TEST(hash_cache_bloom_destroy(&p_bloom));
+    HASH_CACHE_TEST(p_bloom == (void *) 0);
+
+    // Pass
+    return 1;
+}
+
+static int test_bloom_cache ( void )
+{
+
+    // Initialized data
+    cache         *p_cache  = (void *) 0;
+    cache_options  _options =
+    {
+        .bloom     = 64,
+        .pfn_evict = test_bloom_evict
+    };
+
+    // Construct a cache with a bloom filter
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, 128, &_options));
+
+    // Insert many times more keys than the filter expects
+    for (size_t i = 0; i < 4096; i++)
+        HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i)));
+
+    // Every key that wasn't evicted is found
+    for (size_t i = 0; i < 4096; i++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Search the cache
+        HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(i), &p_value) == !evicted[i]);
+
+        // Check the value
+        HASH_CACHE_TEST(evicted[i] || p_value == HASH_CACHE_TEST_KEY(i));
+    }
+
+    // A key that was never inserted isn't found
+    for (size_t i = 4096; i < 8192; i++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Search the cache
+        HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(i), &p_value) == 0);
+    }
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_bloom_hash_table ( void )
+{
+
+    // Initialized data
+    hash_table         *p_hash_table = (void *) 0;
+    hash_table_options  _options     = { .bloom = 64 };
+
+    // Construct a hash table with a bloom filter
+    HASH_CACHE_TEST(hash_table_construct_options(&p_hash_table, 64, &_options));
+
+    // Insert some keys
+    for (size_t i = 0; i < 48; i++)
+        HASH_CACHE_TEST(hash_table_insert(p_hash_table, HASH_CACHE_TEST_KEY(i)));
+
+    // Grow the hash table, which rebuilds the filter
+    HASH_CACHE_TEST(hash_table_resize(p_hash_table, 1024));
+
+    // Insert many more keys
+    for (size_t i = 48; i < 768; i++)
+        HASH_CACHE_TEST(hash_table_insert(p_hash_table, HASH_CACHE_TEST_KEY(i)));
+
+    // Every key is found
+    for (size_t i = 0; i < 768; i++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Search the hash table
+        HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(i), &p_value));
+        HASH_CACHE_TEST(p_value == HASH_CACHE_TEST_KEY(i));
+    }
+
+    // A key that was never inserted isn't found
+    for (size_t i = 768; i < 4096; i++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Search the hash table
+        HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(i), &p_value) == 0);
+    }
+
+    // Destroy the hash table
+    HASH_CACHE_TEST(hash_table_destroy(&p_hash_table, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static void test_bloom_evict ( void *p_value, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Remember the key was evicted
+    evicted[(size_t) p_value >> 1] = true;
+
+    // Done
+    return;
+}
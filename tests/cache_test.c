@@ -0,0 +1,542 @@
+/** !
+ * Tests for the cache
+ *
+ * @file tests/cache_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// hash cache
+#include <hash_cache/cache.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define CACHE_TEST_SIZE  32
+#define CACHE_TEST_WORDS 48
+#define CACHE_TEST_BATCH 25
+#define CACHE_TEST_CHEAP 20
+#define CACHE_TEST_SMALL 100
+#define CACHE_TEST_LARGE 1000
+#define CACHE_TEST_TAG   0xAB
+#define CACHE_TEST_COUNT 256
+
+// Type definitions
+typedef struct
+{
+    const void *p_key;
+    size_t      count;
+} test_cache_counter;
+
+typedef struct
+{
+    size_t found,
+           created;
+    int    fail;
+} test_cache_upsert_context;
+
+// Data
+static char               words[CACHE_TEST_WORDS][8]  = { { 0 } };
+static size_t             evictions[CACHE_TEST_BATCH] = { 0 },
+                          equalities                  = 0;
+static test_cache_counter counters[CACHE_TEST_SIZE]   = { { 0 } };
+
+// Forward declarations
+/** !
+ * A cache constructed with cache_construct and a custom equality function
+ * has no key hash. It still finds every key by equality, evicts in LRU
+ * order, and removes keys
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_cache_custom_equality ( void );
+
+/** !
+ * cache_insert_many adds the values that fit the budget, and passes each
+ * value that doesn't to the evict function, once
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_cache_insert_many_budget ( void );
+
+/** !
+ * Every key of a small cache has the same tag, so each search compares
+ * every slot by hash and key. Hits, misses, and removals agree with a large
+ * cache, which searches its buckets
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_cache_tag_collisions ( void );
+
+/** !
+ * Count words with cache_upsert. The create function is called once per
+ * word, and the found function for every other occurrence. A create
+ * function that fails inserts nothing
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_cache_upsert ( void );
+
+/** !
+ * Every key has the same hash, so each slot matches the stored hash, and
+ * the equality function tells the keys apart. Get and upsert still find
+ * the right value, in a cache that searches its tags, and in a cache that
+ * searches its buckets
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_cache_collisions ( void );
+
+/** !
+ * The cost of a value. The first CACHE_TEST_CHEAP keys cost 1, and the
+ * rest cost more than any budget of the tests
+ *
+ * @param p_value the value
+ *
+ * @return the cost of the value
+ */
+static size_t test_cache_cost ( const void *const p_value );
+
+/** !
+ * Count an eviction of a key
+ *
+ * @param p_value   the value of the evicted key
+ * @param p_context unused
+ *
+ * @return void
+ */
+static void test_cache_evict ( void *p_value, void *p_context );
+
+/** !
+ * Hash the key i of HASH_CACHE_TEST_KEY, so that every key has the tag
+ * CACHE_TEST_TAG, and a unique hash
+ *
+ * @param p_key the key
+ *
+ * @return the hash of the key
+ */
+static hash64 test_cache_hash_tag ( const void *const p_key );
+
+/** !
+ * Get the key of a counter
+ *
+ * @param p_value the counter
+ *
+ * @return the key
+ */
+static void *test_cache_counter_key ( const void *const p_value );
+
+/** !
+ * Hash every key to the same hash
+ *
+ * @param p_key the key
+ *
+ * @return the hash of the key
+ */
+static hash64 test_cache_hash_constant ( const void *const p_key );
+
+/** !
+ * Compare two keys, and count the comparison
+ *
+ * @param p_a a key
+ * @param p_b another key
+ *
+ * @return 0 if the keys are equal
+ */
+static int test_cache_equality ( const void *const p_a, const void *const p_b );
+
+/** !
+ * Increment a counter
+ *
+ * @param p_value   the counter
+ * @param p_context the upsert context
+ *
+ * @return void
+ */
+static void test_cache_counter_found ( void *p_value, void *p_context );
+
+/** !
+ * Make a counter of a key, or fail if the context says so
+ *
+ * @param p_key     the key
+ * @param p_context the upsert context
+ *
+ * @return the counter, or 0 on failure
+ */
+static void *test_cache_counter_create ( const void *const p_key, void *p_context );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_cache_custom_equality, passed);
+    HASH_CACHE_TEST_RUN(test_cache_insert_many_budget, passed);
+    HASH_CACHE_TEST_RUN(test_cache_tag_collisions, passed);
+    HASH_CACHE_TEST_RUN(test_cache_upsert, passed);
+    HASH_CACHE_TEST_RUN(test_cache_collisions, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_cache_custom_equality ( void )
+{
+
+    // Initialized data
+    cache *p_cache = (void *) 0;
+    void  *p_value = (void *) 0;
+    char   _key[8] = { 0 };
+
+    // Construct a cache that compares keys as strings
+    HASH_CACHE_TEST(cache_construct(&p_cache, CACHE_TEST_SIZE, (fn_hash_cache_equality *) strcmp, (void *) 0));
+
+    // Insert more words than the cache holds
+    for (size_t i = 0; i < CACHE_TEST_WORDS; i++)
+    {
+
+        // Write the word
+        snprintf(words[i], sizeof(words[i]), "w%zu", i);
+
+        // Insert the word
+        HASH_CACHE_TEST(cache_insert(p_cache, words[i], words[i]));
+    }
+
+    // The oldest words were evicted, and the rest are found from a copy of the word
+    for (size_t i = 0; i < CACHE_TEST_WORDS; i++)
+    {
+
+        // Copy the word
+        snprintf(_key, sizeof(_key), "w%zu", i);
+
+        // Search the cache
+        HASH_CACHE_TEST(cache_get(p_cache, _key, &p_value) == ( i >= CACHE_TEST_WORDS - CACHE_TEST_SIZE ));
+        HASH_CACHE_TEST(i < CACHE_TEST_WORDS - CACHE_TEST_SIZE || p_value == words[i]);
+    }
+
+    // Remove a word
+    HASH_CACHE_TEST(cache_remove(p_cache, "w40", &p_value));
+    HASH_CACHE_TEST(p_value == words[40]);
+    HASH_CACHE_TEST(cache_get(p_cache, "w40", &p_value) == 0);
+    HASH_CACHE_TEST(p_cache->properties.count == CACHE_TEST_SIZE - 1);
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_cache_insert_many_budget ( void )
+{
+
+    // Initialized data
+    cache         *p_cache                   = (void *) 0;
+    cache_options  _options                  =
+    {
+        .pfn_cost  = test_cache_cost,
+        .budget    = 100,
+        .pfn_evict = test_cache_evict
+    };
+    const void    *keys[CACHE_TEST_BATCH]    = { 0 };
+    void          *p_value                   = (void *) 0;
+
+    // Construct a cache with a budget
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, 64, &_options));
+
+    // Make a batch of cheap and expensive properties
+    for (size_t i = 0; i < CACHE_TEST_BATCH; i++) keys[i] = HASH_CACHE_TEST_KEY(i);
+
+    // Only the cheap properties are added
+    HASH_CACHE_TEST(cache_insert_many(p_cache, keys, keys, CACHE_TEST_BATCH) == CACHE_TEST_CHEAP);
+
+    // Each expensive value was evicted once, and the cheap values are in the cache
+    for (size_t i = 0; i < CACHE_TEST_BATCH; i++)
+    {
+        HASH_CACHE_TEST(evictions[i] == ( i >= CACHE_TEST_CHEAP ));
+        HASH_CACHE_TEST(cache_get(p_cache, keys[i], &p_value) == ( i < CACHE_TEST_CHEAP ));
+    }
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_cache_tag_collisions ( void )
+{
+
+    // Initialized data
+    cache         *p_small  = (void *) 0,
+                  *p_large  = (void *) 0;
+    cache_options  _options = { .pfn_key_hash = test_cache_hash_tag };
+    void          *p_value  = (void *) 0;
+    size_t         found    = 0;
+
+    // Construct a cache that searches its tags, and a cache that searches its buckets
+    HASH_CACHE_TEST(cache_construct_options(&p_small, CACHE_TEST_SMALL, &_options));
+    HASH_CACHE_TEST(cache_construct_options(&p_large, CACHE_TEST_LARGE, &_options));
+    HASH_CACHE_TEST(p_small->index.p_tags != (void *) 0);
+    HASH_CACHE_TEST(p_large->index.p_tags == (void *) 0);
+
+    // Fill the small cache, and insert the same keys into the large cache
+    for (size_t i = 0; i < CACHE_TEST_SMALL; i++)
+    {
+        HASH_CACHE_TEST(cache_insert(p_small, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i)));
+        HASH_CACHE_TEST(cache_insert(p_large, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i)));
+    }
+
+    // Remove every third key from both caches
+    for (size_t i = 0; i < CACHE_TEST_SMALL; i += 3)
+    {
+        HASH_CACHE_TEST(cache_remove(p_small, HASH_CACHE_TEST_KEY(i), &p_value));
+        HASH_CACHE_TEST(p_value == HASH_CACHE_TEST_KEY(i));
+        HASH_CACHE_TEST(cache_remove(p_large, HASH_CACHE_TEST_KEY(i), &p_value));
+        HASH_CACHE_TEST(cache_remove(p_small, HASH_CACHE_TEST_KEY(i), (void *) 0) == 0);
+    }
+
+    // Both caches hit and miss the same keys, with the same values
+    for (size_t i = 0; i < 2 * CACHE_TEST_SMALL; i++)
+    {
+
+        // Initialized data
+        int hit = ( i < CACHE_TEST_SMALL && i % 3 );
+
+        // Search both caches
+        HASH_CACHE_TEST(cache_get(p_small, HASH_CACHE_TEST_KEY(i), &p_value) == hit);
+        HASH_CACHE_TEST(hit == 0 || p_value == HASH_CACHE_TEST_KEY(i));
+        HASH_CACHE_TEST(cache_get(p_large, HASH_CACHE_TEST_KEY(i), &p_value) == hit);
+        HASH_CACHE_TEST(hit == 0 || p_value == HASH_CACHE_TEST_KEY(i));
+    }
+
+    // Reinsert the removed keys, and insert more keys than the small cache holds
+    for (size_t i = 0; i < 2 * CACHE_TEST_SMALL; i++)
+        if ( i >= CACHE_TEST_SMALL || i % 3 == 0 )
+            HASH_CACHE_TEST(cache_insert(p_small, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i)));
+
+    // The small cache is full, and each key it finds has its own value
+    for (size_t i = 0; i < 2 * CACHE_TEST_SMALL; i++)
+        if ( cache_get(p_small, HASH_CACHE_TEST_KEY(i), &p_value) )
+        {
+            HASH_CACHE_TEST(p_value == HASH_CACHE_TEST_KEY(i));
+            found++;
+        }
+    HASH_CACHE_TEST(p_small->properties.count == CACHE_TEST_SMALL);
+    HASH_CACHE_TEST(found == CACHE_TEST_SMALL);
+
+    // Destroy the caches
+    HASH_CACHE_TEST(cache_destroy(&p_small, (void *) 0));
+    HASH_CACHE_TEST(cache_destroy(&p_large, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_cache_upsert ( void )
+{
+
+    // Initialized data
+    cache                     *p_cache  = (void *) 0;
+    cache_options              _options = { .pfn_key_get = test_cache_counter_key };
+    test_cache_upsert_context  _context = { 0 };
+    void                      *p_value  = (void *) 0;
+
+    // Construct a cache of counters
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, CACHE_TEST_SIZE, &_options));
+
+    // Count each occurrence of each word
+    for (size_t i = 0; i < CACHE_TEST_COUNT; i++)
+        HASH_CACHE_TEST(cache_upsert(p_cache, HASH_CACHE_TEST_KEY(i % CACHE_TEST_SIZE), test_cache_counter_found, test_cache_counter_create, &_context));
+
+    // Each word was created once, and found on every other occurrence
+    HASH_CACHE_TEST(_context.created == CACHE_TEST_SIZE);
+    HASH_CACHE_TEST(_context.found   == CACHE_TEST_COUNT - CACHE_TEST_SIZE);
+    HASH_CACHE_TEST(p_cache->properties.count == CACHE_TEST_SIZE);
+
+    // Each counter counted every occurrence of its word
+    for (size_t i = 0; i < CACHE_TEST_SIZE; i++)
+    {
+        HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(i), &p_value));
+        HASH_CACHE_TEST(p_value == &counters[i]);
+        HASH_CACHE_TEST(counters[i].count == CACHE_TEST_COUNT / CACHE_TEST_SIZE);
+    }
+
+    // A create function that fails inserts nothing
+    HASH_CACHE_TEST(cache_remove(p_cache, HASH_CACHE_TEST_KEY(0), (void *) 0));
+    _context.fail = 1;
+    HASH_CACHE_TEST(cache_upsert(p_cache, HASH_CACHE_TEST_KEY(0), test_cache_counter_found, test_cache_counter_create, &_context) == 0);
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(0), &p_value) == 0);
+    HASH_CACHE_TEST(p_cache->properties.count == CACHE_TEST_SIZE - 1);
+
+    // A word that is found never calls the create function
+    HASH_CACHE_TEST(cache_upsert(p_cache, HASH_CACHE_TEST_KEY(1), test_cache_counter_found, test_cache_counter_create, &_context));
+    HASH_CACHE_TEST(counters[1].count == CACHE_TEST_COUNT / CACHE_TEST_SIZE + 1);
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_cache_collisions ( void )
+{
+
+    // Initialized data
+    cache_options  _options =
+    {
+        .pfn_equality = test_cache_equality,
+        .pfn_key_get  = test_cache_counter_key,
+        .pfn_key_hash = test_cache_hash_constant
+    };
+    size_t         sizes[]  = { CACHE_TEST_SIZE, CACHE_TEST_LARGE };
+
+    // Search the tags, and then the buckets
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(*sizes); s++)
+    {
+
+        // Initialized data
+        cache                     *p_cache  = (void *) 0;
+        test_cache_upsert_context  _context = { 0 };
+        void                      *p_value  = (void *) 0;
+
+        // Construct a cache of counters, whose keys all have the same hash
+        HASH_CACHE_TEST(cache_construct_options(&p_cache, sizes[s], &_options));
+
+        // Count each occurrence of each word
+        equalities = 0;
+        for (size_t i = 0; i < CACHE_TEST_COUNT; i++)
+            HASH_CACHE_TEST(cache_upsert(p_cache, HASH_CACHE_TEST_KEY(i % CACHE_TEST_SIZE), test_cache_counter_found, test_cache_counter_create, &_context));
+
+        // The equality function told the words apart
+        HASH_CACHE_TEST(_context.created == CACHE_TEST_SIZE);
+        HASH_CACHE_TEST(_context.found   == CACHE_TEST_COUNT - CACHE_TEST_SIZE);
+        HASH_CACHE_TEST(equalities       >  CACHE_TEST_COUNT);
+
+        // Each word is found, with its own counter
+        for (size_t i = 0; i < CACHE_TEST_SIZE; i++)
+        {
+            HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(i), &p_value));
+            HASH_CACHE_TEST(p_value == &counters[i]);
+            HASH_CACHE_TEST(counters[i].count == CACHE_TEST_COUNT / CACHE_TEST_SIZE);
+        }
+
+        // A word with the same hash that wasn't inserted isn't found
+        HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(CACHE_TEST_SIZE), &p_value) == 0);
+
+        // Destroy the cache
+        HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+    }
+
+    // Pass
+    return 1;
+}
+
+static size_t test_cache_cost ( const void *const p_value )
+{
+
+    // Done
+    return ( (size_t) p_value >> 1 < CACHE_TEST_CHEAP ) ? 1 : 1000;
+}
+
+static void test_cache_evict ( void *p_value, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Count the eviction
+    evictions[(size_t) p_value >> 1]++;
+
+    // Done
+    return;
+}
+
+static hash64 test_cache_hash_tag ( const void *const p_key )
+{
+
+    // The top byte is the tag, and the low bits keep the hashes apart
+    return ( (hash64) CACHE_TEST_TAG << 56 ) | ( (size_t) p_key >> 1 );
+}
+
+static void *test_cache_counter_key ( const void *const p_value )
+{
+
+    // Done
+    return (void *) ( (const test_cache_counter *) p_value )->p_key;
+}
+
+static void test_cache_counter_found ( void *p_value, void *p_context )
+{
+
+    // Initialized data
+    test_cache_upsert_context *p_upsert_context = p_context;
+    test_cache_counter        *p_counter        = p_value;
+
+    // Count the occurrence
+    p_counter->count++, p_upsert_context->found++;
+
+    // Done
+    return;
+}
+
+static void *test_cache_counter_create ( const void *const p_key, void *p_context )
+{
+
+    // Initialized data
+    test_cache_upsert_context *p_upsert_context = p_context;
+    test_cache_counter        *p_counter        = &counters[(size_t) p_key >> 1];
+
+    // Fail, if asked to
+    if ( p_upsert_context->fail ) return (void *) 0;
+
+    // Count the first occurrence
+    *p_counter = (test_cache_counter) { .p_key = p_key, .count = 1 }, p_upsert_context->created++;
+
+    // Success
+    return p_counter;
+}
+
+static hash64 test_cache_hash_constant ( const void *const p_key )
+{
+
+    // Unused
+    (void) p_key;
+
+    // Done
+    return 0x5A5A5A5A5A5A5A5A;
+}
+
+static int test_cache_equality ( const void *const p_a, const void *const p_b )
+{
+
+    // Count the comparison
+    equalities++;
+
+    // Done
+    return ( p_a == p_b ) ? 0 : 1;
+}
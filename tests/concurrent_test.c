@@ -0,0 +1,791 @@
+/** !
+ * Tests for the concurrent cache. Build with HASH_CACHE_SANITIZER set to
+ * address or thread to check the lock free reads
+ *
+ * @file tests/concurrent_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+// hash cache
+#include <hash_cache/concurrent_cache.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define CONCURRENT_TEST_KEYS       4096
+#define CONCURRENT_TEST_CAPACITY   1024
+#define CONCURRENT_TEST_READERS    4
+#define CONCURRENT_TEST_WRITERS    2
+#define CONCURRENT_TEST_OPERATIONS 50000
+#define CONCURRENT_TEST_FLIGHT     8
+#define CONCURRENT_TEST_REFRESH    16
+
+// Structure declarations
+struct concurrent_test_value_s;
+
+// Type definitions
+typedef struct concurrent_test_value_s concurrent_test_value;
+
+// Structure definitions
+struct concurrent_test_value_s
+{
+    size_t key; // The key of the value, read by the cache's equality function
+};
+
+// Data
+static concurrent_cache      *p_concurrent_cache                  = (void *) 0;
+static concurrent_test_value *p_values[CONCURRENT_TEST_KEYS]      = { 0 };
+static size_t                 reads[CONCURRENT_TEST_READERS]      = { 0 };
+static bool                   stop                                = false;
+static size_t                 loads                               = 0,
+                              evictions                           = 0,
+                              loaded                              = 0;
+static int                    load_result                         = 1;
+static size_t                 load_cost                           = 1;
+static pthread_barrier_t      _flight;
+static concurrent_test_value  refresh_values[CONCURRENT_TEST_REFRESH] = { 0 };
+static size_t                 releases[CONCURRENT_TEST_REFRESH]       = { 0 },
+                              refresh_next                            = 0;
+static concurrent_test_value *p_refresh_loaded                        = (void *) 0;
+static bool                   refresh_block                           = false,
+                              refresh_started                         = false,
+                              refresh_go                              = false,
+                              removed                                 = false;
+
+// Forward declarations
+/** !
+ * Get random keys from many threads without locking, while other threads
+ * insert, replace, and remove them. Each removed or evicted value is freed
+ * right away. Afterwards, every value the writers left in the cache is
+ * found, and nothing else is
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_concurrent ( void );
+
+/** !
+ * Get random keys until the writers stop
+ *
+ * @param p_parameter the index of the reader
+ *
+ * @return 0
+ */
+static void *test_concurrent_reader ( void *p_parameter );
+
+/** !
+ * Insert, replace and remove random keys. A writer only writes the keys
+ * that are equal to its index, modulo the quantity of writers
+ *
+ * @param p_parameter the index of the writer
+ *
+ * @return 0
+ */
+static void *test_concurrent_writer ( void *p_parameter );
+
+/** !
+ * Miss on one key from many threads at once. The threads share one load,
+ * and each gets the loaded value. A failed load, or a loaded value that 
+ * costs more than the cache's budget, fails every thread
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_single_flight ( void );
+
+/** !
+ * Start every thread at once, and get or load the same key
+ *
+ * @param p_parameter unused
+ *
+ * @return the loaded value, or 0 if the get failed
+ */
+static void *test_single_flight_thread ( void *p_parameter );
+
+/** !
+ * Load a value slowly, so every thread misses before the load is done
+ *
+ * @param p_key     the key
+ * @param p_context unused
+ * @param pp_value  return
+ *
+ * @return load_result
+ */
+static int test_single_flight_load ( const void *const p_key, void *p_context, void **const pp_value );
+
+/** !
+ * The cost of a loaded value
+ *
+ * @param p_value unused
+ *
+ * @return load_cost
+ */
+static size_t test_single_flight_cost ( const void *const p_value );
+
+/** !
+ * Reload a key while its stale value is read, evicted, and removed. Reads
+ * during a reload get the stale value. An eviction of the stale value waits
+ * for the reload, which then drops the fresh value, and a remove of the key
+ * waits for the reload. Each value is released once
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_refresh ( void );
+
+/** !
+ * Read key 0 until a reload of it starts. Each read must get the stale value
+ *
+ * @param p_stale the stale value of key 0
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_refresh_begin ( const concurrent_test_value *const p_stale );
+
+/** !
+ * Remove key 0
+ *
+ * @param p_parameter unused
+ *
+ * @return the removed value, or 0 if the remove failed
+ */
+static void *test_refresh_remover ( void *p_parameter );
+
+/** !
+ * Reload a value. A reload that test_refresh_begin asked for waits until
+ * the test lets it finish, and the rest fail at once
+ *
+ * @param p_key     the key
+ * @param p_context unused
+ * @param pp_value  return
+ *
+ * @return 1 on success, 0 on error
+ */
+static int test_refresh_load ( const void *const p_key, void *p_context, void **const pp_value );
+
+/** !
+ * Take the next value of refresh_values
+ *
+ * @param key the key of the value
+ *
+ * @return the value
+ */
+static concurrent_test_value *test_refresh_value ( size_t key );
+
+/** !
+ * Count a release of a value of refresh_values
+ *
+ * @param p_value   the value
+ * @param p_context unused
+ *
+ * @return void
+ */
+static void test_refresh_evict ( void *p_value, void *p_context );
+
+/** !
+ * Count a release of a value of refresh_values
+ *
+ * @param p_value the value
+ *
+ * @return void
+ */
+static void test_refresh_free ( void *p_value );
+
+/** !
+ * Compare the keys of two values
+ *
+ * @param p_a the key of A
+ * @param p_b the key of B
+ *
+ * @return 0 if A == B else 1
+ */
+static int test_concurrent_equals ( const void *const p_a, const void *const p_b );
+
+/** !
+ * Get the key of a value
+ *
+ * @param p_value the value
+ *
+ * @return the key of the value
+ */
+static void *test_concurrent_key ( const void *const p_value );
+
+/** !
+ * Hash a key
+ *
+ * @param p_key the key
+ *
+ * @return the hash of the key
+ */
+static hash64 test_concurrent_hash ( const void *const p_key );
+
+/** !
+ * Forget an evicted value, and free it
+ *
+ * @param p_value   the value
+ * @param p_context unused
+ *
+ * @return void
+ */
+static void test_concurrent_evict ( void *p_value, void *p_context );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_concurrent, passed);
+    HASH_CACHE_TEST_RUN(test_single_flight, passed);
+    HASH_CACHE_TEST_RUN(test_refresh, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_concurrent ( void )
+{
+
+    // Initialized data
+    pthread_t                 readers[CONCURRENT_TEST_READERS] = { 0 },
+                              writers[CONCURRENT_TEST_WRITERS] = { 0 };
+    concurrent_cache_stats    _stats                           = { 0 };
+    concurrent_cache_options  _options                         =
+    {
+        .cache =
+        {
+            .pfn_equality = test_concurrent_equals,
+            .pfn_key_get  = test_concurrent_key,
+            .pfn_key_hash = test_concurrent_hash,
+            .pfn_evict    = test_concurrent_evict
+        },
+        .shards = 4
+    };
+    size_t                    gets                             = 0;
+
+    // Construct a concurrent cache
+    HASH_CACHE_TEST(concurrent_cache_construct(&p_concurrent_cache, CONCURRENT_TEST_CAPACITY, &_options));
+
+    // Start the readers and the writers
+    for (size_t i = 0; i < CONCURRENT_TEST_READERS; i++) HASH_CACHE_TEST(pthread_create(&readers[i], (void *) 0, test_concurrent_reader, (void *) i) == 0);
+    for (size_t i = 0; i < CONCURRENT_TEST_WRITERS; i++) HASH_CACHE_TEST(pthread_create(&writers[i], (void *) 0, test_concurrent_writer, (void *) i) == 0);
+
+    // Wait for the writers, then stop the readers
+    for (size_t i = 0; i < CONCURRENT_TEST_WRITERS; i++) HASH_CACHE_TEST(pthread_join(writers[i], (void *) 0) == 0);
+    __atomic_store_n(&stop, true, __ATOMIC_RELEASE);
+    for (size_t i = 0; i < CONCURRENT_TEST_READERS; i++) HASH_CACHE_TEST(pthread_join(readers[i], (void *) 0) == 0);
+
+    // Every get was counted
+    for (size_t i = 0; i < CONCURRENT_TEST_READERS; i++) gets += reads[i];
+    HASH_CACHE_TEST(concurrent_cache_stats_get(p_concurrent_cache, &_stats));
+    HASH_CACHE_TEST(_stats.hits + _stats.misses == gets);
+
+    // The cache never holds more than its capacity
+    HASH_CACHE_TEST(_stats.count <= _stats.max);
+
+    // Each value that the writers left in the cache is found, and each removed or evicted value isn't
+    for (size_t i = 0; i < CONCURRENT_TEST_KEYS; i++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Search the cache
+        HASH_CACHE_TEST(concurrent_cache_get(p_concurrent_cache, &i, &p_value) == ( p_values[i] != (void *) 0 ));
+        HASH_CACHE_TEST(p_value == p_values[i]);
+    }
+
+    // Destroy the cache, and free every value in it
+    HASH_CACHE_TEST(concurrent_cache_destroy(&p_concurrent_cache, free));
+
+    // Pass
+    return 1;
+}
+
+static void *test_concurrent_reader ( void *p_parameter )
+{
+
+    // Initialized data
+    size_t   reader = (size_t) p_parameter;
+    unsigned seed   = (unsigned) reader + 1;
+
+    // Get random keys until the writers stop
+    while ( __atomic_load_n(&stop, __ATOMIC_ACQUIRE) == false )
+    {
+
+        // Initialized data
+        size_t  key     = (size_t) rand_r(&seed) % CONCURRENT_TEST_KEYS;
+        void   *p_value = (void *) 0;
+
+        // Get the key. The value may be freed as soon as the get returns, so it isn't read
+        (void) concurrent_cache_get(p_concurrent_cache, &key, &p_value);
+
+        // Count the get
+        reads[reader]++;
+    }
+
+    // Done
+    return (void *) 0;
+}
+
+static void *test_concurrent_writer ( void *p_parameter )
+{
+
+    // Initialized data
+    size_t   writer = (size_t) p_parameter;
+    unsigned seed   = (unsigned) writer + 100;
+
+    // Write random keys of this writer
+    for (size_t i = 0; i < CONCURRENT_TEST_OPERATIONS; i++)
+    {
+
+        // Initialized data
+        size_t key = (size_t) rand_r(&seed) % ( CONCURRENT_TEST_KEYS / CONCURRENT_TEST_WRITERS ) * CONCURRENT_TEST_WRITERS + writer;
+
+        // Insert or replace the key ...
+        if ( i % 3 )
+        {
+
+            // Initialized data
+            concurrent_test_value *p_value = malloc(sizeof(concurrent_test_value));
+
+            // Error check
+            if ( p_value == (void *) 0 ) abort();
+
+            // Remember the value before the cache can evict it
+            p_value->key = key;
+            __atomic_store_n(&p_values[key], p_value, __ATOMIC_RELEASE);
+
+            // Insert the value
+            if ( concurrent_cache_insert(p_concurrent_cache, &p_value->key, p_value) == 0 ) abort();
+        }
+
+        // ... or remove it
+        else
+        {
+
+            // Initialized data
+            void *p_value = (void *) 0;
+
+            // Remove the key, forget its value, and free it
+            if ( concurrent_cache_remove(p_concurrent_cache, &key, &p_value) )
+            {
+
+                // Initialized data
+                concurrent_test_value *p_expected = p_value;
+
+                // Forget the value
+                __atomic_compare_exchange_n(&p_values[key], &p_expected, (void *) 0, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+
+                // Free the value
+                free(p_value);
+            }
+        }
+    }
+
+    // Done
+    return (void *) 0;
+}
+
+static int test_single_flight ( void )
+{
+
+    // Initialized data
+    pthread_t                 threads[CONCURRENT_TEST_FLIGHT]   = { 0 };
+    void                     *p_results[CONCURRENT_TEST_FLIGHT] = { 0 };
+    concurrent_cache_options  _options                          =
+    {
+        .cache =
+        {
+            .pfn_equality = test_concurrent_equals,
+            .pfn_key_get  = test_concurrent_key,
+            .pfn_key_hash = test_concurrent_hash,
+            .pfn_evict    = test_concurrent_evict,
+            .pfn_cost     = test_single_flight_cost,
+            .budget       = 64
+        },
+        .shards = 2
+    };
+
+    // Construct a concurrent cache
+    HASH_CACHE_TEST(concurrent_cache_construct(&p_concurrent_cache, 64, &_options));
+
+    // Succeed, then fail, then load a value the cache rejects
+    for (size_t round = 0; round < 3; round++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Set up the round
+        load_result = ( round != 1 ), load_cost = ( round == 2 ) ? 1000 : 1;
+        loads       = 0, evictions = 0, loaded = 0;
+
+        // Start each thread at once
+        HASH_CACHE_TEST(pthread_barrier_init(&_flight, (void *) 0, CONCURRENT_TEST_FLIGHT) == 0);
+        for (size_t i = 0; i < CONCURRENT_TEST_FLIGHT; i++) HASH_CACHE_TEST(pthread_create(&threads[i], (void *) 0, test_single_flight_thread, (void *) 0) == 0);
+        for (size_t i = 0; i < CONCURRENT_TEST_FLIGHT; i++) HASH_CACHE_TEST(pthread_join(threads[i], &p_results[i]) == 0);
+        HASH_CACHE_TEST(pthread_barrier_destroy(&_flight) == 0);
+
+        // The threads shared one load
+        HASH_CACHE_TEST(loads == 1);
+
+        // A successful load gives every thread the value, and a failed load fails every thread
+        for (size_t i = 0; i < CONCURRENT_TEST_FLIGHT; i++)
+            HASH_CACHE_TEST(p_results[i] == ( ( round == 0 ) ? (void *) loaded : (void *) 0 ));
+
+        // The rejected value was passed to the evict function
+        HASH_CACHE_TEST(evictions == ( round == 2 ));
+
+        // Only the successful load is in the cache
+        HASH_CACHE_TEST(concurrent_cache_remove(p_concurrent_cache, &(size_t) { 0 }, &p_value) == ( round == 0 ));
+
+        // Free the removed value
+        free(p_value);
+    }
+
+    // Destroy the cache
+    HASH_CACHE_TEST(concurrent_cache_destroy(&p_concurrent_cache, free));
+
+    // Pass
+    return 1;
+}
+
+static void *test_single_flight_thread ( void *p_parameter )
+{
+
+    // Initialized data
+    size_t  key     = 0;
+    void   *p_value = (void *) 0;
+
+    // Unused
+    (void) p_parameter;
+
+    // Wait for every thread
+    pthread_barrier_wait(&_flight);
+
+    // Get or load the key
+    if ( concurrent_cache_get_or_load(p_concurrent_cache, &key, test_single_flight_load, (void *) 0, &p_value) == 0 ) return (void *) 0;
+
+    // Success
+    return p_value;
+}
+
+static int test_single_flight_load ( const void *const p_key, void *p_context, void **const pp_value )
+{
+
+    // Initialized data
+    concurrent_test_value *p_value  = (void *) 0;
+    timestamp              deadline = timer_high_precision() + timer_seconds_divisor() / 20;
+
+    // Unused
+    (void) p_context;
+
+    // Count the load
+    __atomic_fetch_add(&loads, 1, __ATOMIC_ACQ_REL);
+
+    // Take a while, so every thread misses
+    while ( timer_high_precision() < deadline );
+
+    // Fail
+    if ( load_result == 0 ) return 0;
+
+    // Make the value
+    p_value = malloc(sizeof(concurrent_test_value));
+
+    // Error check
+    if ( p_value == (void *) 0 ) return 0;
+
+    // Return the value to the caller
+    p_value->key = *(const size_t *) p_key;
+    *pp_value    = p_value;
+
+    // Remember the value
+    __atomic_store_n(&loaded, (size_t) p_value, __ATOMIC_RELEASE);
+
+    // Success
+    return 1;
+}
+
+static size_t test_single_flight_cost ( const void *const p_value )
+{
+
+    // Unused
+    (void) p_value;
+
+    // Done
+    return load_cost;
+}
+
+static int test_refresh ( void )
+{
+
+    // Initialized data
+    pthread_t                 remover   = { 0 };
+    timestamp                 second    = timer_seconds_divisor(),
+                              deadline  = 0;
+    concurrent_cache_options  _options  =
+    {
+        .cache =
+        {
+            .pfn_equality = test_concurrent_equals,
+            .pfn_key_get  = test_concurrent_key,
+            .pfn_key_hash = test_concurrent_hash,
+            .pfn_evict    = test_refresh_evict,
+            .ttl          = 10 * second
+        },
+        .shards     = 1,
+        .pfn_loader = test_refresh_load,
+        .refresh    = 20 * second,
+        .workers    = 1
+    };
+    concurrent_test_value    *p_stale   = (void *) 0,
+                             *p_fresh   = (void *) 0;
+    void                     *p_value   = (void *) 0;
+
+    // Construct a concurrent cache of 2 properties. Every read is in the refresh window
+    HASH_CACHE_TEST(concurrent_cache_construct(&p_concurrent_cache, 2, &_options));
+
+    // Insert key 0, and reload it
+    p_stale = test_refresh_value(0);
+    HASH_CACHE_TEST(concurrent_cache_insert(p_concurrent_cache, &p_stale->key, p_stale));
+    HASH_CACHE_TEST(test_refresh_begin(p_stale));
+
+    // The stale value is served while the loader runs
+    for (size_t i = 0; i < 1000; i++)
+        HASH_CACHE_TEST(concurrent_cache_get(p_concurrent_cache, &(size_t) { 0 }, &p_value) && p_value == p_stale);
+
+    // Finish the reload, and wait for the fresh value
+    __atomic_store_n(&refresh_go, true, __ATOMIC_RELEASE);
+    for (deadline = timer_high_precision() + second; timer_high_precision() < deadline && ( concurrent_cache_get(p_concurrent_cache, &(size_t) { 0 }, &p_value) == 0 || p_value == p_stale ); );
+
+    // The fresh value replaced the stale value, which was released
+    p_fresh = __atomic_load_n(&p_refresh_loaded, __ATOMIC_ACQUIRE);
+    HASH_CACHE_TEST(p_value == p_fresh);
+    HASH_CACHE_TEST(__atomic_load_n(&releases[p_stale - refresh_values], __ATOMIC_ACQUIRE) == 1);
+
+    // Reload key 0 again, then evict it by inserting 2 other keys
+    p_stale = p_fresh;
+    HASH_CACHE_TEST(test_refresh_begin(p_stale));
+    for (size_t key = 1; key <= 2; key++)
+        HASH_CACHE_TEST(concurrent_cache_insert(p_concurrent_cache, &key, test_refresh_value(key)));
+
+    // The key is gone, but the stale value isn't released until the reload is done
+    HASH_CACHE_TEST(concurrent_cache_get(p_concurrent_cache, &(size_t) { 0 }, &p_value) == 0);
+    HASH_CACHE_TEST(__atomic_load_n(&releases[p_stale - refresh_values], __ATOMIC_ACQUIRE) == 0);
+
+    // Finish the reload, and wait for it to release the stale value and the fresh value
+    __atomic_store_n(&refresh_go, true, __ATOMIC_RELEASE);
+    for (deadline = timer_high_precision() + second; timer_high_precision() < deadline && __atomic_load_n(&releases[p_stale - refresh_values], __ATOMIC_ACQUIRE) == 0; );
+    for (; timer_high_precision() < deadline && __atomic_load_n(&p_refresh_loaded, __ATOMIC_ACQUIRE) == p_stale; );
+    p_fresh = __atomic_load_n(&p_refresh_loaded, __ATOMIC_ACQUIRE);
+    for (; timer_high_precision() < deadline && __atomic_load_n(&releases[p_fresh - refresh_values], __ATOMIC_ACQUIRE) == 0; );
+
+    // The fresh value of the evicted key wasn't inserted
+    HASH_CACHE_TEST(p_fresh != p_stale);
+    HASH_CACHE_TEST(__atomic_load_n(&releases[p_stale - refresh_values], __ATOMIC_ACQUIRE) == 1);
+    HASH_CACHE_TEST(__atomic_load_n(&releases[p_fresh - refresh_values], __ATOMIC_ACQUIRE) == 1);
+    HASH_CACHE_TEST(concurrent_cache_get(p_concurrent_cache, &(size_t) { 0 }, &p_value) == 0);
+
+    // Insert key 0 again, reload it, and remove it during the reload
+    p_stale = test_refresh_value(0);
+    HASH_CACHE_TEST(concurrent_cache_insert(p_concurrent_cache, &p_stale->key, p_stale));
+    HASH_CACHE_TEST(test_refresh_begin(p_stale));
+    HASH_CACHE_TEST(pthread_create(&remover, (void *) 0, test_refresh_remover, (void *) 0) == 0);
+
+    // The remove waits for the reload
+    for (deadline = timer_high_precision() + second / 20; timer_high_precision() < deadline; );
+    HASH_CACHE_TEST(__atomic_load_n(&removed, __ATOMIC_ACQUIRE) == false);
+
+    // Finish the reload. The fresh value replaces the stale value, and then it's removed
+    __atomic_store_n(&refresh_go, true, __ATOMIC_RELEASE);
+    HASH_CACHE_TEST(pthread_join(remover, &p_value) == 0);
+    p_fresh = __atomic_load_n(&p_refresh_loaded, __ATOMIC_ACQUIRE);
+    HASH_CACHE_TEST(p_fresh != p_stale && p_value == p_fresh);
+    HASH_CACHE_TEST(__atomic_load_n(&releases[p_stale - refresh_values], __ATOMIC_ACQUIRE) == 1);
+
+    // The remove gave the fresh value to the test, which releases it
+    test_refresh_free(p_value);
+
+    // Destroy the cache, and release every value in it
+    HASH_CACHE_TEST(concurrent_cache_destroy(&p_concurrent_cache, test_refresh_free));
+
+    // Each value was released once
+    for (size_t i = 0; i < refresh_next; i++)
+        HASH_CACHE_TEST(releases[i] == 1);
+
+    // Pass
+    return 1;
+}
+
+static int test_refresh_begin ( const concurrent_test_value *const p_stale )
+{
+
+    // Initialized data
+    timestamp deadline = timer_high_precision() + timer_seconds_divisor();
+
+    // Ask for the next reload to wait
+    __atomic_store_n(&refresh_started, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&refresh_go, false, __ATOMIC_RELEASE);
+    __atomic_store_n(&refresh_block, true, __ATOMIC_RELEASE);
+
+    // Read the key until a read queues the reload, and the loader starts
+    while ( __atomic_load_n(&refresh_started, __ATOMIC_ACQUIRE) == false )
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Each read gets the stale value
+        HASH_CACHE_TEST(concurrent_cache_get(p_concurrent_cache, &(size_t) { 0 }, &p_value) && p_value == p_stale);
+
+        // Don't wait forever
+        HASH_CACHE_TEST(timer_high_precision() < deadline);
+    }
+
+    // Success
+    return 1;
+}
+
+static void *test_refresh_remover ( void *p_parameter )
+{
+
+    // Initialized data
+    void *p_value = (void *) 0;
+
+    // Unused
+    (void) p_parameter;
+
+    // Remove key 0
+    __atomic_store_n(&removed, false, __ATOMIC_RELEASE);
+    if ( concurrent_cache_remove(p_concurrent_cache, &(size_t) { 0 }, &p_value) == 0 ) p_value = (void *) 0;
+    __atomic_store_n(&removed, true, __ATOMIC_RELEASE);
+
+    // Done
+    return p_value;
+}
+
+static int test_refresh_load ( const void *const p_key, void *p_context, void **const pp_value )
+{
+
+    // Initialized data
+    bool                   blocked = true;
+    concurrent_test_value *p_value = (void *) 0;
+
+    // Unused
+    (void) p_context;
+
+    // Fail every reload that the test didn't ask for
+    if ( __atomic_compare_exchange_n(&refresh_block, &blocked, false, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) == false ) return 0;
+
+    // Tell the test that the reload started, and wait for it
+    __atomic_store_n(&refresh_started, true, __ATOMIC_RELEASE);
+    while ( __atomic_load_n(&refresh_go, __ATOMIC_ACQUIRE) == false );
+
+    // Make the fresh value
+    p_value = test_refresh_value(*(const size_t *) p_key);
+
+    // Remember the value
+    __atomic_store_n(&p_refresh_loaded, p_value, __ATOMIC_RELEASE);
+
+    // Return the value to the caller
+    *pp_value = p_value;
+
+    // Success
+    return 1;
+}
+
+static concurrent_test_value *test_refresh_value ( size_t key )
+{
+
+    // Initialized data
+    concurrent_test_value *p_value = &refresh_values[__atomic_fetch_add(&refresh_next, 1, __ATOMIC_ACQ_REL)];
+
+    // Store the key
+    p_value->key = key;
+
+    // Success
+    return p_value;
+}
+
+static void test_refresh_evict ( void *p_value, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Count the release
+    test_refresh_free(p_value);
+
+    // Done
+    return;
+}
+
+static void test_refresh_free ( void *p_value )
+{
+
+    // Count the release
+    __atomic_fetch_add(&releases[(concurrent_test_value *) p_value - refresh_values], 1, __ATOMIC_ACQ_REL);
+
+    // Done
+    return;
+}
+
+static int test_concurrent_equals ( const void *const p_a, const void *const p_b )
+{
+
+    // Done
+    return ( *(const size_t *) p_a == *(const size_t *) p_b ) ? 0 : 1;
+}
+
+static void *test_concurrent_key ( const void *const p_value )
+{
+
+    // Done
+    return &((concurrent_test_value *) p_value)->key;
+}
+
+static hash64 test_concurrent_hash ( const void *const p_key )
+{
+
+    // Done
+    return hash_cache_key_hash((void *) *(const size_t *) p_key);
+}
+
+static void test_concurrent_evict ( void *p_value, void *p_context )
+{
+
+    // Initialized data
+    concurrent_test_value *p_expected = p_value;
+
+    // Unused
+    (void) p_context;
+
+    // Count the eviction
+    __atomic_fetch_add(&evictions, 1, __ATOMIC_ACQ_REL);
+
+    // Forget the value, unless its key was already given a new value
+    __atomic_compare_exchange_n(&p_values[p_expected->key], &p_expected, (void *) 0, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+
+    // Free the value
+    free(p_value);
+
+    // Done
+    return;
+}
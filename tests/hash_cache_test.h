@@ -0,0 +1,25 @@
+/** !
+ * Header for hash cache tests
+ *
+ * @file tests/hash_cache_test.h
+ *
+ * @author Jacob Smith
+ */
+
+// Include guard
+#pragma once
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// Preprocessor definitions
+// Fail the calling test, and say why, if an expression is false
+#define HASH_CACHE_TEST(expression) do { if ( ( expression ) == 0 ) { fprintf(stderr, "[hash cache] [test] %s:%d \"%s\" failed in call to function \"%s\"\n", __FILE__, __LINE__, #expression, __FUNCTION__); return 0; } } while (0)
+
+// Run a test, and print its result
+#define HASH_CACHE_TEST_RUN(pfn_test, passed) do { int result = pfn_test(); printf("%s %s\n", ( result ) ? "[PASS]" : "[FAIL]", #pfn_test); (passed) &= result; } while (0)
+
+// Map an integer to an address that can be a key or a value. Never 0
+#define HASH_CACHE_TEST_KEY(i) ((void *) (size_t) ( ( (size_t) (i) << 1 ) | 1 ))
@@ -0,0 +1,422 @@
+/** !
+ * Tests for the hash table
+ *
+ * @file tests/hash_table_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// hash cache
+#include <hash_cache/hash_table.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define HASH_TABLE_TEST_SIZE  1024
+#define HASH_TABLE_TEST_KEYS  1000
+#define HASH_TABLE_TEST_WORDS 16
+#define HASH_TABLE_TEST_COUNT 256
+
+// Type definitions
+typedef struct
+{
+    const void *p_key;
+    size_t      count;
+} test_hash_table_counter;
+
+typedef struct
+{
+    size_t found,
+           created;
+    int    fail;
+} test_hash_table_upsert_context;
+
+// Data
+static size_t                  visits[HASH_TABLE_TEST_KEYS]    = { 0 },
+                               equalities                      = 0;
+static test_hash_table_counter counters[HASH_TABLE_TEST_WORDS] = { { 0 } };
+
+// Forward declarations
+/** !
+ * Build a nearly full hash table with 1, 2, 4, and 8 threads. Every key is
+ * found by hash_table_search, and hash_table_for_each_parallel visits each
+ * property once
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_hash_table_build_parallel ( void );
+
+/** !
+ * Build a hash table where every key has a home slot at the end of the
+ * table. The partitions run off the end of their ranges, and the serial pass
+ * wraps the overflow to the front of the table. Every key is still found,
+ * and visited once
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_hash_table_build_parallel_overflow ( void );
+
+/** !
+ * Build a hash table from the keys with many threads, search every key, and
+ * visit every property with many threads
+ *
+ * @param pfn_key_hash the key hash, or 0 for default
+ * @param nthreads     the quantity of threads
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_hash_table_build ( fn_hash_cache_key_hash *pfn_key_hash, size_t nthreads );
+
+/** !
+ * Count words with hash_table_upsert. The create function is called once
+ * per word, and the found function for every other occurrence. A create
+ * function that fails inserts nothing
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_hash_table_upsert ( void );
+
+/** !
+ * Every key has the same hash, so each slot of the probe sequence matches
+ * the stored hash, and the equality function tells the keys apart. Search
+ * and upsert still find the right property
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_hash_table_collisions ( void );
+
+/** !
+ * Get the key of a counter
+ *
+ * @param p_value the counter
+ *
+ * @return the key
+ */
+static void *test_hash_table_counter_key ( const void *const p_value );
+
+/** !
+ * Increment a counter
+ *
+ * @param p_value   the counter
+ * @param p_context the upsert context
+ *
+ * @return void
+ */
+static void test_hash_table_counter_found ( void *p_value, void *p_context );
+
+/** !
+ * Make a counter of a key, or fail if the context says so
+ *
+ * @param p_key     the key
+ * @param p_context the upsert context
+ *
+ * @return the counter, or 0 on failure
+ */
+static void *test_hash_table_counter_create ( const void *const p_key, void *p_context );
+
+/** !
+ * Hash the key i of HASH_CACHE_TEST_KEY to the end of the hash space, so
+ * that every key has a home slot at the end of the table
+ *
+ * @param p_key the key
+ *
+ * @return the hash of the key
+ */
+static hash64 test_hash_table_hash_skewed ( const void *const p_key );
+
+/** !
+ * Count a visit of a property
+ *
+ * @param p_property the property
+ *
+ * @return 1
+ */
+static int test_hash_table_visit ( void *p_property );
+
+/** !
+ * Hash every key to the same hash
+ *
+ * @param p_key the key
+ *
+ * @return the hash of the key
+ */
+static hash64 test_hash_table_hash_constant ( const void *const p_key );
+
+/** !
+ * Compare two keys, and count the comparison
+ *
+ * @param p_a a key
+ * @param p_b another key
+ *
+ * @return 0 if the keys are equal
+ */
+static int test_hash_table_equality ( const void *const p_a, const void *const p_b );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_hash_table_build_parallel, passed);
+    HASH_CACHE_TEST_RUN(test_hash_table_build_parallel_overflow, passed);
+    HASH_CACHE_TEST_RUN(test_hash_table_upsert, passed);
+    HASH_CACHE_TEST_RUN(test_hash_table_collisions, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_hash_table_build_parallel ( void )
+{
+
+    // Build with each quantity of threads
+    for (size_t nthreads = 1; nthreads <= 8; nthreads <<= 1)
+        HASH_CACHE_TEST(test_hash_table_build((void *) 0, nthreads));
+
+    // Pass
+    return 1;
+}
+
+static int test_hash_table_build_parallel_overflow ( void )
+{
+
+    // Build with each quantity of threads
+    for (size_t nthreads = 1; nthreads <= 8; nthreads <<= 1)
+        HASH_CACHE_TEST(test_hash_table_build(test_hash_table_hash_skewed, nthreads));
+
+    // Pass
+    return 1;
+}
+
+static int test_hash_table_build ( fn_hash_cache_key_hash *pfn_key_hash, size_t nthreads )
+{
+
+    // Initialized data
+    hash_table *p_hash_table                      = (void *) 0;
+    void       *properties[HASH_TABLE_TEST_KEYS]  = { 0 };
+    void       *p_value                           = (void *) 0;
+
+    // Make the properties
+    for (size_t i = 0; i < HASH_TABLE_TEST_KEYS; i++) properties[i] = HASH_CACHE_TEST_KEY(i);
+
+    // Construct a hash table
+    HASH_CACHE_TEST(hash_table_construct(&p_hash_table, HASH_TABLE_TEST_SIZE, (void *) 0, (void *) 0, pfn_key_hash));
+
+    // Build the hash table
+    HASH_CACHE_TEST(hash_table_build_parallel(p_hash_table, properties, HASH_TABLE_TEST_KEYS, nthreads));
+    HASH_CACHE_TEST(p_hash_table->properties.count == HASH_TABLE_TEST_KEYS);
+
+    // The skewed keys wrapped around to the first slot
+    HASH_CACHE_TEST(pfn_key_hash == (void *) 0 || p_hash_table->properties.pp_data[0] != (void *) 0);
+
+    // Every key is found
+    for (size_t i = 0; i < HASH_TABLE_TEST_KEYS; i++)
+    {
+        HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(i), &p_value));
+        HASH_CACHE_TEST(p_value == HASH_CACHE_TEST_KEY(i));
+    }
+
+    // A key that wasn't inserted isn't found
+    HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(HASH_TABLE_TEST_KEYS), &p_value) == 0);
+
+    // Visit every property
+    memset(visits, 0, sizeof(visits));
+    HASH_CACHE_TEST(hash_table_for_each_parallel(p_hash_table, test_hash_table_visit, nthreads));
+
+    // Each property was visited once
+    for (size_t i = 0; i < HASH_TABLE_TEST_KEYS; i++)
+        HASH_CACHE_TEST(visits[i] == 1);
+
+    // Destroy the hash table
+    HASH_CACHE_TEST(hash_table_destroy(&p_hash_table, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_hash_table_upsert ( void )
+{
+
+    // Initialized data
+    hash_table                     *p_hash_table = (void *) 0;
+    hash_table_options              _options     = { .pfn_key_get = test_hash_table_counter_key };
+    test_hash_table_upsert_context  _context     = { 0 };
+    void                           *p_value      = (void *) 0;
+
+    // Construct a hash table of counters
+    HASH_CACHE_TEST(hash_table_construct_options(&p_hash_table, 64, &_options));
+
+    // Count each occurrence of each word
+    for (size_t i = 0; i < HASH_TABLE_TEST_COUNT; i++)
+        HASH_CACHE_TEST(hash_table_upsert(p_hash_table, HASH_CACHE_TEST_KEY(i % HASH_TABLE_TEST_WORDS), test_hash_table_counter_found, test_hash_table_counter_create, &_context));
+
+    // Each word was created once, and found on every other occurrence
+    HASH_CACHE_TEST(_context.created == HASH_TABLE_TEST_WORDS);
+    HASH_CACHE_TEST(_context.found   == HASH_TABLE_TEST_COUNT - HASH_TABLE_TEST_WORDS);
+    HASH_CACHE_TEST(p_hash_table->properties.count == HASH_TABLE_TEST_WORDS);
+
+    // Each counter counted every occurrence of its word
+    for (size_t i = 0; i < HASH_TABLE_TEST_WORDS; i++)
+    {
+        HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(i), &p_value));
+        HASH_CACHE_TEST(p_value == &counters[i]);
+        HASH_CACHE_TEST(counters[i].count == HASH_TABLE_TEST_COUNT / HASH_TABLE_TEST_WORDS);
+    }
+
+    // A create function that fails inserts nothing
+    _context.fail = 1;
+    HASH_CACHE_TEST(hash_table_upsert(p_hash_table, HASH_CACHE_TEST_KEY(HASH_TABLE_TEST_WORDS), test_hash_table_counter_found, test_hash_table_counter_create, &_context) == 0);
+    HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(HASH_TABLE_TEST_WORDS), &p_value) == 0);
+    HASH_CACHE_TEST(p_hash_table->properties.count == HASH_TABLE_TEST_WORDS);
+
+    // A word that is found never calls the create function
+    HASH_CACHE_TEST(hash_table_upsert(p_hash_table, HASH_CACHE_TEST_KEY(0), test_hash_table_counter_found, test_hash_table_counter_create, &_context));
+    HASH_CACHE_TEST(counters[0].count == HASH_TABLE_TEST_COUNT / HASH_TABLE_TEST_WORDS + 1);
+
+    // Destroy the hash table
+    HASH_CACHE_TEST(hash_table_destroy(&p_hash_table, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_hash_table_collisions ( void )
+{
+
+    // Initialized data
+    hash_table                     *p_hash_table = (void *) 0;
+    hash_table_options              _options     =
+    {
+        .pfn_equality = test_hash_table_equality,
+        .pfn_key_get  = test_hash_table_counter_key,
+        .pfn_key_hash = test_hash_table_hash_constant
+    };
+    test_hash_table_upsert_context  _context     = { 0 };
+    void                           *p_value      = (void *) 0;
+
+    // Construct a hash table of counters, whose keys all have the same hash
+    HASH_CACHE_TEST(hash_table_construct_options(&p_hash_table, 64, &_options));
+
+    // Count each occurrence of each word
+    equalities = 0;
+    for (size_t i = 0; i < HASH_TABLE_TEST_COUNT; i++)
+        HASH_CACHE_TEST(hash_table_upsert(p_hash_table, HASH_CACHE_TEST_KEY(i % HASH_TABLE_TEST_WORDS), test_hash_table_counter_found, test_hash_table_counter_create, &_context));
+
+    // The equality function told the words apart
+    HASH_CACHE_TEST(_context.created == HASH_TABLE_TEST_WORDS);
+    HASH_CACHE_TEST(_context.found   == HASH_TABLE_TEST_COUNT - HASH_TABLE_TEST_WORDS);
+    HASH_CACHE_TEST(equalities       >  HASH_TABLE_TEST_COUNT);
+
+    // Each word is found, with its own counter
+    for (size_t i = 0; i < HASH_TABLE_TEST_WORDS; i++)
+    {
+        HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(i), &p_value));
+        HASH_CACHE_TEST(p_value == &counters[i]);
+        HASH_CACHE_TEST(counters[i].count == HASH_TABLE_TEST_COUNT / HASH_TABLE_TEST_WORDS);
+    }
+
+    // A word with the same hash that wasn't inserted isn't found
+    HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(HASH_TABLE_TEST_WORDS), &p_value) == 0);
+
+    // Destroy the hash table
+    HASH_CACHE_TEST(hash_table_destroy(&p_hash_table, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static hash64 test_hash_table_hash_skewed ( const void *const p_key )
+{
+
+    // Done
+    return ~(hash64) 0 - ( (size_t) p_key >> 1 );
+}
+
+static int test_hash_table_visit ( void *p_property )
+{
+
+    // Count the visit
+    __atomic_fetch_add(&visits[(size_t) p_property >> 1], 1, __ATOMIC_RELAXED);
+
+    // Success
+    return 1;
+}
+
+static void *test_hash_table_counter_key ( const void *const p_value )
+{
+
+    // Done
+    return (void *) ( (const test_hash_table_counter *) p_value )->p_key;
+}
+
+static void test_hash_table_counter_found ( void *p_value, void *p_context )
+{
+
+    // Initialized data
+    test_hash_table_upsert_context *p_upsert_context = p_context;
+    test_hash_table_counter        *p_counter        = p_value;
+
+    // Count the occurrence
+    p_counter->count++, p_upsert_context->found++;
+
+    // Done
+    return;
+}
+
+static void *test_hash_table_counter_create ( const void *const p_key, void *p_context )
+{
+
+    // Initialized data
+    test_hash_table_upsert_context *p_upsert_context = p_context;
+    test_hash_table_counter        *p_counter        = &counters[(size_t) p_key >> 1];
+
+    // Fail, if asked to
+    if ( p_upsert_context->fail ) return (void *) 0;
+
+    // Count the first occurrence
+    *p_counter = (test_hash_table_counter) { .p_key = p_key, .count = 1 }, p_upsert_context->created++;
+
+    // Success
+    return p_counter;
+}
+
+static hash64 test_hash_table_hash_constant ( const void *const p_key )
+{
+
+    // Unused
+    (void) p_key;
+
+    // Done
+    return 0x5A5A5A5A5A5A5A5A;
+}
+
+static int test_hash_table_equality ( const void *const p_a, const void *const p_b )
+{
+
+    // Count the comparison
+    equalities++;
+
+    // Done
+    return ( p_a == p_b ) ? 0 : 1;
+}
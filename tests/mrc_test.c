@@ -0,0 +1,215 @@
+/** !
+ * Tests for miss ratio curve estimation
+ *
+ * @file tests/mrc_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+
+// hash cache
+#include <hash_cache/mrc.h>
+#include <hash_cache/cache.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define MRC_TEST_SIZE       1024
+#define MRC_TEST_LOOP       1536
+#define MRC_TEST_PASSES     128
+#define MRC_TEST_KEYS       2048
+#define MRC_TEST_REFERENCES 200000
+
+// Forward declarations
+/** !
+ * Reference a loop of keys, longer than the cache and shorter than twice
+ * the cache, many times. Sampling every hash, an LRU cache of half or once
+ * the size misses every reference, and twice or four times the size hits
+ * every reference after the first pass
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_mrc_loop ( void );
+
+/** !
+ * Sampling one in sixteen hashes estimates the same curve as
+ * test_mrc_loop, within a few percent
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_mrc_sampled ( void );
+
+/** !
+ * The curve of an LRU cache, at the size of the cache, estimates the hit
+ * ratio the cache measures on a uniform workload
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_mrc_cache ( void );
+
+/** !
+ * Reference a loop of keys many times, and compute the curve
+ *
+ * @param sample   sample one in this many hashes
+ * @param p_points return, HASH_CACHE_MRC_POINTS points
+ *
+ * @return 1 on success, 0 on error
+ */
+static int test_mrc_loop_curve ( size_t sample, hash_cache_mrc_point *const p_points );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_mrc_loop, passed);
+    HASH_CACHE_TEST_RUN(test_mrc_sampled, passed);
+    HASH_CACHE_TEST_RUN(test_mrc_cache, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_mrc_loop_curve ( size_t sample, hash_cache_mrc_point *const p_points )
+{
+
+    // Initialized data
+    hash_cache_mrc *p_mrc = (void *) 0;
+
+    // Construct an estimator
+    HASH_CACHE_TEST(hash_cache_mrc_construct(&p_mrc, MRC_TEST_SIZE, sample));
+
+    // Reference the loop many times
+    for (size_t pass = 0; pass < MRC_TEST_PASSES; pass++)
+        for (size_t i = 0; i < MRC_TEST_LOOP; i++)
+            hash_cache_mrc_reference(p_mrc, hash_cache_key_hash(HASH_CACHE_TEST_KEY(i)));
+
+    // Compute the curve
+    HASH_CACHE_TEST(hash_cache_mrc_curve(p_mrc, p_points));
+
+    // Destroy the estimator
+    HASH_CACHE_TEST(hash_cache_mrc_destroy(&p_mrc));
+    HASH_CACHE_TEST(p_mrc == (void *) 0);
+
+    // Success
+    return 1;
+}
+
+static int test_mrc_loop ( void )
+{
+
+    // Initialized data
+    hash_cache_mrc_point points[HASH_CACHE_MRC_POINTS] = { 0 };
+
+    // Estimate the curve from every hash
+    HASH_CACHE_TEST(test_mrc_loop_curve(1, points));
+
+    // The points are half, once, twice, and four times the size of the cache
+    for (size_t i = 0; i < HASH_CACHE_MRC_POINTS; i++)
+        HASH_CACHE_TEST(points[i].size == ( (size_t) MRC_TEST_SIZE << i ) >> 1);
+
+    // The smaller caches hit almost never
+    HASH_CACHE_TEST(points[0].hit_ratio < 0.01);
+    HASH_CACHE_TEST(points[1].hit_ratio < 0.01);
+
+    // The larger caches hit every reference, except the faded misses of the first pass
+    HASH_CACHE_TEST(points[2].hit_ratio > 0.99);
+    HASH_CACHE_TEST(points[3].hit_ratio > 0.99);
+
+    // Pass
+    return 1;
+}
+
+static int test_mrc_sampled ( void )
+{
+
+    // Initialized data
+    hash_cache_mrc_point points[HASH_CACHE_MRC_POINTS] = { 0 };
+
+    // Estimate the curve from one in sixteen hashes
+    HASH_CACHE_TEST(test_mrc_loop_curve(16, points));
+
+    // The smaller caches rarely hit, and the larger caches almost always do
+    HASH_CACHE_TEST(points[0].hit_ratio < 0.05);
+    HASH_CACHE_TEST(points[1].hit_ratio < 0.05);
+    HASH_CACHE_TEST(points[2].hit_ratio > 0.95);
+    HASH_CACHE_TEST(points[3].hit_ratio > 0.95);
+
+    // Pass
+    return 1;
+}
+
+static int test_mrc_cache ( void )
+{
+
+    // Initialized data
+    cache                *p_cache                       = (void *) 0;
+    cache_options         _options                      =
+    {
+        .p_policy = &cache_policy_lru,
+        .mrc      = 1
+    };
+    hash_cache_mrc_point  points[HASH_CACHE_MRC_POINTS] = { 0 };
+    size_t                hits                          = 0;
+    unsigned              seed                          = 5;
+    double                hit_ratio                     = 0.0;
+
+    // A cache without an estimator has no curve
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, MRC_TEST_SIZE, &(cache_options) { 0 }));
+    HASH_CACHE_TEST(cache_miss_ratio_curve(p_cache, points) == 0);
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Construct an LRU cache that estimates its curve
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, MRC_TEST_SIZE, &_options));
+
+    // Reference random keys, and insert each miss
+    for (size_t i = 0; i < MRC_TEST_REFERENCES; i++)
+    {
+
+        // Initialized data
+        void   *p_key   = HASH_CACHE_TEST_KEY((size_t) rand_r(&seed) % MRC_TEST_KEYS),
+               *p_value = (void *) 0;
+
+        // Hit
+        if ( cache_get(p_cache, p_key, &p_value) ) hits++;
+
+        // Miss
+        else HASH_CACHE_TEST(cache_insert(p_cache, p_key, p_key));
+    }
+
+    // Compute the curve
+    HASH_CACHE_TEST(cache_miss_ratio_curve(p_cache, points));
+
+    // The estimate at the size of the cache is close to the measured hit ratio, which is about half
+    hit_ratio = (double) hits / (double) MRC_TEST_REFERENCES;
+    HASH_CACHE_TEST(points[1].size == MRC_TEST_SIZE);
+    HASH_CACHE_TEST(points[1].hit_ratio > hit_ratio - 0.03 && points[1].hit_ratio < hit_ratio + 0.03);
+
+    // A bigger cache hits more often
+    HASH_CACHE_TEST(points[0].hit_ratio < points[1].hit_ratio);
+    HASH_CACHE_TEST(points[1].hit_ratio < points[2].hit_ratio);
+    HASH_CACHE_TEST(points[2].hit_ratio <= points[3].hit_ratio);
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
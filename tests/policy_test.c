@@ -0,0 +1,371 @@
+/** !
+ * Tests for the eviction policies and their frequency sketch
+ *
+ * @file tests/policy_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+
+// hash cache
+#include <hash_cache/cache.h>
+#include <hash_cache/sketch.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define POLICY_TEST_CAPACITY 1024
+#define POLICY_TEST_HOT      512
+#define POLICY_TEST_ROUNDS   8
+#define POLICY_TEST_SCAN     32768
+
+// Forward declarations
+/** !
+ * Reference a hot set of keys many times, then scan many more keys than the
+ * cache holds, each once. Every miss inserts the key
+ *
+ * @param p_policy the eviction policy
+ * @param p_hits   return, the quantity of hot keys still in the cache after the scan
+ *
+ * @return 1 on success, 0 on error
+ */
+static int test_policy_scan ( const cache_policy *const p_policy, size_t *const p_hits );
+
+/** !
+ * Reference a key, and insert it on a miss
+ *
+ * @param p_cache the cache
+ * @param i       the key
+ *
+ * @return 1 on success, 0 on error
+ */
+static int test_policy_reference ( cache *const p_cache, size_t i );
+
+/** !
+ * A scan flushes the hot set out of an LRU cache. This shows the scan is
+ * long enough to flush a policy without scan resistance
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_lru_scan ( void );
+
+/** !
+ * An ARC cache keeps the hot set in its frequency list through a scan
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_arc_scan ( void );
+
+/** !
+ * A scan flushes the hot set out of a CLOCK cache, like an LRU cache. The
+ * scan clears every reference bit before it evicts the hot set
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_clock_scan ( void );
+
+/** !
+ * A CLOCK-Pro cache keeps the hot set in its hot pages through a scan. The
+ * scanned keys are cold, and the cold hand evicts them
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_clock_pro_scan ( void );
+
+/** !
+ * A frequency sketch never underestimates before a halving, saturates its
+ * counters, and halves them after a sample of increments
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_sketch ( void );
+
+/** !
+ * A W-TinyLFU cache doesn't admit scanned keys in place of the frequent
+ * keys of its main segments
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_tinylfu_scan ( void );
+
+/** !
+ * An S3-FIFO cache evicts scanned keys from its small queue, without
+ * touching the frequent keys of its main queue
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_s3fifo_scan ( void );
+
+/** !
+ * A key evicted from the small queue of an S3-FIFO cache is remembered by
+ * the ghost queue. Inserting it again puts it in the main queue, where a
+ * scan doesn't evict it
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_s3fifo_ghost ( void );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_lru_scan, passed);
+    HASH_CACHE_TEST_RUN(test_arc_scan, passed);
+    HASH_CACHE_TEST_RUN(test_clock_scan, passed);
+    HASH_CACHE_TEST_RUN(test_clock_pro_scan, passed);
+    HASH_CACHE_TEST_RUN(test_sketch, passed);
+    HASH_CACHE_TEST_RUN(test_tinylfu_scan, passed);
+    HASH_CACHE_TEST_RUN(test_s3fifo_scan, passed);
+    HASH_CACHE_TEST_RUN(test_s3fifo_ghost, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_policy_scan ( const cache_policy *const p_policy, size_t *const p_hits )
+{
+
+    // Initialized data
+    cache         *p_cache  = (void *) 0;
+    cache_options  _options = { .p_policy = p_policy };
+    size_t         hits     = 0;
+
+    // Construct a cache
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, POLICY_TEST_CAPACITY, &_options));
+
+    // Reference the hot set many times
+    for (size_t round = 0; round < POLICY_TEST_ROUNDS; round++)
+        for (size_t i = 0; i < POLICY_TEST_HOT; i++)
+            HASH_CACHE_TEST(test_policy_reference(p_cache, i));
+
+    // Scan keys that are never referenced again
+    for (size_t i = POLICY_TEST_HOT; i < POLICY_TEST_HOT + POLICY_TEST_SCAN; i++)
+        HASH_CACHE_TEST(test_policy_reference(p_cache, i));
+
+    // The cache never holds more than its capacity
+    HASH_CACHE_TEST(p_cache->properties.count <= POLICY_TEST_CAPACITY);
+
+    // Count the hot keys that survived the scan
+    for (size_t i = 0; i < POLICY_TEST_HOT; i++)
+        hits += ( cache_lookup(p_cache, HASH_CACHE_TEST_KEY(i)) != CACHE_NIL );
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Return the hits to the caller
+    *p_hits = hits;
+
+    // Success
+    return 1;
+}
+
+static int test_policy_reference ( cache *const p_cache, size_t i )
+{
+
+    // Initialized data
+    void *p_value = (void *) 0;
+
+    // Hit
+    if ( cache_get(p_cache, HASH_CACHE_TEST_KEY(i), &p_value) ) return p_value == HASH_CACHE_TEST_KEY(i);
+
+    // Miss
+    return cache_insert(p_cache, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i));
+}
+
+static int test_lru_scan ( void )
+{
+
+    // Initialized data
+    size_t hits = 0;
+
+    // Scan an LRU cache
+    HASH_CACHE_TEST(test_policy_scan(&cache_policy_lru, &hits));
+
+    // Nothing survived
+    HASH_CACHE_TEST(hits == 0);
+
+    // Pass
+    return 1;
+}
+
+static int test_arc_scan ( void )
+{
+
+    // Initialized data
+    size_t hits = 0;
+
+    // Scan an ARC cache
+    HASH_CACHE_TEST(test_policy_scan(&cache_policy_arc, &hits));
+
+    // Most of the hot set survived
+    HASH_CACHE_TEST(hits >= POLICY_TEST_HOT * 9 / 10);
+
+    // Pass
+    return 1;
+}
+
+static int test_clock_scan ( void )
+{
+
+    // Initialized data
+    size_t hits = 0;
+
+    // Scan a CLOCK cache
+    HASH_CACHE_TEST(test_policy_scan(&cache_policy_clock, &hits));
+    // Nothing survived
+    HASH_CACHE_TEST(hits == 0);
+
+    // Pass
+    return 1;
+}
+
+static int test_clock_pro_scan ( void )
+{
+
+    // Initialized data
+    size_t hits = 0;
+
+    // Scan a CLOCK-Pro cache
+    HASH_CACHE_TEST(test_policy_scan(&cache_policy_clock_pro, &hits));
+    // Most of the hot set survived
+    HASH_CACHE_TEST(hits >= POLICY_TEST_HOT * 9 / 10);
+
+    // Pass
+    return 1;
+}
+
+static int test_sketch ( void )
+{
+
+    // Initialized data
+    hash_cache_sketch *p_sketch = (void *) 0;
+    hash64             h        = hash_cache_key_hash(HASH_CACHE_TEST_KEY(0));
+
+    // Construct a sketch
+    HASH_CACHE_TEST(hash_cache_sketch_construct(&p_sketch, 1024));
+
+    // Count some keys a few times each
+    for (size_t i = 1; i <= 64; i++)
+        for (size_t j = 0; j < i % 8; j++)
+            hash_cache_sketch_increment(p_sketch, hash_cache_key_hash(HASH_CACHE_TEST_KEY(i)));
+
+    // The estimates are never too low
+    for (size_t i = 1; i <= 64; i++)
+        HASH_CACHE_TEST(hash_cache_sketch_estimate(p_sketch, hash_cache_key_hash(HASH_CACHE_TEST_KEY(i))) >= i % 8);
+
+    // A counter saturates
+    for (size_t i = 0; i < 2 * HASH_CACHE_SKETCH_COUNTER_MAX; i++) hash_cache_sketch_increment(p_sketch, h);
+    HASH_CACHE_TEST(hash_cache_sketch_estimate(p_sketch, h) == HASH_CACHE_SKETCH_COUNTER_MAX);
+
+    // Count enough other keys to halve every counter
+    for (size_t i = 1; i <= p_sketch->sample; i++)
+        hash_cache_sketch_increment(p_sketch, hash_cache_key_hash(HASH_CACHE_TEST_KEY(i + 1024)));
+
+    // The old popularity faded
+    HASH_CACHE_TEST(hash_cache_sketch_estimate(p_sketch, h) < HASH_CACHE_SKETCH_COUNTER_MAX);
+
+    // Clear the sketch, and forget every key
+    HASH_CACHE_TEST(hash_cache_sketch_clear(p_sketch));
+    HASH_CACHE_TEST(hash_cache_sketch_estimate(p_sketch, h) == 0);
+
+    // Destroy the sketch
+    HASH_CACHE_TEST(hash_cache_sketch_destroy(&p_sketch));
+
+    // Pass
+    return 1;
+}
+
+static int test_tinylfu_scan ( void )
+{
+
+    // Initialized data
+    size_t hits = 0;
+
+    // Scan a W-TinyLFU cache
+    HASH_CACHE_TEST(test_policy_scan(&cache_policy_tinylfu, &hits));
+
+    // Most of the hot set survived
+    HASH_CACHE_TEST(hits >= POLICY_TEST_HOT * 9 / 10);
+
+    // Pass
+    return 1;
+}
+
+static int test_s3fifo_scan ( void )
+{
+
+    // Initialized data
+    size_t hits = 0;
+
+    // Scan an S3-FIFO cache
+    HASH_CACHE_TEST(test_policy_scan(&cache_policy_s3fifo, &hits));
+
+    // Most of the hot set survived
+    HASH_CACHE_TEST(hits >= POLICY_TEST_HOT * 9 / 10);
+
+    // Pass
+    return 1;
+}
+
+static int test_s3fifo_ghost ( void )
+{
+
+    // Initialized data
+    cache         *p_cache  = (void *) 0;
+    cache_options  _options = { .p_policy = &cache_policy_s3fifo };
+
+    // Construct a cache
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, POLICY_TEST_CAPACITY, &_options));
+
+    // Insert a key, and scan enough keys to push it out of the small queue
+    HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(0), HASH_CACHE_TEST_KEY(0)));
+    for (size_t i = 1; i <= POLICY_TEST_CAPACITY; i++)
+        HASH_CACHE_TEST(test_policy_reference(p_cache, i));
+
+    // The key was evicted
+    HASH_CACHE_TEST(cache_lookup(p_cache, HASH_CACHE_TEST_KEY(0)) == CACHE_NIL);
+
+    // Insert the key again. The ghost queue sends it to the main queue
+    HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(0), HASH_CACHE_TEST_KEY(0)));
+
+    // Scan many more keys than the cache holds
+    for (size_t i = POLICY_TEST_CAPACITY + 1; i <= POLICY_TEST_CAPACITY + POLICY_TEST_SCAN; i++)
+        HASH_CACHE_TEST(test_policy_reference(p_cache, i));
+
+    // The key is still in the cache
+    HASH_CACHE_TEST(cache_lookup(p_cache, HASH_CACHE_TEST_KEY(0)) != CACHE_NIL);
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
@@ -0,0 +1,253 @@
+/** !
+ * Tests for the set associative cache
+ *
+ * @file tests/set_cache_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// hash cache
+#include <hash_cache/set_cache.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define SET_CACHE_TEST_SIZE 1000
+#define SET_CACHE_TEST_KEYS 64
+
+// Data
+static size_t evictions[SET_CACHE_TEST_KEYS] = { 0 },
+              frees                          = 0;
+
+// Forward declarations
+/** !
+ * The sets fill one cache line each, start on a cache line, and their
+ * quantity is the size rounded up to a power of 2 quantity of sets
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_set_cache_layout ( void );
+
+/** !
+ * Get, insert, replace, remove, and clear keys
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_set_cache_operations ( void );
+
+/** !
+ * A full set evicts a way that wasn't used since every way was last used,
+ * and keeps the ways that were
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_set_cache_eviction ( void );
+
+/** !
+ * Count an eviction of a key
+ *
+ * @param p_value   the value of the evicted key
+ * @param p_context unused
+ *
+ * @return void
+ */
+static void test_set_cache_evict ( void *p_value, void *p_context );
+
+/** !
+ * Count a freed value
+ *
+ * @param p_value the value
+ *
+ * @return void
+ */
+static void test_set_cache_free ( void *p_value );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_set_cache_layout, passed);
+    HASH_CACHE_TEST_RUN(test_set_cache_operations, passed);
+    HASH_CACHE_TEST_RUN(test_set_cache_eviction, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_set_cache_layout ( void )
+{
+
+    // Initialized data
+    set_cache *p_set_cache = (void *) 0;
+
+    // A set is one cache line on a 64 bit target
+    HASH_CACHE_TEST(sizeof(void *) != 8 || sizeof(set_cache_set) == 64);
+
+    // Construct a set associative cache
+    HASH_CACHE_TEST(set_cache_construct(&p_set_cache, SET_CACHE_TEST_SIZE, (void *) 0));
+
+    // 1000 properties need 143 sets of 7 ways, rounded up to 256 sets
+    HASH_CACHE_TEST(p_set_cache->mask + 1 == 256);
+    HASH_CACHE_TEST(set_cache_bytes(p_set_cache) == 256 * sizeof(set_cache_set));
+
+    // The sets start on a cache line
+    HASH_CACHE_TEST(( (size_t) p_set_cache->p_sets & 63 ) == 0);
+
+    // Destroy the set associative cache
+    HASH_CACHE_TEST(set_cache_destroy(&p_set_cache, (void *) 0));
+    HASH_CACHE_TEST(p_set_cache == (void *) 0);
+
+    // Pass
+    return 1;
+}
+
+static int test_set_cache_operations ( void )
+{
+
+    // Initialized data
+    set_cache         *p_set_cache = (void *) 0;
+    set_cache_options  _options    = { .pfn_evict = test_set_cache_evict };
+    void              *p_value     = (void *) 0;
+    size_t             found       = 0;
+
+    // Forget every eviction
+    memset(evictions, 0, sizeof(evictions)), frees = 0;
+
+    // Construct a set associative cache
+    HASH_CACHE_TEST(set_cache_construct(&p_set_cache, SET_CACHE_TEST_SIZE, &_options));
+
+    // A key that was never inserted is a miss
+    HASH_CACHE_TEST(set_cache_get(p_set_cache, HASH_CACHE_TEST_KEY(0), &p_value) == 0);
+
+    // Insert each key
+    for (size_t i = 0; i < SET_CACHE_TEST_KEYS; i++)
+        HASH_CACHE_TEST(set_cache_insert(p_set_cache, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i)));
+
+    // Every key that wasn't evicted is a hit, with its value. Few keys share a full set
+    for (size_t i = 0; i < SET_CACHE_TEST_KEYS; i++)
+    {
+
+        // Search the cache
+        HASH_CACHE_TEST(set_cache_get(p_set_cache, HASH_CACHE_TEST_KEY(i), &p_value) == ( evictions[i] == 0 ));
+        HASH_CACHE_TEST(evictions[i] || p_value == HASH_CACHE_TEST_KEY(i));
+
+        // Count the hit
+        found += ( evictions[i] == 0 );
+    }
+    HASH_CACHE_TEST(found >= SET_CACHE_TEST_KEYS * 9 / 10);
+
+    // Inserting the same value again replaces nothing
+    memset(evictions, 0, sizeof(evictions));
+    HASH_CACHE_TEST(set_cache_insert(p_set_cache, HASH_CACHE_TEST_KEY(1), HASH_CACHE_TEST_KEY(1)));
+    HASH_CACHE_TEST(evictions[1] == 0);
+
+    // Remove a key
+    HASH_CACHE_TEST(set_cache_remove(p_set_cache, HASH_CACHE_TEST_KEY(1), &p_value));
+    HASH_CACHE_TEST(p_value == HASH_CACHE_TEST_KEY(1));
+    HASH_CACHE_TEST(set_cache_get(p_set_cache, HASH_CACHE_TEST_KEY(1), &p_value) == 0);
+    HASH_CACHE_TEST(set_cache_remove(p_set_cache, HASH_CACHE_TEST_KEY(1), (void *) 0) == 0);
+
+    // Clear the cache, and free each value
+    HASH_CACHE_TEST(set_cache_clear(p_set_cache, test_set_cache_free));
+    HASH_CACHE_TEST(frees == found - 1);
+    for (size_t i = 0; i < SET_CACHE_TEST_KEYS; i++)
+        HASH_CACHE_TEST(set_cache_get(p_set_cache, HASH_CACHE_TEST_KEY(i), &p_value) == 0);
+
+    // Destroy the set associative cache
+    HASH_CACHE_TEST(set_cache_destroy(&p_set_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_set_cache_eviction ( void )
+{
+
+    // Initialized data
+    set_cache         *p_set_cache = (void *) 0;
+    set_cache_options  _options    = { .pfn_evict = test_set_cache_evict };
+    void              *p_value     = (void *) 0;
+
+    // Forget every eviction
+    memset(evictions, 0, sizeof(evictions));
+
+    // Construct a set associative cache of one set
+    HASH_CACHE_TEST(set_cache_construct(&p_set_cache, SET_CACHE_WAYS, &_options));
+    HASH_CACHE_TEST(p_set_cache->mask == 0);
+
+    // Fill the set
+    for (size_t i = 0; i < SET_CACHE_WAYS; i++)
+        HASH_CACHE_TEST(set_cache_insert(p_set_cache, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i)));
+
+    // Nothing was evicted
+    for (size_t i = 0; i < SET_CACHE_WAYS; i++)
+        HASH_CACHE_TEST(evictions[i] == 0);
+
+    // Use every key but the first
+    for (size_t i = 1; i < SET_CACHE_WAYS; i++)
+        HASH_CACHE_TEST(set_cache_get(p_set_cache, HASH_CACHE_TEST_KEY(i), &p_value));
+
+    // Insert another key, which evicts the first key
+    HASH_CACHE_TEST(set_cache_insert(p_set_cache, HASH_CACHE_TEST_KEY(SET_CACHE_WAYS), HASH_CACHE_TEST_KEY(SET_CACHE_WAYS)));
+    HASH_CACHE_TEST(evictions[0] == 1);
+    HASH_CACHE_TEST(set_cache_get(p_set_cache, HASH_CACHE_TEST_KEY(0), &p_value) == 0);
+
+    // The other keys are still in the set
+    for (size_t i = 1; i <= SET_CACHE_WAYS; i++)
+    {
+        HASH_CACHE_TEST(evictions[i] == 0);
+        HASH_CACHE_TEST(set_cache_get(p_set_cache, HASH_CACHE_TEST_KEY(i), &p_value));
+    }
+
+    // Destroy the set associative cache
+    HASH_CACHE_TEST(set_cache_destroy(&p_set_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static void test_set_cache_evict ( void *p_value, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Count the eviction
+    evictions[(size_t) p_value >> 1]++;
+
+    // Done
+    return;
+}
+
+static void test_set_cache_free ( void *p_value )
+{
+
+    // Unused
+    (void) p_value;
+
+    // Count the value
+    frees++;
+
+    // Done
+    return;
+}
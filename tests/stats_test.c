@@ -0,0 +1,182 @@
+/** !
+ * Tests for the statistics of the cache and the hash table. Build with
+ * HASH_CACHE_STATS on to check the counters
+ *
+ * @file tests/stats_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+
+// hash cache
+#include <hash_cache/cache.h>
+#include <hash_cache/hash_table.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Forward declarations
+/** !
+ * Get, insert, replace, and evict keys of a small cache, and check each
+ * counter. Each key has its own tag, so a hit compares one slot, and a
+ * miss compares none
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_stats_cache ( void );
+
+/** !
+ * Insert keys into a hash table, some with the same home slot, search
+ * them, resize the table, and check each counter
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_stats_hash_table ( void );
+
+/** !
+ * Hash the key i of HASH_CACHE_TEST_KEY, so that its top 3 bits are i
+ * modulo 8, and its tag is unique, and never 0, for i less than 248
+ *
+ * @param p_key the key
+ *
+ * @return the hash of the key
+ */
+static hash64 test_stats_hash ( const void *const p_key );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_stats_cache, passed);
+    HASH_CACHE_TEST_RUN(test_stats_hash_table, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_stats_cache ( void )
+{
+
+    // Initialized data
+    cache            *p_cache  = (void *) 0;
+    cache_options     _options = { .pfn_key_hash = test_stats_hash };
+    hash_cache_stats  _stats   = { 0 };
+    void             *p_value  = (void *) 0;
+
+    // Construct an LRU cache of 4 properties
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, 4, &_options));
+
+    // Insert 5 keys, which evicts the first
+    for (size_t i = 0; i < 5; i++)
+        HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i)));
+
+    // Hit twice, and miss twice
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(4), &p_value));
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(1), &p_value));
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(0), &p_value) == 0);
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(9), &p_value) == 0);
+
+    // Replace a value
+    HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(1), HASH_CACHE_TEST_KEY(1)));
+
+    #ifdef HASH_CACHE_STATS
+
+        // Sum the counters
+        HASH_CACHE_TEST(cache_stats(p_cache, &_stats));
+
+        // Check each counter
+        HASH_CACHE_TEST(_stats.hits      == 2);
+        HASH_CACHE_TEST(_stats.misses    == 2);
+        HASH_CACHE_TEST(_stats.inserts   == 6);
+        HASH_CACHE_TEST(_stats.evictions == 1);
+        HASH_CACHE_TEST(_stats.probes    == 2);
+        HASH_CACHE_TEST(_stats.resizes   == 0);
+    #else
+
+        // There are no counters
+        HASH_CACHE_TEST(cache_stats(p_cache, &_stats) == 0);
+    #endif
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_stats_hash_table ( void )
+{
+
+    // Initialized data
+    hash_table       *p_hash_table = (void *) 0;
+    hash_cache_stats  _stats       = { 0 };
+    void             *p_value      = (void *) 0;
+
+    // Construct a hash table of 8 slots. Key i has home slot i modulo 8
+    HASH_CACHE_TEST(hash_table_construct(&p_hash_table, 8, (void *) 0, (void *) 0, test_stats_hash));
+
+    // Insert keys 0, 1, and 8. Key 8 probes slots 0 and 1, and takes slot 2
+    HASH_CACHE_TEST(hash_table_insert(p_hash_table, HASH_CACHE_TEST_KEY(0)));
+    HASH_CACHE_TEST(hash_table_insert(p_hash_table, HASH_CACHE_TEST_KEY(1)));
+    HASH_CACHE_TEST(hash_table_insert(p_hash_table, HASH_CACHE_TEST_KEY(8)));
+
+    // Hit in 1 probe, and in 3 probes
+    HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(0), &p_value));
+    HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(8), &p_value));
+
+    // Miss in 3 probes, ended by the empty slot 3, and in 0 probes, at the empty slot 5
+    HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(16), &p_value) == 0);
+    HASH_CACHE_TEST(hash_table_search(p_hash_table, HASH_CACHE_TEST_KEY(5), &p_value) == 0);
+
+    // Grow the hash table
+    HASH_CACHE_TEST(hash_table_resize(p_hash_table, 16));
+
+    #ifdef HASH_CACHE_STATS
+
+        // Sum the counters
+        HASH_CACHE_TEST(hash_table_stats(p_hash_table, &_stats));
+
+        // Check each counter
+        HASH_CACHE_TEST(_stats.hits      == 2);
+        HASH_CACHE_TEST(_stats.misses    == 2);
+        HASH_CACHE_TEST(_stats.inserts   == 3);
+        HASH_CACHE_TEST(_stats.evictions == 0);
+        HASH_CACHE_TEST(_stats.probes    == 1 + 3 + 3 + 0);
+        HASH_CACHE_TEST(_stats.resizes   == 1);
+    #else
+
+        // There are no counters
+        HASH_CACHE_TEST(hash_table_stats(p_hash_table, &_stats) == 0);
+    #endif
+
+    // Destroy the hash table
+    HASH_CACHE_TEST(hash_table_destroy(&p_hash_table, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static hash64 test_stats_hash ( const void *const p_key )
+{
+
+    // Initialized data
+    size_t i = (size_t) p_key >> 1;
+
+    // The top 3 bits pick the home slot of 8, the next 5 bits finish the tag, and the low bits keep the hashes apart
+    return ( (hash64) ( i % 8 ) << 61 ) | ( (hash64) ( ( i / 8 + 1 ) % 32 ) << 56 ) | i;
+}
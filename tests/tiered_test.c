@@ -0,0 +1,434 @@
+/** !
+ * Tests for the tiered cache
+ *
+ * @file tests/tiered_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+// hash cache
+#include <hash_cache/tiered_cache.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define TIERED_TEST_KEYS       256
+#define TIERED_TEST_CAPACITY   128
+#define TIERED_TEST_READERS    4
+#define TIERED_TEST_WRITERS    2
+#define TIERED_TEST_OPERATIONS 50000
+
+// Structure declarations
+struct tiered_test_value_s;
+
+// Type definitions
+typedef struct tiered_test_value_s tiered_test_value;
+
+// Structure definitions
+struct tiered_test_value_s
+{
+    size_t key; // The key of the value, read by the cache's equality function
+};
+
+// Data
+static tiered_cache      *p_tiered_cache             = (void *) 0;
+static tiered_test_value *p_values[TIERED_TEST_KEYS] = { 0 };
+static bool               stop                       = false;
+static pthread_barrier_t  _step;
+
+// Forward declarations
+/** !
+ * A thread reads a key into its L1 cache. Replacing the key, and removing
+ * it, from another thread invalidates the L1 copy
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_tiered_invalidate ( void );
+
+/** !
+ * Read a key at each step of test_tiered_invalidate
+ *
+ * @param p_parameter unused
+ *
+ * @return 0 on pass, else the step that failed
+ */
+static void *test_tiered_invalidate_reader ( void *p_parameter );
+
+/** !
+ * Get hot keys from many threads, while other threads insert, replace,
+ * remove and clear them. When the writers are done, each reader checks that
+ * every key it reads through its L1 cache has the value the writers left
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_tiered_concurrent ( void );
+
+/** !
+ * Get random keys until the writers stop, then check every key
+ *
+ * @param p_parameter the seed of the reader
+ *
+ * @return 0 on pass, else the parameter
+ */
+static void *test_tiered_reader ( void *p_parameter );
+
+/** !
+ * Insert, replace and remove random keys. A writer only writes the keys
+ * that are equal to its index, modulo the quantity of writers
+ *
+ * @param p_parameter the index of the writer
+ *
+ * @return 0
+ */
+static void *test_tiered_writer ( void *p_parameter );
+
+/** !
+ * Compare the keys of two values
+ *
+ * @param p_a the key of A
+ * @param p_b the key of B
+ *
+ * @return 0 if A == B else 1
+ */
+static int test_tiered_equals ( const void *const p_a, const void *const p_b );
+
+/** !
+ * Get the key of a value
+ *
+ * @param p_value the value
+ *
+ * @return the key of the value
+ */
+static void *test_tiered_key ( const void *const p_value );
+
+/** !
+ * Hash a key
+ *
+ * @param p_key the key
+ *
+ * @return the hash of the key
+ */
+static hash64 test_tiered_hash ( const void *const p_key );
+
+/** !
+ * Forget a value that left the cache, and free it
+ *
+ * @param p_value the value
+ *
+ * @return void
+ */
+static void test_tiered_free ( void *p_value );
+
+/** !
+ * Forget an evicted value, and free it
+ *
+ * @param p_value   the value
+ * @param p_context unused
+ *
+ * @return void
+ */
+static void test_tiered_evict ( void *p_value, void *p_context );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_tiered_invalidate, passed);
+    HASH_CACHE_TEST_RUN(test_tiered_concurrent, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_tiered_invalidate ( void )
+{
+
+    // Initialized data
+    pthread_t             reader   = { 0 };
+    void                 *p_result = (void *) 0;
+    tiered_test_value     _a       = { .key = 0 },
+                          _b       = { .key = 0 };
+    tiered_cache_options  _options =
+    {
+        .l2 =
+        {
+            .cache =
+            {
+                .pfn_equality = test_tiered_equals,
+                .pfn_key_get  = test_tiered_key,
+                .pfn_key_hash = test_tiered_hash
+            }
+        }
+    };
+
+    // Construct a tiered cache
+    HASH_CACHE_TEST(tiered_cache_construct(&p_tiered_cache, TIERED_TEST_CAPACITY, &_options));
+
+    // Insert a key, and start the reader
+    HASH_CACHE_TEST(tiered_cache_insert(p_tiered_cache, &_a.key, &_a));
+    p_values[0] = &_a;
+    HASH_CACHE_TEST(pthread_barrier_init(&_step, (void *) 0, 2) == 0);
+    HASH_CACHE_TEST(pthread_create(&reader, (void *) 0, test_tiered_invalidate_reader, (void *) 0) == 0);
+
+    // Replace the key, after the reader copies it to its L1 cache
+    pthread_barrier_wait(&_step);
+    HASH_CACHE_TEST(tiered_cache_insert(p_tiered_cache, &_b.key, &_b));
+    p_values[0] = &_b;
+    pthread_barrier_wait(&_step);
+
+    // Remove the key, after the reader sees the new value
+    pthread_barrier_wait(&_step);
+    HASH_CACHE_TEST(tiered_cache_remove(p_tiered_cache, &_b.key, (void *) 0));
+    p_values[0] = (void *) 0;
+    pthread_barrier_wait(&_step);
+
+    // The reader saw each value
+    HASH_CACHE_TEST(pthread_join(reader, &p_result) == 0);
+    HASH_CACHE_TEST(p_result == (void *) 0);
+    HASH_CACHE_TEST(pthread_barrier_destroy(&_step) == 0);
+
+    // Destroy the tiered cache
+    HASH_CACHE_TEST(tiered_cache_destroy(&p_tiered_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static void *test_tiered_invalidate_reader ( void *p_parameter )
+{
+
+    // Initialized data
+    size_t  key     = 0;
+    void   *p_value = (void *) 0;
+
+    // Unused
+    (void) p_parameter;
+
+    // Read the first value twice, so the second read hits the L1 cache
+    if ( tiered_cache_get(p_tiered_cache, &key, &p_value) == 0 || p_value != p_values[0] ) return (void *) 1;
+    if ( tiered_cache_get(p_tiered_cache, &key, &p_value) == 0 || p_value != p_values[0] ) return (void *) 1;
+
+    // Wait for the key to be replaced
+    pthread_barrier_wait(&_step);
+    pthread_barrier_wait(&_step);
+
+    // The L1 copy is stale, so the new value is read
+    if ( tiered_cache_get(p_tiered_cache, &key, &p_value) == 0 || p_value != p_values[0] ) return (void *) 2;
+
+    // Wait for the key to be removed
+    pthread_barrier_wait(&_step);
+    pthread_barrier_wait(&_step);
+
+    // The key is gone
+    if ( tiered_cache_get(p_tiered_cache, &key, &p_value) ) return (void *) 3;
+
+    // Pass
+    return (void *) 0;
+}
+
+static int test_tiered_concurrent ( void )
+{
+
+    // Initialized data
+    pthread_t             readers[TIERED_TEST_READERS] = { 0 },
+                          writers[TIERED_TEST_WRITERS] = { 0 };
+    tiered_cache_options  _options                     =
+    {
+        .l2 =
+        {
+            .cache =
+            {
+                .pfn_equality = test_tiered_equals,
+                .pfn_key_get  = test_tiered_key,
+                .pfn_key_hash = test_tiered_hash,
+                .pfn_evict    = test_tiered_evict
+            },
+            .shards = 4
+        }
+    };
+
+    // Forget every value
+    for (size_t i = 0; i < TIERED_TEST_KEYS; i++) p_values[i] = (void *) 0;
+
+    // Construct a tiered cache
+    HASH_CACHE_TEST(tiered_cache_construct(&p_tiered_cache, TIERED_TEST_CAPACITY, &_options));
+
+    // Start the readers and the writers
+    for (size_t i = 0; i < TIERED_TEST_READERS; i++) HASH_CACHE_TEST(pthread_create(&readers[i], (void *) 0, test_tiered_reader, (void *) ( i + 1 )) == 0);
+    for (size_t i = 0; i < TIERED_TEST_WRITERS; i++) HASH_CACHE_TEST(pthread_create(&writers[i], (void *) 0, test_tiered_writer, (void *) i) == 0);
+
+    // Wait for the writers, then stop the readers
+    for (size_t i = 0; i < TIERED_TEST_WRITERS; i++) HASH_CACHE_TEST(pthread_join(writers[i], (void *) 0) == 0);
+    __atomic_store_n(&stop, true, __ATOMIC_RELEASE);
+
+    // Each reader saw the values the writers left
+    for (size_t i = 0; i < TIERED_TEST_READERS; i++)
+    {
+
+        // Initialized data
+        void *p_result = (void *) 0;
+
+        // Wait for the reader
+        HASH_CACHE_TEST(pthread_join(readers[i], &p_result) == 0);
+        HASH_CACHE_TEST(p_result == (void *) 0);
+    }
+
+    // Destroy the tiered cache, and free every value in it
+    HASH_CACHE_TEST(tiered_cache_destroy(&p_tiered_cache, free));
+
+    // Pass
+    return 1;
+}
+
+static void *test_tiered_reader ( void *p_parameter )
+{
+
+    // Initialized data
+    unsigned seed = (unsigned) (size_t) p_parameter;
+
+    // Get hot keys until the writers stop. A value may be freed as soon as the get returns, so it isn't read
+    while ( __atomic_load_n(&stop, __ATOMIC_ACQUIRE) == false )
+    {
+
+        // Initialized data
+        size_t  key     = (size_t) rand_r(&seed) % ( TIERED_TEST_KEYS / 4 );
+        void   *p_value = (void *) 0;
+
+        // Get the key
+        (void) tiered_cache_get(p_tiered_cache, &key, &p_value);
+    }
+
+    // Every key has the value the writers left, even if a stale copy is in the L1 cache
+    for (size_t key = 0; key < TIERED_TEST_KEYS; key++)
+    {
+
+        // Initialized data
+        void *p_value = (void *) 0;
+
+        // Get the key
+        if ( tiered_cache_get(p_tiered_cache, &key, &p_value) != ( p_values[key] != (void *) 0 ) ) return p_parameter;
+        if ( p_value != p_values[key] ) return p_parameter;
+    }
+
+    // Pass
+    return (void *) 0;
+}
+
+static void *test_tiered_writer ( void *p_parameter )
+{
+
+    // Initialized data
+    size_t   writer = (size_t) p_parameter;
+    unsigned seed   = (unsigned) writer + 100;
+
+    // Write random keys of this writer
+    for (size_t i = 0; i < TIERED_TEST_OPERATIONS; i++)
+    {
+
+        // Initialized data
+        size_t key = (size_t) rand_r(&seed) % ( TIERED_TEST_KEYS / TIERED_TEST_WRITERS ) * TIERED_TEST_WRITERS + writer;
+
+        // Now and then, clear the cache
+        if ( i % 10000 == 5000 ) tiered_cache_clear(p_tiered_cache, test_tiered_free);
+
+        // Insert or replace the key ...
+        if ( i % 3 )
+        {
+
+            // Initialized data
+            tiered_test_value *p_value = malloc(sizeof(tiered_test_value));
+
+            // Error check
+            if ( p_value == (void *) 0 ) abort();
+
+            // Remember the value before the cache can evict it
+            p_value->key = key;
+            __atomic_store_n(&p_values[key], p_value, __ATOMIC_RELEASE);
+
+            // Insert the value
+            if ( tiered_cache_insert(p_tiered_cache, &p_value->key, p_value) == 0 ) abort();
+        }
+
+        // ... or remove it
+        else
+        {
+
+            // Initialized data
+            void *p_value = (void *) 0;
+
+            // Remove the key, forget its value, and free it
+            if ( tiered_cache_remove(p_tiered_cache, &key, &p_value) ) test_tiered_free(p_value);
+        }
+    }
+
+    // Done
+    return (void *) 0;
+}
+
+static int test_tiered_equals ( const void *const p_a, const void *const p_b )
+{
+
+    // Done
+    return ( *(const size_t *) p_a == *(const size_t *) p_b ) ? 0 : 1;
+}
+
+static void *test_tiered_key ( const void *const p_value )
+{
+
+    // Done
+    return &((tiered_test_value *) p_value)->key;
+}
+
+static hash64 test_tiered_hash ( const void *const p_key )
+{
+
+    // Done
+    return hash_cache_key_hash((void *) *(const size_t *) p_key);
+}
+
+static void test_tiered_free ( void *p_value )
+{
+
+    // Initialized data
+    tiered_test_value *p_expected = p_value;
+
+    // Forget the value, unless its key was already given a new value
+    __atomic_compare_exchange_n(&p_values[p_expected->key], &p_expected, (void *) 0, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+
+    // Free the value
+    free(p_value);
+
+    // Done
+    return;
+}
+
+static void test_tiered_evict ( void *p_value, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Forget the value, and free it
+    test_tiered_free(p_value);
+
+    // Done
+    return;
+}
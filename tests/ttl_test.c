@@ -0,0 +1,335 @@
+/** !
+ * Tests for the timer wheel, and time to live expiration of a cache
+ *
+ * @file tests/ttl_test.c
+ *
+ * @author Jacob Smith
+ */
+
+// Standard library
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// hash cache
+#include <hash_cache/wheel.h>
+#include <hash_cache/cache.h>
+
+// Tests
+#include "hash_cache_test.h"
+
+// Preprocessor definitions
+#define TTL_TEST_TIMERS     2000
+#define TTL_TEST_OPERATIONS 200000
+#define TTL_TEST_KEYS       64
+
+// Data
+static size_t evictions[TTL_TEST_KEYS] = { 0 };
+
+// Forward declarations
+/** !
+ * Schedule, cancel, and expire timers at random, with deadlines from a few
+ * ticks to beyond the top level of the wheel, and long idle advances. Each
+ * pop is checked against a list of deadlines
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_wheel ( void );
+
+/** !
+ * cache_maintain evicts every expired property, and only those
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_ttl_maintain ( void );
+
+/** !
+ * A property inserted with the default time to live is a miss once it
+ * expires, even if the cache is never maintained
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_ttl_default ( void );
+
+/** !
+ * A full cache evicts its expired properties before its live ones, even if
+ * the policy would pick a live property
+ *
+ * @param void
+ *
+ * @return 1 on pass, 0 on fail
+ */
+static int test_ttl_expired_first ( void );
+
+/** !
+ * Wait until a time has passed
+ *
+ * @param deadline the time
+ *
+ * @return void
+ */
+static void test_ttl_wait ( timestamp deadline );
+
+/** !
+ * Count an eviction of a key
+ *
+ * @param p_value   the value of the evicted key
+ * @param p_context unused
+ *
+ * @return void
+ */
+static void test_ttl_evict ( void *p_value, void *p_context );
+
+// Entry point
+int main ( int argc, const char *argv[] )
+{
+
+    // Unused
+    (void) argc;
+    (void) argv;
+
+    // Initialized data
+    int passed = 1;
+
+    // Run each test
+    HASH_CACHE_TEST_RUN(test_wheel, passed);
+    HASH_CACHE_TEST_RUN(test_ttl_maintain, passed);
+    HASH_CACHE_TEST_RUN(test_ttl_default, passed);
+    HASH_CACHE_TEST_RUN(test_ttl_expired_first, passed);
+
+    // Done
+    return ( passed ) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int test_wheel ( void )
+{
+
+    // Initialized data
+    static timestamp  deadlines[TTL_TEST_TIMERS] = { 0 };
+    static bool       scheduled[TTL_TEST_TIMERS] = { 0 };
+    hash_cache_wheel *p_wheel                    = (void *) 0;
+    timestamp         now                        = 1000;
+    unsigned          seed                       = 3;
+
+    // Construct a timer wheel with a tick of 1
+    HASH_CACHE_TEST(hash_cache_wheel_construct(&p_wheel, TTL_TEST_TIMERS, 1, now));
+
+    // Operate on the wheel at random
+    for (size_t i = 0; i < TTL_TEST_OPERATIONS; i++)
+    {
+
+        // Initialized data
+        int    operation = rand_r(&seed) % 10;
+        size_t slot      = (size_t) rand_r(&seed) % TTL_TEST_TIMERS;
+
+        // Schedule a timer on the first level, a higher level, or past the top level ...
+        if ( operation < 5 )
+        {
+
+            // Initialized data
+            int       level    = rand_r(&seed) % 4;
+            timestamp deadline = now + ( ( level == 0 ) ? rand_r(&seed) % 70 : ( level == 1 ) ? rand_r(&seed) % 5000 : ( level == 2 ) ? rand_r(&seed) % 300000 : (timestamp) rand_r(&seed) << 10 );
+
+            // Schedule the timer
+            hash_cache_wheel_schedule(p_wheel, slot, deadline);
+
+            // Remember the deadline
+            deadlines[slot] = deadline, scheduled[slot] = true;
+        }
+
+        // ... or cancel a timer ...
+        else if ( operation < 7 ) hash_cache_wheel_cancel(p_wheel, slot), scheduled[slot] = false;
+
+        // ... or advance the wheel, a little or a lot, and expire timers
+        else
+        {
+
+            // Initialized data
+            size_t expired = HASH_CACHE_WHEEL_NIL;
+
+            // Advance the wheel
+            now += ( rand_r(&seed) % 3 == 0 ) ? rand_r(&seed) % 100000 : rand_r(&seed) % 50;
+            hash_cache_wheel_advance(p_wheel, now);
+
+            // Each expired timer was scheduled, and is due
+            while ( ( expired = hash_cache_wheel_pop(p_wheel) ) != HASH_CACHE_WHEEL_NIL )
+            {
+                HASH_CACHE_TEST(scheduled[expired] && deadlines[expired] <= now);
+                scheduled[expired] = false;
+            }
+
+            // No due timer was missed
+            for (size_t j = 0; j < TTL_TEST_TIMERS; j++)
+                HASH_CACHE_TEST(scheduled[j] == false || deadlines[j] > now);
+        }
+    }
+
+    // Destroy the timer wheel
+    HASH_CACHE_TEST(hash_cache_wheel_destroy(&p_wheel));
+
+    // Pass
+    return 1;
+}
+
+static int test_ttl_maintain ( void )
+{
+
+    // Initialized data
+    cache         *p_cache  = (void *) 0;
+    cache_options  _options =
+    {
+        .expire    = true,
+        .pfn_evict = test_ttl_evict
+    };
+    timestamp      ttl      = timer_seconds_divisor();
+
+    // Forget every eviction
+    memset(evictions, 0, sizeof(evictions));
+
+    // Construct a cache that tracks expiration
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, TTL_TEST_KEYS, &_options));
+
+    // Half the keys expire in a second, and the rest never do
+    for (size_t i = 0; i < TTL_TEST_KEYS / 2; i++)
+        HASH_CACHE_TEST(cache_insert_ttl(p_cache, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i), ttl));
+    for (size_t i = TTL_TEST_KEYS / 2; i < TTL_TEST_KEYS; i++)
+        HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(i), HASH_CACHE_TEST_KEY(i)));
+
+    // Nothing has expired yet
+    HASH_CACHE_TEST(cache_maintain(p_cache, timer_high_precision()));
+    HASH_CACHE_TEST(p_cache->properties.count == TTL_TEST_KEYS);
+
+    // Maintain the cache two seconds from now
+    HASH_CACHE_TEST(cache_maintain(p_cache, timer_high_precision() + 2 * ttl));
+
+    // Each key with a time to live was evicted once, and the rest are still in the cache
+    for (size_t i = 0; i < TTL_TEST_KEYS; i++)
+    {
+        HASH_CACHE_TEST(evictions[i] == ( i < TTL_TEST_KEYS / 2 ));
+        HASH_CACHE_TEST(( cache_lookup(p_cache, HASH_CACHE_TEST_KEY(i)) == CACHE_NIL ) == ( i < TTL_TEST_KEYS / 2 ));
+    }
+
+    // The expired properties are gone
+    HASH_CACHE_TEST(p_cache->properties.count == TTL_TEST_KEYS / 2);
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_ttl_default ( void )
+{
+
+    // Initialized data
+    cache         *p_cache  = (void *) 0;
+    cache_options  _options =
+    {
+        .ttl       = timer_seconds_divisor() / 1000,
+        .pfn_evict = test_ttl_evict
+    };
+    void          *p_value  = (void *) 0;
+
+    // Forget every eviction
+    memset(evictions, 0, sizeof(evictions));
+
+    // Construct a cache with a time to live of a millisecond
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, TTL_TEST_KEYS, &_options));
+
+    // Insert a key
+    HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(0), HASH_CACHE_TEST_KEY(0)));
+
+    // Wait for the key to expire
+    test_ttl_wait(timer_high_precision() + 2 * _options.ttl);
+
+    // The key is a miss, and was evicted
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(0), &p_value) == 0);
+    HASH_CACHE_TEST(evictions[0] == 1);
+    HASH_CACHE_TEST(p_cache->properties.count == 0);
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static int test_ttl_expired_first ( void )
+{
+
+    // Initialized data
+    cache         *p_cache  = (void *) 0;
+    cache_options  _options =
+    {
+        .p_policy  = &cache_policy_lru,
+        .expire    = true,
+        .pfn_evict = test_ttl_evict
+    };
+    timestamp      ttl      = timer_seconds_divisor() / 1000;
+    void          *p_value  = (void *) 0;
+
+    // Forget every eviction
+    memset(evictions, 0, sizeof(evictions));
+
+    // Construct a cache of 4 properties
+    HASH_CACHE_TEST(cache_construct_options(&p_cache, 4, &_options));
+
+    // Insert 2 keys that expire, and 2 that don't
+    HASH_CACHE_TEST(cache_insert_ttl(p_cache, HASH_CACHE_TEST_KEY(1), HASH_CACHE_TEST_KEY(1), ttl));
+    HASH_CACHE_TEST(cache_insert_ttl(p_cache, HASH_CACHE_TEST_KEY(2), HASH_CACHE_TEST_KEY(2), ttl));
+    HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(3), HASH_CACHE_TEST_KEY(3)));
+    HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(4), HASH_CACHE_TEST_KEY(4)));
+
+    // Use the keys that expire, so LRU would evict the others first
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(1), &p_value));
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(2), &p_value));
+
+    // Wait for the keys to expire
+    test_ttl_wait(timer_high_precision() + 2 * ttl);
+
+    // Insert 2 more keys into the full cache
+    HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(5), HASH_CACHE_TEST_KEY(5)));
+    HASH_CACHE_TEST(cache_insert(p_cache, HASH_CACHE_TEST_KEY(6), HASH_CACHE_TEST_KEY(6)));
+
+    // The expired keys were evicted, and the live keys weren't
+    HASH_CACHE_TEST(evictions[1] == 1 && evictions[2] == 1);
+    HASH_CACHE_TEST(evictions[3] == 0 && evictions[4] == 0);
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(3), &p_value));
+    HASH_CACHE_TEST(cache_get(p_cache, HASH_CACHE_TEST_KEY(4), &p_value));
+
+    // Destroy the cache
+    HASH_CACHE_TEST(cache_destroy(&p_cache, (void *) 0));
+
+    // Pass
+    return 1;
+}
+
+static void test_ttl_wait ( timestamp deadline )
+{
+
+    // Spin until the deadline
+    while ( timer_high_precision() <= deadline );
+
+    // Done
+    return;
+}
+
+static void test_ttl_evict ( void *p_value, void *p_context )
+{
+
+    // Unused
+    (void) p_context;
+
+    // Count the eviction
+    evictions[(size_t) p_value >> 1]++;
+
+    // Done
+    return;
+}
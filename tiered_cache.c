@@ -0,0 +1,607 @@
+/** !
+ * Implementation of tiered cache
+ *
+ * @file tiered_cache.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/tiered_cache.h>
+
+// Data
+static __thread struct
+{
+    tiered_cache       *p_tiered_cache;
+    fn_hash_cache_free *pfn_free;
+} tiered_cache_clearing; // The tiered cache that the calling thread clears, and its free function
+
+// Function declarations
+/** !
+ * Pick the generation of a key's stripe
+ *
+ * @param p_tiered_cache the tiered cache
+ * @param h              the hash of the key
+ *
+ * @return the generation
+ */
+static inline size_t *tiered_cache_generation_of ( tiered_cache *const p_tiered_cache, hash64 h )
+{
+
+    // Success
+    return &p_tiered_cache->generations[h % TIERED_CACHE_GENERATIONS];
+}
+
+/** !
+ * Invalidate every L1 copy of the keys of a stripe, and wait for the 
+ * threads that are searching their L1 caches. The caller already changed
+ * the L2 cache, so a thread that reads the new generation also reads the 
+ * change. When this returns, no thread holds an invalidated L1 copy.
+ *
+ * @param p_tiered_cache the tiered cache
+ * @param h              the hash of a key of the stripe
+ *
+ * @return void
+ */
+static void tiered_cache_invalidate ( tiered_cache *const p_tiered_cache, hash64 h );
+
+/** !
+ * Free a value of an L2 cache that is being cleared, after its L1 copies 
+ * are invalidated
+ *
+ * @param p_value the value
+ *
+ * @return void
+ */
+static void tiered_cache_clear_free ( void *p_value );
+
+/** !
+ * Invalidate the L1 copies of a value that the L2 cache evicted, expired,
+ * or replaced, and pass the value to the caller's evict function
+ *
+ * @param p_value   the value
+ * @param p_context the tiered cache
+ *
+ * @return void
+ */
+static void tiered_cache_evict ( void *p_value, void *p_context );
+
+/** !
+ * Get the calling thread's L1 cache, allocating it on the thread's first
+ * get
+ *
+ * @param p_tiered_cache the tiered cache
+ *
+ * @return the L1 cache, or null pointer if there's no memory for it
+ */
+static tiered_cache_l1 *tiered_cache_l1_of ( tiered_cache *const p_tiered_cache );
+
+/** !
+ * Free the L1 cache of a thread that exited
+ *
+ * @param p_parameter the L1 cache
+ *
+ * @return void
+ */
+static void tiered_cache_l1_release ( void *p_parameter );
+
+// Function definitions
+int tiered_cache_construct ( tiered_cache **const pp_tiered_cache, size_t size, const tiered_cache_options *const p_options )
+{
+
+    // Argument check
+    if ( pp_tiered_cache == (void *) 0 ) goto no_tiered_cache;
+    if ( size            ==          0 ) goto invalid_size;
+
+    // Initialized data
+    tiered_cache_options      _options       = ( p_options ) ? *p_options : (tiered_cache_options) { 0 };
+    concurrent_cache_options  _l2_options    = _options.l2;
+    tiered_cache             *p_tiered_cache = HASH_CACHE_REALLOC(0, sizeof(tiered_cache));
+    size_t                    entries        = 1;
+
+    // Error check
+    if ( p_tiered_cache == (void *) 0 ) goto no_mem;
+
+    // Compute the quantity of entries of an L1 cache
+    while ( entries < ( ( _options.l1 ) ? _options.l1 : TIERED_CACHE_L1 ) ) entries <<= 1;
+
+    // Initialize the tiered cache
+    *p_tiered_cache = (tiered_cache)
+    {
+        .mask      = entries - 1,
+        .pfn_evict = _l2_options.cache.pfn_evict,
+        .p_context = _l2_options.cache.p_context
+    };
+
+    // The L2 cache invalidates the L1 copies of the values it evicts
+    _l2_options.cache.pfn_evict = tiered_cache_evict;
+    _l2_options.cache.p_context = p_tiered_cache;
+
+    // Create the lock of the L1 caches
+    if ( mutex_create(&p_tiered_cache->_mutex) == 0 ) goto failed_to_create_lock;
+
+    // Create the key of each thread's L1 cache
+    if ( pthread_key_create(&p_tiered_cache->l1, tiered_cache_l1_release) ) goto failed_to_create_key;
+
+    // Construct the L2 cache
+    if ( concurrent_cache_construct(&p_tiered_cache->p_l2, size, &_l2_options) == 0 ) goto failed_to_construct_l2;
+
+    // The L2 cache resolved the default key functions
+    p_tiered_cache->pfn_equality = p_tiered_cache->p_l2->p_shards[0].p_cache->pfn_equality;
+    p_tiered_cache->pfn_key_get  = p_tiered_cache->p_l2->p_shards[0].p_cache->pfn_key_get;
+    p_tiered_cache->pfn_key_hash = p_tiered_cache->p_l2->pfn_key_hash;
+
+    // Return a pointer to the caller
+    *pp_tiered_cache = p_tiered_cache;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_tiered_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"pp_tiered_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_size:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Parameter \"size\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Hash cache errors
+        {
+            failed_to_construct_l2:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Failed to construct L2 cache in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                pthread_key_delete(p_tiered_cache->l1);
+                mutex_destroy(&p_tiered_cache->_mutex);
+                p_tiered_cache = HASH_CACHE_REALLOC(p_tiered_cache, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Sync errors
+        {
+            failed_to_create_lock:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Failed to create lock in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                p_tiered_cache = HASH_CACHE_REALLOC(p_tiered_cache, 0);
+
+                // Error
+                return 0;
+        }
+
+        // POSIX errors
+        {
+            failed_to_create_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Failed to create thread specific key in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                mutex_destroy(&p_tiered_cache->_mutex);
+                p_tiered_cache = HASH_CACHE_REALLOC(p_tiered_cache, 0);
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int tiered_cache_get ( tiered_cache *const p_tiered_cache, const void *const p_key, void **const pp_result )
+{
+
+    // Argument check
+    if ( p_tiered_cache == (void *) 0 ) goto no_tiered_cache;
+    if ( p_key          == (void *) 0 ) goto no_key;
+    if ( pp_result      == (void *) 0 ) goto no_result;
+
+    // Initialized data
+    hash64              h          = p_tiered_cache->pfn_key_hash(p_key);
+    size_t              generation = 0;
+    tiered_cache_l1    *p_l1       = tiered_cache_l1_of(p_tiered_cache);
+    tiered_cache_entry *p_entry    = ( p_l1 ) ? &p_l1->p_entries[h & p_tiered_cache->mask] : (void *) 0;
+    bool                hit        = false;
+
+    // Start searching the L1 cache. A value isn't released while the search may compare its key
+    if ( p_l1 ) __atomic_store_n(&p_l1->sequence, p_l1->sequence + 1, __ATOMIC_SEQ_CST);
+
+    // Load the generation of the key's stripe
+    generation = __atomic_load_n(tiered_cache_generation_of(p_tiered_cache, h), __ATOMIC_SEQ_CST);
+
+    // L1 hit. The entry is valid while its stripe keeps its generation
+    hit = p_entry                           &&
+          p_entry->p_value                  &&
+          p_entry->hash       == h          &&
+          p_entry->generation == generation &&
+          p_entry->hits                     &&
+          p_tiered_cache->pfn_equality(p_tiered_cache->pfn_key_get(p_entry->p_value), p_key) == 0;
+
+    // Stop searching the L1 cache
+    if ( p_l1 ) __atomic_store_n(&p_l1->sequence, p_l1->sequence + 1, __ATOMIC_RELEASE);
+
+    // L1 hit
+    if ( hit )
+    {
+
+        // Count down to the next forwarded hit
+        p_entry->hits--;
+
+        // Return the value to the caller
+        *pp_result = p_entry->p_value;
+
+        // Success
+        return 1;
+    }
+
+    // L2 miss
+    if ( concurrent_cache_get(p_tiered_cache->p_l2, p_key, pp_result) == 0 ) return 0;
+
+    // Fill the L1 entry with the generation read before the L2 cache, so a
+    // change made during the search invalidates the entry
+    if ( p_entry )
+        *p_entry = (tiered_cache_entry)
+        {
+            .hash       = h,
+            .p_value    = *pp_result,
+            .generation = generation,
+            .hits       = TIERED_CACHE_FORWARD
+        };
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_tiered_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"p_tiered_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_result:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"pp_result\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int tiered_cache_insert ( tiered_cache *const p_tiered_cache, const void *const p_key, const void *const p_value )
+{
+
+    // Argument check
+    if ( p_tiered_cache == (void *) 0 ) goto no_tiered_cache;
+
+    // Insert the value. A replaced value goes through the evict function
+    return concurrent_cache_insert(p_tiered_cache->p_l2, p_key, p_value);
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_tiered_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"p_tiered_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int tiered_cache_remove ( tiered_cache *const p_tiered_cache, const void *const p_key, void **const pp_result )
+{
+
+    // Argument check
+    if ( p_tiered_cache == (void *) 0 ) goto no_tiered_cache;
+    if ( p_key          == (void *) 0 ) goto no_key;
+
+    // Remove the value
+    if ( concurrent_cache_remove(p_tiered_cache->p_l2, p_key, pp_result) == 0 ) return 0;
+
+    // Invalidate the L1 copies
+    tiered_cache_invalidate(p_tiered_cache, p_tiered_cache->pfn_key_hash(p_key));
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_tiered_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"p_tiered_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            no_key:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"p_key\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int tiered_cache_clear ( tiered_cache *const p_tiered_cache, fn_hash_cache_free *pfn_free )
+{
+
+    // Argument check
+    if ( p_tiered_cache == (void *) 0 ) goto no_tiered_cache;
+
+    // Initialized data
+    int result = 0;
+
+    // Free each value after its L1 copies are invalidated
+    tiered_cache_clearing.p_tiered_cache = p_tiered_cache;
+    tiered_cache_clearing.pfn_free       = pfn_free;
+
+    // Clear the L2 cache. A reader can't fill its L1 cache from a shard that is being cleared
+    result = concurrent_cache_clear(p_tiered_cache->p_l2, ( pfn_free ) ? tiered_cache_clear_free : (void *) 0);
+
+    // Done clearing
+    tiered_cache_clearing.p_tiered_cache = (void *) 0;
+    tiered_cache_clearing.pfn_free       = (void *) 0;
+
+    // Error check
+    if ( result == 0 ) return 0;
+
+    // Invalidate every L1 entry
+    for (size_t i = 0; i < TIERED_CACHE_GENERATIONS; i++) __atomic_fetch_add(&p_tiered_cache->generations[i], 1, __ATOMIC_SEQ_CST);
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_tiered_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"p_tiered_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int tiered_cache_destroy ( tiered_cache **const pp_tiered_cache, fn_hash_cache_free *pfn_free )
+{
+
+    // Argument check
+    if ( pp_tiered_cache  == (void *) 0 ) goto no_tiered_cache;
+    if ( *pp_tiered_cache == (void *) 0 ) goto no_tiered_cache;
+
+    // Initialized data
+    tiered_cache *p_tiered_cache = *pp_tiered_cache;
+
+    // No more pointer for caller
+    *pp_tiered_cache = (void *) 0;
+
+    // Destroy the L2 cache
+    concurrent_cache_destroy(&p_tiered_cache->p_l2, pfn_free);
+
+    // Threads that exit from now on keep their L1 caches
+    pthread_key_delete(p_tiered_cache->l1);
+
+    // Free every L1 cache
+    while ( p_tiered_cache->p_l1s )
+    {
+
+        // Initialized data
+        tiered_cache_l1 *p_l1 = p_tiered_cache->p_l1s;
+
+        // Free the L1 cache
+        p_tiered_cache->p_l1s = p_l1->p_next;
+        p_l1                  = HASH_CACHE_REALLOC(p_l1, 0);
+    }
+
+    // Destroy the lock of the L1 caches
+    mutex_destroy(&p_tiered_cache->_mutex);
+
+    // Free the tiered cache
+    if ( HASH_CACHE_REALLOC(p_tiered_cache, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_tiered_cache:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [tiered cache] Null pointer provided for parameter \"pp_tiered_cache\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static void tiered_cache_invalidate ( tiered_cache *const p_tiered_cache, hash64 h )
+{
+
+    // Bump the generation
+    __atomic_fetch_add(tiered_cache_generation_of(p_tiered_cache, h), 1, __ATOMIC_SEQ_CST);
+
+    // Lock the L1 caches
+    mutex_lock(&p_tiered_cache->_mutex);
+
+    // Wait for each thread that started searching its L1 cache before the 
+    // generation changed. A thread that starts later reads the new generation
+    for (tiered_cache_l1 *p_l1 = p_tiered_cache->p_l1s; p_l1; p_l1 = p_l1->p_next)
+    {
+
+        // Initialized data
+        size_t sequence = __atomic_load_n(&p_l1->sequence, __ATOMIC_SEQ_CST);
+
+        // Wait for the search
+        if ( sequence & 1 ) while ( __atomic_load_n(&p_l1->sequence, __ATOMIC_ACQUIRE) == sequence );
+    }
+
+    // Unlock the L1 caches
+    mutex_unlock(&p_tiered_cache->_mutex);
+
+    // Done
+    return;
+}
+
+static void tiered_cache_clear_free ( void *p_value )
+{
+
+    // Initialized data
+    tiered_cache *p_tiered_cache = tiered_cache_clearing.p_tiered_cache;
+
+    // Invalidate the L1 copies
+    tiered_cache_invalidate(p_tiered_cache, p_tiered_cache->pfn_key_hash(p_tiered_cache->pfn_key_get(p_value)));
+
+    // Free the value
+    tiered_cache_clearing.pfn_free(p_value);
+
+    // Done
+    return;
+}
+
+static void tiered_cache_evict ( void *p_value, void *p_context )
+{
+
+    // Initialized data
+    tiered_cache *p_tiered_cache = p_context;
+
+    // Invalidate the L1 copies
+    tiered_cache_invalidate(p_tiered_cache, p_tiered_cache->pfn_key_hash(p_tiered_cache->pfn_key_get(p_value)));
+
+    // Hand the value to the caller
+    if ( p_tiered_cache->pfn_evict ) p_tiered_cache->pfn_evict(p_value, p_tiered_cache->p_context);
+
+    // Done
+    return;
+}
+
+static tiered_cache_l1 *tiered_cache_l1_of ( tiered_cache *const p_tiered_cache )
+{
+
+    // Initialized data
+    tiered_cache_l1 *p_l1 = pthread_getspecific(p_tiered_cache->l1);
+
+    // The thread already has an L1 cache
+    if ( p_l1 ) return p_l1;
+
+    // Allocate memory for the L1 cache
+    p_l1 = HASH_CACHE_REALLOC(0, sizeof(tiered_cache_l1) + sizeof(tiered_cache_entry) * ( p_tiered_cache->mask + 1 ));
+
+    // Without an L1 cache, the thread reads the L2 cache
+    if ( p_l1 == (void *) 0 ) return (void *) 0;
+
+    // Initialize the L1 cache. The entries follow the L1 cache
+    *p_l1 = (tiered_cache_l1)
+    {
+        .p_tiered_cache = p_tiered_cache,
+        .p_entries      = (tiered_cache_entry *) ( p_l1 + 1 )
+    };
+    memset(p_l1->p_entries, 0, sizeof(tiered_cache_entry) * ( p_tiered_cache->mask + 1 ));
+
+    // Add the L1 cache to the list
+    mutex_lock(&p_tiered_cache->_mutex);
+    p_l1->p_next          = p_tiered_cache->p_l1s;
+    p_tiered_cache->p_l1s = p_l1;
+    mutex_unlock(&p_tiered_cache->_mutex);
+
+    // Store the thread's L1 cache
+    pthread_setspecific(p_tiered_cache->l1, p_l1);
+
+    // Success
+    return p_l1;
+}
+
+static void tiered_cache_l1_release ( void *p_parameter )
+{
+
+    // Initialized data
+    tiered_cache_l1  *p_l1           = p_parameter;
+    tiered_cache     *p_tiered_cache = p_l1->p_tiered_cache;
+    tiered_cache_l1 **pp_next        = (void *) 0;
+
+    // Remove the L1 cache from the list
+    mutex_lock(&p_tiered_cache->_mutex);
+    for (pp_next = &p_tiered_cache->p_l1s; *pp_next != p_l1; pp_next = &(*pp_next)->p_next);
+    *pp_next = p_l1->p_next;
+    mutex_unlock(&p_tiered_cache->_mutex);
+
+    // Free the L1 cache
+    p_l1 = HASH_CACHE_REALLOC(p_l1, 0);
+
+    // Done
+    return;
+}
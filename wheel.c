@@ -0,0 +1,474 @@
+/** !
+ * Implementation of hierarchical timer wheel
+ *
+ * @file wheel.c
+ *
+ * @author Jacob Smith
+ */
+
+// Header
+#include <hash_cache/wheel.h>
+
+// Standard library
+#include <stdlib.h>
+#include <string.h>
+
+// Preprocessor definitions
+#define HASH_CACHE_WHEEL_MASK    ( HASH_CACHE_WHEEL_BUCKETS - 1 )
+#define HASH_CACHE_WHEEL_SPAN    ( 1ULL << ( HASH_CACHE_WHEEL_BITS * HASH_CACHE_WHEEL_LEVELS ) )
+#define HASH_CACHE_WHEEL_EXPIRED ( HASH_CACHE_WHEEL_LEVELS * HASH_CACHE_WHEEL_BUCKETS )
+
+// Each level's occupied buckets fill one word
+#if HASH_CACHE_WHEEL_BITS != 6
+    #error "HASH_CACHE_WHEEL_BITS must be 6"
+#endif
+
+// Function declarations
+/** !
+ * Compute the sentinel of a bucket
+ *
+ * @param p_wheel the timer wheel
+ * @param level   the level
+ * @param bucket  the bucket
+ *
+ * @return the index of the sentinel
+ */
+static inline size_t hash_cache_wheel_sentinel ( const hash_cache_wheel *const p_wheel, size_t level, size_t bucket )
+{
+
+    // Success
+    return p_wheel->max + level * HASH_CACHE_WHEEL_BUCKETS + bucket;
+}
+
+/** !
+ * Add a timer to the back of a list
+ *
+ * @param p_wheel  the timer wheel
+ * @param sentinel the sentinel of the list
+ * @param i        the timer
+ *
+ * @return void
+ */
+static inline void hash_cache_wheel_link ( hash_cache_wheel *const p_wheel, size_t sentinel, size_t i )
+{
+
+    // Initialized data
+    hash_cache_wheel_timer *p_timers = p_wheel->p_timers;
+
+    // Link the timer before the sentinel
+    p_timers[i].prev                       = p_timers[sentinel].prev;
+    p_timers[i].next                       = sentinel;
+    p_timers[p_timers[sentinel].prev].next = i;
+    p_timers[sentinel].prev                = i;
+
+    // Mark the bucket occupied, unless the list is the expired list
+    if ( sentinel != p_wheel->max + HASH_CACHE_WHEEL_EXPIRED ) p_wheel->occupied[( sentinel - p_wheel->max ) / HASH_CACHE_WHEEL_BUCKETS] |= 1ULL << ( ( sentinel - p_wheel->max ) % HASH_CACHE_WHEEL_BUCKETS );
+
+    // Done
+    return;
+}
+
+/** !
+ * Compute the next tick after the current tick that expires or cascades an
+ * occupied bucket
+ *
+ * @param p_wheel the timer wheel, with at least one timer in a bucket
+ *
+ * @return the tick
+ */
+static unsigned long long hash_cache_wheel_next ( const hash_cache_wheel *const p_wheel );
+
+/** !
+ * Reschedule every timer in a bucket of a level, to a lower level
+ *
+ * @param p_wheel the timer wheel
+ * @param level   the level
+ *
+ * @return the bucket of the level
+ */
+static size_t hash_cache_wheel_cascade ( hash_cache_wheel *const p_wheel, size_t level );
+
+// Function definitions
+int hash_cache_wheel_construct ( hash_cache_wheel **const pp_wheel, size_t max, timestamp resolution, timestamp now )
+{
+
+    // Argument check
+    if ( pp_wheel   == (void *) 0 ) goto no_wheel;
+    if ( max        ==          0 ) goto invalid_max;
+    if ( resolution <=          0 ) goto invalid_resolution;
+
+    // Initialized data
+    hash_cache_wheel *p_wheel = HASH_CACHE_REALLOC(0, sizeof(hash_cache_wheel));
+
+    // Error check
+    if ( p_wheel == (void *) 0 ) goto no_mem;
+
+    // Initialize the timer wheel
+    *p_wheel = (hash_cache_wheel)
+    {
+        .p_timers   = HASH_CACHE_REALLOC(0, sizeof(hash_cache_wheel_timer) * ( max + HASH_CACHE_WHEEL_EXPIRED + 1 )),
+        .max        = max,
+        .resolution = resolution
+    };
+
+    // Error check
+    if ( p_wheel->p_timers == (void *) 0 ) goto no_mem;
+
+    // Every bucket starts empty
+    hash_cache_wheel_clear(p_wheel);
+
+    // Start at the current tick
+    p_wheel->tick = (unsigned long long) ( now / resolution );
+
+    // Return a pointer to the caller
+    *pp_wheel = p_wheel;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_wheel:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [wheel] Null pointer provided for parameter \"pp_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_max:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [wheel] Parameter \"max\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+
+            invalid_resolution:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [wheel] Parameter \"resolution\" must be greater than zero in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            no_mem:
+                #ifndef NDEBUG
+                    log_error("[hash cache] Failed to allocate memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Clean up
+                if ( p_wheel ) p_wheel = HASH_CACHE_REALLOC(p_wheel, 0);
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+void hash_cache_wheel_schedule ( hash_cache_wheel *const p_wheel, size_t slot, timestamp deadline )
+{
+
+    // Initialized data
+    unsigned long long tick  = (unsigned long long) ( ( deadline + p_wheel->resolution - 1 ) / p_wheel->resolution ),
+                       delta = 0;
+    size_t             level = 0;
+
+    // Unlink the timer, if it's scheduled
+    hash_cache_wheel_cancel(p_wheel, slot);
+
+    // Store the deadline
+    p_wheel->p_timers[slot].deadline = deadline;
+
+    // A timer that already expired goes to the expired list
+    if ( deadline <= 0 || tick <= p_wheel->tick )
+    {
+
+        // Add the timer to the expired list
+        hash_cache_wheel_link(p_wheel, p_wheel->max + HASH_CACHE_WHEEL_EXPIRED, slot);
+
+        // Done
+        return;
+    }
+
+    // A timer past the top level waits in the farthest bucket, and is rescheduled when it cascades
+    delta = tick - p_wheel->tick;
+    if ( delta >= HASH_CACHE_WHEEL_SPAN ) delta = HASH_CACHE_WHEEL_SPAN - 1, tick = p_wheel->tick + delta;
+
+    // Find the lowest level that spans the delta
+    while ( delta >= ( 1ULL << ( HASH_CACHE_WHEEL_BITS * ( level + 1 ) ) ) ) level++;
+
+    // Add the timer to its bucket
+    hash_cache_wheel_link(p_wheel, hash_cache_wheel_sentinel(p_wheel, level, (size_t) ( tick >> ( HASH_CACHE_WHEEL_BITS * level ) ) & HASH_CACHE_WHEEL_MASK), slot);
+    p_wheel->scheduled++;
+
+    // Done
+    return;
+}
+
+void hash_cache_wheel_cancel ( hash_cache_wheel *const p_wheel, size_t slot )
+{
+
+    // Initialized data
+    hash_cache_wheel_timer *p_timers = p_wheel->p_timers;
+    size_t                  prev     = p_timers[slot].prev,
+                            next     = p_timers[slot].next;
+
+    // Not scheduled?
+    if ( next == HASH_CACHE_WHEEL_NIL ) return;
+
+    // Unlink the timer
+    p_timers[prev].next = next;
+    p_timers[next].prev = prev;
+    p_timers[slot].prev = HASH_CACHE_WHEEL_NIL;
+    p_timers[slot].next = HASH_CACHE_WHEEL_NIL;
+
+    // The last timer of a bucket leaves the bucket empty
+    if ( prev == next && prev >= p_wheel->max && prev != p_wheel->max + HASH_CACHE_WHEEL_EXPIRED ) p_wheel->occupied[( prev - p_wheel->max ) / HASH_CACHE_WHEEL_BUCKETS] &= ~( 1ULL << ( ( prev - p_wheel->max ) % HASH_CACHE_WHEEL_BUCKETS ) );
+
+    // A timer whose tick has passed is on the expired list, not in a bucket
+    if ( p_timers[slot].deadline > 0 && (unsigned long long) ( ( p_timers[slot].deadline + p_wheel->resolution - 1 ) / p_wheel->resolution ) > p_wheel->tick ) p_wheel->scheduled--;
+
+    // Done
+    return;
+}
+
+void hash_cache_wheel_advance ( hash_cache_wheel *const p_wheel, timestamp now )
+{
+
+    // Initialized data
+    unsigned long long target = (unsigned long long) ( now / p_wheel->resolution );
+
+    // Tick until the wheel catches up
+    while ( p_wheel->tick < target )
+    {
+
+        // Initialized data
+        size_t             sentinel = 0;
+        unsigned long long next     = 0;
+
+        // An empty wheel skips ahead
+        if ( p_wheel->scheduled == 0 ) { p_wheel->tick = target; break; }
+
+        // Find the next tick that does anything
+        next = hash_cache_wheel_next(p_wheel);
+
+        // Skip ahead to the target, if nothing happens before it ...
+        if ( next > target ) { p_wheel->tick = target; break; }
+
+        // ... else skip ahead to the tick
+        p_wheel->tick = next;
+
+        // When the lowest level wraps around, cascade the next bucket of each higher level
+        if ( ( p_wheel->tick & HASH_CACHE_WHEEL_MASK ) == 0 )
+            for (size_t level = 1; level < HASH_CACHE_WHEEL_LEVELS; level++)
+                if ( hash_cache_wheel_cascade(p_wheel, level) ) break;
+
+        // Every timer in the lowest level's bucket expires on this tick
+        sentinel = hash_cache_wheel_sentinel(p_wheel, 0, (size_t) p_wheel->tick & HASH_CACHE_WHEEL_MASK);
+
+        // Move the bucket to the expired list
+        while ( p_wheel->p_timers[sentinel].next != sentinel )
+        {
+
+            // Initialized data
+            size_t i = p_wheel->p_timers[sentinel].next;
+
+            // Unlink the timer
+            p_wheel->p_timers[sentinel].next                  = p_wheel->p_timers[i].next;
+            p_wheel->p_timers[p_wheel->p_timers[i].next].prev = sentinel;
+            p_wheel->scheduled--;
+
+            // Add the timer to the expired list
+            hash_cache_wheel_link(p_wheel, p_wheel->max + HASH_CACHE_WHEEL_EXPIRED, i);
+        }
+
+        // The bucket is empty
+        p_wheel->occupied[0] &= ~( 1ULL << ( sentinel - p_wheel->max ) );
+    }
+
+    // Done
+    return;
+}
+
+size_t hash_cache_wheel_pop ( hash_cache_wheel *const p_wheel )
+{
+
+    // Initialized data
+    size_t expired = p_wheel->max + HASH_CACHE_WHEEL_EXPIRED,
+           i       = p_wheel->p_timers[expired].next;
+
+    // No timer expired?
+    if ( i == expired ) return HASH_CACHE_WHEEL_NIL;
+
+    // Unlink the timer
+    p_wheel->p_timers[expired].next                   = p_wheel->p_timers[i].next;
+    p_wheel->p_timers[p_wheel->p_timers[i].next].prev = expired;
+    p_wheel->p_timers[i].prev                         = HASH_CACHE_WHEEL_NIL;
+    p_wheel->p_timers[i].next                         = HASH_CACHE_WHEEL_NIL;
+
+    // Success
+    return i;
+}
+
+int hash_cache_wheel_clear ( hash_cache_wheel *const p_wheel )
+{
+
+    // Argument check
+    if ( p_wheel == (void *) 0 ) goto no_wheel;
+
+    // No timer is scheduled
+    for (size_t i = 0; i < p_wheel->max; i++)
+        p_wheel->p_timers[i] = (hash_cache_wheel_timer) { .deadline = 0, .prev = HASH_CACHE_WHEEL_NIL, .next = HASH_CACHE_WHEEL_NIL };
+
+    // Every bucket, and the expired list, is an empty ring
+    for (size_t i = p_wheel->max; i <= p_wheel->max + HASH_CACHE_WHEEL_EXPIRED; i++)
+        p_wheel->p_timers[i] = (hash_cache_wheel_timer) { .deadline = 0, .prev = i, .next = i };
+
+    // No timer is in a bucket
+    p_wheel->scheduled = 0;
+    memset(p_wheel->occupied, 0, sizeof(p_wheel->occupied));
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_wheel:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [wheel] Null pointer provided for parameter \"p_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+int hash_cache_wheel_destroy ( hash_cache_wheel **const pp_wheel )
+{
+
+    // Argument check
+    if ( pp_wheel  == (void *) 0 ) goto no_wheel;
+    if ( *pp_wheel == (void *) 0 ) goto no_wheel;
+
+    // Initialized data
+    hash_cache_wheel *p_wheel = *pp_wheel;
+
+    // No more pointer for caller
+    *pp_wheel = (void *) 0;
+
+    // Free the timers
+    if ( HASH_CACHE_REALLOC(p_wheel->p_timers, 0) ) goto failed_to_free;
+
+    // Free the timer wheel
+    if ( HASH_CACHE_REALLOC(p_wheel, 0) ) goto failed_to_free;
+
+    // Success
+    return 1;
+
+    // Error handling
+    {
+
+        // Argument errors
+        {
+            no_wheel:
+                #ifndef NDEBUG
+                    log_error("[hash cache] [wheel] Null pointer provided for parameter \"pp_wheel\" in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+
+        // Standard library errors
+        {
+            failed_to_free:
+                #ifndef NDEBUG
+                    log_error("[standard library] Failed to free memory in call to function \"%s\"\n", __FUNCTION__);
+                #endif
+
+                // Error
+                return 0;
+        }
+    }
+}
+
+static size_t hash_cache_wheel_cascade ( hash_cache_wheel *const p_wheel, size_t level )
+{
+
+    // Initialized data
+    size_t bucket   = (size_t) ( p_wheel->tick >> ( HASH_CACHE_WHEEL_BITS * level ) ) & HASH_CACHE_WHEEL_MASK,
+           sentinel = hash_cache_wheel_sentinel(p_wheel, level, bucket),
+           i        = p_wheel->p_timers[sentinel].next;
+
+    // Empty the bucket
+    p_wheel->p_timers[sentinel].prev  = sentinel;
+    p_wheel->p_timers[sentinel].next  = sentinel;
+    p_wheel->occupied[level]         &= ~( 1ULL << bucket );
+
+    // Reschedule each timer
+    while ( i != sentinel )
+    {
+
+        // Initialized data
+        size_t next = p_wheel->p_timers[i].next;
+
+        // The timer leaves the bucket
+        p_wheel->p_timers[i].prev = HASH_CACHE_WHEEL_NIL;
+        p_wheel->p_timers[i].next = HASH_CACHE_WHEEL_NIL;
+        p_wheel->scheduled--;
+
+        // Schedule the timer again, relative to the current tick
+        hash_cache_wheel_schedule(p_wheel, i, p_wheel->p_timers[i].deadline);
+
+        // Next
+        i = next;
+    }
+
+    // Success
+    return bucket;
+}
+
+static unsigned long long hash_cache_wheel_next ( const hash_cache_wheel *const p_wheel )
+{
+
+    // Initialized data
+    unsigned long long next = ~0ULL;
+
+    // Find the first occupied bucket of each level, after the current tick
+    for (size_t level = 0; level < HASH_CACHE_WHEEL_LEVELS; level++)
+    {
+
+        // Initialized data
+        unsigned long long occupied = p_wheel->occupied[level],
+                           index    = ( p_wheel->tick >> ( HASH_CACHE_WHEEL_BITS * level ) ) + 1,
+                           offset   = 0,
+                           tick     = 0;
+
+        // Skip empty levels
+        if ( occupied == 0 ) continue;
+
+        // Rotate the level's buckets, so the bucket of the next index is bit 0
+        offset   = index & HASH_CACHE_WHEEL_MASK;
+        occupied = ( offset ) ? ( occupied >> offset ) | ( occupied << ( HASH_CACHE_WHEEL_BUCKETS - offset ) ) : occupied;
+
+        // The first occupied bucket expires, or cascades, when the level reaches it
+        tick = ( index + (unsigned long long) __builtin_ctzll(occupied) ) << ( HASH_CACHE_WHEEL_BITS * level );
+
+        // Keep the earliest
+        if ( tick < next ) next = tick;
+    }
+
+    // Success
+    return next;
+}